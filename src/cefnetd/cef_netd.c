@@ -41,12 +41,17 @@
 #endif //__APPLE
 #include "cef_netd.h"
 #include "cef_status.h"
+#include "cef_worker.h"
 #ifdef __APPLE__
 #include <sys/socket.h>
 #include <netinet/in.h>
 #endif //__APPLE
 
 #include <sys/ioctl.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#define CefC_Netd_Epoll
+#endif // __linux__
 
 #ifndef CefC_ContentStore
 #define CefC_NDEF_ContentStore
@@ -93,9 +98,29 @@ typedef	enum	{
 	CefC_Connection_Type_Csm,
 	CefC_Connection_Type_Ccr,
 	CefC_Connection_Type_Num,
+	CefC_Connection_Type_Worker = 97,
+	CefC_Connection_Type_Accept = 98,
 	CefC_Connection_Type_Local = 99,
 }	CefC_Connection_Type;
 
+/*----- Timers of the main loop, kept in a min-heap ordered by the deadline -----*/
+typedef	enum	{
+	CefC_Netd_Timer_Pit = 0,					/* PIT expiry 							*/
+	CefC_Netd_Timer_Fib,						/* FIB cleaning 						*/
+	CefC_Netd_Timer_Ccore,						/* Reconnection to ccored 				*/
+	CefC_Netd_Timer_Excache,					/* Push to the external cache 			*/
+	CefC_Netd_Timer_Num,
+}	CefT_Netd_Timer_Id;
+
+#define CefC_Netd_Wait_Max_Ms		100			/* Upper limit of one wait (msec) 		*/
+#define CefC_Netd_Ep_Events			256			/* Events handled by one epoll_wait		*/
+#define CefC_Netd_Txque_Bulk		32			/* Elements popped from TX queue at once*/
+#define CefC_Netd_Rcv_Tail_Min		16384		/* Compacts the receive buffer of a face*/
+												/* if the free tail is shorter than it 	*/
+#define CefC_Netd_Ep_Reg_Max		(CefC_Listen_Face_Max * 2 + CefC_App_Conn_Num * 2 + 8)
+												/* the apps may use eventfd as well 	*/
+#define CefC_Netd_Shm_Read_Max		64			/* Reads from a ring at one wakeup		*/
+
 
 #define CefC_App_MatchType_Exact		0
 #define CefC_App_MatchType_Prefix		1
@@ -136,6 +161,40 @@ static uint64_t stat_rcv_size_max = 0;
 
 static char root_user_name[CefC_Ctrl_User_Len] = {"root"};
 
+/* Min-heap of the timers of the main loop 	*/
+static struct {
+	uint64_t			expire[CefC_Netd_Timer_Num];	/* Deadline of each timer (usec)	*/
+	int 				heap[CefC_Netd_Timer_Num];		/* Timer IDs in heap order 			*/
+	int 				pos[CefC_Netd_Timer_Num];		/* Position in heap, -1 if unset	*/
+	int 				num;
+} cefnetd_timer;
+
+#ifdef CefC_Netd_Epoll
+/* Registration of a FD to epoll 	*/
+typedef struct {
+	int 				fd;
+	int 				type;						/* CefC_Connection_Type 			*/
+	int 				faceid;
+	uint32_t 			fd_gen;						/* Generation of the Face's FD 		*/
+	int 				out_f;						/* Waits for EPOLLOUT 				*/
+} CefT_Netd_Ep_Reg;
+
+/* Persistent epoll registrations and the state they were built from 	*/
+static struct {
+	int 				epfd;
+	CefT_Netd_Ep_Reg	regs[CefC_Netd_Ep_Reg_Max];	/* sorted by FD 					*/
+	int 				reg_num;
+	int 				synced_f;
+	uint32_t 			face_gen;
+	int 				app_fds_num;
+	int 				babel_sock;
+	int 				cs_local_sock;
+	int 				cs_tcp_sock;
+	int 				rt_sock;
+	int 				out_num;					/* Registrations waiting for EPOLLOUT*/
+} cefnetd_ep = { .epfd = -1 };
+#endif // CefC_Netd_Epoll
+
 
 #ifdef CefC_ContentStore
 static uint64_t ccninfo_push_time = 0;
@@ -236,6 +295,19 @@ cefnetd_udp_input_process (
 	int fd, 								/* FD which is polled POLLIN				*/
 	int faceid								/* Face-ID that message arrived 			*/
 );
+/*--------------------------------------------------------------------------------------
+	Handles the datagram received from the UDP socket
+----------------------------------------------------------------------------------------*/
+static int
+cefnetd_udp_dgram_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int fd, 								/* FD which is polled POLLIN				*/
+	int faceid,								/* Face-ID that message arrived 			*/
+	unsigned char* buff,					/* Received datagram						*/
+	size_t recv_len,						/* Length of the datagram					*/
+	struct addrinfo* sas_p,					/* Source address							*/
+	socklen_t sas_len						/* Length of the source address				*/
+);
 /*--------------------------------------------------------------------------------------
 	Handles the input message from the TCP listen socket
 ----------------------------------------------------------------------------------------*/
@@ -436,10 +508,75 @@ cefnetd_input_message_process (
 ----------------------------------------------------------------------------------------*/
 static int									/* Returns a negative value if it fails 	*/
 cefnetd_messege_head_seek (
-	CefT_Face* face,						/* the face structure						*/
+	unsigned char* buff,					/* buffer of the received data 				*/
+	int* index,								/* offset of the data not handled yet 		*/
+	int* len,								/* length of the data not handled yet 		*/
 	uint16_t* payload_len,
 	uint16_t* header_len
 );
+/*--------------------------------------------------------------------------------------
+	Handles the messages in the received data in place
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_input_message_handle (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* buff,					/* buffer of the received data 				*/
+	int* index,								/* offset of the data not handled yet 		*/
+	int* len,								/* length of the data not handled yet 		*/
+	char*	user_id
+);
+/*--------------------------------------------------------------------------------------
+	Passes the Interest or the Content Object to the forwarding worker which owns
+	its Name, unless the message needs the functions of the main thread
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the worker took the message 		*/
+cefnetd_worker_steer (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* msg, 					/* the received message 					*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the message which a forwarding worker handed back
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_back_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* msg, 					/* the message 								*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the messages in the receive buffer of the face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_face_rcv_buff_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	CefT_Face* face,						/* the face structure						*/
+	char*	user_id
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the free area at the tail of the receive buffer of the face
+----------------------------------------------------------------------------------------*/
+static unsigned char*						/* tail of the receive buffer 				*/
+cefnetd_face_rcv_tail_get (
+	CefT_Face* face,						/* the face structure						*/
+	int min_len,							/* length to compact the buffer if the tail */
+											/* is shorter than it 						*/
+	int* tail_len							/* length of the free area 					*/
+);
 /*--------------------------------------------------------------------------------------
 	Handles the received Interest message
 ----------------------------------------------------------------------------------------*/
@@ -782,6 +919,18 @@ cefnetd_incoming_command_process (
 											/* transmission of the message(s)			*/
 	CefT_CcnMsg_MsgBdy* pm					/* Structure to set parsed CEFORE message	*/
 );
+/*--------------------------------------------------------------------------------------
+	Attaches the shared memory ring passed by the local app to its face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_shmring_attach (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int idx,									/* index of the app in app_fds			*/
+	unsigned char* msg,							/* message received with the FDs		*/
+	int len,									/* length of the message				*/
+	int fds[],									/* FDs passed by the app				*/
+	int fd_num									/* number of the FDs					*/
+);
 /*--------------------------------------------------------------------------------------
 	Accepts and receives the frame(s) from local face
 ----------------------------------------------------------------------------------------*/
@@ -814,6 +963,113 @@ cefnetd_poll_socket_prepare (
 	CefC_Connection_Type fd_type[],
 	int faceids[]
 );
+/*--------------------------------------------------------------------------------------
+	Accepts the TCP socket and adds it to the listen faces
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tcp_accept (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Waits for and handles the input with poll()
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_poll_dispatch (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+#ifdef CefC_Netd_Epoll
+/*--------------------------------------------------------------------------------------
+	Waits for and handles the input with epoll
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_dispatch (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Synchronizes the epoll registrations with the faces and the sockets in use
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_sync (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Waits for EPOLLOUT on the faces which have the messages waiting to be sent
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_out_sync (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Compares the epoll registrations by FD
+----------------------------------------------------------------------------------------*/
+static int
+cefnetd_epoll_reg_compare (
+	const void* a,
+	const void* b
+);
+/*--------------------------------------------------------------------------------------
+	Adds, modifies or deletes the registration of a FD to epoll
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_ctl (
+	int op,										/* EPOLL_CTL_ADD/MOD/DEL 				*/
+	const CefT_Netd_Ep_Reg* reg
+);
+#endif // CefC_Netd_Epoll
+/*--------------------------------------------------------------------------------------
+	Clears all the timers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_init (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Swaps two timers in the min-heap
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_heap_swap (
+	int a,
+	int b
+);
+/*--------------------------------------------------------------------------------------
+	Restores the order of the min-heap at the specified position
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_heap_fix (
+	int idx
+);
+/*--------------------------------------------------------------------------------------
+	Sets the deadline of the specified timer (UINT64_MAX unsets it)
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_set (
+	int id,										/* CefT_Netd_Timer_Id					*/
+	uint64_t expire								/* deadline (usec)						*/
+);
+/*--------------------------------------------------------------------------------------
+	Runs the expired timers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_run (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Re-arms the timers from the state of each module
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_rearm (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the time to wait for the input until the earliest timer
+----------------------------------------------------------------------------------------*/
+static int										/* timeout (msec)						*/
+cefnetd_timer_wait_get (
+	uint64_t nowt								/* current time (usec) 					*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains my NodeID (IP Address)
 ----------------------------------------------------------------------------------------*/
@@ -985,6 +1241,13 @@ cefnetd_handle_create (
 	hdl->Ex_Cache_Access		= CefC_Default_CSMGR_ACCESS_RW;
 	strcpy( hdl->bw_stat_pin_name, "bw_stat" );
 	hdl->Buffer_Cache_Time		= CefC_Default_BUFFER_CACHE_TIME * 1000;
+	hdl->udp_batch_size			= CefC_Default_UDP_BATCH_SIZE;
+	hdl->face_outq_size			= CefC_Default_FACE_OUTQ_SIZE;
+	hdl->face_outq_policy		= CefC_Default_FACE_OUTQ_POLICY;
+	hdl->hash_high_water		= CefC_Hash_High_Water_Def;
+	hdl->hash_low_water			= CefC_Hash_Low_Water_Def;
+	hdl->local_shm_size			= CefC_Default_LocalShmSize;
+	hdl->fwd_workers			= CefC_Default_FWD_WORKERS;
 	hdl->cefstatus_pipe_fd[0]	= -1;
 	hdl->cefstatus_pipe_fd[1]	= -1;
 	//202108
@@ -1023,6 +1286,7 @@ cefnetd_handle_create (
 		return (NULL);
 	}
 	cef_log_write (CefC_Log_Info, "Loading cefnetd.conf ... OK\n");
+	cef_hash_water_mark_set (hdl->hash_high_water, hdl->hash_low_water);
 
 	/* Initialize sha256 validation environment for ccninfo */
 	if (hdl->ccninfo_valid_type == CefC_T_RSA_SHA256) {
@@ -1071,7 +1335,7 @@ cefnetd_handle_create (
 	cefnetd_node_id_get (hdl);
 
 	/* Creates and initialize FIB			*/
-	hdl->fib = cef_hash_tbl_create_ext ((uint16_t) hdl->fib_max_size, CefC_Hash_Coef_FIB);
+	hdl->fib = cef_hash_tbl_create_resizable ((uint16_t) hdl->fib_max_size, CefC_Hash_Coef_FIB);
 	cef_fib_init (hdl->fib,
 				  hdl->nodeid4_num,
 				  hdl->nodeid16_num,
@@ -1090,8 +1354,8 @@ cefnetd_handle_create (
 
 	/* Creates PIT 							*/
 	cef_pit_init (hdl->ccninfo_reply_timeout, hdl->Symbolic_max_lifetime, hdl->Regular_max_lifetime); //0.8.3
-	hdl->pit = cef_lhash_tbl_create_ext (hdl->pit_max_size, CefC_Hash_Coef_PIT);
-	hdl->pit_clean_t = cef_client_present_timeus_calc () + CefC_Pit_CleaningTime;
+	hdl->pit = cef_lhash_tbl_create_resizable (hdl->pit_max_size, CefC_Hash_Coef_PIT);
+	cef_pit_timer_init (hdl->pit, cef_client_present_timeus_calc ());
 	cef_log_write (CefC_Log_Info, "Creation PIT ... OK\n");
 
 	/* Prepares sockets for applications 	*/
@@ -1125,18 +1389,14 @@ cefnetd_handle_create (
 	hdl->cs_stat->csmgr_access = hdl->Ex_Cache_Access;
 	/* BUFFER_CACHE_TIME */
 	hdl->cs_stat->buffer_cache_time = hdl->Buffer_Cache_Time;
-
-	/* set send content rate 	*/
-	hdl->send_rate = (double)(8.0 / (double) hdl->fwd_rate);
-	hdl->send_next = 0;
 #else // CefC_ContentStore
 	hdl->cs_stat = NULL;
 #endif // CefC_ContentStore
 
 	/* Creates App Reg table 		*/
-	hdl->app_reg = cef_hash_tbl_create_ext (hdl->app_fib_max_size, CefC_Hash_Coef_FIB);
+	hdl->app_reg = cef_hash_tbl_create_resizable (hdl->app_fib_max_size, CefC_Hash_Coef_FIB);
 	/* Creates App Reg PIT 			*/
-	hdl->app_pit = cef_lhash_tbl_create_ext (hdl->app_pit_max_size, CefC_Hash_Coef_PIT);
+	hdl->app_pit = cef_lhash_tbl_create_resizable (hdl->app_pit_max_size, CefC_Hash_Coef_PIT);
 
 	/* Inits the plugin 			*/
 	cef_plugin_init (&(hdl->plugin_hdl));
@@ -1187,6 +1447,9 @@ cefnetd_handle_create (
 		}
 	}
 
+	/* Starts the forwarding workers, which need the strategy and the Content Store */
+	cefnetd_worker_init (hdl);
+
 	/* Records the user which launched cefnetd 		*/
 	wp = getenv ("USER");
 
@@ -1304,6 +1567,9 @@ cefnetd_handle_destroy (
 ) {
 	char sock_path[1024];
 
+	/* The workers refer to the FIB and the Faces 	*/
+	cefnetd_worker_destroy ();
+
 	/* destroy plugins 		*/
 	cef_tp_plugin_destroy (hdl->plugin_hdl.tp);
 	cef_plugin_destroy (&(hdl->plugin_hdl));
@@ -1377,18 +1643,23 @@ void
 cefnetd_event_dispatch (
 	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
 ) {
-	int i;
-	int res;
-
 	uint64_t nowt = cef_client_present_timeus_calc ();
 
 	cef_log_write (CefC_Log_Info, "Running\n");
 	cefnetd_running_f = 1;
 
-	struct pollfd fds[CefC_Listen_Face_Max * 2];
-	CefC_Connection_Type fd_type[CefC_Listen_Face_Max * 2];
-	int faceids[CefC_Listen_Face_Max * 2];
-	int fdnum;
+#ifdef CefC_Netd_Epoll
+	cefnetd_ep.epfd = epoll_create1 (EPOLL_CLOEXEC);
+	if (cefnetd_ep.epfd < 0) {
+		cef_log_write (CefC_Log_Warn,
+			"epoll_create1 failed (%s), uses poll() instead\n", strerror (errno));
+		cefnetd_ep.epfd = -1;
+	}
+	cefnetd_ep.synced_f = 0;
+	cefnetd_ep.reg_num = 0;
+#endif // CefC_Netd_Epoll
+	cefnetd_timer_init ();
+	cefnetd_timer_rearm (hdl, nowt);
 
 #ifdef CefC_Ccore
 	uint64_t ret_cnt = 5;
@@ -1429,57 +1700,27 @@ cefnetd_event_dispatch (
 		}
 #endif // CefC_Ccore
 
-		/* Cleans PIT entries 		*/
-		cefnetd_pit_cleanup (hdl, nowt);
+		/* Cleans PIT/FIB entries when their timers expire 		*/
+		cefnetd_timer_run (hdl, nowt);
 
-		/* Cleans FIB entries 		*/
-		cefnetd_fib_cleanup (hdl, nowt);
-		/* Accepts the TCP socket 	*/
-		res = cef_face_accept_connect ();
-
-		if ((res > 0) && (hdl->intcpfdc < CefC_Listen_Face_Max)) {
-			hdl->intcpfaces[hdl->intcpfdc] = (uint16_t) res;
-			hdl->intcpfds[hdl->intcpfdc].fd
-				= cef_face_get_fd_from_faceid ((uint16_t) res);
-			hdl->intcpfds[hdl->intcpfdc].events = POLLIN | POLLERR;
-			hdl->intcpfdc++;
+		/* Receives the frame(s) from the faces and the local processes 		*/
+#ifdef CefC_Netd_Epoll
+		if (cefnetd_ep.epfd != -1) {
+			cefnetd_epoll_dispatch (hdl, nowt);
+		} else {
+			cefnetd_poll_dispatch (hdl);
 		}
+#else // CefC_Netd_Epoll
+		cefnetd_poll_dispatch (hdl);
+#endif // CefC_Netd_Epoll
 
-		/* Receives the frame(s) from local process 		*/
-		cefnetd_input_from_local_process (hdl);
-		cef_face_update_listen_faces (
-				hdl->inudpfds, hdl->inudpfaces, &hdl->inudpfdc,
-				hdl->intcpfds, hdl->intcpfaces, &hdl->intcpfdc);
-		/* Receives the frame(s) from the listen port 		*/
-		fdnum = cefnetd_poll_socket_prepare (hdl, fds, fd_type, faceids);
-		res = poll (fds, fdnum, 1);
-
-		for (i = 0 ; res > 0 && i < fdnum ; i++) {
-
-			if (fds[i].revents != 0) {
-				res--;
-				if (fds[i].revents & POLLIN) {
-					if (fd_type[i] == CefC_Connection_Type_Local) {
-						continue;
-					}
-					(*cefnetd_input_process[fd_type[i]]) (
-										hdl, fds[i].fd, faceids[i]);
-				}
-#ifdef __APPLE__
-				if (fds[i].revents & (POLLERR | POLLNVAL)) {
-#else // __APPLE__
-				if (fds[i].revents & (POLLERR | POLLNVAL | POLLHUP)) {
-#endif // __APPLE__
-					if (fd_type[i] < CefC_Connection_Type_Csm) {
-						cef_face_close (faceids[i]);
-						cef_fib_faceid_cleanup (hdl->fib);
-					}
-				}
+		cefnetd_input_from_txque_process (hdl);
 
-			}
-		}
+		/* Sends the messages which the forwarding workers returned 	*/
+		cefnetd_worker_process (hdl, cefnetd_worker_back_process);
 
-		cefnetd_input_from_txque_process (hdl);
+		/* Sends the UDP datagrams queued in this iteration 	*/
+		cef_face_udp_batch_flush ();
 
 #ifdef CefC_ContentStore
 		if ((hdl->cs_stat->cache_type != CefC_Cache_Type_None) &&
@@ -1497,8 +1738,16 @@ cefnetd_event_dispatch (
 		}
 #endif // CefC_ContentStore
 
+		/* Re-arms the timers, the PIT may have new entries 	*/
+		cefnetd_timer_rearm (hdl, nowt);
 	}
 
+#ifdef CefC_Netd_Epoll
+	if (cefnetd_ep.epfd != -1) {
+		close (cefnetd_ep.epfd);
+		cefnetd_ep.epfd = -1;
+	}
+#endif // CefC_Netd_Epoll
 }
 /*--------------------------------------------------------------------------------------
 	Ccninfo Full discobery authentication & authorization
@@ -1649,6 +1898,7 @@ cefnetd_poll_socket_prepare (
 	CefC_Connection_Type fd_type[],
 	int faceids[]
 ) {
+	CefT_Shmring* sr;
 	int res = 0;
 	int i;
 	int n;
@@ -1724,11 +1974,628 @@ cefnetd_poll_socket_prepare (
 			fd_type[res] = CefC_Connection_Type_Local;
 			faceids[res] = 0;
 			res++;
+
+			/* The app with the shared memory ring wakes up cefnetd by eventfd 	*/
+			sr = cef_face_shmring_get ((uint16_t) hdl->app_faces[i]);
+			if (sr) {
+				fds[res].events = POLLIN | POLLERR;
+				fds[res].fd = sr->efd;
+				fd_type[res] = CefC_Connection_Type_Local;
+				faceids[res] = 0;
+				res++;
+			}
 		}
 	}
 
+	/* The forwarding workers wake up cefnetd by eventfd when they return messages */
+	if (cefnetd_worker_efd_get () != -1) {
+		fds[res].events = POLLIN | POLLERR;
+		fds[res].fd = cefnetd_worker_efd_get ();
+		fd_type[res] = CefC_Connection_Type_Worker;
+		faceids[res] = 0;
+		res++;
+	}
+
 	return (res);
 }
+/*--------------------------------------------------------------------------------------
+	Accepts the TCP socket and adds it to the listen faces
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tcp_accept (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	int res;
+
+	res = cef_face_accept_connect ();
+
+	if ((res > 0) && (hdl->intcpfdc < CefC_Listen_Face_Max)) {
+		hdl->intcpfaces[hdl->intcpfdc] = (uint16_t) res;
+		hdl->intcpfds[hdl->intcpfdc].fd
+			= cef_face_get_fd_from_faceid ((uint16_t) res);
+		hdl->intcpfds[hdl->intcpfdc].events = POLLIN | POLLERR;
+		hdl->intcpfdc++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Waits for and handles the input with poll()
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_poll_dispatch (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	struct pollfd fds[CefC_Netd_Ep_Reg_Max];
+	CefC_Connection_Type fd_type[CefC_Netd_Ep_Reg_Max];
+	int faceids[CefC_Netd_Ep_Reg_Max];
+	uint16_t out_faces[CefC_Netd_Ep_Reg_Max];
+	int fdnum;
+	int outnum;
+	int out_f = 0;
+	int res;
+	int fd;
+	int i, n;
+
+	/* Accepts the TCP socket 	*/
+	cefnetd_tcp_accept (hdl);
+
+	/* Receives the frame(s) from local process 		*/
+	cefnetd_input_from_local_process (hdl);
+
+	cef_face_update_listen_faces (
+			hdl->inudpfds, hdl->inudpfaces, &hdl->inudpfdc,
+			hdl->intcpfds, hdl->intcpfaces, &hdl->intcpfdc);
+
+	/* Receives the frame(s) from the listen port 		*/
+	fdnum = cefnetd_poll_socket_prepare (hdl, fds, fd_type, faceids);
+
+	/* Waits for POLLOUT on the faces which have the messages waiting to be sent */
+	outnum = cef_face_outq_pending_get (out_faces, CefC_Netd_Ep_Reg_Max);
+	for (n = 0 ; n < outnum ; n++) {
+		fd = cef_face_get_fd_from_faceid (out_faces[n]);
+		for (i = 0 ; i < fdnum ; i++) {
+			if (fds[i].fd == fd) {
+				fds[i].events |= POLLOUT;
+				break;
+			}
+		}
+	}
+	res = poll (fds, fdnum, 1);
+
+	for (i = 0 ; res > 0 && i < fdnum ; i++) {
+
+		if (fds[i].revents != 0) {
+			res--;
+			if (fds[i].revents & POLLOUT) {
+				out_f = 1;
+			}
+			if (fds[i].revents & POLLIN) {
+				if ((fd_type[i] == CefC_Connection_Type_Local) ||
+					(fd_type[i] == CefC_Connection_Type_Worker)) {
+					continue;
+				}
+				(*cefnetd_input_process[fd_type[i]]) (
+									hdl, fds[i].fd, faceids[i]);
+			}
+#ifdef __APPLE__
+			if (fds[i].revents & (POLLERR | POLLNVAL)) {
+#else // __APPLE__
+			if (fds[i].revents & (POLLERR | POLLNVAL | POLLHUP)) {
+#endif // __APPLE__
+				if (fd_type[i] < CefC_Connection_Type_Csm) {
+					cef_face_close (faceids[i]);
+					cef_fib_faceid_cleanup (hdl->fib);
+				}
+			}
+		}
+	}
+
+	/* Sends the messages queued to the writable faces 	*/
+	if (out_f) {
+		cef_face_outq_flush ();
+	}
+}
+#ifdef CefC_Netd_Epoll
+/*--------------------------------------------------------------------------------------
+	Compares the epoll registrations by FD
+----------------------------------------------------------------------------------------*/
+static int
+cefnetd_epoll_reg_compare (
+	const void* a,
+	const void* b
+) {
+	return (((const CefT_Netd_Ep_Reg*) a)->fd - ((const CefT_Netd_Ep_Reg*) b)->fd);
+}
+/*--------------------------------------------------------------------------------------
+	Adds, modifies or deletes the registration of a FD to epoll
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_ctl (
+	int op,										/* EPOLL_CTL_ADD/MOD/DEL 				*/
+	const CefT_Netd_Ep_Reg* reg
+) {
+	struct epoll_event ev;
+
+	memset (&ev, 0, sizeof (ev));
+	ev.events = (reg->out_f) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	ev.data.u64 = ((uint64_t) reg->fd << 32) |
+				  ((uint64_t) (reg->type & 0xFFFF) << 16) | (uint64_t) reg->faceid;
+
+	if (epoll_ctl (cefnetd_ep.epfd, op, reg->fd, &ev) == 0) {
+		return;
+	}
+	/* A FD which was closed and reused is not registered anymore, and	*/
+	/* a FD whose old registration remains has to be modified 			*/
+	if ((op == EPOLL_CTL_MOD) && (errno == ENOENT)) {
+		op = EPOLL_CTL_ADD;
+	} else if ((op == EPOLL_CTL_ADD) && (errno == EEXIST)) {
+		op = EPOLL_CTL_MOD;
+	} else {
+		if (op != EPOLL_CTL_DEL) {
+			cef_log_write (CefC_Log_Warn, "%s(%u) epoll_ctl (fd=%d) failed (%s)\n",
+				__func__, __LINE__, reg->fd, strerror (errno));
+		}
+		return;
+	}
+	if (epoll_ctl (cefnetd_ep.epfd, op, reg->fd, &ev) < 0) {
+		cef_log_write (CefC_Log_Warn, "%s(%u) epoll_ctl (fd=%d) failed (%s)\n",
+			__func__, __LINE__, reg->fd, strerror (errno));
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Synchronizes the epoll registrations with the faces and the sockets in use
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_sync (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	struct pollfd fds[CefC_Netd_Ep_Reg_Max];
+	CefC_Connection_Type fd_type[CefC_Netd_Ep_Reg_Max];
+	int faceids[CefC_Netd_Ep_Reg_Max];
+	CefT_Netd_Ep_Reg regs[CefC_Netd_Ep_Reg_Max];
+	CefT_Face* face;
+	int fdnum;
+	int num = 0;
+	int i, n;
+	int cs_local_sock = -1;
+	int cs_tcp_sock = -1;
+	int rt_sock = -1;
+	int fd;
+
+#ifdef CefC_ContentStore
+	cs_local_sock = hdl->cs_stat->local_sock;
+	cs_tcp_sock = hdl->cs_stat->tcp_sock;
+#endif // CefC_ContentStore
+#ifdef CefC_Ccore
+	if (hdl->rt_hdl) {
+		rt_sock = hdl->rt_hdl->sock;
+	}
+#endif // CefC_Ccore
+
+	/* Nothing to do when no face nor socket has changed since the last sync 	*/
+	if ((cefnetd_ep.synced_f) &&
+		(cefnetd_ep.face_gen == cef_face_generation_get ()) &&
+		(cefnetd_ep.app_fds_num == hdl->app_fds_num) &&
+		(cefnetd_ep.babel_sock == hdl->babel_sock) &&
+		(cefnetd_ep.cs_local_sock == cs_local_sock) &&
+		(cefnetd_ep.cs_tcp_sock == cs_tcp_sock) &&
+		(cefnetd_ep.rt_sock == rt_sock)) {
+		return;
+	}
+	cefnetd_ep.synced_f 		= 1;
+	cefnetd_ep.face_gen 		= cef_face_generation_get ();
+	cefnetd_ep.app_fds_num 		= hdl->app_fds_num;
+	cefnetd_ep.babel_sock 		= hdl->babel_sock;
+	cefnetd_ep.cs_local_sock 	= cs_local_sock;
+	cefnetd_ep.cs_tcp_sock 		= cs_tcp_sock;
+	cefnetd_ep.rt_sock 			= rt_sock;
+	memset (regs, 0, sizeof (regs));
+
+	/* Collects the FDs in use 		*/
+	cef_face_update_listen_faces (
+			hdl->inudpfds, hdl->inudpfaces, &hdl->inudpfdc,
+			hdl->intcpfds, hdl->intcpfaces, &hdl->intcpfdc);
+	fdnum = cefnetd_poll_socket_prepare (hdl, fds, fd_type, faceids);
+
+	for (i = 0 ; i < fdnum ; i++) {
+		regs[num].fd 		= fds[i].fd;
+		regs[num].type 		= fd_type[i];
+		regs[num].faceid 	= faceids[i];
+		regs[num].fd_gen 	= 0;
+
+		if (fd_type[i] < CefC_Connection_Type_Csm) {
+			face = cef_face_get_face_from_faceid ((uint16_t) faceids[i]);
+			regs[num].fd_gen = face->fd_gen;
+		} else if (fd_type[i] == CefC_Connection_Type_Local) {
+			for (n = 0 ; n < hdl->app_fds_num ; n++) {
+				if (hdl->app_fds[n] == fds[i].fd) {
+					face = cef_face_get_face_from_faceid (
+											(uint16_t) hdl->app_faces[n]);
+					regs[num].fd_gen = face->fd_gen;
+					break;
+				}
+			}
+		}
+		num++;
+	}
+
+	/* The listen sockets are handled by accept 	*/
+	for (i = 0 ; i < 4 && num < CefC_Netd_Ep_Reg_Max ; i++) {
+		switch (i) {
+			case 0: {
+				fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenTcpv4);
+				regs[num].type = CefC_Connection_Type_Accept;
+				break;
+			}
+			case 1: {
+				fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenTcpv6);
+				regs[num].type = CefC_Connection_Type_Accept;
+				break;
+			}
+			case 2: {
+				fd = cef_face_get_fd_from_faceid (CefC_Faceid_Local);
+				regs[num].type = CefC_Connection_Type_Local;
+				break;
+			}
+			default: {
+				fd = -1;
+				if (hdl->babel_use_f) {
+					fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenBabel);
+				}
+				regs[num].type = CefC_Connection_Type_Local;
+				break;
+			}
+		}
+		if (fd > 0) {
+			regs[num].fd 		= fd;
+			regs[num].faceid 	= 0;
+			regs[num].fd_gen 	= 0;
+			num++;
+		}
+	}
+	if ((hdl->babel_sock > 0) && (num < CefC_Netd_Ep_Reg_Max)) {
+		regs[num].fd 		= hdl->babel_sock;
+		regs[num].type 		= CefC_Connection_Type_Local;
+		regs[num].faceid 	= 0;
+		regs[num].fd_gen 	= 0;
+		num++;
+	}
+
+	/* Sorts by FD and drops the duplicates 	*/
+	qsort (regs, num, sizeof (CefT_Netd_Ep_Reg), cefnetd_epoll_reg_compare);
+	for (i = 0, n = 0 ; i < num ; i++) {
+		if ((n > 0) && (regs[n - 1].fd == regs[i].fd)) {
+			continue;
+		}
+		regs[n++] = regs[i];
+	}
+	num = n;
+
+	/* Merges the new registrations into the registered ones 	*/
+	i = 0;
+	n = 0;
+	while ((i < cefnetd_ep.reg_num) || (n < num)) {
+		if ((n == num) ||
+			((i < cefnetd_ep.reg_num) && (cefnetd_ep.regs[i].fd < regs[n].fd))) {
+			cefnetd_epoll_ctl (EPOLL_CTL_DEL, &cefnetd_ep.regs[i]);
+			i++;
+		} else if ((i == cefnetd_ep.reg_num) ||
+				   (regs[n].fd < cefnetd_ep.regs[i].fd)) {
+			cefnetd_epoll_ctl (EPOLL_CTL_ADD, &regs[n]);
+			n++;
+		} else {
+			regs[n].out_f = cefnetd_ep.regs[i].out_f;
+			if ((regs[n].type != cefnetd_ep.regs[i].type) ||
+				(regs[n].faceid != cefnetd_ep.regs[i].faceid) ||
+				(regs[n].fd_gen != cefnetd_ep.regs[i].fd_gen) ||
+				(regs[n].fd_gen == 0)) {
+				cefnetd_epoll_ctl (EPOLL_CTL_MOD, &regs[n]);
+			}
+			i++;
+			n++;
+		}
+	}
+	memcpy (cefnetd_ep.regs, regs, sizeof (CefT_Netd_Ep_Reg) * num);
+	cefnetd_ep.reg_num = num;
+}
+/*--------------------------------------------------------------------------------------
+	Waits for EPOLLOUT on the faces which have the messages waiting to be sent
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_out_sync (
+	void
+) {
+	uint16_t faceids[CefC_Netd_Ep_Reg_Max];
+	unsigned char want[CefC_Netd_Ep_Reg_Max];
+	CefT_Netd_Ep_Reg key;
+	CefT_Netd_Ep_Reg* reg;
+	int num;
+	int i;
+
+	num = cef_face_outq_pending_get (faceids, CefC_Netd_Ep_Reg_Max);
+	if ((num == 0) && (cefnetd_ep.out_num == 0)) {
+		return;
+	}
+	memset (want, 0, cefnetd_ep.reg_num);
+
+	for (i = 0 ; i < num ; i++) {
+		key.fd = cef_face_get_fd_from_faceid (faceids[i]);
+		reg = (CefT_Netd_Ep_Reg*) bsearch (&key, cefnetd_ep.regs, cefnetd_ep.reg_num,
+						sizeof (CefT_Netd_Ep_Reg), cefnetd_epoll_reg_compare);
+		if (reg) {
+			want[reg - cefnetd_ep.regs] = 1;
+		}
+	}
+
+	cefnetd_ep.out_num = 0;
+	for (i = 0 ; i < cefnetd_ep.reg_num ; i++) {
+		if (cefnetd_ep.regs[i].out_f != want[i]) {
+			cefnetd_ep.regs[i].out_f = want[i];
+			cefnetd_epoll_ctl (EPOLL_CTL_MOD, &cefnetd_ep.regs[i]);
+		}
+		cefnetd_ep.out_num += cefnetd_ep.regs[i].out_f;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Waits for and handles the input with epoll
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_epoll_dispatch (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+) {
+	struct epoll_event evs[CefC_Netd_Ep_Events];
+	int res;
+	int i;
+	int fd;
+	int type;
+	int faceid;
+	int local_f = 0;
+	int out_f = 0;
+
+	cefnetd_epoll_sync (hdl);
+	cefnetd_epoll_out_sync ();
+
+	res = epoll_wait (cefnetd_ep.epfd, evs, CefC_Netd_Ep_Events,
+						cefnetd_timer_wait_get (nowt));
+	if (res < 0) {
+		if (errno != EINTR) {
+			cef_log_write (CefC_Log_Error, "%s(%u) epoll_wait failed (%s)\n",
+				__func__, __LINE__, strerror (errno));
+		}
+		return;
+	}
+	hdl->nowtus = cef_client_present_timeus_calc ();
+
+	for (i = 0 ; i < res ; i++) {
+		fd 		= (int)((evs[i].data.u64 >> 32) & 0xFFFFFFFF);
+		type 	= (int)((evs[i].data.u64 >> 16) & 0xFFFF);
+		faceid 	= (int)(evs[i].data.u64 & 0xFFFF);
+
+		if (evs[i].events & EPOLLOUT) {
+			out_f = 1;
+		}
+		if (type == CefC_Connection_Type_Local) {
+			local_f = 1;
+			continue;
+		}
+		if (type == CefC_Connection_Type_Accept) {
+			cefnetd_tcp_accept (hdl);
+			continue;
+		}
+		/* The messages of the workers are handled after the dispatch 	*/
+		if (type == CefC_Connection_Type_Worker) {
+			continue;
+		}
+		/* The FD may be closed by the event handled before 	*/
+		if ((type < CefC_Connection_Type_Csm) &&
+			(cef_face_check_active ((uint16_t) faceid) < 1)) {
+			continue;
+		}
+		if (evs[i].events & EPOLLIN) {
+			(*cefnetd_input_process[type]) (hdl, fd, faceid);
+		}
+		if (evs[i].events & (EPOLLERR | EPOLLHUP)) {
+			if ((type < CefC_Connection_Type_Csm) &&
+				(cef_face_check_active ((uint16_t) faceid) > 0)) {
+				cef_face_close (faceid);
+				cef_fib_faceid_cleanup (hdl->fib);
+			}
+		}
+	}
+
+	/* Sends the messages queued to the writable faces 	*/
+	if (out_f) {
+		cef_face_outq_flush ();
+	}
+
+	/* Receives the frame(s) from local process 		*/
+	if (local_f) {
+		cefnetd_input_from_local_process (hdl);
+	}
+}
+#endif // CefC_Netd_Epoll
+/*--------------------------------------------------------------------------------------
+	Clears all the timers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_init (
+	void
+) {
+	int id;
+
+	for (id = 0 ; id < CefC_Netd_Timer_Num ; id++) {
+		cefnetd_timer.expire[id] = UINT64_MAX;
+		cefnetd_timer.heap[id] = 0;
+		cefnetd_timer.pos[id] = -1;
+	}
+	cefnetd_timer.num = 0;
+}
+/*--------------------------------------------------------------------------------------
+	Swaps two timers in the min-heap
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_heap_swap (
+	int a,
+	int b
+) {
+	int tmp = cefnetd_timer.heap[a];
+
+	cefnetd_timer.heap[a] = cefnetd_timer.heap[b];
+	cefnetd_timer.heap[b] = tmp;
+	cefnetd_timer.pos[cefnetd_timer.heap[a]] = a;
+	cefnetd_timer.pos[cefnetd_timer.heap[b]] = b;
+}
+/*--------------------------------------------------------------------------------------
+	Restores the order of the min-heap at the specified position
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_heap_fix (
+	int idx
+) {
+	int parent;
+	int child;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (cefnetd_timer.expire[cefnetd_timer.heap[parent]] <=
+			cefnetd_timer.expire[cefnetd_timer.heap[idx]]) {
+			break;
+		}
+		cefnetd_timer_heap_swap (parent, idx);
+		idx = parent;
+	}
+	while (1) {
+		child = idx * 2 + 1;
+		if (child >= cefnetd_timer.num) {
+			break;
+		}
+		if ((child + 1 < cefnetd_timer.num) &&
+			(cefnetd_timer.expire[cefnetd_timer.heap[child + 1]] <
+				cefnetd_timer.expire[cefnetd_timer.heap[child]])) {
+			child++;
+		}
+		if (cefnetd_timer.expire[cefnetd_timer.heap[idx]] <=
+			cefnetd_timer.expire[cefnetd_timer.heap[child]]) {
+			break;
+		}
+		cefnetd_timer_heap_swap (idx, child);
+		idx = child;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Sets the deadline of the specified timer (UINT64_MAX unsets it)
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_set (
+	int id,										/* CefT_Netd_Timer_Id					*/
+	uint64_t expire								/* deadline (usec)						*/
+) {
+	int idx = cefnetd_timer.pos[id];
+
+	if (expire == UINT64_MAX) {
+		if (idx < 0) {
+			return;
+		}
+		cefnetd_timer.num--;
+		if (idx != cefnetd_timer.num) {
+			cefnetd_timer_heap_swap (idx, cefnetd_timer.num);
+			cefnetd_timer.pos[id] = -1;
+			cefnetd_timer_heap_fix (idx);
+		} else {
+			cefnetd_timer.pos[id] = -1;
+		}
+		return;
+	}
+	cefnetd_timer.expire[id] = expire;
+	if (idx < 0) {
+		idx = cefnetd_timer.num++;
+		cefnetd_timer.heap[idx] = id;
+		cefnetd_timer.pos[id] = idx;
+	}
+	cefnetd_timer_heap_fix (idx);
+}
+/*--------------------------------------------------------------------------------------
+	Runs the expired timers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_run (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+) {
+	int id;
+
+	while ((cefnetd_timer.num > 0) &&
+		   (cefnetd_timer.expire[cefnetd_timer.heap[0]] <= nowt)) {
+		id = cefnetd_timer.heap[0];
+		cefnetd_timer_set (id, UINT64_MAX);
+
+		switch (id) {
+			case CefC_Netd_Timer_Pit: {
+				cefnetd_pit_cleanup (hdl, nowt);
+				break;
+			}
+			case CefC_Netd_Timer_Fib: {
+				cefnetd_fib_cleanup (hdl, nowt);
+				break;
+			}
+			default: {
+				/* Only wakes up the main loop, which handles it 	*/
+				break;
+			}
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Re-arms the timers from the state of each module
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_timer_rearm (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+) {
+	cefnetd_timer_set (CefC_Netd_Timer_Pit, cef_pit_timer_next_get (nowt));
+	cefnetd_timer_set (CefC_Netd_Timer_Fib, hdl->fib_clean_t + 1);
+
+#ifdef CefC_Ccore
+	if ((hdl->rt_hdl) && (hdl->rt_hdl->sock == -1)) {
+		cefnetd_timer_set (CefC_Netd_Timer_Ccore, hdl->rt_hdl->reconnect_time + 1);
+	} else {
+		cefnetd_timer_set (CefC_Netd_Timer_Ccore, UINT64_MAX);
+	}
+#endif // CefC_Ccore
+
+#ifdef CefC_ContentStore
+	if (hdl->cs_stat->cache_type == CefC_Cache_Type_Excache) {
+		cefnetd_timer_set (CefC_Netd_Timer_Excache, ccninfo_push_time + 1);
+	} else {
+		cefnetd_timer_set (CefC_Netd_Timer_Excache, UINT64_MAX);
+	}
+#endif // CefC_ContentStore
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the time to wait for the input until the earliest timer
+----------------------------------------------------------------------------------------*/
+static int										/* timeout (msec)						*/
+cefnetd_timer_wait_get (
+	uint64_t nowt								/* current time (usec) 					*/
+) {
+	uint64_t expire;
+	uint64_t wait_us;
+
+	if (cefnetd_timer.num == 0) {
+		return (CefC_Netd_Wait_Max_Ms);
+	}
+	expire = cefnetd_timer.expire[cefnetd_timer.heap[0]];
+	if (expire <= nowt) {
+		return (0);
+	}
+	wait_us = expire - nowt;
+	if (wait_us >= CefC_Netd_Wait_Max_Ms * 1000) {
+		return (CefC_Netd_Wait_Max_Ms);
+	}
+	/* Rounds up not to wake up before the deadline 	*/
+	return ((int)((wait_us + 999) / 1000));
+}
 /*--------------------------------------------------------------------------------------
 	Handles the elements of TX queue
 ----------------------------------------------------------------------------------------*/
@@ -1737,32 +2604,27 @@ cefnetd_input_from_txque_process (
 	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
 ) {
 	CefT_Tx_Elem* tx_elem;
+	void* tx_elems[CefC_Netd_Txque_Bulk];
+	int tx_num;
+	int n;
 	int i;
+	unsigned char* msg;
 	unsigned char hoplimit;
-	uint32_t seqnum;
-
-#ifdef CefC_ContentStore
-	CefT_Cs_Tx_Elem* cs_tx_elem;
-	CefT_Cs_Stat* cs_stat = hdl->cs_stat;
-	CefT_Cs_Tx_Elem_Cob* cob_temp;
-	int send_cnt = 0;
-	uint64_t nowt;
-	uint64_t data_sum = 0;
-#endif // CefC_ContentStore
-	uint16_t new_buff_len = 0;
 
-	while (1) {
-		/* Pop one element from the TX Ring Queue 		*/
-		tx_elem = (CefT_Tx_Elem*) cef_rngque_pop (hdl->plugin_hdl.tx_que);
+	/* Pops the elements from the TX Ring Queue in a batch 		*/
+	while ((tx_num = cef_rngque_pop_bulk (
+			hdl->plugin_hdl.tx_que, tx_elems, CefC_Netd_Txque_Bulk)) > 0) {
 
-		if (tx_elem != NULL) {
+		for (n = 0 ; n < tx_num ; n++) {
+			tx_elem = (CefT_Tx_Elem*) tx_elems[n];
+			msg = tx_elem->pb->data;
 
 			if (tx_elem->type > CefC_Elem_Type_Object) {
 				goto FREE_POOLED_BK;
 			}
 
-			if (tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_INTEREST) {
-				hoplimit = tx_elem->msg[CefC_O_Fix_HopLimit];
+			if (msg[CefC_O_Fix_Type] == CefC_PT_INTEREST) {
+				hoplimit = msg[CefC_O_Fix_HopLimit];
 			} else {
 				hoplimit = 1;
 			}
@@ -1771,74 +2633,70 @@ cefnetd_input_from_txque_process (
 				goto FREE_POOLED_BK;
 			}
 
+			/* The Faces share the message, and the sequence number of each Face 	*/
+			/* is sent in its own header 											*/
 			for (i = 0 ; i < tx_elem->faceid_num ; i++) {
 				if (cef_face_check_active (tx_elem->faceids[i]) > 0) {
-					new_buff_len = tx_elem->msg_len;
-					if (tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_OBJECT) {
-						seqnum = cef_face_get_seqnum_from_faceid (tx_elem->faceids[i]);
-						new_buff_len =
-							cef_frame_seqence_update (tx_elem->msg, seqnum);
-					}
-					cef_face_frame_send_forced (
-						tx_elem->faceids[i], tx_elem->msg, new_buff_len);
+					cef_face_pktbuf_send_forced (tx_elem->faceids[i], tx_elem->pb,
+						(msg[CefC_O_Fix_Type] == CefC_PT_OBJECT));
 					hdl->stat_send_frames++;
 				}
 			}
 
 FREE_POOLED_BK:
 			/* Free the pooled block 	*/
+			cef_pktbuf_unref (tx_elem->pb);
 			cef_mpool_free (hdl->plugin_hdl.tx_que_mp, tx_elem);
-
-		} else {
-			break;
 		}
 	}
 
-#ifdef CefC_ContentStore
-	if ((hdl->cs_stat->cache_type != CefC_Default_Cache_Type) &&
-		 ((nowt = cef_client_present_timeus_calc ()) > hdl->send_next)) {
-		while (1) {
-			/* Pop one element from the TX Ring Queue 		*/
-			cs_tx_elem = (CefT_Cs_Tx_Elem*) cef_rngque_read (cs_stat->tx_que);
+	return (1);
+}
 
-			if (cs_tx_elem == NULL) {
-				break;
-			}
-			if (cs_tx_elem->type == CefC_Cs_Tx_Elem_Type_Cob) {
-				cs_tx_elem = (CefT_Cs_Tx_Elem*) cef_rngque_pop (cs_stat->tx_que);
-
-				/* send cob	*/
-				cob_temp = (CefT_Cs_Tx_Elem_Cob*) cs_tx_elem->data;
-				csmgr_cob_forward (
-							cob_temp->faceid, cob_temp->cob.msg,
-							cob_temp->cob.msg_len, cob_temp->cob.chunk_num);
-				/* Free the pooled block 	*/
-				data_sum += cob_temp->cob.msg_len;
-				cef_mpool_free (cs_stat->tx_cob_mp, cob_temp);
-				cef_mpool_free (cs_stat->tx_que_mp, cs_tx_elem);
-				send_cnt++;
-				hdl->stat_send_frames++;
-			} else {
-#ifdef CefC_Debug
-				cef_dbg_write (CefC_Dbg_Fine,
-					"Memcache queue read the unknown type message\n");
-#endif // CefC_Debug
-				cef_rngque_pop (cs_stat->tx_que);
-				cef_mpool_free (cs_stat->tx_que_mp, cs_tx_elem);
-			}
-			if (send_cnt > CefC_Csmgr_Max_Send_Num) {
-				/* Temporarily suspend	*/
-				break;
+/*--------------------------------------------------------------------------------------
+	Attaches the shared memory ring passed by the local app to its face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_shmring_attach (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int idx,									/* index of the app in app_fds			*/
+	unsigned char* msg,							/* message received with the FDs		*/
+	int len,									/* length of the message				*/
+	int fds[],									/* FDs passed by the app				*/
+	int fd_num									/* number of the FDs					*/
+) {
+	CefT_Shmring* sr = NULL;
+	int i;
+
+	if ((fd_num == CefC_Shmring_Fd_Num) && (hdl->local_shm_size > 0) &&
+		(len == (int) strlen (CefC_Shmring_Req)) &&
+		(memcmp (msg, CefC_Shmring_Req, len) == 0)) {
+		/* The memfd has to be sealed against resizing and the others have to be 	*/
+		/* eventfds. The FDs are closed if the ring can not be mapped. 				*/
+		if (cef_shmring_fds_check (fds) > 0) {
+			sr = cef_shmring_attach (fds);
+		} else {
+			for (i = 0 ; i < fd_num ; i++) {
+				close (fds[i]);
 			}
 		}
-		/* set next	*/
-		hdl->send_next = nowt + (hdl->send_rate * data_sum);
+	} else {
+		for (i = 0 ; i < fd_num ; i++) {
+			close (fds[i]);
+		}
 	}
-#endif // CefC_ContentStore
 
-	return (1);
+	if (sr == NULL) {
+		send (hdl->app_fds[idx], CefC_Shmring_Nak, strlen (CefC_Shmring_Nak), 0);
+		return;
+	}
+	cef_face_shmring_set ((uint16_t) hdl->app_faces[idx], sr);
+	send (hdl->app_fds[idx], CefC_Shmring_Ack, strlen (CefC_Shmring_Ack), 0);
+#ifdef CefC_Debug
+	cef_dbg_write (CefC_Dbg_Fine, "Face#%d uses the shared memory ring (%u bytes)\n",
+		hdl->app_faces[idx], sr->size);
+#endif // CefC_Debug
 }
-
 /*--------------------------------------------------------------------------------------
 	Accepts and receives the frame(s) from local face
 ----------------------------------------------------------------------------------------*/
@@ -1858,6 +2716,11 @@ cefnetd_input_from_local_process (
 	unsigned char* rsp_msg;
 	struct pollfd send_fds[1];
 	char	user_id[512];
+	int shm_fds[CefC_Shmring_Fd_Num];
+	int shm_fd_num;
+	CefT_Shmring* sr;
+	int shm_f = 0;
+	int n;
 	rsp_msg = calloc(1, CefC_Max_Length*10);
 
 	/* Obtains the FD for local face 	*/
@@ -1905,8 +2768,14 @@ cefnetd_input_from_local_process (
 
 	/* Checks whether frame(s) arrivals from the active local faces */
 	for (i = 0 ; i < hdl->app_fds_num ; i++) {
-		len = recv (hdl->app_fds[i], buff, CefC_Max_Length, 0);
+		len = cef_shmring_fds_recv (
+				hdl->app_fds[i], buff, CefC_Max_Length, shm_fds, &shm_fd_num);
 
+		if (shm_fd_num > 0) {
+			/* The app asks to exchange the messages by the shared memory ring */
+			cefnetd_shmring_attach (hdl, i, buff, len, shm_fds, shm_fd_num);
+			continue;
+		}
 		if (len > 0) {
 			hdl->app_steps[i] = 0;
 
@@ -1978,6 +2847,33 @@ cefnetd_input_from_local_process (
 		}
 	}
 
+	/* Receives the frame(s) from the shared memory rings 		*/
+	for (i = 0 ; i < hdl->app_fds_num ; i++) {
+		sr = cef_face_shmring_get ((uint16_t) hdl->app_faces[i]);
+		if (sr == NULL) {
+			continue;
+		}
+		shm_f = 1;
+		cef_shmring_wakeup_clear (sr);
+
+		for (n = 0 ; n < CefC_Netd_Shm_Read_Max ; n++) {
+			len = cef_shmring_read (sr, buff, CefC_Max_Length);
+			if (len <= 0) {
+				break;
+			}
+			cefnetd_input_message_process (
+					hdl, CefC_Faceid_Local, hdl->app_faces[i], buff, len, user_id);
+		}
+		/* Comes back at the next loop not to keep the other faces waiting 	*/
+		if (n == CefC_Netd_Shm_Read_Max) {
+			cef_shmring_wakeup_self (sr);
+		}
+	}
+	/* The apps which freed the space of the rings wake up cefnetd as well 	*/
+	if (shm_f) {
+		cef_face_outq_flush ();
+	}
+
 	if (!hdl->babel_use_f) {
 		if (rsp_msg != NULL){
 			free(rsp_msg);
@@ -2699,21 +3595,47 @@ cefnetd_udp_input_process (
 	int fd, 									/* FD which is polled POLLIN			*/
 	int faceid									/* Face-ID that message arrived 		*/
 ) {
-	int protocol;
 	size_t recv_len;
-	int peer_faceid;
 	struct addrinfo sas;
-	struct addrinfo *sas_p;
 	socklen_t sas_len = (socklen_t) sizeof (struct addrinfo);
 	unsigned char buff[CefC_Max_Length];
+	CefT_Face_Rx_Dgram* dgrams;
+	int num;
+	int i;
 
-	sas_p = &sas;
-	char user_id[512];	//0.8.3
+	if (cef_face_batch_size_get () > 1) {
+		/* Drains up to UDP_BATCH_SIZE datagrams with one syscall 	*/
+		num = cef_face_udp_batch_recv (fd, &dgrams);
+		for (i = 0 ; i < num ; i++) {
+			cefnetd_udp_dgram_process (hdl, fd, faceid, dgrams[i].buff, (size_t) dgrams[i].len,
+				(struct addrinfo*) &dgrams[i].sas, dgrams[i].sas_len);
+		}
+		return (1);
+	}
 
 	/* Receives the message(s) from the specified FD */
 	recv_len
 		= recvfrom (fd, buff, CefC_Max_Length, 0, (struct sockaddr*) &sas, &sas_len);
 
+	return (cefnetd_udp_dgram_process (hdl, fd, faceid, buff, recv_len, &sas, sas_len));
+}
+/*--------------------------------------------------------------------------------------
+	Handles the datagram received from the UDP socket
+----------------------------------------------------------------------------------------*/
+static int
+cefnetd_udp_dgram_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd, 									/* FD which is polled POLLIN			*/
+	int faceid,									/* Face-ID that message arrived 		*/
+	unsigned char* buff,						/* Received datagram					*/
+	size_t recv_len,							/* Length of the datagram				*/
+	struct addrinfo* sas_p,						/* Source address						*/
+	socklen_t sas_len							/* Length of the source address			*/
+) {
+	int protocol;
+	int peer_faceid;
+	char user_id[512];	//0.8.3
+
 	// TBD: process for the special message
 
 	/* Looks up the peer Face-ID 		*/
@@ -2833,11 +3755,22 @@ cefnetd_tcp_input_process (
 	int faceid									/* Face-ID that message arrived 		*/
 ) {
 	int recv_len;
-	unsigned char buff[CefC_Max_Length];
+	CefT_Face* face;
+	unsigned char* tail;
+	int tail_len;
 	char	user_id[512];
 
-	/* Receives the message(s) from the specified FD */
-	recv_len = read (fd, buff, CefC_Max_Length);
+	/* Receives the message(s) into the tail of the receive buffer of the face 	*/
+	/* to handle them in place 													*/
+	face = cef_face_get_face_from_faceid (faceid);
+	tail = cefnetd_face_rcv_tail_get (face, CefC_Netd_Rcv_Tail_Min, &tail_len);
+	if (tail_len == 0) {
+		/* The buffer is full of the data which is not a message 	*/
+		face->head = 0;
+		face->len  = 0;
+		tail = cefnetd_face_rcv_tail_get (face, CefC_Netd_Rcv_Tail_Min, &tail_len);
+	}
+	recv_len = read (fd, tail, tail_len);
 
 	if (recv_len <= 0) {
 		cef_log_write (CefC_Log_Warn, "Detected Face#%d (TCP) is down\n", faceid);
@@ -2862,8 +3795,16 @@ cefnetd_tcp_input_process (
 	}
 
 	strcpy( user_id, addrstr );
+
+#ifdef CefC_Debug
+	cef_dbg_write (CefC_Dbg_Finer,
+		"Inputs CEFORE message(s) from Face#%d\n", faceid);
+	cef_dbg_buff_write (CefC_Dbg_Finest, tail, recv_len);
+#endif // CefC_Debug
+
 	/* Handles the received CEFORE message 	*/
-	cefnetd_input_message_process (hdl, faceid, faceid, buff, recv_len, user_id);
+	face->len += (uint16_t) recv_len;
+	cefnetd_face_rcv_buff_process (hdl, faceid, faceid, face, user_id);
 
 	return (1);
 }
@@ -4129,11 +5070,10 @@ cefnetd_input_message_process (
 	char* user_id
 ) {
 	CefT_Face* face;
-	unsigned char* wp;
-	uint16_t move_len;
-	uint16_t fdv_payload_len;
-	uint16_t fdv_header_len;
-	int res;
+	unsigned char* tail;
+	int tail_len;
+	int move_len;
+	int index = 0;
 
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Finer,
@@ -4144,49 +5084,265 @@ cefnetd_input_message_process (
 	/* Obtains the face structure corresponding to the peer Face-ID 	*/
 	face = cef_face_get_face_from_faceid (peer_faceid);
 
-	/* Handles the received message(s) 		*/
-	while (msg_size > 0) {
-		/* Calculates the size of the message which have not been yet handled 	*/
-		if (msg_size > CefC_Max_Length - face->len) {
-			move_len = CefC_Max_Length - face->len;
-		} else {
-			move_len = (uint16_t) msg_size;
+	/* Handles the messages in place if no partial message is left in the face. 	*/
+	/* Only the partial message at the end is copied to the receive buffer. 		*/
+	if (face->len == 0) {
+		cefnetd_input_message_handle (
+			hdl, faceid, peer_faceid, msg, &index, &msg_size, user_id);
+
+		/* The rest is shorter than a message, so it fits in the buffer 	*/
+		face->head = 0;
+		face->len  = (uint16_t) msg_size;
+		if (msg_size > 0) {
+			memcpy (face->rcv_buff, msg + index, msg_size);
 		}
-		msg_size -= move_len;
+		return (1);
+	}
 
+	while (msg_size > 0) {
 		/* Updates the receive buffer 		*/
-		memcpy (face->rcv_buff + face->len, msg, move_len);
-		face->len += move_len;
+		tail = cefnetd_face_rcv_tail_get (face, msg_size, &tail_len);
+		if (tail_len == 0) {
+			/* The buffer is full of the data which is not a message 	*/
+			face->head = 0;
+			face->len  = 0;
+			continue;
+		}
+		move_len = (msg_size > tail_len) ? tail_len : msg_size;
+		memcpy (tail, msg, move_len);
+		face->len += (uint16_t) move_len;
 		msg += move_len;
+		msg_size -= move_len;
 
-		while (face->len > 0) {
-			/* Seeks the top of the message */
-			res = cefnetd_messege_head_seek (face, &fdv_payload_len, &fdv_header_len);
-			if (res < 0) {
-				break;
+		cefnetd_face_rcv_buff_process (hdl, faceid, peer_faceid, face, user_id);
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Handles the messages in the received data in place
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_input_message_handle (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int faceid, 								/* Face-ID where messages arrived at	*/
+	int peer_faceid, 							/* Face-ID to reply to the origin of 	*/
+												/* transmission of the message(s)		*/
+	unsigned char* buff,						/* buffer of the received data 			*/
+	int* index,									/* offset of the data not handled yet 	*/
+	int* len,									/* length of the data not handled yet 	*/
+	char* user_id
+) {
+	/* Ccninfo appends the blocks after the received message, so it is handled 	*/
+	/* in the buffer which has the room up to CefC_Max_Length 					*/
+	static unsigned char work_buff[CefC_Max_Length];
+	unsigned char* msg;
+	uint16_t fdv_payload_len;
+	uint16_t fdv_header_len;
+	int res;
+	uint8_t msg_type;
+	uint64_t hash_num;
+
+	while (*len > 0) {
+		/* Seeks the top of the message */
+		res = cefnetd_messege_head_seek (
+				buff, index, len, &fdv_payload_len, &fdv_header_len);
+		if (res < 0) {
+			break;
+		}
+		msg = &buff[*index];
+
+		/* Calls the function corresponding to the type of the message 	*/
+		if (msg[1] > CefC_PT_MAX) {
+			cef_log_write (CefC_Log_Warn,
+				"Detects the unknown PT_XXX=%d\n", msg[1]);
+		} else {
+			if (msg[1] >= CefC_PT_REQUEST) {
+				memcpy (work_buff, msg, fdv_payload_len + fdv_header_len);
+				msg = work_buff;
+			}
+			msg_type = msg[1];
+			hash_num = cef_hash_count_get ();
+
+			if (((msg_type == CefC_PT_INTEREST) || (msg_type == CefC_PT_OBJECT)) &&
+				(cefnetd_worker_num_get () > 0) &&
+				(cefnetd_worker_steer (hdl, faceid, peer_faceid,
+							msg, fdv_payload_len, fdv_header_len) > 0)) {
+				*index += fdv_payload_len + fdv_header_len;
+				*len   -= fdv_payload_len + fdv_header_len;
+				continue;
 			}
 
-			/* Calls the function corresponding to the type of the message 	*/
-			if (face->rcv_buff[1] > CefC_PT_MAX) {
-				cef_log_write (CefC_Log_Warn,
-					"Detects the unknown PT_XXX=%d\n", face->rcv_buff[1]);
-			} else {
-				(*cefnetd_incoming_msg_process[face->rcv_buff[1]])
-					(hdl, faceid, peer_faceid,
-							face->rcv_buff, fdv_payload_len, fdv_header_len, user_id);
+			/* The Faces, the Content Store and the csmgrd upload which keep this	*/
+			/* message share one copy of it 										*/
+			cef_pktbuf_cur_set (msg, fdv_payload_len + fdv_header_len);
+			(*cefnetd_incoming_msg_process[msg_type])
+				(hdl, faceid, peer_faceid,
+						msg, fdv_payload_len, fdv_header_len, user_id);
+			cef_pktbuf_cur_clear ();
+
+			/* Counts the keys hashed to forward the Interest 		*/
+			if (msg_type == CefC_PT_INTEREST) {
+				hash_num = cef_hash_count_get () - hash_num;
+				hdl->stat_hash_interest++;
+				hdl->stat_hash_num += hash_num;
+				if (hash_num > hdl->stat_hash_max) {
+					hdl->stat_hash_max = hash_num;
+				}
 			}
+		}
 
-			/* Updates the receive buffer 		*/
-			move_len = fdv_payload_len + fdv_header_len;
+		/* Moves the cursor to the next message 		*/
+		*index += fdv_payload_len + fdv_header_len;
+		*len   -= fdv_payload_len + fdv_header_len;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Passes the Interest or the Content Object to the forwarding worker which owns
+	its Name, unless the message needs the functions of the main thread
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the worker took the message 		*/
+cefnetd_worker_steer (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* msg, 					/* the received message 					*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+) {
+	/* Only the main thread steers, and the view is too large for the stack 	*/
+	static CefT_CcnMsg_View view;
+	CefT_CcnMsg_OptHdr poh = { 0 };
+	struct tlv_hdr* tlv;
+	unsigned char* name;
+	uint16_t name_len;
+	uint8_t hash;
+
+	if ((uint32_t) payload_len + header_len > CefC_Max_Msg_Size) {
+		return (0);
+	}
+
+	/* The signed messages are verified by the main thread 	*/
+	tlv = (struct tlv_hdr*) &msg[header_len];
+	if (header_len + CefC_S_TLF + ntohs (tlv->length) != payload_len + header_len) {
+		return (0);
+	}
+	if (cef_frame_message_view_parse (
+			msg, payload_len, header_len, &poh, &view, msg[1]) < 1) {
+		return (0);
+	}
+
+	/* The transport plugins, the applications and the ORG options are handled 	*/
+	/* by the main thread 															*/
+	if ((poh.org_len > 0) || (poh.app_reg_f > 0) || (poh.dev_reg_pit_num > 0) ||
+		(view.org.value != NULL)) {
+		return (0);
+	}
+	name = cef_frame_view_name_get (&view, &name_len);
+	if ((name == NULL) || (view.chunk_num_f == 0)) {
+		return (0);
+	}
+
+	/* Commands 	*/
+	hash = hdl->cefrt_seed;
+	CEFRTHASH8 (name, hash, name_len);
+	if ((hdl->cmd_filter[hash] >= CefC_Cmd_Link_Req) &&
+		(hdl->cmd_filter[hash] <= CefC_Cmd_Link_Res) &&
+		(hdl->cmd_len[hash] == name_len) &&
+		(memcmp (&hdl->cmd[hash][0], name, name_len) == 0)) {
+		return (0);
+	}
+	name_len -= CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum;
 
-			wp = face->rcv_buff + move_len;
-			memmove (face->rcv_buff, wp, face->len - move_len);
-			face->len -= move_len;
+	if (msg[1] == CefC_PT_INTEREST) {
+		if ((view.tlv[CefC_T_PAYLOAD].value != NULL) ||
+			(view.tlv[CefC_T_KEYIDRESTR].value != NULL) ||
+			(view.tlv[CefC_T_OBJHASHRESTR].value != NULL) ||
+			(view.hoplimit < 1)) {
+			return (0);
+		}
+		if ((cef_hash_tbl_item_num_get (hdl->app_reg) > 0) &&
+			(cef_hash_tbl_item_get_for_app (hdl->app_reg, name, name_len) != NULL)) {
+			return (0);
+		}
+	} else {
+		if (cef_lhash_tbl_item_num_get (hdl->app_pit) > 0) {
+			return (0);
 		}
 	}
 
+	cefnetd_worker_push (hdl,
+		(int)(cef_hash_key_hashv_create (name, name_len) % cefnetd_worker_num_get ()),
+		faceid, peer_faceid, msg, payload_len, header_len);
+
 	return (1);
 }
+/*--------------------------------------------------------------------------------------
+	Handles the message which a forwarding worker handed back
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_back_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* msg, 					/* the message 								*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+) {
+	char user_id[] = "";
+
+	cef_pktbuf_cur_set (msg, payload_len + header_len);
+	(*cefnetd_incoming_msg_process[msg[1]])
+		(hdl, faceid, peer_faceid, msg, payload_len, header_len, user_id);
+	cef_pktbuf_cur_clear ();
+}
+/*--------------------------------------------------------------------------------------
+	Handles the messages in the receive buffer of the face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_face_rcv_buff_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int faceid, 								/* Face-ID where messages arrived at	*/
+	int peer_faceid, 							/* Face-ID to reply to the origin of 	*/
+												/* transmission of the message(s)		*/
+	CefT_Face* face,							/* the face structure					*/
+	char* user_id
+) {
+	int index = face->head;
+	int len = face->len;
+
+	cefnetd_input_message_handle (
+		hdl, faceid, peer_faceid, face->rcv_buff, &index, &len, user_id);
+
+	if (len == 0) {
+		index = 0;
+	}
+	face->head = (uint16_t) index;
+	face->len  = (uint16_t) len;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the free area at the tail of the receive buffer of the face. The data
+	which is not handled yet is moved to the top only when the tail is shorter
+	than min_len.
+----------------------------------------------------------------------------------------*/
+static unsigned char*							/* tail of the receive buffer 			*/
+cefnetd_face_rcv_tail_get (
+	CefT_Face* face,							/* the face structure					*/
+	int min_len,								/* length to compact the buffer if the 	*/
+												/* tail is shorter than it 				*/
+	int* tail_len								/* length of the free area 				*/
+) {
+	if ((face->head > 0) &&
+		(CefC_Max_Length - (face->head + face->len) < min_len)) {
+		memmove (face->rcv_buff, face->rcv_buff + face->head, face->len);
+		face->head = 0;
+	}
+	*tail_len = CefC_Max_Length - (face->head + face->len);
+
+	return (face->rcv_buff + face->head + face->len);
+}
 #ifdef CefC_ContentStore
 /*--------------------------------------------------------------------------------------
 	Handles the received message(s) from csmgr
@@ -4340,58 +5496,44 @@ cefnetd_csmgr_messege_head_seek (
 ----------------------------------------------------------------------------------------*/
 static int									/* Returns a negative value if it fails 	*/
 cefnetd_messege_head_seek (
-	CefT_Face* face,						/* the face structure						*/
+	unsigned char* buff,					/* buffer of the received data 				*/
+	int* index,								/* offset of the data not handled yet 		*/
+	int* len,								/* length of the data not handled yet 		*/
 	uint16_t* payload_len,
 	uint16_t* header_len
 ) {
-	uint16_t move_len;
+	unsigned char* bp;
 	unsigned char* wp;
-	unsigned char* ep;
-	unsigned char buff[CefC_Max_Length];
-	uint16_t index = 0;
 	static uint16_t short_step = 0;
 
 	struct cef_hdr* chp;
 	uint16_t pkt_len;
 	uint16_t hdr_len;
 
-	while (face->len > 7) {
-		chp = (struct cef_hdr*) &(face->rcv_buff[index]);
-
-		pkt_len = ntohs (chp->pkt_len);
-		hdr_len = chp->hdr_len;
+	while (*len > 7) {
+		bp  = &buff[*index];
+		chp = (struct cef_hdr*) bp;
 
 		if (chp->version != CefC_Version) {
-			wp = &face->rcv_buff[index];
-			ep = face->rcv_buff + index + face->len;
-			move_len = 0;
-
-			while (wp < ep) {
-				if (*wp != CefC_Version) {
-					wp++;
-				} else {
-					move_len = ep - wp;
-					memcpy (buff, wp, move_len);
-					memcpy (face->rcv_buff, buff, move_len);
-					face->len -= wp - face->rcv_buff;
-
-					chp = (struct cef_hdr*) &(face->rcv_buff);
-					pkt_len = ntohs (chp->pkt_len);
-					hdr_len = chp->hdr_len;
-					index = 0;
-
-					break;
-				}
-			}
-			if (move_len == 0) {
-				face->len = 0;
+			/* Skips to the byte which can be the top of a message 	*/
+			wp = memchr (bp, CefC_Version, *len);
+			if (wp == NULL) {
+				*index += *len;
+				*len = 0;
 				return (-1);
 			}
+			*index += wp - bp;
+			*len   -= wp - bp;
+			continue;
 		}
 
-		if (chp->type > CefC_PT_MAX) {
-			face->len--;
-			index++;
+		pkt_len = ntohs (chp->pkt_len);
+		hdr_len = chp->hdr_len;
+
+		if ((chp->type > CefC_PT_MAX) ||
+			(hdr_len < CefC_S_Fix_Header) || (pkt_len < hdr_len)) {
+			(*index)++;
+			(*len)--;
 			continue;
 		}
 
@@ -4399,20 +5541,16 @@ cefnetd_messege_head_seek (
 		*payload_len 	= pkt_len - hdr_len;
 		*header_len 	= hdr_len;
 
-		if (face->len < *payload_len + *header_len) {
+		if (*len < pkt_len) {
 			short_step++;
 			if (short_step > 2) {
 				short_step = 0;
-				face->len--;
-				index++;
+				(*index)++;
+				(*len)--;
 				continue;
 			}
 			return (-1);
 		}
-
-		if (index > 0) {
-			memmove (face->rcv_buff, face->rcv_buff + index, face->len);
-		}
 		short_step = 0;
 		return (1);
 	}
@@ -4433,7 +5571,8 @@ cefnetd_incoming_interest_process (
 	uint16_t header_len,					/* Header Length of this message			*/
 	char*	user_id
 ) {
-	CefT_CcnMsg_MsgBdy pm = { 0 };
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View view;
 	CefT_CcnMsg_OptHdr poh = { 0 };
 
 	int res;
@@ -4585,8 +5724,11 @@ cefnetd_incoming_interest_process (
 SKIP_BW_STAT_CHECK:;
 
 	/* Parses the received Interest 	*/
-	res = cef_frame_message_parse (
-					msg, payload_len, header_len, &poh, &pm, CefC_PT_INTEREST);
+	res = cef_frame_message_view_parse (
+					msg, payload_len, header_len, &poh, &view, CefC_PT_INTEREST);
+	if (res > 0) {
+		res = cef_frame_view_msgbdy_fill (&view, &pm);
+	}
 	if (res < 0) {
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine, "Detects the invalid Interest\n");
@@ -4712,7 +5854,8 @@ SKIP_BW_STAT_CHECK:;
 
 	if (pit_res != 0) {
 		/* Searches a FIB entry matching this Interest 		*/
-		fe = cef_fib_entry_search (hdl->fib, pm.name, name_len);
+		fe = cef_fib_entry_search_with_hashv (hdl->fib, pm.name, name_len,
+					pm.name_hash_end, pm.name_hashv, pm.name_hash_num);
 
 		/* Count of Received Interest */
 		hdl->stat_recv_interest++;
@@ -4732,13 +5875,15 @@ SKIP_BW_STAT_CHECK:;
 			struct cef_hdr* msghdr;
 			uint16_t pkt_len;
 			uint16_t hdr_len;
+			unsigned char* piggyback;
 
-			msghdr = (struct cef_hdr*) pm.payload;
+			piggyback = cef_frame_view_payload_get (&view, NULL);
+			msghdr = (struct cef_hdr*) piggyback;
 			pkt_len = ntohs (msghdr->pkt_len);
 			hdr_len = msghdr->hdr_len;
 
 			cefnetd_incoming_piggyback_process (
-				hdl, faceid, peer_faceid, pm.payload, pkt_len - hdr_len, hdr_len);
+				hdl, faceid, peer_faceid, piggyback, pkt_len - hdr_len, hdr_len);
 
 			tp_plugin_res = CefC_Pi_Interest_Send;
 		}
@@ -4767,7 +5912,7 @@ SKIP_BW_STAT_CHECK:;
 		elem.in_faceid 			= (uint16_t) peer_faceid;
 		elem.parsed_msg 		= &pm;
 		elem.parsed_oph 		= &poh;
-		memcpy (&(elem.msg[0]), msg, payload_len + header_len);
+		elem.msg 				= msg;
 		elem.msg_len 			= payload_len + header_len;
 		elem.out_faceid_num 	= face_num;
 
@@ -4795,7 +5940,7 @@ SKIP_BW_STAT_CHECK:;
 			elem.hashv 				= contents_hashv;
 			elem.in_faceid 			= (uint16_t) peer_faceid;
 			elem.parsed_msg 		= &pm;
-			memcpy (&(elem.msg[0]), msg, payload_len + header_len);
+			elem.msg 				= msg;
 			elem.msg_len 			= payload_len + header_len;
 			elem.out_faceid_num 	= face_num;
 
@@ -4899,7 +6044,8 @@ FORWARD_INTEREST:
 		} else {
 			name_len = pm.name_len;
 		}
-		fip = (uint16_t*) cef_hash_tbl_item_get_for_app (hdl->app_reg, pm.name, name_len);
+		fip = (uint16_t*) cef_hash_tbl_item_get_for_app_with_hashv (hdl->app_reg, pm.name,
+								name_len, cef_frame_name_hashv_get (&pm, pm.name, name_len));
 
 		if (fip) {
 			if (cef_face_check_active (*fip) > 0) {
@@ -4991,7 +6137,8 @@ cefnetd_incoming_object_process (
 	uint16_t header_len,					/* Header Length of this message			*/
 	char*	user_id
 ) {
-	CefT_CcnMsg_MsgBdy pm = { 0 };
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View view;
 	CefT_CcnMsg_OptHdr poh = { 0 };
 	CefT_Pit_Entry* pe = NULL;
 	int res;
@@ -5033,8 +6180,11 @@ cefnetd_incoming_object_process (
 		return (-1);
 	}
 
-	res = cef_frame_message_parse (
-					msg, payload_len, header_len, &poh, &pm, CefC_PT_OBJECT);
+	res = cef_frame_message_view_parse (
+					msg, payload_len, header_len, &poh, &view, CefC_PT_OBJECT);
+	if (res > 0) {
+		res = cef_frame_view_msgbdy_fill (&view, &pm);
+	}
 	if (res < 0) {
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine, "Detects the invalid Content Object\n");
@@ -5219,7 +6369,7 @@ cefnetd_incoming_object_process (
 		elem.in_faceid 			= (uint16_t) peer_faceid;
 		elem.parsed_msg 		= &pm;
 		elem.parsed_oph 		= &poh;
-		memcpy (&(elem.msg[0]), msg, payload_len + header_len);
+		elem.msg 				= msg;
 		elem.msg_len 			= payload_len + header_len;
 		elem.out_faceid_num 	= face_num;
 
@@ -5247,7 +6397,7 @@ cefnetd_incoming_object_process (
 			elem.hashv 				= contents_hashv;
 			elem.in_faceid 			= (uint16_t) peer_faceid;
 			elem.parsed_msg 		= &pm;
-			memcpy (&(elem.msg[0]), msg, payload_len + header_len);
+			elem.msg 				= msg;
 			elem.msg_len 			= payload_len + header_len;
 			elem.out_faceid_num 	= face_num;
 
@@ -5727,7 +6877,8 @@ cefnetd_incoming_ccninforeq_process (
 			} else {
 				name_len = pm.name_len;
 			}
-			fip = (uint16_t*) cef_hash_tbl_item_get_for_app (hdl->app_reg, pm.name, name_len);
+			fip = (uint16_t*) cef_hash_tbl_item_get_for_app_with_hashv (hdl->app_reg, pm.name,
+								name_len, cef_frame_name_hashv_get (&pm, pm.name, name_len));
 #ifdef DEB_CCNINFO
 {
 	int ii;
@@ -5828,7 +6979,8 @@ cefnetd_incoming_ccninforeq_process (
 		}
 
 		/* Searches a FIB entry matching this request 	*/
-		fe = cef_fib_entry_search (hdl->fib, pm.name, name_len);
+		fe = cef_fib_entry_search_with_hashv (hdl->fib, pm.name, name_len,
+					pm.name_hash_end, pm.name_hashv, pm.name_hash_num);
 
 		/* Obtains Face-ID(s) to forward the request 	*/
 		if (fe) {
@@ -6555,7 +7707,8 @@ cefnetd_incoming_csmgr_object_process (
 	uint16_t header_len,					/* Header Length of this message			*/
 	char*	user_id
 ) {
-	CefT_CcnMsg_MsgBdy pm = { 0 };
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View view;
 	CefT_CcnMsg_OptHdr poh = { 0 };
 	CefT_Pit_Entry* pe;
 	int loop_max = 2;						/* For App(0), Trans(1)						*/
@@ -6598,8 +7751,11 @@ cefnetd_incoming_csmgr_object_process (
 		return (-1);
 	}
 
-	res = cef_frame_message_parse (
-					msg, payload_len, header_len, &poh, &pm, CefC_PT_OBJECT);
+	res = cef_frame_message_view_parse (
+					msg, payload_len, header_len, &poh, &view, CefC_PT_OBJECT);
+	if (res > 0) {
+		res = cef_frame_view_msgbdy_fill (&view, &pm);
+	}
 	if (res < 0) {
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Finer,
@@ -7171,6 +8327,71 @@ cefnetd_config_read (
 			}
 			hdl->Buffer_Cache_Time = res * 1000;
 		}
+		else if ( strcasecmp (pname, CefC_ParamName_UDP_BATCH_SIZE) == 0 ) {
+			res = atoi(ws);
+			if ( (res < 1) || (res > CefC_Face_Batch_Max) ) {
+				cef_log_write (CefC_Log_Error,
+					"UDP_BATCH_SIZE must be higher than 0 and lower than %d.\n",
+					CefC_Face_Batch_Max + 1);
+				return (-1);
+			}
+			hdl->udp_batch_size = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_FACE_OUTQ_SIZE) == 0 ) {
+			res = atoi(ws);
+			if ( (res < 0) || (res > CefC_Face_Outq_Size_Max) ) {
+				cef_log_write (CefC_Log_Error,
+					"FACE_OUTQ_SIZE must be higher than or equal to 0 and lower than %d.\n",
+					CefC_Face_Outq_Size_Max + 1);
+				return (-1);
+			}
+			hdl->face_outq_size = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_FACE_OUTQ_POLICY) == 0 ) {
+			res = atoi(ws);
+			if ( (res != CefC_Face_Outq_Drop_Tail) && (res != CefC_Face_Outq_Drop_Head) ) {
+				cef_log_write (CefC_Log_Error, "FACE_OUTQ_POLICY must be 0 or 1.\n");
+				return (-1);
+			}
+			hdl->face_outq_policy = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_HASH_HIGH_WATER) == 0 ) {
+			res = atoi(ws);
+			if ( (res < 1) || (res > 100) ) {
+				cef_log_write (CefC_Log_Error, "HASH_HIGH_WATER must be 1 to 100.\n");
+				return (-1);
+			}
+			hdl->hash_high_water = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_HASH_LOW_WATER) == 0 ) {
+			res = atoi(ws);
+			if ( (res < 0) || (res > 100) ) {
+				cef_log_write (CefC_Log_Error, "HASH_LOW_WATER must be 0 to 100.\n");
+				return (-1);
+			}
+			hdl->hash_low_water = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_LocalShmSize) == 0 ) {
+			res = atoi(ws);
+			if ( (res != 0) &&
+				 ((res < CefC_Shmring_Size_Min) || (res > CefC_Shmring_Size_Max)) ) {
+				cef_log_write (CefC_Log_Error,
+					"LOCAL_SHM_SIZE must be 0, or higher than %d and lower than %d.\n",
+					CefC_Shmring_Size_Min - 1, CefC_Shmring_Size_Max + 1);
+				return (-1);
+			}
+			hdl->local_shm_size = res;
+		}
+		else if ( strcasecmp (pname, CefC_ParamName_FWD_WORKERS) == 0 ) {
+			res = atoi(ws);
+			if ( (res < 0) || (res > CefC_FWD_WORKERS_Max) ) {
+				cef_log_write (CefC_Log_Error,
+					"FORWARDING_WORKERS must be higher than or equal to 0 and lower than %d.\n",
+					CefC_FWD_WORKERS_Max + 1);
+				return (-1);
+			}
+			hdl->fwd_workers = res;
+		}
 		//202108
 #ifdef	CefC_INTEREST_RETURN
 		else if ( strcasecmp (pname, CefC_ParamName_IR_Option) == 0 ) {
@@ -7244,6 +8465,13 @@ cefnetd_config_read (
 	}
 	fclose (fp);
 
+	/* A halved table must stay under the high water mark not to grow again 	*/
+	if ( hdl->hash_low_water * 2 >= hdl->hash_high_water ) {
+		cef_log_write (CefC_Log_Error,
+			"HASH_LOW_WATER must be lower than half of HASH_HIGH_WATER.\n");
+		return (-1);
+	}
+
 	//202108
 	if ( hdl->IR_Option == 0 ) {
 		strcpy( hdl->bw_stat_pin_name, "None" );
@@ -7274,6 +8502,13 @@ cefnetd_config_read (
 	cef_dbg_write (CefC_Dbg_Fine, "CSMGR_ACCESS = %s\n",
 					(hdl->Ex_Cache_Access == CefC_Default_CSMGR_ACCESS_RW) ? "RW" : "RO" );
 	cef_dbg_write (CefC_Dbg_Fine, "BUFFER_CACHE_TIME    = %d\n", hdl->Buffer_Cache_Time);
+	cef_dbg_write (CefC_Dbg_Fine, "UDP_BATCH_SIZE       = %d\n", hdl->udp_batch_size);
+	cef_dbg_write (CefC_Dbg_Fine, "FACE_OUTQ_SIZE       = %d\n", hdl->face_outq_size);
+	cef_dbg_write (CefC_Dbg_Fine, "FACE_OUTQ_POLICY     = %d\n", hdl->face_outq_policy);
+	cef_dbg_write (CefC_Dbg_Fine, "HASH_HIGH_WATER      = %d\n", hdl->hash_high_water);
+	cef_dbg_write (CefC_Dbg_Fine, "HASH_LOW_WATER       = %d\n", hdl->hash_low_water);
+	cef_dbg_write (CefC_Dbg_Fine, "LOCAL_SHM_SIZE       = %d\n", hdl->local_shm_size);
+	cef_dbg_write (CefC_Dbg_Fine, "FORWARDING_WORKERS   = %d\n", hdl->fwd_workers);
 	cef_dbg_write (CefC_Dbg_Fine, "BANDWIDTH_STAT_PLUGIN = %s\n", hdl->bw_stat_pin_name);
 	//202108
 	cef_dbg_write (CefC_Dbg_Fine, "ENABLE_INTEREST_RETURN = %d\n", hdl->IR_Option);
@@ -7501,6 +8736,12 @@ cefnetd_faces_init (
 		cef_log_write (CefC_Log_Error, "Failed to init Face package.\n");
 		return (-1);
 	}
+	res = cef_face_batch_init (hdl->udp_batch_size);
+	if (res < 0) {
+		cef_log_write (CefC_Log_Error, "Failed to init the batched UDP I/O.\n");
+		return (-1);
+	}
+	cef_face_outq_init (hdl->face_outq_size, hdl->face_outq_policy);
 
 	/* Creates listening face 			*/
 	res = cef_face_udp_listen_face_create (hdl->port_num, &res_v4, &res_v6);
@@ -7576,94 +8817,63 @@ cefnetd_pit_cleanup (
 	CefT_Down_Faces* face;
 	int idx;
 	CefT_Rx_Elem_Sig_DelPit sig_delpit;
-	int clean_num = 0;
-	int rec_index = 0;
-	int end_index;
-	int end_flag = 0;
-	uint32_t elem_num, elem_index, eidx;
+	uint64_t expired_num = 0;
+	uint64_t elapsed_us;
 
-	if (nowt > hdl->pit_clean_t) {
-		int pit_num = cef_lhash_tbl_item_num_get(hdl->pit);
-		end_index = hdl->pit_clean_i;
+	/* Only the entries whose lifetime expired are taken from the timing wheel,	*/
+	/* so the cost does not depend on the size of PIT.							*/
+	while ((pe = cef_pit_timer_expired_get (nowt)) != NULL) {
 
+		if (!cef_pit_entry_lock (pe)) {
+			cef_pit_timer_schedule (pe);
+			continue;
+		}
+		expired_num++;
 #ifdef	__PIT_CLEAN__
-	if (pit_num > 0) {
-		fprintf(stderr, "[%s] pit_num=%d\n", __func__, pit_num);
-	}
+fprintf( stderr, "[%s] cef_pit_clean()\n", __func__ );
 #endif
+		cef_pit_clean (hdl->pit, pe);
 
-		while (clean_num < pit_num) {
-			pe = (CefT_Pit_Entry*) cef_lhash_tbl_elem_get (hdl->pit, &(hdl->pit_clean_i), &elem_num);
+		/* Indicates that a PIT entry was deleted to Transport  	*/
+		if (hdl->plugin_hdl.tp[pe->tp_variant].pit) {
 
-			if (hdl->pit_clean_i == end_index) {
-				end_flag++;
-				if (end_flag > 1) {
-					break;
-				}
-			}
-			rec_index = hdl->pit_clean_i;
-			hdl->pit_clean_i++;
+			/* Records PIT entries ware deleted  	*/
+			face = &(pe->clean_dnfaces);
+			idx = 0;
 
-			if (pe == NULL) {
-				break;
+			while ((face->next) && (idx < CefC_Elem_Face_Num)) {
+				face = face->next;
+				sig_delpit.faceids[idx] = face->faceid;
+				idx++;
 			}
-#ifdef	__PIT_CLEAN__
-	fprintf( stderr, "[%s] elem_get rec_index=%d, elm_num=%d\n", __func__, rec_index, elem_num);
-#endif
-
-			for (eidx = 0, elem_index = 0; elem_index < elem_num; elem_index++) {
-				pe = (CefT_Pit_Entry*)
-						cef_lhash_tbl_item_get_from_index (hdl->pit, rec_index, eidx);
-
-				if (!pe || !cef_pit_entry_lock(pe) ){
-					eidx++;
-					continue;
-				}
-
-				clean_num++;
-#ifdef	__PIT_CLEAN__
-fprintf( stderr, "[%s] cef_pit_clean(), elem_index=%d, eidx=%d\n", __func__, elem_index, eidx );
-#endif
-				cef_pit_clean (hdl->pit, pe);
-
-				/* Indicates that a PIT entry was deleted to Transport  	*/
-				if (hdl->plugin_hdl.tp[pe->tp_variant].pit) {
-
-					/* Records PIT entries ware deleted  	*/
-					face = &(pe->clean_dnfaces);
-					idx = 0;
-
-					while (face->next) {
-						face = face->next;
-						sig_delpit.faceids[idx] = face->faceid;
-						idx++;
-					}
 
-					if (idx > 0) {
+			if (idx > 0) {
 
-						sig_delpit.faceid_num = idx;
-						sig_delpit.hashv = pe->hashv;
+				sig_delpit.faceid_num = idx;
+				sig_delpit.hashv = pe->hashv;
 
-						(*(hdl->plugin_hdl.tp)[pe->tp_variant].pit)(
-							&(hdl->plugin_hdl.tp[pe->tp_variant]), &sig_delpit);
-					}
-				}
+				(*(hdl->plugin_hdl.tp)[pe->tp_variant].pit)(
+					&(hdl->plugin_hdl.tp[pe->tp_variant]), &sig_delpit);
+			}
+		}
 
-//				if (pe->dnfacenum < 1) {
-				if (pe->drp_lifetime_us < nowt) {	// 2023/04/05 by iD
+		if (pe->drp_lifetime_us < nowt) {	// 2023/04/05 by iD
 #ifdef	__PIT_CLEAN__
 fprintf( stderr, "[%s] cef_pit_entry_free()\n", __func__ );
 #endif
+			cef_pit_entry_free (hdl->pit, pe);
+		} else {
+			cef_pit_timer_schedule (pe);
+			cef_pit_entry_unlock(pe);
+		}
+	}
 
-					cef_pit_entry_free (hdl->pit, pe);
-
-				} else {
-					cef_pit_entry_unlock(pe);
-					eidx++;
-				}
-			}
+	if (expired_num > 0) {
+		elapsed_us = cef_client_present_timeus_calc () - nowt;
+		hdl->stat_pit_expired += expired_num;
+		if (elapsed_us > hdl->stat_pit_clean_max_us) {
+			hdl->stat_pit_clean_max_us = elapsed_us;
 		}
-		hdl->pit_clean_t = nowt + CefC_Pit_CleaningTime;
 	}
 
 	return;
@@ -7916,7 +9126,8 @@ cefnetd_cefcache_object_process (
 	uint16_t hdr_len;
 	uint16_t payload_len;
 	uint16_t header_len;
-	CefT_CcnMsg_MsgBdy pm = { 0 };
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View view;
 	CefT_CcnMsg_OptHdr poh = { 0 };
 	CefT_Pit_Entry* pe;
 
@@ -7950,8 +9161,11 @@ cefnetd_cefcache_object_process (
 #endif // CefC_Debug
 		return (-1);
 	}
-	res = cef_frame_message_parse (
-					msg, payload_len, header_len, &poh, &pm, CefC_PT_OBJECT);
+	res = cef_frame_message_view_parse (
+					msg, payload_len, header_len, &poh, &view, CefC_PT_OBJECT);
+	if (res > 0) {
+		res = cef_frame_view_msgbdy_fill (&view, &pm);
+	}
 	if (res < 0) {
 		return (-1);
 	}
@@ -8688,7 +9902,8 @@ SKIP_INTEREST:;
 	hdl->stat_recv_interest++;
 	/* Count of Received Interest by type */
 	hdl->stat_recv_interest_types[pm->InterestType]++;
-	fe = cef_fib_entry_search (hdl->fib, pm->name, pm->name_len);
+	fe = cef_fib_entry_search_with_hashv (hdl->fib, pm->name, pm->name_len,
+					pm->name_hash_end, pm->name_hashv, pm->name_hash_num);
 	if (fe) {
 		/* Count of Received Interest at FIB */
 		fe->rx_int++;
@@ -8701,7 +9916,8 @@ SKIP_INTEREST:;
 	if ( pit_res_first != 0 ) {
 		if ( hdl->Selective_fwd == CefC_Selet_FWD_ON ) {
 			/* Searches a FIB entry matching this Interest 		*/
-			fe = cef_fib_entry_search (hdl->fib, pm->name, pm->name_len);
+			fe = cef_fib_entry_search_with_hashv (hdl->fib, pm->name, pm->name_len,
+					pm->name_hash_end, pm->name_hashv, pm->name_hash_num);
 			/* Obtains Face-ID(s) to forward the Interest */
 			if (fe) {
 				face_num = cef_fib_forward_faceid_select (fe, peer_faceid, faceids);
@@ -241,6 +241,13 @@ typedef struct {
 	int					Regular_max_lifetime;
 	int					Ex_Cache_Access;		/* 0:Read/Write   1:ReadOnly			*/
 	uint32_t			Buffer_Cache_Time;		/* Buffer cahce timt					*/
+	int					udp_batch_size;			/* Max datagrams per recvmmsg/sendmmsg	*/
+	int					face_outq_size;			/* Max bytes queued per Face 			*/
+	int					face_outq_policy;		/* Drop policy of the output queue 		*/
+	int					hash_high_water;		/* Load (%) to grow PIT and FIB 		*/
+	int					hash_low_water;			/* Load (%) to shrink PIT and FIB 		*/
+	int					local_shm_size;			/* Size of the shared memory ring 		*/
+	int					fwd_workers;			/* Number of the forwarding workers 	*/
 												/* for KeyIdRestriction					*/
 												/* Private key, public key prefix		*/
 												/*   Private key name: 					*/
@@ -298,8 +305,6 @@ typedef struct {
 	uint8_t				app_fds_num;
 
 	/********** Timers				***********/
-	uint64_t			pit_clean_t;
-	uint32_t 			pit_clean_i;
 	uint64_t			fib_clean_t;
 	uint32_t 			fib_clean_i;
 
@@ -312,13 +317,16 @@ typedef struct {
 	uint64_t			stat_send_interest;				/* Count of Send Interest		*/
 	uint64_t			stat_send_interest_types[3];	/* Count of Send Interest by type */
 														/* 0:Regular, 1:Symbolic, 2:Selective */
+	uint64_t			stat_pit_expired;				/* Count of expired PIT entries	*/
+	uint64_t			stat_pit_clean_max_us;			/* Max time of 1 PIT cleanup (usec) */
+	uint64_t			stat_hash_interest;				/* Count of Interests hash-counted	*/
+	uint64_t			stat_hash_num;					/* Keys hashed for the Interests	*/
+	uint64_t			stat_hash_max;					/* Max keys hashed for 1 Interest	*/
 
 	/********** Content Store		***********/
 	CefT_Cs_Stat*		cs_stat;				/* Status of Content Store				*/
 #if (defined CefC_ContentStore) \
 	|| (defined CefC_Conpub) || (defined CefC_CefnetdCache)
-	double				send_rate;				/* send content rate					*/
-	uint64_t			send_next;				/* Send content next					*/
 #endif // CefC_ContentStore || CefC_Conpub
 
 	/********** Neighbor Management ***********/
@@ -281,7 +281,8 @@ cefnetd_object_forward (
 			name_len = pm->name_len;
 		}
 
-		fwdstr.fe = cef_fib_entry_search (hdl->fib, pm->name, name_len);
+		fwdstr.fe = cef_fib_entry_search_with_hashv (hdl->fib, pm->name, name_len,
+					pm->name_hash_end, pm->name_hashv, pm->name_hash_num);
 
 		/* Forwards the ContentObject according to Forwarding Strategy. */
 		hdl->fwd_strtgy_hdl->fwd_cob(&fwdstr);
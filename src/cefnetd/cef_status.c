@@ -48,11 +48,14 @@
 #include <netdb.h>
 
 #include "cef_status.h"
+#include "cef_worker.h"
 #include <cefore/cef_hash.h>
 #include <cefore/cef_fib.h>
 #include <cefore/cef_face.h>
 #include <cefore/cef_frame.h>
 #include <cefore/cef_print.h>
+#include <cefore/cef_mpool.h>
+#include <cefore/cef_valid.h>
 #include <cefore/cef_plugin_com.h>
 #if ((defined CefC_CefnetdCache) && (defined CefC_Develop))
 #include <cefore/cef_mem_cache.h>
@@ -88,6 +91,14 @@ static int
 cef_status_face_output (
 	void
 );
+/*--------------------------------------------------------------------------------------
+	Output the output queue of the Face
+----------------------------------------------------------------------------------------*/
+static void
+cef_status_face_outq_output (
+	CefT_Face* face,
+	char* buff
+);
 /*--------------------------------------------------------------------------------------
 	Output FIB status
 ----------------------------------------------------------------------------------------*/
@@ -223,6 +234,100 @@ cef_status_stats_output (
 			(unsigned long long)hdl->stat_send_frames,
 			cache_type,
 			hdl->forwarding_strategy);
+	sprintf (work_str, "PIT Expiry       : %llu (max %llu us/tick)\n",
+			(unsigned long long)hdl->stat_pit_expired,
+			(unsigned long long)hdl->stat_pit_clean_max_us);
+	if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+		goto endfunc;
+	}
+	sprintf (work_str, "Name Hash        : %llu for %llu Interests (max %llu/Interest)\n",
+			(unsigned long long)hdl->stat_hash_num,
+			(unsigned long long)hdl->stat_hash_interest,
+			(unsigned long long)hdl->stat_hash_max);
+	if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+		goto endfunc;
+	}
+	{
+		uint32_t pit_num = cef_lhash_tbl_item_num_get (hdl->pit);
+		uint32_t pit_cap = cef_lhash_tbl_capacity_get (hdl->pit);
+		uint32_t fib_num = cef_hash_tbl_item_num_get (hdl->fib);
+		uint32_t fib_cap = cef_hash_tbl_capacity_get (hdl->fib);
+		sprintf (work_str, "Table Load       : PIT %u%% (%u/%u), FIB %u%% (%u/%u)\n",
+				(unsigned)(pit_cap ? (uint64_t) pit_num * 100 / pit_cap : 0), pit_num, pit_cap,
+				(unsigned)(fib_cap ? (uint64_t) fib_num * 100 / fib_cap : 0), fib_num, fib_cap);
+	}
+	if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+		goto endfunc;
+	}
+	if (cefnetd_worker_num_get () > 0) {
+		CefT_Worker_Stat wstat;
+		cefnetd_worker_stat_get (&wstat);
+		sprintf (work_str,
+			"Workers          : %d (PIT %u, push %llu, drop %llu, back %llu, FIB snap %llu)\n",
+			wstat.num, wstat.pit_num, (unsigned long long)wstat.push_num,
+			(unsigned long long)wstat.drop_num, (unsigned long long)wstat.back_num,
+			(unsigned long long)wstat.snap_num);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
+	if (cef_face_batch_size_get () > 1) {
+		CefT_Face_Batch_Stat bstat;
+		cef_face_batch_stat_get (&bstat);
+		sprintf (work_str,
+			"UDP Batch        : %d (drop %llu)\n"
+			"  Datagrams/call : 1 2-3 4-7 8-15 16-31 32-63 64\n"
+			"  Rx (recvmmsg)  : %llu %llu %llu %llu %llu %llu %llu\n"
+			"  Tx (sendmmsg)  : %llu %llu %llu %llu %llu %llu %llu\n",
+			cef_face_batch_size_get (), (unsigned long long)bstat.tx_drop,
+			(unsigned long long)bstat.rx_hist[0], (unsigned long long)bstat.rx_hist[1],
+			(unsigned long long)bstat.rx_hist[2], (unsigned long long)bstat.rx_hist[3],
+			(unsigned long long)bstat.rx_hist[4], (unsigned long long)bstat.rx_hist[5],
+			(unsigned long long)bstat.rx_hist[6],
+			(unsigned long long)bstat.tx_hist[0], (unsigned long long)bstat.tx_hist[1],
+			(unsigned long long)bstat.tx_hist[2], (unsigned long long)bstat.tx_hist[3],
+			(unsigned long long)bstat.tx_hist[4], (unsigned long long)bstat.tx_hist[5],
+			(unsigned long long)bstat.tx_hist[6]);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
+	{
+		CefT_Valid_Stat vstat;
+		cef_valid_stat_get (&vstat);
+		sprintf (work_str,
+			"Verification     : %llu/sec (total %llu, OK %llu, key cache hit %llu, miss %llu)\n",
+			(unsigned long long)vstat.verify_per_sec, (unsigned long long)vstat.verify_num,
+			(unsigned long long)vstat.verify_ok, (unsigned long long)vstat.key_cache_hit,
+			(unsigned long long)vstat.key_cache_miss);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
+	{
+		CefT_Mp_Stat mstats[CefC_Mp_Pool_Max];
+		int mnum;
+		int n;
+
+		mnum = cef_mpool_stat_get (mstats, CefC_Mp_Pool_Max);
+		if (mnum > 0) {
+			sprintf (work_str, "Memory Pools :\n");
+			if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+				goto endfunc;
+			}
+		}
+		for (n = 0 ; n < mnum ; n++) {
+			sprintf (work_str,
+				"  %-16s : size %zu, total %llu, in use %llu, high-water %llu\n",
+				mstats[n].key, mstats[n].size,
+				(unsigned long long)mstats[n].total,
+				(unsigned long long)mstats[n].in_use,
+				(unsigned long long)mstats[n].high_water);
+			if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+				goto endfunc;
+			}
+		}
+	}
 #ifdef CefC_INTEREST_RETURN
 	sprintf (work_str, "Interest Return  : %s\n"
 		, (hdl->IR_Option != 1) ? "Disabled" : "Enabled");
@@ -285,6 +390,23 @@ cef_status_stats_output (
 	if ((fret=cef_status_pit_output (&hdl->pit, output_opt_f, numofpit)) != 0){
 		goto endfunc;
 	}
+#ifdef	CefC_Develop
+	{
+		CefT_Pit_Slab_Stat pit_slab;
+
+		cef_pit_slab_stat_get (&pit_slab);
+		sprintf (work_str, "PIT Slab : used=%llu, pooled=%llu, "
+			"spilled(DownFaces=%llu, UpFaces=%llu, Names=%llu)\n",
+			(unsigned long long)pit_slab.entry_num,
+			(unsigned long long)pit_slab.entry_pooled,
+			(unsigned long long)pit_slab.dnface_spill_num,
+			(unsigned long long)pit_slab.upface_spill_num,
+			(unsigned long long)pit_slab.name_spill_num);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
+#endif	// CefC_Develop
 
 #if ((defined CefC_CefnetdCache) && (defined CefC_Develop))
 	if (hdl->cs_mode == 1) {
@@ -303,6 +425,24 @@ endfunc:;
 		return (0);
 	}
 }
+/*--------------------------------------------------------------------------------------
+	Output the output queue of the Face
+----------------------------------------------------------------------------------------*/
+static void
+cef_status_face_outq_output (
+	CefT_Face* face,
+	char* buff
+) {
+	buff[0] = 0x00;
+
+	/* Faces which never queued nor dropped are shown as before 	*/
+	if ((face->outq.enq == 0) && (face->outq.drop == 0)) {
+		return;
+	}
+	sprintf (buff, " [outq %u msgs, %u bytes, queued %llu, drop %llu]",
+		face->outq.num, face->outq.bytes,
+		(unsigned long long) face->outq.enq, (unsigned long long) face->outq.drop);
+}
 /*--------------------------------------------------------------------------------------
 	Output Face status
 ----------------------------------------------------------------------------------------*/
@@ -354,7 +494,9 @@ cef_status_face_output (
 		/* check local face flag	*/
 		face = cef_face_get_face_from_faceid (sock->faceid);
 		if (face->local_f || (sock->faceid == 0)) {
-			sprintf (work_str, "  faceid = %3d : Local face\n", sock->faceid);
+			face_info_index = sprintf (face_info, "  faceid = %3d : Local face", sock->faceid);
+			cef_status_face_outq_output (face, face_info + face_info_index);
+			sprintf (work_str, "%s\n", face_info);
 			if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
 				return (-1);
 			}
@@ -436,6 +578,7 @@ cef_status_face_output (
 				 "address = %s:%s (%s)%s", node, port, prot_str[sock->protocol],
 				 (cef_face_check_active (sock->faceid) < 1) ? " # down" : "");
 		}
+		cef_status_face_outq_output (face, face_info + strlen (face_info));
 
 		sprintf (work_str, "%s\n", face_info);
 		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
@@ -742,13 +885,12 @@ cef_status_app_forward_output (
 
 	struct App_Reg* entry = NULL;
 	int table_num = 0;
-	int i = 0;
 	char uri[65535] = {0};
 	int res = 0;
 	char work_str[CefC_Max_Length*2];
 	int fret = 0;
 
-	CefT_Hash* ht = (CefT_Hash*)(*handle);	//20210104
+	uint32_t index = 0;
 	int		elem_cnt = 0;
 
 	/* get table num		*/
@@ -766,28 +908,27 @@ cef_status_app_forward_output (
 		return (-1);
 	}
 
-	for ( i = 0; i < ht->elem_max; i++ ) {
-		if (ht->tbl[i].klen > 0) {
-			entry = (struct App_Reg*)ht->tbl[i].elem;
-			elem_cnt++;
-			res = cef_frame_conversion_name_to_uri (entry->name, entry->name_len, uri);
-			if (res < 0) {
-				continue;
-			}
-			/* output uri	*/
-			sprintf (work_str, "  %s\n", uri);
+	for (index = 0 ;
+		 (entry = (struct App_Reg*) cef_hash_tbl_item_check_from_index (*handle, &index)) != NULL ;
+		 index++) {
+		elem_cnt++;
+		res = cef_frame_conversion_name_to_uri (entry->name, entry->name_len, uri);
+		if (res < 0) {
+			continue;
+		}
+		/* output uri	*/
+		sprintf (work_str, "  %s\n", uri);
 
-			if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
-				return (-1);
-			}
-			/* output faces	*/
-			sprintf (work_str, "    Faces : %d\n", entry->faceid);
-			if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
-				return (-1);
-			}
-			if ( elem_cnt >= table_num ) {
-				break;
-			}
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			return (-1);
+		}
+		/* output faces	*/
+		sprintf (work_str, "    Faces : %d\n", entry->faceid);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			return (-1);
+		}
+		if ( elem_cnt >= table_num ) {
+			break;
 		}
 	}
 
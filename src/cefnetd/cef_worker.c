@@ -0,0 +1,1028 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_worker.c
+ *
+ * The main thread passes a message to the worker which owns its Name through a
+ * single producer ring, and the worker returns it through another ring either to
+ * be sent to the selected Faces or to be handled by the main thread. The workers
+ * search a snapshot of the FIB which the main thread replaces when a route or a
+ * Face changes. A replaced snapshot is freed after every worker has started a new
+ * batch (or is waiting), so that the workers take no lock to search it.
+ */
+
+#define __CEF_WORKER_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+
+#include "cef_worker.h"
+
+#ifdef CefC_Netd_Worker_Enable
+#include <sys/eventfd.h>
+#endif // CefC_Netd_Worker_Enable
+
+#include <cefore/cef_rngque.h>
+#include <cefore/cef_mpool.h>
+#include <cefore/cef_pktbuf.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Worker_Wait_Max		100			/* Max wait of an idle worker (msec) 	*/
+#define CefC_Worker_Offline			UINT64_MAX	/* Epoch of a worker which is waiting 	*/
+#define CefC_Worker_Cache_Line		64
+
+#define CefC_Worker_Job_Rx			0			/* to be forwarded by the worker 		*/
+#define CefC_Worker_Job_Tx			1			/* to be sent by the main thread 		*/
+#define CefC_Worker_Job_Back		2			/* to be handled by the main thread 	*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** Message passed between the main thread and a worker 	*****/
+typedef struct {
+	uint8_t 		kind;						/* CefC_Worker_Job_XXX 					*/
+	uint8_t 		msg_type;					/* CefC_PT_INTEREST or CefC_PT_OBJECT 	*/
+	uint8_t 		peer_type;					/* CefC_Face_Type_XXX of the peer Face 	*/
+	uint16_t 		faceid;						/* Face-ID where the message arrived at	*/
+	uint16_t 		peer_faceid;				/* Face-ID of the origin 				*/
+	uint16_t 		payload_len;
+	uint16_t 		header_len;
+	uint16_t 		faceid_num;					/* number of the Faces to send to 		*/
+	uint16_t 		faceids[CefC_Fib_UpFace_Max];
+	CefT_Pktbuf* 	pb;							/* the message 							*/
+} CefT_Worker_Job;
+
+/***** Routes which the workers read 	*****/
+typedef struct CefT_Worker_View {
+	CefT_Fib_Snapshot* 	fib;					/* snapshot of the FIB 					*/
+	uint32_t 			fib_gen;				/* generation of the FIB 				*/
+	uint64_t 			retired_epoch;			/* epoch at which it was replaced 		*/
+	struct CefT_Worker_View* next;				/* next older retired view 				*/
+} CefT_Worker_View;
+
+/***** Counters of a worker 	*****/
+typedef struct {
+	uint64_t 	recv_interest;
+	uint64_t 	recv_interest_types[CefC_PIT_TYPE_MAX];
+	uint64_t 	send_interest;
+	uint64_t 	send_interest_types[CefC_PIT_TYPE_MAX];
+	uint64_t 	recv_frames;
+	uint64_t 	send_frames;
+	uint64_t 	pit_expired;
+	uint64_t 	back_num;
+	uint64_t 	pit_num;
+} CefT_Worker_Count;
+
+#define CefC_Worker_Count_Num		(sizeof (CefT_Worker_Count) / sizeof (uint64_t))
+
+/***** Forwarding worker 	*****/
+typedef struct {
+
+	/*----- Written by the worker -----*/
+	CefT_Worker_Count 	cnt						/* counted in the batch 				*/
+		__attribute__ ((aligned (CefC_Worker_Cache_Line)));
+	CefT_Worker_Count 	pub;					/* published after the batch 			*/
+	uint64_t 			qs_epoch;				/* epoch at which the view was read 	*/
+	int 				sleep_f;				/* 1 while waiting on efd 				*/
+
+	/*----- Written by the main thread -----*/
+	CefT_Worker_Count 	folded					/* pub added to the statistics 			*/
+		__attribute__ ((aligned (CefC_Worker_Cache_Line)));
+	uint64_t 			push_num;
+	uint64_t 			drop_num;
+
+	/*----- Read only -----*/
+	pthread_t 			thread
+		__attribute__ ((aligned (CefC_Worker_Cache_Line)));
+	int 				efd;					/* wakes up the worker 					*/
+	CefT_Rngque* 		rx_que;					/* main thread -> worker 				*/
+	CefT_Rngque* 		tx_que;					/* worker -> main thread 				*/
+	CefT_Hash_Handle 	pit;					/* PIT used only by the worker 			*/
+
+} CefT_Worker;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static struct {
+	int 				num;					/* number of the running workers 		*/
+	int 				stop_f;
+	int 				efd;					/* wakes up the main thread 			*/
+	int 				notified_f;				/* 1 if efd is written and not read 	*/
+	uint64_t 			epoch;					/* incremented when the view changes 	*/
+	CefT_Worker_View* 	view;					/* the view which the workers read 		*/
+	CefT_Worker_View* 	retired;				/* replaced views, the newest first 	*/
+	uint64_t 			snap_num;
+	uint32_t 			face_gen;				/* generation of the Face Table 		*/
+	uint8_t 			face_type[CefC_Face_Router_Max];	/* Invalid if not active 	*/
+	CefT_Mp_Handle 		job_mp;
+	CefT_Netd_Handle* 	hdl;
+	CefT_Worker 		workers[CefC_FWD_WORKERS_Max];
+} netd_worker = { 0, 0, -1 };
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+#ifdef CefC_Netd_Worker_Enable
+static void
+cefnetd_worker_wakeup (
+	int efd									/* eventfd 									*/
+);
+static void
+cefnetd_worker_wakeup_clear (
+	int efd									/* eventfd 									*/
+);
+static CefT_Worker_View* 					/* the view, or NULL if it fails 			*/
+cefnetd_worker_view_create (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+);
+static void
+cefnetd_worker_view_destroy (
+	CefT_Worker_View* view
+);
+static void
+cefnetd_worker_view_sync (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+);
+static void
+cefnetd_worker_view_reclaim (
+	void
+);
+static void
+cefnetd_worker_face_sync (
+	void
+);
+static void*
+cefnetd_worker_run (
+	void* arg								/* the worker 								*/
+);
+static void
+cefnetd_worker_interest_handle (
+	CefT_Worker* w,							/* the worker 								*/
+	const CefT_Worker_View* view,
+	CefT_Worker_Job* job
+);
+static void
+cefnetd_worker_object_handle (
+	CefT_Worker* w,							/* the worker 								*/
+	CefT_Worker_Job* job
+);
+static void
+cefnetd_worker_pit_cleanup (
+	CefT_Worker* w,							/* the worker 								*/
+	uint64_t nowt							/* current time (usec) 						*/
+);
+static void
+cefnetd_worker_count_publish (
+	CefT_Worker* w							/* the worker 								*/
+);
+static void
+cefnetd_worker_count_fold (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	CefT_Worker* w							/* the worker 								*/
+);
+#endif // CefC_Netd_Worker_Enable
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Starts the forwarding workers if the configuration allows them
+----------------------------------------------------------------------------------------*/
+int 										/* number of the started workers 			*/
+cefnetd_worker_init (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+) {
+#ifdef CefC_Netd_Worker_Enable
+	CefT_Worker* w;
+	uint32_t pit_size;
+	int i;
+
+	if (hdl->fwd_workers < 1) {
+		return (0);
+	}
+
+	/* The workers forward as the default strategy does, and have neither the 	*/
+	/* Content Store, the Interest Return nor the plugins of the main thread. 	*/
+	/* The error level is used since the default log level drops the warnings. 	*/
+	if (strcmp (hdl->forwarding_strategy, "default") != 0) {
+		cef_log_write (CefC_Log_Error, "FORWARDING_WORKERS=%d is ignored, because "
+			"FORWARDING_STRATEGY is %s (it needs default)\n",
+			hdl->fwd_workers, hdl->forwarding_strategy);
+		return (0);
+	}
+	if ((hdl->cs_stat != NULL) && (hdl->cs_stat->cache_type != CefC_Cache_Type_None)) {
+		cef_log_write (CefC_Log_Error, "FORWARDING_WORKERS=%d is ignored, because "
+			"CS_MODE is %d (it needs 0)\n", hdl->fwd_workers, hdl->cs_stat->cache_type);
+		return (0);
+	}
+	if (hdl->IR_Option != 0) {
+		cef_log_write (CefC_Log_Error, "FORWARDING_WORKERS=%d is ignored, because "
+			"ENABLE_INTEREST_RETURN is %d (it needs 0)\n", hdl->fwd_workers, hdl->IR_Option);
+		return (0);
+	}
+#ifdef CefC_Mobility
+	if ((hdl->plugin_hdl.mb->interest) || (hdl->plugin_hdl.mb->cob)) {
+		cef_log_write (CefC_Log_Error, "FORWARDING_WORKERS=%d is ignored, because "
+			"the mobility plugin is used\n", hdl->fwd_workers);
+		return (0);
+	}
+#endif // CefC_Mobility
+
+	memset (&netd_worker, 0, sizeof (netd_worker));
+	netd_worker.hdl = hdl;
+	netd_worker.efd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+	netd_worker.job_mp = cef_mpool_init ("CefWkJob", sizeof (CefT_Worker_Job), 1024);
+	netd_worker.view = cefnetd_worker_view_create (hdl);
+	if ((netd_worker.efd < 0) || (netd_worker.view == NULL)) {
+		cef_log_write (CefC_Log_Error, "%s(%u) Failed to prepare the workers\n",
+			__func__, __LINE__);
+		cefnetd_worker_destroy ();
+		return (0);
+	}
+	netd_worker.snap_num = 1;
+	cefnetd_worker_face_sync ();
+
+	/* Each worker owns the entries of the Names hashed to it 	*/
+	pit_size = hdl->pit_max_size / hdl->fwd_workers;
+	if (pit_size < 1) {
+		pit_size = 1;
+	}
+	for (i = 0 ; i < hdl->fwd_workers ; i++) {
+		w = &netd_worker.workers[i];
+		w->efd 		= eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+		w->rx_que 	= cef_rngque_create_with_mode (CefC_Worker_Que_Size, CefC_Rngque_Mode_Spsc);
+		w->tx_que 	= cef_rngque_create_with_mode (CefC_Worker_Que_Size, CefC_Rngque_Mode_Spsc);
+		w->pit 		= cef_lhash_tbl_create_resizable (pit_size, CefC_Hash_Coef_PIT);
+		w->qs_epoch = CefC_Worker_Offline;
+
+		if ((w->efd < 0) || (w->rx_que == NULL) || (w->tx_que == NULL) ||
+			(w->pit == (CefT_Hash_Handle) NULL) ||
+			(pthread_create (&w->thread, NULL, cefnetd_worker_run, w) != 0)) {
+			cef_log_write (CefC_Log_Error,
+				"%s(%u) Failed to create the forwarding worker\n", __func__, __LINE__);
+			if (w->efd >= 0) {
+				close (w->efd);
+			}
+			if (w->rx_que) {
+				cef_rngque_destroy (w->rx_que);
+			}
+			if (w->tx_que) {
+				cef_rngque_destroy (w->tx_que);
+			}
+			if (w->pit) {
+				cef_lhash_tbl_destroy (w->pit);
+			}
+			memset (w, 0, sizeof (CefT_Worker));
+			break;
+		}
+		netd_worker.num++;
+	}
+	if (netd_worker.num == 0) {
+		cefnetd_worker_destroy ();
+		return (0);
+	}
+	cef_log_write (CefC_Log_Info, "Forwarding workers ... %d\n", netd_worker.num);
+
+	return (netd_worker.num);
+#else // CefC_Netd_Worker_Enable
+	if (hdl->fwd_workers > 0) {
+		cef_log_write (CefC_Log_Error,
+			"FORWARDING_WORKERS is ignored, because it is supported only on Linux\n");
+	}
+	return (0);
+#endif // CefC_Netd_Worker_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Stops the forwarding workers and frees their PITs
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_destroy (
+	void
+) {
+#ifdef CefC_Netd_Worker_Enable
+	CefT_Worker_View* view;
+	CefT_Worker_Job* job;
+	CefT_Worker* w;
+	int i;
+
+	__atomic_store_n (&netd_worker.stop_f, 1, __ATOMIC_SEQ_CST);
+	for (i = 0 ; i < netd_worker.num ; i++) {
+		cefnetd_worker_wakeup (netd_worker.workers[i].efd);
+	}
+	for (i = 0 ; i < netd_worker.num ; i++) {
+		w = &netd_worker.workers[i];
+		pthread_join (w->thread, NULL);
+
+		while ((job = (CefT_Worker_Job*) cef_rngque_pop (w->rx_que)) != NULL) {
+			cef_pktbuf_unref (job->pb);
+		}
+		while ((job = (CefT_Worker_Job*) cef_rngque_pop (w->tx_que)) != NULL) {
+			cef_pktbuf_unref (job->pb);
+		}
+		cef_rngque_destroy (w->rx_que);
+		cef_rngque_destroy (w->tx_que);
+		cef_lhash_tbl_destroy (w->pit);
+		close (w->efd);
+	}
+	netd_worker.num = 0;
+
+	cefnetd_worker_view_destroy (netd_worker.view);
+	netd_worker.view = NULL;
+	while ((view = netd_worker.retired) != NULL) {
+		netd_worker.retired = view->next;
+		cefnetd_worker_view_destroy (view);
+	}
+	if (netd_worker.job_mp) {
+		cef_mpool_destroy (netd_worker.job_mp);
+		netd_worker.job_mp = 0;
+	}
+	if (netd_worker.efd >= 0) {
+		close (netd_worker.efd);
+		netd_worker.efd = -1;
+	}
+#endif // CefC_Netd_Worker_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the number of the running workers
+----------------------------------------------------------------------------------------*/
+int 										/* 0 if the main thread forwards all 		*/
+cefnetd_worker_num_get (
+	void
+) {
+	return (netd_worker.num);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the eventfd with which the workers wake up the main thread
+----------------------------------------------------------------------------------------*/
+int 										/* eventfd, -1 if no worker runs 			*/
+cefnetd_worker_efd_get (
+	void
+) {
+	if (netd_worker.num == 0) {
+		return (-1);
+	}
+	return (netd_worker.efd);
+}
+/*--------------------------------------------------------------------------------------
+	Passes the received message to the specified worker
+----------------------------------------------------------------------------------------*/
+int 										/* 1 if passed, 0 if dropped 				*/
+cefnetd_worker_push (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int idx,								/* index of the worker 						*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	const unsigned char* msg, 				/* the message 								*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+) {
+#ifdef CefC_Netd_Worker_Enable
+	CefT_Worker* w = &netd_worker.workers[idx];
+	CefT_Worker_Job* job;
+
+	/* The route or the Face which the previous message added is used for this one */
+	if ((netd_worker.retired) ||
+		(netd_worker.view->fib_gen != cef_fib_generation_get ()) ||
+		(netd_worker.face_gen != cef_face_generation_get ())) {
+		cefnetd_worker_view_sync (hdl);
+	}
+
+	job = (CefT_Worker_Job*) cef_mpool_alloc (netd_worker.job_mp);
+	if (job == NULL) {
+		__atomic_store_n (&w->drop_num, w->drop_num + 1, __ATOMIC_RELAXED);
+		return (0);
+	}
+	job->kind 			= CefC_Worker_Job_Rx;
+	job->msg_type 		= msg[1];
+	job->peer_type 		= (uint8_t) cef_face_type_get ((uint16_t) peer_faceid);
+	job->faceid 		= (uint16_t) faceid;
+	job->peer_faceid 	= (uint16_t) peer_faceid;
+	job->payload_len 	= payload_len;
+	job->header_len 	= header_len;
+	job->faceid_num 	= 0;
+	job->pb = cef_pktbuf_create (msg, payload_len + header_len);
+
+	if ((job->pb == NULL) || (cef_rngque_push (w->rx_que, job) == 0)) {
+		cef_pktbuf_unref (job->pb);
+		cef_mpool_free (netd_worker.job_mp, job);
+		__atomic_store_n (&w->drop_num, w->drop_num + 1, __ATOMIC_RELAXED);
+		return (0);
+	}
+	__atomic_store_n (&w->push_num, w->push_num + 1, __ATOMIC_RELAXED);
+
+	/* Pairs with the fence of the worker which goes to sleep 	*/
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&w->sleep_f, __ATOMIC_RELAXED) &&
+		__atomic_exchange_n (&w->sleep_f, 0, __ATOMIC_SEQ_CST)) {
+		cefnetd_worker_wakeup (w->efd);
+	}
+	return (1);
+#else // CefC_Netd_Worker_Enable
+	return (0);
+#endif // CefC_Netd_Worker_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Sends the messages which the workers forwarded, and handles the messages which
+	they handed back. Called by the main thread in each loop.
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	CefT_Worker_Back_Handler handler		/* handles the messages handed back 		*/
+) {
+#ifdef CefC_Netd_Worker_Enable
+	CefT_Worker_Job* jobs[CefC_Worker_Batch];
+	CefT_Worker_Job* job;
+	CefT_Worker* w;
+	int left_f = 0;
+	int handled;
+	int num;
+	int i, n, k;
+
+	if (netd_worker.num == 0) {
+		return;
+	}
+	/* Pairs with the fence of the worker which notifies the main thread 	*/
+	__atomic_store_n (&netd_worker.notified_f, 0, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	cefnetd_worker_wakeup_clear (netd_worker.efd);
+
+	cefnetd_worker_view_sync (hdl);
+
+	for (i = 0 ; i < netd_worker.num ; i++) {
+		w = &netd_worker.workers[i];
+
+		/* Takes at most a queue of messages not to starve the receive path 	*/
+		for (handled = 0 ; handled < CefC_Worker_Que_Size ; handled += num) {
+			num = cef_rngque_pop_bulk (w->tx_que, (void**) jobs, CefC_Worker_Batch);
+			if (num == 0) {
+				break;
+			}
+			for (n = 0 ; n < num ; n++) {
+				job = jobs[n];
+
+				if (job->kind == CefC_Worker_Job_Tx) {
+					for (k = 0 ; k < job->faceid_num ; k++) {
+						if (cef_face_check_active (job->faceids[k]) > 0) {
+							cef_face_pktbuf_send_forced (job->faceids[k], job->pb,
+								(job->msg_type == CefC_PT_OBJECT) ? 1 : 0);
+						}
+					}
+				} else {
+					(*handler) (hdl, job->faceid, job->peer_faceid,
+						job->pb->data, job->payload_len, job->header_len);
+				}
+				cef_pktbuf_unref (job->pb);
+				cef_mpool_free (netd_worker.job_mp, job);
+			}
+		}
+		if (handled >= CefC_Worker_Que_Size) {
+			left_f = 1;
+		}
+		cefnetd_worker_count_fold (hdl, w);
+	}
+
+	/* Comes back in the next loop without waiting 	*/
+	if (left_f) {
+		cefnetd_worker_wakeup (netd_worker.efd);
+	}
+#endif // CefC_Netd_Worker_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the workers. Any thread can call it.
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_stat_get (
+	CefT_Worker_Stat* stat					/* statistics to return						*/
+) {
+	CefT_Worker* w;
+	int i;
+
+	memset (stat, 0, sizeof (CefT_Worker_Stat));
+	stat->num = netd_worker.num;
+
+	for (i = 0 ; i < stat->num ; i++) {
+		w = &netd_worker.workers[i];
+		stat->pit_num 	+= (uint32_t) __atomic_load_n (&w->pub.pit_num, __ATOMIC_RELAXED);
+		stat->back_num 	+= __atomic_load_n (&w->pub.back_num, __ATOMIC_RELAXED);
+		stat->push_num 	+= __atomic_load_n (&w->push_num, __ATOMIC_RELAXED);
+		stat->drop_num 	+= __atomic_load_n (&w->drop_num, __ATOMIC_RELAXED);
+	}
+	stat->snap_num = __atomic_load_n (&netd_worker.snap_num, __ATOMIC_RELAXED);
+}
+#ifdef CefC_Netd_Worker_Enable
+/*--------------------------------------------------------------------------------------
+	Wakes up the thread waiting on the specified eventfd
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_wakeup (
+	int efd									/* eventfd 									*/
+) {
+	uint64_t one = 1;
+
+	if (write (efd, &one, sizeof (one)) < 0) {
+		/* The counter is already set when it fails with EAGAIN 	*/
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Clears the counter of the specified eventfd
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_wakeup_clear (
+	int efd									/* eventfd 									*/
+) {
+	uint64_t val;
+
+	if (read (efd, &val, sizeof (val)) < 0) {
+		/* Nothing was written 	*/
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Creates the view of the current FIB
+----------------------------------------------------------------------------------------*/
+static CefT_Worker_View* 					/* the view, or NULL if it fails 			*/
+cefnetd_worker_view_create (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+) {
+	CefT_Worker_View* view;
+
+	view = (CefT_Worker_View*) calloc (1, sizeof (CefT_Worker_View));
+	if (view == NULL) {
+		return (NULL);
+	}
+	view->fib_gen 	= cef_fib_generation_get ();
+	view->fib 		= cef_fib_snapshot_create (hdl->fib);
+	if (view->fib == NULL) {
+		free (view);
+		return (NULL);
+	}
+	return (view);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the view
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_view_destroy (
+	CefT_Worker_View* view
+) {
+	if (view == NULL) {
+		return;
+	}
+	cef_fib_snapshot_destroy (view->fib);
+	free (view);
+}
+/*--------------------------------------------------------------------------------------
+	Updates the Face types if the Faces changed, and replaces the view if the FIB
+	changed. The replaced views are freed when every worker has read a later epoch.
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_view_sync (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+) {
+	CefT_Worker_View* view;
+
+	if (netd_worker.retired) {
+		cefnetd_worker_view_reclaim ();
+	}
+	if (netd_worker.face_gen != cef_face_generation_get ()) {
+		cefnetd_worker_face_sync ();
+	}
+	if (netd_worker.view->fib_gen == cef_fib_generation_get ()) {
+		return;
+	}
+	view = cefnetd_worker_view_create (hdl);
+	if (view == NULL) {
+		return;
+	}
+	/* The workers which still read the previous view may do so until they read 	*/
+	/* the new epoch. A view is published even while older ones wait to be freed. 	*/
+	view->next = NULL;
+	netd_worker.view->next = netd_worker.retired;
+	netd_worker.retired = netd_worker.view;
+	__atomic_store_n (&netd_worker.view, view, __ATOMIC_SEQ_CST);
+	netd_worker.retired->retired_epoch =
+		__atomic_add_fetch (&netd_worker.epoch, 1, __ATOMIC_SEQ_CST);
+	__atomic_store_n (&netd_worker.snap_num, netd_worker.snap_num + 1, __ATOMIC_RELAXED);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the replaced views which no worker reads any more
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_view_reclaim (
+	void
+) {
+	CefT_Worker_View** prev;
+	CefT_Worker_View* view;
+	uint64_t min_epoch = CefC_Worker_Offline;
+	uint64_t epoch;
+	int i;
+
+	for (i = 0 ; i < netd_worker.num ; i++) {
+		epoch = __atomic_load_n (&netd_worker.workers[i].qs_epoch, __ATOMIC_SEQ_CST);
+		if (epoch < min_epoch) {
+			min_epoch = epoch;
+		}
+	}
+	prev = &netd_worker.retired;
+	while ((view = *prev) != NULL) {
+		if (view->retired_epoch <= min_epoch) {
+			*prev = view->next;
+			cefnetd_worker_view_destroy (view);
+		} else {
+			prev = &view->next;
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Updates the types of the Faces in place. A worker may see a Face go down in the
+	middle of a batch; the main thread checks each Face again before it sends.
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_face_sync (
+	void
+) {
+	uint8_t type;
+	int i;
+
+	netd_worker.face_gen = cef_face_generation_get ();
+
+	for (i = 0 ; i < CefC_Face_Router_Max ; i++) {
+		if (cef_face_check_active ((uint16_t) i) > 0) {
+			type = (uint8_t) cef_face_type_get ((uint16_t) i);
+		} else {
+			type = CefC_Face_Type_Invalid;
+		}
+		if (netd_worker.face_type[i] != type) {
+			__atomic_store_n (&netd_worker.face_type[i], type, __ATOMIC_RELAXED);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Main loop of a worker
+----------------------------------------------------------------------------------------*/
+static void*
+cefnetd_worker_run (
+	void* arg								/* the worker 								*/
+) {
+	CefT_Worker* w = (CefT_Worker*) arg;
+	CefT_Worker_Job* jobs[CefC_Worker_Batch];
+	const CefT_Worker_View* view;
+	struct pollfd pfd;
+	uint64_t nowt;
+	uint64_t next;
+	uint64_t epoch;
+	int timeout;
+	int num;
+	int i;
+
+	nowt = cef_client_present_timeus_calc ();
+	cef_pit_timer_init (w->pit, nowt);
+	pfd.fd 		= w->efd;
+	pfd.events 	= POLLIN;
+
+	while (!__atomic_load_n (&netd_worker.stop_f, __ATOMIC_SEQ_CST)) {
+
+		/* The views replaced before this epoch are not read anymore 	*/
+		epoch = __atomic_load_n (&netd_worker.epoch, __ATOMIC_SEQ_CST);
+		__atomic_store_n (&w->qs_epoch, epoch, __ATOMIC_SEQ_CST);
+		view = __atomic_load_n (&netd_worker.view, __ATOMIC_SEQ_CST);
+
+		num = cef_rngque_pop_bulk (w->rx_que, (void**) jobs, CefC_Worker_Batch);
+		nowt = cef_client_present_timeus_calc ();
+
+		for (i = 0 ; i < num ; i++) {
+			if (jobs[i]->msg_type == CefC_PT_INTEREST) {
+				cefnetd_worker_interest_handle (w, view, jobs[i]);
+			} else {
+				cefnetd_worker_object_handle (w, jobs[i]);
+			}
+			if (jobs[i]->kind == CefC_Worker_Job_Back) {
+				w->cnt.back_num++;
+			}
+			/* The main thread never waits for the workers, so it drains the queue */
+			while (cef_rngque_push (w->tx_que, jobs[i]) == 0) {
+				if (__atomic_load_n (&netd_worker.stop_f, __ATOMIC_RELAXED)) {
+					cef_pktbuf_unref (jobs[i]->pb);
+					break;
+				}
+				cefnetd_worker_wakeup (netd_worker.efd);
+				sched_yield ();
+			}
+		}
+		if (num > 0) {
+			__atomic_thread_fence (__ATOMIC_SEQ_CST);
+			if (!__atomic_exchange_n (&netd_worker.notified_f, 1, __ATOMIC_SEQ_CST)) {
+				cefnetd_worker_wakeup (netd_worker.efd);
+			}
+		}
+		cefnetd_worker_pit_cleanup (w, nowt);
+		cefnetd_worker_count_publish (w);
+
+		if (num > 0) {
+			continue;
+		}
+
+		/* Waits until a message is passed or an entry expires 	*/
+		__atomic_store_n (&w->sleep_f, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence (__ATOMIC_SEQ_CST);
+		if (cef_rngque_read (w->rx_que) != NULL) {
+			__atomic_store_n (&w->sleep_f, 0, __ATOMIC_SEQ_CST);
+			continue;
+		}
+		__atomic_store_n (&w->qs_epoch, CefC_Worker_Offline, __ATOMIC_SEQ_CST);
+
+		next = cef_pit_timer_next_get (nowt);
+		if (next == UINT64_MAX) {
+			timeout = CefC_Worker_Wait_Max;
+		} else if (next <= nowt) {
+			timeout = 0;
+		} else if (next - nowt >= (uint64_t) CefC_Worker_Wait_Max * 1000) {
+			timeout = CefC_Worker_Wait_Max;
+		} else {
+			timeout = (int)((next - nowt + 999) / 1000);
+		}
+		if (poll (&pfd, 1, timeout) > 0) {
+			cefnetd_worker_wakeup_clear (w->efd);
+		}
+		__atomic_store_n (&w->sleep_f, 0, __ATOMIC_SEQ_CST);
+	}
+	__atomic_store_n (&w->qs_epoch, CefC_Worker_Offline, __ATOMIC_SEQ_CST);
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Forwards the Interest as cefnetd_incoming_interest_process does with the default
+	strategy. The Interest which the snapshot can not route is handed back before
+	its PIT entry is created.
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_interest_handle (
+	CefT_Worker* w,							/* the worker 								*/
+	const CefT_Worker_View* view,
+	CefT_Worker_Job* job
+) {
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View mv;
+	CefT_CcnMsg_OptHdr poh = { 0 };
+	const CefT_Fib_Snap_Route* route;
+	CefT_Pit_Entry* pe;
+	unsigned char* msg = job->pb->data;
+	uint16_t name_len;
+	uint8_t type;
+	int pit_res;
+	int sel = -1;
+	int fid;
+	int i;
+
+	job->kind = CefC_Worker_Job_Back;
+
+	if ((cef_frame_message_view_parse (msg, job->payload_len, job->header_len,
+			&poh, &mv, CefC_PT_INTEREST) < 1) ||
+		(cef_frame_view_msgbdy_fill (&mv, &pm) < 0)) {
+		return;
+	}
+	if ((pm.InterestType != CefC_PIT_TYPE_Rgl) || (pm.chunk_num_f == 0)) {
+		return;
+	}
+	name_len = pm.name_len - (CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum);
+	if (cef_fib_snapshot_search (view->fib, pm.name, name_len,
+			pm.name_hash_end, pm.name_hashv, pm.name_hash_num, &route) < 0) {
+		return;
+	}
+
+	/* From here the main thread only sends the Interest to the selected Face 	*/
+	job->kind = CefC_Worker_Job_Tx;
+
+	pe = cef_pit_entry_lookup_with_lock (
+			w->pit, &pm, &poh, pm.name, pm.name_len, CefC_Pit_WithLOCK);
+	if (pe == NULL) {
+		return;
+	}
+	pit_res = cef_pit_entry_down_face_update (pe, job->peer_faceid, &pm, &poh, msg,
+				netd_worker.hdl->InterestRetrans);
+	cef_pit_entry_unlock (pe);
+	if (pit_res == 0) {
+		return;
+	}
+	w->cnt.recv_interest++;
+	w->cnt.recv_interest_types[pm.InterestType]++;
+
+	if ((route == NULL) || (route->face_num == 0)) {
+		return;
+	}
+	if (job->peer_type != CefC_Face_Type_Local) {
+		/* Only this worker holds the buffer yet 	*/
+		pm.hoplimit--;
+		msg[CefC_O_Fix_HopLimit] = pm.hoplimit;
+	}
+	if (pm.hoplimit < 1) {
+		return;
+	}
+
+	/* The first active Face of the type of the incoming Face, or else the first 	*/
+	/* active Face 																	*/
+	for (i = 0 ; i < route->face_num ; i++) {
+		fid = route->faceids[i];
+		if ((fid == job->peer_faceid) || (fid >= CefC_Face_Router_Max) ||
+			((type = __atomic_load_n (&netd_worker.face_type[fid], __ATOMIC_RELAXED))
+				== CefC_Face_Type_Invalid)) {
+			continue;
+		}
+		if (sel < 0) {
+			sel = fid;
+		}
+		if (type == job->peer_type) {
+			sel = fid;
+			break;
+		}
+	}
+	if (sel < 0) {
+		return;
+	}
+	cef_pit_entry_up_face_update (pe, (uint16_t) sel, &pm, &poh);
+	job->faceids[0] = (uint16_t) sel;
+	job->faceid_num = 1;
+
+	w->cnt.send_interest++;
+	w->cnt.send_interest_types[pm.InterestType]++;
+}
+/*--------------------------------------------------------------------------------------
+	Forwards the Content Object as cefnetd_incoming_object_process does with the
+	default strategy. The Object which matches no entry of the worker is handed back.
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_object_handle (
+	CefT_Worker* w,							/* the worker 								*/
+	CefT_Worker_Job* job
+) {
+	CefT_CcnMsg_MsgBdy pm;
+	CefT_CcnMsg_View mv;
+	CefT_CcnMsg_OptHdr poh = { 0 };
+	CefT_Pit_Entry* pe;
+	CefT_Down_Faces* face;
+	uint16_t faceids[CefC_Fib_UpFace_Max];
+	int face_num = 0;
+	int i;
+
+	job->kind = CefC_Worker_Job_Back;
+
+	if ((cef_frame_message_view_parse (job->pb->data, job->payload_len, job->header_len,
+			&poh, &mv, CefC_PT_OBJECT) < 1) ||
+		(cef_frame_view_msgbdy_fill (&mv, &pm) < 0)) {
+		return;
+	}
+	if (pm.chunk_num_f == 0) {
+		return;
+	}
+	pe = cef_pit_entry_search_with_chunk (w->pit, &pm, &poh);
+	if (pe == NULL) {
+		return;
+	}
+	job->kind = CefC_Worker_Job_Tx;
+	w->cnt.recv_frames++;
+
+	for (face = pe->dnfaces.next ; face && face_num < CefC_Fib_UpFace_Max ; face = face->next) {
+		faceids[face_num++] = face->faceid;
+	}
+	for (i = 0 ; i < face_num ; i++) {
+		for (face = pe->dnfaces.next ; face ; face = face->next) {
+			if ((face->faceid == faceids[i]) &&
+				((pm.org.longlife_f) || (face->nonce == pm.nonce))) {
+				break;
+			}
+		}
+		if ((face == NULL) || (!cef_pit_entry_down_face_ver_search (face, 0, &pm))) {
+			continue;
+		}
+		if ((face->faceid < CefC_Face_Router_Max) &&
+			(__atomic_load_n (&netd_worker.face_type[face->faceid], __ATOMIC_RELAXED)
+				!= CefC_Face_Type_Invalid)) {
+			job->faceids[job->faceid_num++] = face->faceid;
+			w->cnt.send_frames++;
+			cef_pit_entry_down_face_ver_remove (pe, face, &pm);
+		} else {
+			cef_pit_down_faceid_remove (pe, face->faceid);
+		}
+	}
+	if ((face_num > 0) && (pe->stole_f)) {
+		if (cef_pit_entry_lock (pe)) {
+			cef_pit_entry_free (w->pit, pe);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Cleans the PIT entries of the worker whose timers expired
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_pit_cleanup (
+	CefT_Worker* w,							/* the worker 								*/
+	uint64_t nowt							/* current time (usec) 						*/
+) {
+	CefT_Pit_Entry* pe;
+
+	while ((pe = cef_pit_timer_expired_get (nowt)) != NULL) {
+		if (!cef_pit_entry_lock (pe)) {
+			cef_pit_timer_schedule (pe);
+			continue;
+		}
+		w->cnt.pit_expired++;
+		cef_pit_clean (w->pit, pe);
+
+		if (pe->drp_lifetime_us < nowt) {
+			cef_pit_entry_free (w->pit, pe);
+		} else {
+			cef_pit_timer_schedule (pe);
+			cef_pit_entry_unlock (pe);
+		}
+	}
+	w->cnt.pit_num = (uint64_t) cef_lhash_tbl_item_num_get (w->pit);
+}
+/*--------------------------------------------------------------------------------------
+	Publishes the counters of the batch to the main thread
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_count_publish (
+	CefT_Worker* w							/* the worker 								*/
+) {
+	const uint64_t* src = (const uint64_t*) &w->cnt;
+	uint64_t* dst = (uint64_t*) &w->pub;
+	int i;
+
+	for (i = 0 ; i < (int) CefC_Worker_Count_Num ; i++) {
+		__atomic_store_n (&dst[i], src[i], __ATOMIC_RELAXED);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Adds the counters published by the worker to the statistics of cefnetd
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_worker_count_fold (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	CefT_Worker* w							/* the worker 								*/
+) {
+	CefT_Worker_Count now;
+	CefT_Worker_Count* old = &w->folded;
+	const uint64_t* src = (const uint64_t*) &w->pub;
+	uint64_t* dst = (uint64_t*) &now;
+	int i;
+
+	for (i = 0 ; i < (int) CefC_Worker_Count_Num ; i++) {
+		dst[i] = __atomic_load_n (&src[i], __ATOMIC_RELAXED);
+	}
+	hdl->stat_recv_interest += now.recv_interest - old->recv_interest;
+	hdl->stat_send_interest += now.send_interest - old->send_interest;
+	for (i = 0 ; i < CefC_PIT_TYPE_MAX ; i++) {
+		hdl->stat_recv_interest_types[i] +=
+			now.recv_interest_types[i] - old->recv_interest_types[i];
+		hdl->stat_send_interest_types[i] +=
+			now.send_interest_types[i] - old->send_interest_types[i];
+	}
+	hdl->stat_recv_frames += now.recv_frames - old->recv_frames;
+	hdl->stat_send_frames += now.send_frames - old->send_frames;
+	hdl->stat_pit_expired += now.pit_expired - old->pit_expired;
+
+	*old = now;
+}
+#endif // CefC_Netd_Worker_Enable
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_worker.h
+ *
+ * Forwarding workers of cefnetd. Each worker owns the PIT entries of the Names
+ * hashed to it, and forwards the Regular Interests and the Content Objects of
+ * those Names with a read-only snapshot of the FIB. The main thread still receives
+ * and sends all the messages, and keeps the messages which need its functions.
+ */
+
+#ifndef __CEF_WORKER_HEADER__
+#define __CEF_WORKER_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include "cef_netd.h"
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/* The workers wait on eventfd, so that they are available only on Linux 	*/
+#ifdef __linux__
+#define CefC_Netd_Worker_Enable
+#endif // __linux__
+
+#define CefC_Worker_Que_Size		4096		/* Messages queued to/from a worker 	*/
+#define CefC_Worker_Batch			64			/* Messages handled at once 			*/
+
+/****************************************************************************************
+ Structure Declarations
+ ****************************************************************************************/
+
+/***** Statistics of the forwarding workers 	*****/
+typedef struct {
+	int 		num;					/* Number of the running workers 				*/
+	uint32_t 	pit_num;				/* PIT entries owned by the workers 			*/
+	uint64_t 	push_num;				/* Messages passed to the workers 				*/
+	uint64_t 	drop_num;				/* Messages dropped since the queue was full 	*/
+	uint64_t 	back_num;				/* Messages handed back to the main thread 		*/
+	uint64_t 	snap_num;				/* FIB snapshots published to the workers 		*/
+} CefT_Worker_Stat;
+
+/***** Handles the message which a worker handed back to the main thread 	*****/
+typedef void (*CefT_Worker_Back_Handler) (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	unsigned char* msg, 					/* the message 								*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+);
+
+/****************************************************************************************
+ Global Variables
+ ****************************************************************************************/
+
+
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Starts the forwarding workers if the configuration allows them
+----------------------------------------------------------------------------------------*/
+int 										/* number of the started workers 			*/
+cefnetd_worker_init (
+	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
+);
+/*--------------------------------------------------------------------------------------
+	Stops the forwarding workers and frees their PITs
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_destroy (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the number of the running workers
+----------------------------------------------------------------------------------------*/
+int 										/* 0 if the main thread forwards all 		*/
+cefnetd_worker_num_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the eventfd with which the workers wake up the main thread
+----------------------------------------------------------------------------------------*/
+int 										/* eventfd, -1 if no worker runs 			*/
+cefnetd_worker_efd_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Passes the received message to the specified worker
+----------------------------------------------------------------------------------------*/
+int 										/* 1 if passed, 0 if dropped 				*/
+cefnetd_worker_push (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int idx,								/* index of the worker 						*/
+	int faceid, 							/* Face-ID where messages arrived at		*/
+	int peer_faceid, 						/* Face-ID to reply to the origin of 		*/
+											/* transmission of the message(s)			*/
+	const unsigned char* msg, 				/* the message 								*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len						/* Header Length of this message			*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the messages which the workers forwarded, and handles the messages which
+	they handed back. Called by the main thread in each loop.
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	CefT_Worker_Back_Handler handler		/* handles the messages handed back 		*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the workers. Any thread can call it.
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_worker_stat_get (
+	CefT_Worker_Stat* stat					/* statistics to return						*/
+);
+
+#endif // __CEF_WORKER_HEADER__
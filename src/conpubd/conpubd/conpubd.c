@@ -152,6 +152,12 @@ static unsigned char* 		Name_buff_p = NULL;
 static char* 				Uri_buff_p = NULL;
 static CsmgrT_Stat** 		Stat_p = NULL;
 
+/* Manifest which lists the CobHash of the chunks (MANIFEST=1) */
+static CefT_CcnMsg_MsgBdy* Man_prames_p = NULL;
+static unsigned char 		Man_seg[CefC_Name_Max_Length];
+static int 					Man_seg_len = 0;
+static uint32_t 			Man_rec_num = 0;
+
 #ifdef CefC_Debug
 	static char workstr[CefC_Max_Length];
 #endif
@@ -469,6 +475,24 @@ conpubd_publish_content_delete (
 	CefT_Conpubd_Handle* hdl,					/* conpub daemon handle					*/
 	CefT_Cpubcnt_Hdl* entry
 );
+/*--------------------------------------------------------------------------------------
+	Adds the CobHash of a chunk to the Manifest
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+conpubd_manifest_record_add (
+	CefT_Conpubd_Handle* hdl,					/* conpub daemon handle					*/
+	CefT_CcnMsg_OptHdr* opt,					/* option header of the Manifest		*/
+	uint32_t chunk_num,							/* chunk number							*/
+	unsigned char* cob_hash						/* CobHash of the chunk					*/
+);
+/*--------------------------------------------------------------------------------------
+	Signs the Manifest and puts it to the cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+conpubd_manifest_cob_put (
+	CefT_Conpubd_Handle* hdl,					/* conpub daemon handle					*/
+	CefT_CcnMsg_OptHdr* opt						/* option header of the Manifest		*/
+);
 /*--------------------------------------------------------------------------------------
 	Content registration check
 ----------------------------------------------------------------------------------------*/
@@ -688,6 +712,11 @@ main (
 		conpubd_post_process (hdl);
 		return (-1);
 	}
+	if ((Man_prames_p = calloc (1, sizeof (CefT_CcnMsg_MsgBdy))) == NULL) {
+		cef_log_write (CefC_Log_Error, "Unable to create woek area (Man_prames_p).\n");
+		conpubd_post_process (hdl);
+		return (-1);
+	}
 
 
 	if ((Name_buff_p = calloc (1, CefC_Max_Length)) == NULL) {
@@ -800,6 +829,7 @@ conpubd_handle_create (
 																/* , which is internal processing time	*/
 	hdl->cache_default_rct = conf_param.cache_default_rct;
 	hdl->valid_type = (uint16_t)cef_valid_type_get (conf_param.Valid_Alg);
+	hdl->manifest_f = conf_param.manifest;
 	hdl->block_size = conf_param.block_size;
 
 	/********** Published info.  ***********/
@@ -1474,6 +1504,9 @@ conpubd_handle_destroy (
 	if (Cob_prames_p != NULL) {
 		free (Cob_prames_p);
 	}
+	if (Man_prames_p != NULL) {
+		free (Man_prames_p);
+	}
 	if (Cob_msg_p != NULL) {
 		free (Cob_msg_p);
 	}
@@ -1544,6 +1577,7 @@ conpubd_config_read (
 	conf_param->purge_interval			= CefC_CnpbDefault_Purge_Interval;;
 	conf_param->cache_default_rct	= CefC_CnpbDefault_Cache_Default_Rct;
 	strcpy(conf_param->Valid_Alg,     CefC_CnpbDefault_Valid_Alg);
+	conf_param->manifest			= CefC_CnpbDefault_Manifest;
 	conf_param->contents_num			= CefC_CnpbDefault_Contents_num;
 	conf_param->contents_capacity	= CefC_CnpbDefault_Contents_Capacity;
 	conf_param->block_size			= CefC_CnpbDefault_Block_Size;
@@ -1659,6 +1693,16 @@ conpubd_config_read (
 			}
 			strcpy (conf_param->Valid_Alg, value);
 		} else
+		if (strcmp (option, "MANIFEST") == 0) {
+			res = conpubd_config_value_get (option, value);
+			if ((res != 0) && (res != 1)) {
+				cef_log_write (CefC_Log_Error,
+					"MANIFEST must be 0 or 1 (Invalid value %s=%s)\n", option, value);
+				fclose (fp);
+				return (-1);
+			}
+			conf_param->manifest = res;
+		} else
 		if (strcmp (option, "CONTENTS_NUM") == 0) {
 			res = conpubd_config_value_get (option, value);
 			if (!(1 <= res && res <= 1000000)) {
@@ -1749,6 +1793,21 @@ conpubd_config_read (
 
 	fclose (fp);
 
+	if (conf_param->manifest) {
+		if (strcmp (conf_param->Valid_Alg, "sha256") != 0) {
+			cef_log_write (CefC_Log_Error,
+				"MANIFEST=1 needs VALID_ALG=sha256 (VALID_ALG=%s)\n", conf_param->Valid_Alg);
+			return (-1);
+		}
+#ifdef	CefC_Db
+		if (strcmp (conf_param->cache_type, CefC_Cnpb_db_Cache_Type) == 0) {
+			cef_log_write (CefC_Log_Error,
+				"MANIFEST=1 can not be used with CACHE_TYPE=%s\n", conf_param->cache_type);
+			return (-1);
+		}
+#endif
+	}
+
 	if (strcmp (conf_param->cache_type, CefC_Cnpb_filesystem_Cache_Type) == 0) {
 		if (!(    access (conf_param->cache_path, F_OK) == 0
 		   && access (conf_param->cache_path, R_OK) == 0
@@ -1781,6 +1840,7 @@ conpubd_config_read (
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->purge_interval=%u\n", conf_param->purge_interval);
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->cache_default_rct=%u\n", conf_param->cache_default_rct);
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->Valid_Alg=%s\n", conf_param->Valid_Alg);
+	cef_dbg_write (CefC_Dbg_Fine, "conf_param->manifest=%d\n", conf_param->manifest);
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->contents_num=%d\n", conf_param->contents_num);
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->contents_capacity="FMTU64"\n", conf_param->contents_capacity);
 	cef_dbg_write (CefC_Dbg_Fine, "conf_param->block_size=%d\n", conf_param->block_size);
@@ -3699,6 +3759,18 @@ conpubd_init (
 		cef_log_write (CefC_Log_Error, "Failed to read the cefnetd.key\n");
 		return (-1);
 	}
+	/* Name segment appended to the content name to name its Manifest */
+	{
+		unsigned char name[CefC_Max_Length];
+
+		res = cef_frame_conversion_uri_to_name ("ccnx:" CefC_MANIFEST_NAME, name);
+		if (res < 0) {
+			cef_log_write (CefC_Log_Error, "Failed to create the Manifest name\n");
+			return (-1);
+		}
+		memcpy (Man_seg, name, res);
+		Man_seg_len = res;
+	}
 
 	conpubd_catalog_data_init ();
 
@@ -3753,6 +3825,7 @@ conpubd_publish_content_create (
 	uint64_t free_file_mega = 0;
 	uint64_t estimated_file_mega = 0;
 	CefT_CcnMsg_OptHdr	opt;
+	uint64_t man_num = 0;
 	
 	/* Check Content num  */
 	if (hdl->published_contents_num >= hdl->contents_num) {
@@ -3767,13 +3840,16 @@ conpubd_publish_content_create (
 		uint64_t capacity;
 		uint64_t cobs;
 
+		if (hdl->manifest_f) {
+			man_num = (entry->cob_num + CefC_MANIFEST_REC_MAX - 1) / CefC_MANIFEST_REC_MAX;
+		}
 		capacity = csmgr_stat_cache_capacity_get (stat_hdl);
 		cobs = hdl->cs_mod_int->cached_cobs();
-		if ((capacity - cobs) < entry->cob_num) {
+		if ((capacity - cobs) < entry->cob_num + man_num) {
 			cef_frame_conversion_name_to_string (entry->name, entry->name_len, Uri_buff_p, "ccn");
 			cef_log_write (CefC_Log_Warn
 							, "CAPACITY over : %s,  capacity="FMTU64",  used cobs="FMTU64",  set cobs="FMTU64"\n"
-							, Uri_buff_p, capacity, cobs, entry->cob_num);
+							, Uri_buff_p, capacity, cobs, entry->cob_num + man_num);
 			return (-99);
 		}
 	}
@@ -3821,7 +3897,12 @@ conpubd_publish_content_create (
 	Cob_prames_p->end_chunk_num_f =1;
 	Cob_prames_p->end_chunk_num = entry->cob_num-1;
 	/* Sets validation info */
-	Cob_prames_p->alg.valid_type = hdl->valid_type;
+	if (hdl->manifest_f) {
+		/* The chunks are validated by their CobHash in the signed Manifest */
+		Cob_prames_p->ObjHash_f = 1;
+	} else {
+		Cob_prames_p->alg.valid_type = hdl->valid_type;
+	}
 
 	/* Sets Version */
 	if (entry->version_len) {
@@ -3830,6 +3911,22 @@ conpubd_publish_content_create (
 	}
 	Cob_prames_p->org.version_len = (uint16_t)entry->version_len;
 
+	/* Inits the Manifest */
+	if (hdl->manifest_f) {
+		memset (Man_prames_p, 0, sizeof (CefT_CcnMsg_MsgBdy));
+		memcpy (Man_prames_p->name, entry->name, entry->name_len);
+		memcpy (&Man_prames_p->name[entry->name_len], Man_seg, Man_seg_len);
+		Man_prames_p->name_len = entry->name_len + Man_seg_len;
+		Man_prames_p->expiry = Cob_prames_p->expiry;
+		Man_prames_p->chunk_num_f = 1;
+		Man_prames_p->end_chunk_num_f = 1;
+		Man_prames_p->end_chunk_num = (uint32_t)(man_num - 1);
+		Man_prames_p->alg.valid_type = hdl->valid_type;
+		Man_prames_p->org = Cob_prames_p->org;
+		Man_prames_p->payload_len = sizeof (uint32_t);
+		Man_rec_num = 0;
+	}
+
 	cef_frame_conversion_name_to_string (entry->name, entry->name_len, Uri_buff_p, "ccn");
 	while (conpubd_running_f) {
 		res = fread (buff, sizeof (unsigned char), hdl->block_size, fp);
@@ -3924,6 +4021,15 @@ conpubd_publish_content_create (
 					hdl->cs_mod_int->cache_item_puts (NULL, 0, NULL);
 					return (-1);
 				}
+				if ((hdl->manifest_f) &&
+					(conpubd_manifest_record_add (
+						hdl, &opt, Cob_prames_p->chunk_num, Cob_prames_p->ObjHash_val) < 0)) {
+					cef_log_write (CefC_Log_Critical, "Failed to publish %s (Manifest)\n", Uri_buff_p);
+					conpubd_running_f = 0;
+					fclose (fp);
+					hdl->cs_mod_int->cache_item_puts (NULL, 0, NULL);
+					return (-1);
+				}
 			}
 			seqnum++;
 		} else {
@@ -3937,6 +4043,16 @@ conpubd_publish_content_create (
 			break;
 		}
 	}
+	if ((hdl->manifest_f) && (Man_rec_num > 0)) {
+		if (conpubd_manifest_cob_put (hdl, &opt) < 0) {
+			cef_log_write (CefC_Log_Critical, "Failed to publish %s (Manifest)\n", Uri_buff_p);
+			conpubd_running_f = 0;
+			fclose (fp);
+			hdl->cs_mod_int->cache_item_puts (NULL, 0, NULL);
+			return (-1);
+		}
+	}
+	entry->man_num = man_num;
 
 	hdl->cs_mod_int->cache_item_puts (NULL, 0, NULL);
 	fclose (fp);
@@ -3947,6 +4063,7 @@ PUTS_DB_CACHE:;
 	/* CefC_App_Reg */
 	{
 		CefT_Connect connect;
+		memset (&connect, 0, sizeof (CefT_Connect));
 		connect.ai = 0;
 		connect.sock = hdl->cefnetd_sock;
 		CefT_Client_Handle fhdl;
@@ -3984,6 +4101,7 @@ conpubd_publish_content_delete (
 
 	{
 		CefT_Connect connect;
+		memset (&connect, 0, sizeof (CefT_Connect));
 		connect.ai = 0;
 		connect.sock = hdl->cefnetd_sock;
 		CefT_Client_Handle fhdl;
@@ -4001,8 +4119,85 @@ conpubd_publish_content_delete (
 			cef_log_write (CefC_Log_Error, "Failed to delete %s (content_cache_del)\n", Uri_buff_p);
 			conpubd_running_f = 0;
 	}
+	if (entry->man_num > 0) {
+		memcpy (&Name_buff_p[name_len], Man_seg, Man_seg_len);
+		if (hdl->cs_mod_int->content_del (
+				Name_buff_p, name_len + Man_seg_len, entry->man_num) < 0) {
+			cef_frame_conversion_name_to_string (entry->name, entry->name_len, Uri_buff_p, "ccn");
+			cef_log_write (CefC_Log_Error,
+				"Failed to delete the Manifest of %s (content_cache_del)\n", Uri_buff_p);
+			conpubd_running_f = 0;
+		}
+	}
 	return (rtc);
 }
+/*--------------------------------------------------------------------------------------
+	Adds the CobHash of a chunk to the Manifest
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+conpubd_manifest_record_add (
+	CefT_Conpubd_Handle* hdl,					/* conpub daemon handle					*/
+	CefT_CcnMsg_OptHdr* opt,					/* option header of the Manifest		*/
+	uint32_t chunk_num,							/* chunk number							*/
+	unsigned char* cob_hash						/* CobHash of the chunk					*/
+) {
+	/* Same record as cefputfile_sec: chunk number followed by the CobHash */
+	memcpy (&Man_prames_p->payload[Man_prames_p->payload_len],
+		&chunk_num, sizeof (uint32_t));
+	Man_prames_p->payload_len += sizeof (uint32_t);
+	memcpy (&Man_prames_p->payload[Man_prames_p->payload_len],
+		cob_hash, CefC_HashVal_Len);
+	Man_prames_p->payload_len += CefC_HashVal_Len;
+	Man_rec_num++;
+
+	if (Man_rec_num == CefC_MANIFEST_REC_MAX) {
+		return (conpubd_manifest_cob_put (hdl, opt));
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Signs the Manifest and puts it to the cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+conpubd_manifest_cob_put (
+	CefT_Conpubd_Handle* hdl,					/* conpub daemon handle					*/
+	CefT_CcnMsg_OptHdr* opt						/* option header of the Manifest		*/
+) {
+	unsigned char cobbuff[CefC_Max_Length];
+	ConpubdT_Content_Entry cont_entry;
+	int len;
+
+	memcpy (Man_prames_p->payload, &Man_rec_num, sizeof (uint32_t));
+	len = cef_frame_object_create (cobbuff, opt, Man_prames_p);
+	if (len < 0) {
+		return (-1);
+	}
+
+	if ((cont_entry.msg = calloc (1, len)) == NULL) {
+		return (-1);
+	}
+	memcpy (cont_entry.msg, cobbuff, len);
+	cont_entry.msg_len = len;
+	if ((cont_entry.name = calloc (1, Man_prames_p->name_len)) == NULL) {
+		free (cont_entry.msg);
+		return (-1);
+	}
+	memcpy (cont_entry.name, Man_prames_p->name, Man_prames_p->name_len);
+	cont_entry.name_len = Man_prames_p->name_len;
+	cont_entry.pay_len = Man_prames_p->payload_len;
+	cont_entry.chunk_num = Man_prames_p->chunk_num;
+	cont_entry.expiry = Man_prames_p->expiry * 1000;
+	cont_entry.rct = (uint64_t)hdl->cache_default_rct;
+	if (hdl->cs_mod_int->cache_item_puts (&cont_entry, sizeof (cont_entry), NULL) < 0) {
+		return (-1);
+	}
+
+	Man_prames_p->chunk_num++;
+	Man_prames_p->payload_len = sizeof (uint32_t);
+	Man_rec_num = 0;
+
+	return (0);
+}
 #ifdef CefC_Db
 static int
 conpubd_publish_content_delete_db (
@@ -4017,6 +4212,7 @@ conpubd_publish_content_delete_db (
 
 	{
 		CefT_Connect connect;
+		memset (&connect, 0, sizeof (CefT_Connect));
 		connect.ai = 0;
 		connect.sock = hdl->cefnetd_sock;
 		CefT_Client_Handle fhdl;
@@ -4051,8 +4247,12 @@ conpubd_content_reg_check (
 	nowtsec = tv.tv_sec;
 
 	while (work) {
-		if ((work->name_len == name_len)
-			&& (memcmp (work->name, name, name_len) == 0)) {
+		if (((work->name_len == name_len)
+				&& (memcmp (work->name, name, name_len) == 0))
+			|| ((work->man_num > 0)
+				&& (work->name_len + Man_seg_len == name_len)
+				&& (memcmp (work->name, name, work->name_len) == 0)
+				&& (memcmp (Man_seg, &name[work->name_len], Man_seg_len) == 0))) {
 			if (nowtsec > work->expiry) {
  				pthread_mutex_lock (&conpub_cnt_mutex);
 				{
@@ -4166,6 +4366,7 @@ conpubd_connect_conpubd_and_regApp (
 				/* App_Reg */
 				{
 					CefT_Connect connect;
+					memset (&connect, 0, sizeof (CefT_Connect));
 					connect.ai = 0;
 					connect.sock = hdl->cefnetd_sock;
 					CefT_Client_Handle fhdl;
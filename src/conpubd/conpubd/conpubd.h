@@ -74,6 +74,7 @@ typedef struct {
 	uint32_t		purge_interval;
 	uint32_t		cache_default_rct;
 	char			Valid_Alg[128];
+	int				manifest;
 	int				contents_num;
 	uint64_t		contents_capacity;
 	int				block_size;
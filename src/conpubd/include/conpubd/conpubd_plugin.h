@@ -131,6 +131,7 @@ typedef struct {
 	int				block_size;
 	uint32_t		cache_default_rct;
 	uint16_t 		valid_type;
+	int				manifest_f;					/* Signs only the Manifest				*/
 
 	/********** APP FIB registration info. ***********/
 	char 		cefnetd_id[128];
@@ -171,6 +172,7 @@ typedef struct _CefT_Cpubcnt_Hdl {
 	time_t 				expiry;
 	uint64_t 			interests;
 	uint64_t			cob_num;
+	uint64_t			man_num;				/* Cobs of the Manifest					*/
 	int					line_no;
 	struct _CefT_Cpubcnt_Hdl* next;
 
@@ -55,7 +55,6 @@
 #include <pthread.h>
 #include <semaphore.h>
 
-#include <openssl/md5.h>
 
 #include "mem_cache.h"
 #include <cefore/cef_client.h>
@@ -939,13 +938,7 @@ cef_mem_hash_number_create (
 	const unsigned char* key,
 	uint32_t klen
 ) {
-	uint32_t hash;
-	unsigned char out[MD5_DIGEST_LENGTH];
-	
-	MD5 (key, klen, out);
-	memcpy (&hash, &out[12], sizeof (uint32_t));
-	
-	return (hash);
+	return (cef_hash_key_hashv_create (key, klen));
 }
 /****************************************************************************************/
 int												/* length of the created key 			*/
@@ -66,6 +66,7 @@
 #include <cefore/cef_client.h>
 #include <cefore/cef_frame.h>
 #include <cefore/cef_log.h>
+#include <cefore/cef_rngque.h>
 #ifdef CefC_Ccore
 #include <ccore/ccore_frame.h>
 #endif // CefC_Ccore
@@ -101,10 +102,20 @@ static int xpthread_mutex_lock (const char* pname, int pline, pthread_mutex_t *m
 #define CSMGR_THRSHLD_MEM_USAGE_FOR_FILE			40
 #define CSMGR_MAXIMUM_FILE_USAGE_FOR_FILE			80
 #define CSMGR_THRSHLD_FILE_USAGE_FOR_FILE 			60
+
+#define CsmgrdC_Ingest_Chunk_Num 					4		/* Chunks of the cob buffer 		*/
+#define CsmgrdC_Ingest_Wait 						100		/* Wait of the process thread (ms)	*/
+#define CsmgrdC_Ingest_Retry_Wait 					1000	/* Wait for the plugin (us)			*/
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** Chunk of the cob buffer passed from the main thread to the process thread 	*****/
+typedef struct {
+	unsigned char* 		buff;
+	int 				len;
+} CsmgrdT_Ingest_Chunk;
+
 
 /****************************************************************************************
  State Variables
@@ -115,16 +126,20 @@ static char 				csmgr_conf_dir[PATH_MAX] = {"/usr/local/cefore"};
 static char 				root_user_name[CefC_Csmgr_User_Len] = {"root"};
 static char 				csmgr_local_sock_name[PATH_MAX] = {0};
 
-static pthread_mutex_t 		csmgr_comn_buff_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t 		csmgr_main_cob_buff_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t		csmgr_comn_buff_cond = PTHREAD_COND_INITIALIZER;
-
-static unsigned char* 		csmgr_main_cob_buff 		= NULL;
-static int 					csmgr_main_cob_buff_idx 	= 0;
-static unsigned char* 		csmgr_comn_cob_buff 		= NULL;
-static int 					csmgr_comn_cob_buff_idx 	= 0;
-static unsigned char* 		csmgr_proc_cob_buff 		= NULL;
-static int 					csmgr_proc_cob_buff_idx 	= 0;
+static pthread_mutex_t 		csmgr_ingest_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t		csmgr_ingest_cond = PTHREAD_COND_INITIALIZER;
+
+/* The main thread fills a chunk and passes it to the process thread which returns 	*/
+/* it after the plugin took the cobs. Each queue has one producer and one consumer. */
+static CsmgrdT_Ingest_Chunk	csmgr_ingest_chunks[CsmgrdC_Ingest_Chunk_Num];
+static CefT_Rngque* 		csmgr_ingest_full_que 		= NULL;
+static CefT_Rngque* 		csmgr_ingest_free_que 		= NULL;
+static CsmgrdT_Ingest_Chunk* csmgr_ingest_cur 			= NULL;
+static uint64_t				csmgr_ingest_time 			= 0;
+static int 					csmgr_ingest_blocked_f 		= 0;
+static uint64_t				csmgr_ingest_num 			= 0;
+static uint64_t				csmgr_ingest_drop 			= 0;
+static uint64_t				csmgr_ingest_block 			= 0;
 static uint64_t				csmgr_wait_time 			= 2000000;
 static CsmgrT_Stat_Handle 	stat_hdl = CsmgrC_Invalid;
 
@@ -527,13 +542,6 @@ static void*
 csmgrd_expire_check_thread (
 	void* arg
 );
-/*--------------------------------------------------------------------------------------
-	function for processing buffering messages
-----------------------------------------------------------------------------------------*/
-static void*
-push_bytes_process_thread (
-	void* arg
-);
 /*--------------------------------------------------------------------------------------
 	Get frame from received message
 ----------------------------------------------------------------------------------------*/
@@ -545,12 +553,27 @@ csmgr_input_bytes_process (
 	int buff_len							/* message length							*/
 );
 /*--------------------------------------------------------------------------------------
-	Push the buffered messages to proc thread buffer
+	Copies the cob to the chunk of the cob buffer
+----------------------------------------------------------------------------------------*/
+static int										/* 1 if copied, 0 if no chunk is free	*/
+csmgrd_ingest_put (
+	unsigned char* msg,							/* Upload Request message				*/
+	int msg_len									/* length of message					*/
+);
+/*--------------------------------------------------------------------------------------
+	Passes the chunk being filled to the process thread
 ----------------------------------------------------------------------------------------*/
 static void
-csmgr_push_bytes_process (
+csmgrd_ingest_publish (
 	void
 );
+/*--------------------------------------------------------------------------------------
+	Handles the messages kept in the receive buffers after a chunk is released
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_ingest_resume (
+	CefT_Csmgrd_Handle* hdl						/* csmgr daemon handle					*/
+);
 
 /***** 0.8.3c S *****/
 #ifdef	CefC_DB_INDEX
@@ -885,32 +908,26 @@ csmgrd_handle_create (
 	}
 	cef_log_write (CefC_Log_Info, "Loading %s ... OK\n", CefC_Csmgrd_Conf_Name);
 
-	csmgr_main_cob_buff =
-		(unsigned char*) malloc (sizeof (unsigned char) * CsmgrC_Buff_Size);
-	if (csmgr_main_cob_buff == NULL) {
+	csmgr_ingest_full_que =
+		cef_rngque_create_with_mode (CsmgrdC_Ingest_Chunk_Num, CefC_Rngque_Mode_Spsc);
+	csmgr_ingest_free_que =
+		cef_rngque_create_with_mode (CsmgrdC_Ingest_Chunk_Num, CefC_Rngque_Mode_Spsc);
+	if ((csmgr_ingest_full_que == NULL) || (csmgr_ingest_free_que == NULL)) {
 		cef_log_write (CefC_Log_Error, "Failed to allocation cob buffer\n");
 		csmgrd_handle_destroy (&hdl);
 		return (NULL);
 	}
-	csmgr_main_cob_buff_idx = 0;
-
-	csmgr_comn_cob_buff =
-		(unsigned char*) malloc (sizeof (unsigned char) * CsmgrC_Buff_Size);
-	if (csmgr_comn_cob_buff == NULL) {
-		cef_log_write (CefC_Log_Error, "Failed to allocation common cob buffer\n");
-		csmgrd_handle_destroy (&hdl);
-		return (NULL);
-	}
-	csmgr_comn_cob_buff_idx = 0;
-
-	csmgr_proc_cob_buff =
-		(unsigned char*) malloc (sizeof (unsigned char) * CsmgrC_Buff_Max);
-	if (csmgr_proc_cob_buff == NULL) {
-		cef_log_write (CefC_Log_Error, "Failed to allocation process cob buffer\n");
-		csmgrd_handle_destroy (&hdl);
-		return (NULL);
+	for (i = 0 ; i < CsmgrdC_Ingest_Chunk_Num ; i++) {
+		csmgr_ingest_chunks[i].buff =
+			(unsigned char*) malloc (sizeof (unsigned char) * CsmgrC_Buff_Size);
+		if (csmgr_ingest_chunks[i].buff == NULL) {
+			cef_log_write (CefC_Log_Error, "Failed to allocation cob buffer\n");
+			csmgrd_handle_destroy (&hdl);
+			return (NULL);
+		}
+		csmgr_ingest_chunks[i].len = 0;
+		cef_rngque_push (csmgr_ingest_free_que, &csmgr_ingest_chunks[i]);
 	}
-	csmgr_proc_cob_buff_idx = 0;
 
 #ifdef CefC_Debug
 	/* Show config value */
@@ -949,7 +966,6 @@ csmgrd_event_dispatch (
 
 	pthread_t		csmgrd_msg_process_th;
 	pthread_t		csmgrd_expire_check_th;
-	pthread_t		push_bytes_process_th;
 	pthread_t		csmgrd_resource_mon_th;
 	void*			status;
 
@@ -982,11 +998,6 @@ csmgrd_event_dispatch (
 		csmgrd_running_f = 0;
 	}
 
-		if (pthread_create (&push_bytes_process_th, NULL, push_bytes_process_thread, hdl) == -1) {
-		cef_log_write (CefC_Log_Error,
-						"Failed to create the new thread(push_bytes_process_thread)\n");
-		csmgrd_running_f = 0;
-	}
 	if (pthread_create (&csmgrd_resource_mon_th, NULL, csmgrd_resource_mon_thread, hdl) == -1) {
 		cef_log_write (CefC_Log_Error,
 						"Failed to create the new thread\n");
@@ -1002,6 +1013,17 @@ csmgrd_event_dispatch (
 		/* Checks socket accept 			*/
 		csmgrd_tcp_connect_accept (hdl);
 
+		/* Handles the cobs kept while no chunk was free 	*/
+		if (csmgr_ingest_blocked_f) {
+			csmgrd_ingest_resume (hdl);
+		}
+
+		/* Passes the cobs to the process thread if they waited too long 	*/
+		if ((csmgr_ingest_cur != NULL) &&
+			(cef_client_present_timeus_calc () - csmgr_ingest_time > csmgr_wait_time)) {
+			csmgrd_ingest_publish ();
+		}
+
 		/* Sets fds to be polled 			*/
 		fdnum = csmgrd_poll_socket_prepare (hdl, fds, fds_index);
 		res = poll (fds, fdnum, 1);
@@ -1013,7 +1035,8 @@ csmgrd_event_dispatch (
 			continue;
 		}
 		if (res == 0) {
-			/* poll time out */
+			/* poll time out, so nothing follows the cobs in the chunk for now */
+			csmgrd_ingest_publish ();
 			continue;
 		}
 
@@ -1123,11 +1146,12 @@ csmgrd_event_dispatch (
 			}
 		}
 	}
-	pthread_cond_signal (&csmgr_comn_buff_cond);		/* To avoid deadlock */
+	pthread_mutex_lock (&csmgr_ingest_mutex);
+	pthread_cond_signal (&csmgr_ingest_cond);		/* To avoid deadlock */
+	pthread_mutex_unlock (&csmgr_ingest_mutex);
 	pthread_join (csmgrd_msg_process_th, &status);
 	pthread_join (csmgrd_expire_check_th, &status);
-	pthread_join (push_bytes_process_th, &status);
-	pthread_cond_destroy (&csmgr_comn_buff_cond);
+	pthread_cond_destroy (&csmgr_ingest_cond);
 
 	/* post process */
 	csmgrd_post_process (hdl);
@@ -1146,30 +1170,46 @@ csmgrd_msg_process_thread (
 	void* arg
 ) {
 	CefT_Csmgrd_Handle* hdl = (CefT_Csmgrd_Handle*) arg;
+	CsmgrdT_Ingest_Chunk* chunk;
+	struct timespec ts;
+	int index;
+	int res;
 
 	while (csmgrd_running_f) {
-		pthread_mutex_lock (&csmgr_comn_buff_mutex);
-		pthread_cond_wait (&csmgr_comn_buff_cond, &csmgr_comn_buff_mutex);
-
-		if (csmgr_comn_cob_buff_idx > 0) {
-			if (CsmgrC_Buff_Max - csmgr_proc_cob_buff_idx >
-				csmgr_comn_cob_buff_idx) {
-
-				memcpy (
-					&csmgr_proc_cob_buff[csmgr_proc_cob_buff_idx],
-					&csmgr_comn_cob_buff[0],
-					csmgr_comn_cob_buff_idx);
-				csmgr_proc_cob_buff_idx += csmgr_comn_cob_buff_idx;
+		chunk = (CsmgrdT_Ingest_Chunk*) cef_rngque_pop (csmgr_ingest_full_que);
+
+		if (chunk == NULL) {
+			clock_gettime (CLOCK_REALTIME, &ts);
+			ts.tv_nsec += CsmgrdC_Ingest_Wait * 1000000;
+			if (ts.tv_nsec >= 1000000000) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
 			}
-			csmgr_comn_cob_buff_idx = 0;
+			pthread_mutex_lock (&csmgr_ingest_mutex);
+			if ((csmgrd_running_f) &&
+				(cef_rngque_read (csmgr_ingest_full_que) == NULL)) {
+				pthread_cond_timedwait (&csmgr_ingest_cond, &csmgr_ingest_mutex, &ts);
+			}
+			pthread_mutex_unlock (&csmgr_ingest_mutex);
+			continue;
 		}
-		pthread_mutex_unlock (&csmgr_comn_buff_mutex);
 
-		if (csmgr_proc_cob_buff_idx > 0) {
-			hdl->cs_mod_int->cache_item_puts (
-							csmgr_proc_cob_buff, csmgr_proc_cob_buff_idx);
-			csmgr_proc_cob_buff_idx = 0;
+		/* The plugin reads the cobs from the chunk. It takes only what fits 	*/
+		/* in its buffers, so the rest is passed again after its writer ran. 	*/
+		index = 0;
+		while ((csmgrd_running_f) && (index < chunk->len)) {
+			res = hdl->cs_mod_int->cache_item_puts (
+							&chunk->buff[index], chunk->len - index);
+			if (res < 0) {
+				break;
+			}
+			index += res;
+			if (index < chunk->len) {
+				usleep (CsmgrdC_Ingest_Retry_Wait);
+			}
 		}
+		chunk->len = 0;
+		cef_rngque_push (csmgr_ingest_free_que, chunk);
 	}
 
 	pthread_exit (NULL);
@@ -1207,23 +1247,6 @@ csmgrd_expire_check_thread (
 
 	return ((void*) NULL);
 }
-/*--------------------------------------------------------------------------------------
-	function for processing buffering messages
-----------------------------------------------------------------------------------------*/
-static void*
-push_bytes_process_thread (
-	void* arg
-) {
-
-	while (csmgrd_running_f) {
-		usleep (csmgr_wait_time);
-		csmgr_push_bytes_process ();
-	}
-
-	pthread_exit (NULL);
-
-	return ((void*) NULL);
-}
 /*--------------------------------------------------------------------------------------
 	Get frame from received message
 ----------------------------------------------------------------------------------------*/
@@ -1287,40 +1310,31 @@ csmgr_input_bytes_process (
 			cstat = cef_csmgr_frame_check (&buff[index], len);
 			if (cstat < 0) {
 //@@@@@fprintf(stderr, "[%s]: [------ goto SKIP; [cstat < 0] -----\n", __FUNCTION__);
+				csmgr_ingest_drop++;
 				goto SKIP;
 			}
 			pthread_mutex_lock (&csmgr_Lack_of_resources_mutex);
 			if (Lack_of_F_resources == 1) {
 				pthread_mutex_unlock (&csmgr_Lack_of_resources_mutex);
+				csmgr_ingest_drop++;
 				goto SKIP;
 			}
 			if (Lack_of_M_resources == 1) {
 				pthread_mutex_unlock (&csmgr_Lack_of_resources_mutex);
+				csmgr_ingest_drop++;
 				goto SKIP;
 			}
 			pthread_mutex_unlock (&csmgr_Lack_of_resources_mutex);
-			if (pthread_mutex_trylock (&csmgr_main_cob_buff_mutex) != 0) {
-				goto SKIP;
-			}
-			if (csmgr_main_cob_buff_idx + len > CsmgrC_Buff_Size) {
-				pthread_mutex_lock (&csmgr_comn_buff_mutex);
-
-				memcpy (
-					csmgr_comn_cob_buff,
-					csmgr_main_cob_buff,
-					csmgr_main_cob_buff_idx);
-				csmgr_comn_cob_buff_idx = csmgr_main_cob_buff_idx;
-				csmgr_main_cob_buff_idx = 0;
-
-				pthread_cond_signal (&csmgr_comn_buff_cond);
-				pthread_mutex_unlock (&csmgr_comn_buff_mutex);
+			if (csmgrd_ingest_put (&buff[index], len) == 0) {
+				/* Keeps the rest in the receive buffer and stops reading this 	*/
+				/* socket until a chunk is released, so cefnetd has to wait 	*/
+				if (csmgr_ingest_blocked_f == 0) {
+					csmgr_ingest_blocked_f = 1;
+					csmgr_ingest_block++;
+				}
+				break;
 			}
-			memcpy (
-				&csmgr_main_cob_buff[csmgr_main_cob_buff_idx],
-				&buff[index], len);
-
-			csmgr_main_cob_buff_idx += len;
-			pthread_mutex_unlock (&csmgr_main_cob_buff_mutex);
+			csmgr_ingest_num++;
 		}
 
 SKIP:;
@@ -1334,32 +1348,77 @@ SKIP:;
 	return (buff_len);
 }
 /*--------------------------------------------------------------------------------------
-	Push the buffered messages to proc thread buffer
+	Copies the cob to the chunk of the cob buffer
+----------------------------------------------------------------------------------------*/
+static int										/* 1 if copied, 0 if no chunk is free	*/
+csmgrd_ingest_put (
+	unsigned char* msg,							/* Upload Request message				*/
+	int msg_len									/* length of message					*/
+) {
+	if ((csmgr_ingest_cur != NULL) &&
+		(csmgr_ingest_cur->len + msg_len > CsmgrC_Buff_Size)) {
+		csmgrd_ingest_publish ();
+	}
+	if (csmgr_ingest_cur == NULL) {
+		csmgr_ingest_cur =
+			(CsmgrdT_Ingest_Chunk*) cef_rngque_pop (csmgr_ingest_free_que);
+		if (csmgr_ingest_cur == NULL) {
+			return (0);
+		}
+		csmgr_ingest_time = cef_client_present_timeus_calc ();
+	}
+	memcpy (&csmgr_ingest_cur->buff[csmgr_ingest_cur->len], msg, msg_len);
+	csmgr_ingest_cur->len += msg_len;
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Passes the chunk being filled to the process thread
 ----------------------------------------------------------------------------------------*/
 static void
-csmgr_push_bytes_process (
+csmgrd_ingest_publish (
 	void
 ) {
-	pthread_mutex_lock (&csmgr_main_cob_buff_mutex);
+	if (csmgr_ingest_cur == NULL) {
+		return;
+	}
+	/* The full queue has a slot for every chunk, so this never fails 	*/
+	cef_rngque_push (csmgr_ingest_full_que, csmgr_ingest_cur);
+	csmgr_ingest_cur = NULL;
 
-	if (csmgr_main_cob_buff_idx > 0) {
+	pthread_mutex_lock (&csmgr_ingest_mutex);
+	pthread_cond_signal (&csmgr_ingest_cond);
+	pthread_mutex_unlock (&csmgr_ingest_mutex);
 
-		pthread_mutex_lock (&csmgr_comn_buff_mutex);
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Handles the messages kept in the receive buffers after a chunk is released
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_ingest_resume (
+	CefT_Csmgrd_Handle* hdl						/* csmgr daemon handle					*/
+) {
+	int fd;
+	int len;
+	int i;
 
-		if (csmgr_main_cob_buff_idx  > 0) {
-			memcpy (
-				csmgr_comn_cob_buff,
-				csmgr_main_cob_buff,
-				csmgr_main_cob_buff_idx);
+	if (cef_rngque_read (csmgr_ingest_free_que) == NULL) {
+		return;
+	}
+	csmgr_ingest_blocked_f = 0;
 
-			csmgr_comn_cob_buff_idx = csmgr_main_cob_buff_idx;
-			csmgr_main_cob_buff_idx = 0;
+	for (i = 0 ; i < CsmgrdC_Max_Sock_Num ; i++) {
+		if (hdl->tcp_index[i] == 0) {
+			continue;
 		}
-
-		pthread_cond_signal (&csmgr_comn_buff_cond);
-		pthread_mutex_unlock (&csmgr_comn_buff_mutex);
+		fd = (i == 0) ? hdl->local_peer_sock : hdl->tcp_fds[i];
+		if (fd == -1) {
+			continue;
+		}
+		len = csmgr_input_bytes_process (hdl, fd, &hdl->tcp_buff[i][0], hdl->tcp_index[i]);
+		hdl->tcp_index[i] = (len > 0) ? len : 0;
 	}
-	pthread_mutex_unlock (&csmgr_main_cob_buff_mutex);
 
 	return;
 }
@@ -1562,12 +1621,21 @@ csmgrd_handle_destroy (
 	if (strlen (csmgr_local_sock_name) != 0) {
 		unlink (csmgr_local_sock_name);
 	}
-	if (csmgr_main_cob_buff) {
-		free (csmgr_main_cob_buff);
+	for (i = 0 ; i < CsmgrdC_Ingest_Chunk_Num ; i++) {
+		if (csmgr_ingest_chunks[i].buff) {
+			free (csmgr_ingest_chunks[i].buff);
+			csmgr_ingest_chunks[i].buff = NULL;
+		}
+	}
+	if (csmgr_ingest_full_que) {
+		cef_rngque_destroy (csmgr_ingest_full_que);
+		csmgr_ingest_full_que = NULL;
 	}
-	if (csmgr_comn_cob_buff) {
-		free (csmgr_comn_cob_buff);
+	if (csmgr_ingest_free_que) {
+		cef_rngque_destroy (csmgr_ingest_free_que);
+		csmgr_ingest_free_que = NULL;
 	}
+	csmgr_ingest_cur = NULL;
 	free (hdl);
 	*csmgrd_hdl = NULL;
 
@@ -2117,9 +2185,13 @@ csmgrd_poll_socket_prepare (
 	int set_num = 0;
 	int i;
 
+	/* The sockets which have the cobs waiting for a chunk are not read 	*/
 	if (hdl->local_peer_sock != -1) {
 		fds[set_num].fd     = hdl->local_peer_sock;
 		fds[set_num].events = POLLIN | POLLERR;
+		if (csmgr_ingest_blocked_f && (hdl->tcp_index[0] > 0)) {
+			fds[set_num].events = POLLERR;
+		}
 		fds_index[set_num]  = 0;
 		set_num++;
 	}
@@ -2128,6 +2200,9 @@ csmgrd_poll_socket_prepare (
 		if (hdl->tcp_fds[i] != -1) {
 			fds[set_num].fd     = hdl->tcp_fds[i];
 			fds[set_num].events = POLLIN | POLLERR;
+			if (csmgr_ingest_blocked_f && (hdl->tcp_index[i] > 0)) {
+				fds[set_num].events = POLLERR;
+			}
 			fds_index[set_num]  = i;
 			set_num++;
 		}
@@ -2530,6 +2605,9 @@ csmgrd_incoming_status_msg (
 SKIP_RESPONSE:;
 	stat_hdr.node_num = htons ((uint16_t) hdl->peer_num);
 	stat_hdr.con_num  = htonl (con_num);
+	stat_hdr.ingest_num 	= cef_client_htonb (csmgr_ingest_num);
+	stat_hdr.ingest_drop 	= cef_client_htonb (csmgr_ingest_drop);
+	stat_hdr.ingest_block 	= cef_client_htonb (csmgr_ingest_block);
 	memcpy (&wbuf[CefC_Csmgr_Msg_HeaderLen+2/* To extend length from 2 bytes to 4 bytes */], &stat_hdr, sizeof (struct CefT_Csmgr_Status_Hdr));
 
 	value32 = htonl (index);
@@ -2737,6 +2815,9 @@ SKIP_RESPONSE:;
 SKIP_RESPONSE:;
 	stat_hdr.node_num = htons ((uint16_t) hdl->peer_num);
 	stat_hdr.con_num  = htonl (con_num);
+	stat_hdr.ingest_num 	= cef_client_htonb (csmgr_ingest_num);
+	stat_hdr.ingest_drop 	= cef_client_htonb (csmgr_ingest_drop);
+	stat_hdr.ingest_block 	= cef_client_htonb (csmgr_ingest_block);
 	memcpy (&wbuf[CefC_Csmgr_Msg_HeaderLen+2/* To extend length from 2 bytes to 4 bytes */], &stat_hdr, sizeof (struct CefT_Csmgr_Status_Hdr));
 
 	value32 = htonl (index);
@@ -95,7 +95,8 @@ typedef struct CsmgrdT_Plugin_Interface {
 	/* Get Cob Entry */
 	int (*cache_item_get)(unsigned char*, uint16_t, uint32_t, int, unsigned char*, uint16_t);
 
-	/* Put contents */
+	/* Put contents. Returns the length of the bytes taken, csmgrd passes the	*/
+	/* rest again later. The buffer is valid only while the function runs. 		*/
 	int (*cache_item_puts)(unsigned char*, int);
 
 	/* Increment access count */
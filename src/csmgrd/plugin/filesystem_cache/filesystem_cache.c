@@ -118,6 +118,10 @@ static int 						fsc_proc_cob_buff_idx[FscC_Max_Buff] 	= {0};
 static CsmgrT_Stat_Handle 		csmgr_stat_hdl;
 static pthread_mutex_t 			fsc_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* The page blocks which are mapped to read the cobs. They are guarded by fsc_cs_mutex	*/
+static FscT_Page_Map 			fsc_page_maps[FscC_Page_Map_Num];
+static uint64_t 				fsc_page_map_tick = 0;
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
@@ -159,7 +163,7 @@ fsc_cache_item_get (
 /*--------------------------------------------------------------------------------------
 	Upload content byte steream
 ----------------------------------------------------------------------------------------*/
-static int							/* The return value is negative if an error occurs	*/
+static int							/* length of the bytes taken, negative if an error	*/
 fsc_cache_item_puts (
 	unsigned char* msg, 
 	int msg_len
@@ -288,6 +292,39 @@ static int							/* The return value is negative if an error occurs	*/
 fsc_recursive_dir_clear (
 	char* filepath								/* file path							*/
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the mapped page block, maps it in place of the least recently used one
+----------------------------------------------------------------------------------------*/
+static FscT_Page_Map*				/* NULL if the block can not be mapped				*/
+fsc_page_map_get (
+	const char* file_path,						/* page file path						*/
+	int block_index,							/* index of the block in the file		*/
+	int rcdsize									/* size of a record						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the record in the mapped page block
+----------------------------------------------------------------------------------------*/
+static unsigned char*				/* NULL if the record is not written in the file	*/
+fsc_page_map_record (
+	FscT_Page_Map* pm,							/* mapped page block					*/
+	int pos_index								/* index of the record in the block		*/
+);
+/*--------------------------------------------------------------------------------------
+	Asks the kernel to read the records which will be sent ahead
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_prefetch (
+	FscT_Page_Map* pm,							/* mapped page block					*/
+	int pos_index,								/* index of the first record			*/
+	int rcd_num									/* number of the records				*/
+);
+/*--------------------------------------------------------------------------------------
+	Unmaps the page blocks of the file
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_purge (
+	const char* file_path						/* page file path. NULL means all		*/
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -625,6 +662,7 @@ fsc_cs_destroy (
 		return;
 	}
 	
+	fsc_page_map_purge (NULL);
 	if (hdl->fsc_cache_path[0] != 0x00) {
 		fsc_recursive_dir_clear (hdl->fsc_cache_path);
 	}
@@ -742,13 +780,11 @@ fsc_cache_item_get (
 	uint64_t 	mask;
 	uint32_t 	x;
 	char		file_path[PATH_MAX];
-	static char	red_file_path[PATH_MAX] = {0};
 	int 		cob_block_index;
-	static int  red_cob_block_index = -1;
-	int			rtc;
 	int 		page_index;
 	int 		pos_index;
-	FILE*		fp = NULL;
+	FscT_Page_Map*	pm;
+	unsigned char*	rec;
 	int 		i;
 	int 		tx_cnt = 0;
 	int			resend_1cob_f = 0;
@@ -757,12 +793,8 @@ fsc_cache_item_get (
 	int 			trg_key_len;
 	uint64_t nowt;
 	struct timeval tv;
-	static unsigned char*	page_cob_buf = NULL;
 	int				rcdsize;
 	int			rc = CefC_CV_Inconsistent;
-	int			update_ver = 1;
-	static uint16_t red_ver_len = 0;
-	static unsigned char red_version[PATH_MAX] = {0};
 	
 #ifdef __FSCACHE_VERSION__
 	fprintf (stderr, "--- fsc_cache_item_get()\n");
@@ -869,74 +901,39 @@ fsc_cache_item_get (
 		rcd->tx_time = nowt + FscC_Sent_Reset_Time;
 	}
 	
-	/* Open the file that specified cob is cached 		*/
+	/* Maps the block of the file that specified cob is cached 		*/
 	cob_block_index = (int)(seqno / FscC_Page_Cob_Num) % FscC_File_Page_Num;
 	page_index = (int)(seqno / FscC_Page_Cob_Num/FscC_File_Page_Num);
 	sprintf (file_path, "%s/%d/%d", hdl->fsc_cache_path, (int) rcd->index, page_index);
 	
-	if (ver_len) {
-		if (red_ver_len == ver_len &&
-			memcmp (version, red_version, red_ver_len) == 0) {
-			update_ver = 0;
-		}
-	} else {
-		update_ver = 0;
-	}
-	
-	if (strcmp (red_file_path, file_path) != 0 || cob_block_index != red_cob_block_index ||
-		(strcmp (red_file_path, file_path) == 0 && update_ver != 0)) {
-		if (page_cob_buf != NULL) {
-			free (page_cob_buf);
-			page_cob_buf = NULL;
-		}
-
-		fp = fopen (file_path, "rb");
-		if (fp == NULL) {
-			csmgrd_log_write (CefC_Log_Error, "Failed to open the cache file (%s)\n", file_path);
-			goto ItemGetPost;
-		}
-		strcpy (red_file_path, file_path);
-		red_cob_block_index = cob_block_index;
-		page_cob_buf = calloc (FscC_Page_Cob_Num, rcdsize);
-		fseek (fp, (int64_t)cob_block_index * (int64_t)rcdsize * FscC_Page_Cob_Num, SEEK_SET);
-		for (int i=0; i<FscC_Page_Cob_Num; i++) {
-			rtc = fread (&page_cob_buf[i*rcdsize], rcdsize, 1, fp);
-			if (rtc != 1) {
-				break;
-			}
-		}
-		if (red_ver_len) {
-			memset (red_version, 0, PATH_MAX);
-		}
-		red_ver_len = ver_len;
-		if (ver_len) {
-			memcpy (red_version, version, ver_len);
-		}
-	} else {
-		fp = NULL;
+	/* The block stays mapped while it is used, and the cobs are sent from the	*/
+	/* mapping. Page files are unmapped before they are deleted, so a new		*/
+	/* version which is written to the same path is never read from a stale map	*/
+	pm = fsc_page_map_get (file_path, cob_block_index, rcdsize);
+	if (pm == NULL) {
+		goto ItemGetPost;
 	}
 	
 	/* Send the cobs 		*/
 	pos_index = (int)(seqno % FscC_Page_Cob_Num);
-#ifdef CefC_Debug
-	{
-		uint16_t mlen;
-		memcpy (&mlen, &page_cob_buf[pos_index*rcdsize], sizeof (uint16_t));
-		csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
+	rec = fsc_page_map_record (pm, pos_index);
+	if (rec == NULL) {
+		goto ItemGetPost;
 	}
+	if (send_cob_f == 1) {
+		fsc_page_map_prefetch (pm, pos_index, FscC_Tx_Cob_Num);
+	}
+	uint16_t mlen;
+	memcpy (&mlen, rec, sizeof (uint16_t));
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
 #endif // CefC_Debug
 	csmgrd_stat_access_count_update (
 			csmgr_stat_hdl, key, key_size);
 	
 	/* Send Cob to cefnetd */
-	uint16_t mlen;
-	memcpy (&mlen, &page_cob_buf[pos_index*rcdsize], sizeof (uint16_t));
-	csmgrd_plugin_cob_msg_send (
-						sock, &page_cob_buf[pos_index*rcdsize+sizeof (uint16_t)], mlen);
+	csmgrd_plugin_cob_msg_send (sock, rec + sizeof (uint16_t), mlen);
 	if (resend_1cob_f == 1) {
-		if (fp != NULL) {
-			fclose (fp);
-		}
 		pthread_mutex_unlock (&fsc_cs_mutex);
 		return (CefC_Csmgr_Cob_Exist);
 	}
@@ -953,18 +950,16 @@ fsc_cache_item_get (
 				seqno++;
 				continue;
 			}
-#ifdef CefC_Debug
-			{
-				uint16_t mlen;
-				memcpy (&mlen, &page_cob_buf[i*rcdsize], sizeof (uint16_t));
-				csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
+			rec = fsc_page_map_record (pm, i);
+			if (rec == NULL) {
+				break;
 			}
+			memcpy (&mlen, rec, sizeof (uint16_t));
+#ifdef CefC_Debug
+			csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
 #endif // CefC_Debug
-			uint16_t mlen;
-			memcpy (&mlen, &page_cob_buf[i*rcdsize], sizeof (uint16_t));
 			if (mlen != 0) {
-				csmgrd_plugin_cob_msg_send (
-					sock, &page_cob_buf[i*rcdsize+sizeof (uint16_t)], mlen);
+				csmgrd_plugin_cob_msg_send (sock, rec + sizeof (uint16_t), mlen);
 			}
 			tx_cnt++;
 			seqno++;
@@ -974,21 +969,17 @@ fsc_cache_item_get (
 	}
 	
 ItemGetPost:
-	if (fp != NULL) {
-		fclose (fp);
-	}
 	pthread_mutex_unlock (&fsc_cs_mutex);
 	return (CefC_Csmgr_Cob_Exist);
 }
 /*--------------------------------------------------------------------------------------
 	Upload content byte steream
 ----------------------------------------------------------------------------------------*/
-static int							/* The return value is negative if an error occurs	*/
+static int							/* length of the bytes taken, negative if an error	*/
 fsc_cache_item_puts (
 	unsigned char* msg, 
 	int msg_len
 ) {
-	CsmgrdT_Content_Entry entry;
 	int i;
 	int res;
 	int index = 0;
@@ -1022,15 +1013,15 @@ fsc_cache_item_puts (
 				, msg_len - index, i);
 #endif // CefC_Debug
 			while (index < msg_len) {
-				res = cef_csmgr_con_entry_create (&msg[index], msg_len - index, &entry);
-				
+				/* Parses the cob into the buffer of the writer thread directly 	*/
+				res = cef_csmgr_con_entry_create (&msg[index], msg_len - index,
+						&fsc_proc_cob_buff[i][fsc_proc_cob_buff_idx[i]]);
+
 				if (res < 0) {
+					/* The rest can not be parsed, so it is discarded 	*/
+					index = msg_len;
 					break;
 				}
-				memcpy (
-					&fsc_proc_cob_buff[i][fsc_proc_cob_buff_idx[i]], 
-					&entry, 
-					sizeof (CsmgrdT_Content_Entry));
 				
 				fsc_proc_cob_buff_idx[i] += 1;
 				index += res;
@@ -1056,11 +1047,11 @@ fsc_cache_item_puts (
 #ifdef CefC_Debug
 	if (i == FscC_Max_Buff) {
 		csmgrd_dbg_write (CefC_Dbg_Fine, 
-			"cob rcv thread lost %d bytes\n", msg_len - index);
+			"cob rcv thread defers %d bytes\n", msg_len - index);
 	}
 #endif // CefC_Debug
 
-	return (0);
+	return (index);
 }
 /*--------------------------------------------------------------------------------------
 	writes the cobs to filesystem cache
@@ -1864,6 +1855,7 @@ fsc_is_file_delete (
 		return (0);
 	}
 
+	fsc_page_map_purge (filepath);
 	rc = unlink (filepath);
 	if (rc < 0) {
 		csmgrd_log_write (CefC_Log_Critical,
@@ -1936,3 +1928,157 @@ fsc_recursive_dir_clear (
 
 	return (0);
 }
+/*--------------------------------------------------------------------------------------
+	Obtains the mapped page block, maps it in place of the least recently used one
+----------------------------------------------------------------------------------------*/
+static FscT_Page_Map*				/* NULL if the block can not be mapped				*/
+fsc_page_map_get (
+	const char* file_path,						/* page file path						*/
+	int block_index,							/* index of the block in the file		*/
+	int rcdsize									/* size of a record						*/
+) {
+	static long page_size = 0;
+	FscT_Page_Map* pm = NULL;
+	struct stat st;
+	uint64_t map_off;
+	int fd;
+	int i;
+	
+	fsc_page_map_tick++;
+	
+	/* Looks up the mapped block and the least recently used slot 	*/
+	for (i = 0 ; i < FscC_Page_Map_Num ; i++) {
+		if (fsc_page_maps[i].map_addr == NULL) {
+			if ((pm == NULL) || (pm->map_addr != NULL)) {
+				pm = &fsc_page_maps[i];
+			}
+			continue;
+		}
+		if ((fsc_page_maps[i].block_index == block_index) &&
+			(fsc_page_maps[i].rcdsize == rcdsize) &&
+			(strcmp (fsc_page_maps[i].path, file_path) == 0)) {
+			fsc_page_maps[i].used = fsc_page_map_tick;
+			return (&fsc_page_maps[i]);
+		}
+		if ((pm == NULL) ||
+			((pm->map_addr != NULL) && (fsc_page_maps[i].used < pm->used))) {
+			pm = &fsc_page_maps[i];
+		}
+	}
+	
+	/* Evicts the least recently used block 		*/
+	if (pm->map_addr != NULL) {
+		munmap (pm->map_addr, pm->map_len);
+		close (pm->fd);
+		pm->map_addr = NULL;
+	}
+	
+	fd = open (file_path, O_RDONLY);
+	if (fd < 0) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to open the cache file (%s)\n", file_path);
+		return (NULL);
+	}
+	if (fstat (fd, &st) < 0) {
+		close (fd);
+		return (NULL);
+	}
+	if (page_size == 0) {
+		page_size = sysconf (_SC_PAGESIZE);
+	}
+	
+	/* Maps the whole block. The records beyond the end of file are not accessed	*/
+	/* until the file grows, see fsc_page_map_record.								*/
+	pm->block_off = (uint64_t) block_index * (uint64_t) rcdsize * FscC_Page_Cob_Num;
+	map_off = pm->block_off - (pm->block_off % (uint64_t) page_size);
+	pm->map_len = (size_t)(pm->block_off - map_off) + (size_t) rcdsize * FscC_Page_Cob_Num;
+	pm->map_addr = mmap (NULL, pm->map_len, PROT_READ, MAP_SHARED, fd, (off_t) map_off);
+	if (pm->map_addr == MAP_FAILED) {
+		csmgrd_log_write (CefC_Log_Error,
+			"Failed to map the cache file (%s): %s\n", file_path, strerror (errno));
+		pm->map_addr = NULL;
+		close (fd);
+		return (NULL);
+	}
+	madvise (pm->map_addr, pm->map_len, MADV_SEQUENTIAL);
+	
+	strcpy (pm->path, file_path);
+	pm->block_index = block_index;
+	pm->rcdsize 	= rcdsize;
+	pm->fd 			= fd;
+	pm->block 		= pm->map_addr + (pm->block_off - map_off);
+	pm->file_size 	= (uint64_t) st.st_size;
+	pm->used 		= fsc_page_map_tick;
+	
+	return (pm);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the record in the mapped page block
+----------------------------------------------------------------------------------------*/
+static unsigned char*				/* NULL if the record is not written in the file	*/
+fsc_page_map_record (
+	FscT_Page_Map* pm,							/* mapped page block					*/
+	int pos_index								/* index of the record in the block		*/
+) {
+	uint64_t rcd_end;
+	struct stat st;
+	
+	/* Touching the pages beyond the end of file raises SIGBUS, so the size is	*/
+	/* checked again when the writer thread may have extended the file			*/
+	rcd_end = pm->block_off + (uint64_t)(pos_index + 1) * (uint64_t) pm->rcdsize;
+	if (rcd_end > pm->file_size) {
+		if ((fstat (pm->fd, &st) < 0) || (rcd_end > (uint64_t) st.st_size)) {
+			return (NULL);
+		}
+		pm->file_size = (uint64_t) st.st_size;
+	}
+	
+	return (pm->block + (size_t) pos_index * (size_t) pm->rcdsize);
+}
+/*--------------------------------------------------------------------------------------
+	Asks the kernel to read the records which will be sent ahead
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_prefetch (
+	FscT_Page_Map* pm,							/* mapped page block					*/
+	int pos_index,								/* index of the first record			*/
+	int rcd_num									/* number of the records				*/
+) {
+	uintptr_t top;
+	uintptr_t end;
+	uintptr_t page_mask;
+	
+	/* Covers this burst and the next one which the consumer will ask soon 		*/
+	page_mask = (uintptr_t) sysconf (_SC_PAGESIZE) - 1;
+	top = (uintptr_t)(pm->block + (size_t) pos_index * (size_t) pm->rcdsize);
+	end = top + (size_t) rcd_num * 2 * (size_t) pm->rcdsize;
+	if (end > (uintptr_t)(pm->map_addr + pm->map_len)) {
+		end = (uintptr_t)(pm->map_addr + pm->map_len);
+	}
+	top &= ~page_mask;
+	if (end <= top) {
+		return;
+	}
+	madvise ((void*) top, (size_t)(end - top), MADV_WILLNEED);
+}
+/*--------------------------------------------------------------------------------------
+	Unmaps the page blocks of the file
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_purge (
+	const char* file_path						/* page file path. NULL means all		*/
+) {
+	int i;
+	
+	for (i = 0 ; i < FscC_Page_Map_Num ; i++) {
+		if (fsc_page_maps[i].map_addr == NULL) {
+			continue;
+		}
+		if ((file_path != NULL) &&
+			(strcmp (fsc_page_maps[i].path, file_path) != 0)) {
+			continue;
+		}
+		munmap (fsc_page_maps[i].map_addr, fsc_page_maps[i].map_len);
+		close (fsc_page_maps[i].fd);
+		fsc_page_maps[i].map_addr = NULL;
+	}
+}
@@ -51,6 +51,7 @@
  ****************************************************************************************/
 
 #define FscC_Max_Node_Inf_Num			1024			/* Max NodeInformation Num		*/
+#define FscC_Page_Map_Num				64				/* Max mapped page blocks		*/
 
 /*------------------------------------------------------------------
 	Limitation
@@ -82,6 +83,21 @@ typedef struct {
 	uint16_t		msg_len;					/* Message length						*/
 } FscT_File_Head_Element;
 
+typedef struct {
+	/********** Mapped page block of the page file ***********/
+	char			path[CefC_Csmgr_File_Path_Length];
+												/* Page file path						*/
+	int				block_index;				/* Index of the block in the file		*/
+	int				rcdsize;					/* Size of a record in the block		*/
+	int				fd;							/* Descriptor of the page file			*/
+	unsigned char*	map_addr;					/* Top of the mapped region				*/
+	size_t			map_len;					/* Length of the mapped region			*/
+	unsigned char*	block;						/* Top of the block in the region		*/
+	uint64_t		block_off;					/* Offset of the block in the file		*/
+	uint64_t		file_size;					/* File size which was seen last		*/
+	uint64_t		used;						/* Tick when the block was used last	*/
+} FscT_Page_Map;
+
 typedef struct {
 
 	/********** FileSystemCache Status ***********/
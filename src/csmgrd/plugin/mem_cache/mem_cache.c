@@ -85,6 +85,12 @@
 #define MemC_CID_KLen				(CefC_S_TLF+CefC_NWP_CID_Prefix_Len+MemC_CID_HexCh_size)
 
 #define MemC_SEMNAME					"/cefmemsem"
+#define MemC_Lock_Stripe_Num			64		/* Number of locks over the hash buckets	*/
+
+#define mem_hash_stripe_lock(y) \
+	pthread_mutex_lock (&mem_hash_stripe_mutex[(y) % MemC_Lock_Stripe_Num])
+#define mem_hash_stripe_unlock(y) \
+	pthread_mutex_unlock (&mem_hash_stripe_mutex[(y) % MemC_Lock_Stripe_Num])
 
 /****************************************************************************************
  Structures Declaration
@@ -105,6 +111,8 @@ typedef struct {
 	uint64_t		ins_time;					/* Insert time							*/
 	unsigned char*	version;					/* version								*/
 	uint16_t		ver_len;					/* Length of version					*/
+	int				refcnt;						/* Reference count. The hash table 		*/
+												/* holds one while the entry is cached	*/
 } CsmgrdT_Content_Mem_Entry;
 
 typedef struct CefT_Mem_Hash_Cell {
@@ -143,6 +151,7 @@ static pthread_t				mem_cache_delete_th;
 static int						delete_pipe_fd[2];
 
 static pthread_mutex_t 			mem_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t 			mem_hash_stripe_mutex[MemC_Lock_Stripe_Num];
 
 #ifdef CefC_Ccore
 static uint64_t 				ORG_cache_capacity = 0;
@@ -188,7 +197,7 @@ mem_cache_item_get (
 /*--------------------------------------------------------------------------------------
 	Upload content byte steream
 ----------------------------------------------------------------------------------------*/
-static int							/* The return value is negative if an error occurs	*/
+static int							/* length of the bytes taken, negative if an error	*/
 mem_cache_item_puts (
 	unsigned char* msg,
 	int msg_len
@@ -292,10 +301,22 @@ cef_mem_hash_tbl_item_get (
 	uint32_t klen
 );
 static CsmgrdT_Content_Mem_Entry*
+cef_mem_hash_tbl_item_ref (
+	const unsigned char* key,
+	uint32_t klen
+);
+static CsmgrdT_Content_Mem_Entry*
 cef_mem_hash_tbl_item_remove (
 	const unsigned char* key,
 	uint32_t klen
 );
+/*--------------------------------------------------------------------------------------
+	Releases the reference to the entry and frees it when the last one is released
+----------------------------------------------------------------------------------------*/
+static void
+mem_entry_release (
+	CsmgrdT_Content_Mem_Entry* entry
+);
 
 int
 csmgrd_key_create_by_Mem_Entry (
@@ -406,6 +427,9 @@ mem_cs_create (
 	}
 
 	/* Creates the memory cache 		*/
+	for (i = 0 ; i < MemC_Lock_Stripe_Num ; i++) {
+		pthread_mutex_init (&mem_hash_stripe_mutex[i], NULL);
+	}
 	mem_hash_tbl = cef_mem_hash_tbl_create (hdl->cache_capacity);
 	if (mem_hash_tbl ==  NULL) {
 		csmgrd_log_write (CefC_Log_Error, "Unable to create mem hash table\n");
@@ -560,6 +584,7 @@ mem_cs_store (
 	entry->ins_time		 = new_entry->ins_time;
 	entry->ver_len		 = new_entry->ver_len;
 	entry->version		 = new_entry->version;
+	entry->refcnt		 = 1;
 
 	if (cef_mem_hash_tbl_item_set (
 		key, key_len, entry, &old_entry) < 0) {
@@ -585,11 +610,7 @@ mem_cs_store (
 	}
 
 	if (old_entry) {
-		free (old_entry->msg);
-		free (old_entry->name);
-		if (old_entry->ver_len)
-			free (old_entry->version);
-		free (old_entry);
+		mem_entry_release (old_entry);
 	} else {
 		hdl->cache_cobs++;
 	}
@@ -613,9 +634,7 @@ mem_cs_remove (
 		csmgrd_stat_cob_remove (
 			csmgr_stat_hdl, entry->name, entry->name_len,
 			entry->chunk_num, entry->pay_len);
-		free (entry->msg);
-		free (entry->name);
-		free (entry);
+		mem_entry_release (entry);
 		hdl->cache_cobs--;
 	}
 
@@ -660,13 +679,17 @@ mem_cs_destroy (
 			cp = mem_hash_tbl->tbl[i];
 			while (cp != NULL) {
 				wcp = cp->next;
-				free (cp->elem);
+				mem_entry_release (cp->elem);
 				free (cp);
 				cp = wcp;
 			}
 		}
 		free (mem_hash_tbl->tbl);
 		free (mem_hash_tbl);
+		mem_hash_tbl = NULL;
+	}
+	for (i = 0 ; i < MemC_Lock_Stripe_Num ; i++) {
+		pthread_mutex_destroy (&mem_hash_stripe_mutex[i]);
 	}
 
 	if (hdl->algo_lib) {
@@ -729,9 +752,7 @@ mem_cs_expire_check (
 					csmgrd_stat_cob_remove (
 						csmgr_stat_hdl, entry->name, entry->name_len,
 						entry->chunk_num, entry->pay_len);
-					free (entry1->msg);
-					free (entry1->name);
-					free (entry1);
+					mem_entry_release (entry1);
 				}
 			}
 		}
@@ -769,8 +790,9 @@ mem_cache_item_get (
 	/* Creates the key 		*/
 	trg_key_len = csmgrd_name_chunknum_concatenate (key, key_size, seqno, trg_key);
 
-	/* Access the specified entry 	*/
-	entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+	/* Access the specified entry. The reference keeps the entry while the cob	*/
+	/* is sent without mem_cs_mutex, so a slow socket does not block the puts.	*/
+	entry = cef_mem_hash_tbl_item_ref (trg_key, trg_key_len);
 
 	if (entry) {
 
@@ -815,34 +837,40 @@ mem_cache_item_get (
 
 			csmgrd_stat_access_count_update (
 					csmgr_stat_hdl, entry->name, entry->name_len);
+			pthread_mutex_unlock (&mem_cs_mutex);
 
 			/* Send Cob to cefnetd */
 			csmgrd_plugin_cob_msg_send (sock, entry->msg, entry->msg_len);
 			exist_f = CefC_Csmgr_Cob_Exist;
-			pthread_mutex_unlock (&mem_cs_mutex);
  		}
 		else {
+			CsmgrdT_Content_Mem_Entry* rmv_entry;
+
 			pthread_mutex_lock (&mem_cs_mutex);
 			/* Removes the expiry cache entry 		*/
-			entry = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
+			rmv_entry = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
 
-			if (hdl->algo_apis.erase) {
-				(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
-			}
-			hdl->cache_cobs--;
+			if (rmv_entry) {
+				if (hdl->algo_apis.erase) {
+					(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
+				}
+				hdl->cache_cobs--;
 
-			csmgrd_stat_cob_remove (
-				csmgr_stat_hdl, entry->name, entry->name_len,
-				entry->chunk_num, entry->pay_len);
+				csmgrd_stat_cob_remove (
+					csmgr_stat_hdl, rmv_entry->name, rmv_entry->name_len,
+					rmv_entry->chunk_num, rmv_entry->pay_len);
 
-			free (entry->msg);
-			free (entry->name);
-			free (entry);
+				mem_entry_release (rmv_entry);
+			}
 			pthread_mutex_unlock (&mem_cs_mutex);
 		}
 	}
 CobNotExist:;
 
+	if (entry) {
+		mem_entry_release (entry);
+	}
+
 	if (entry_p != NULL) {
 		free (entry_p);
 	}
@@ -856,12 +884,11 @@ CobNotExist:;
 /*--------------------------------------------------------------------------------------
 	Upload content byte steream
 ----------------------------------------------------------------------------------------*/
-static int							/* The return value is negative if an error occurs	*/
+static int							/* length of the bytes taken, negative if an error	*/
 mem_cache_item_puts (
 	unsigned char* msg,
 	int msg_len
 ) {
-	CsmgrdT_Content_Entry entry;
 	int i;
 	int res;
 	int index = 0;
@@ -897,15 +924,15 @@ mem_cache_item_puts (
 				, msg_len - index, i);
 #endif // CefC_Debug
 			while (index < msg_len) {
-				res = cef_csmgr_con_entry_create (&msg[index], msg_len - index, &entry);
+				/* Parses the cob into the buffer of the writer thread directly 	*/
+				res = cef_csmgr_con_entry_create (&msg[index], msg_len - index,
+						&mem_proc_cob_buff[i][mem_proc_cob_buff_idx[i]]);
 
 				if (res < 0) {
+					/* The rest can not be parsed, so it is discarded 	*/
+					index = msg_len;
 					break;
 				}
-				memcpy (
-					&mem_proc_cob_buff[i][mem_proc_cob_buff_idx[i]],
-					&entry,
-					sizeof (CsmgrdT_Content_Entry));
 
 				mem_proc_cob_buff_idx[i] += 1;
 				index += res;
@@ -930,11 +957,11 @@ mem_cache_item_puts (
 #ifdef CefC_Debug
 	if (i == MemC_Max_Buff) {
 		csmgrd_dbg_write (CefC_Dbg_Fine,
-			"cob rcv thread lost %d bytes\n", msg_len - index);
+			"cob rcv thread defers %d bytes\n", msg_len - index);
 	}
 #endif // CefC_Debug
 
-	return (0);
+	return (index);
 }
 /*--------------------------------------------------------------------------------------
 	writes the cobs to memry cache
@@ -1011,11 +1038,7 @@ mem_cache_cob_write (
 						}
 						hdl->cache_cobs--;
 						if (entry) {
-							free (entry->msg);
-							free (entry->name);
-							if (entry->ver_len) {
-								free (entry->version);
-							}
+							mem_entry_release (entry);
 						} else {
 							return (-1);
 						}
@@ -1145,6 +1168,7 @@ mem_cache_cob_write (
 			entry->ins_time		 = cobs[index].ins_time;
 			entry->ver_len		 = cobs[index].ver_len;
 			entry->version		 = cobs[index].version;
+			entry->refcnt		 = 1;
 
 			old_entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
 			if (old_entry == NULL) {
@@ -1235,11 +1259,7 @@ mem_cache_cob_write (
 #endif //__MEMCACHE_VERSION__
 						}
 						if (old_entry) {
-							free (old_entry->msg);
-							free (old_entry->name);
-							if (old_entry->ver_len)
-								free (old_entry->version);
-							free (old_entry);
+							mem_entry_release (old_entry);
 						}
 
 						/* Updates the content information 			*/
@@ -1274,11 +1294,7 @@ mem_cache_cob_write (
 							return (-1);
 						}
 						if (old_entry) {
-							free (old_entry->msg);
-							free (old_entry->name);
-							if (old_entry->ver_len)
-								free (old_entry->version);
-							free (old_entry);
+							mem_entry_release (old_entry);
 						}
 					} else {
 #ifdef __MEMCACHE_VERSION__
@@ -1318,7 +1334,7 @@ mem_cs_ac_cnt_inc (
 ) {
 	CsmgrdT_Content_Mem_Entry* entry;
 
-	entry = cef_mem_hash_tbl_item_get (key, key_size);
+	entry = cef_mem_hash_tbl_item_ref (key, key_size);
 	if (!entry) {
 		return;
 	}
@@ -1331,6 +1347,7 @@ mem_cs_ac_cnt_inc (
 
 	csmgrd_stat_access_count_update (
 			csmgr_stat_hdl, entry->name, entry->name_len);
+	mem_entry_release (entry);
 
 	return;
 }
@@ -1529,7 +1546,7 @@ mem_change_cap (
 		cp = mem_hash_tbl->tbl[n];
 		while (cp != NULL) {
 			wcp = cp->next;
-			free (cp->elem);
+			mem_entry_release (cp->elem);
 			free (cp);
 			cp = wcp;
 		}
@@ -1578,6 +1595,7 @@ mem_cache_set_lifetime (
 	csmgrd_stat_content_lifetime_update (csmgr_stat_hdl, name, name_len, new_life);
 
 	/* Check the cache entry information */
+	pthread_mutex_lock (&mem_cs_mutex);
 	for (n = 0 ; n < mem_hash_tbl->tabl_max ; n++) {
 		if (mem_hash_tbl->tbl[n] == NULL) {
 			continue;
@@ -1599,6 +1617,7 @@ mem_cache_set_lifetime (
 			}
 		}
 	}
+	pthread_mutex_unlock (&mem_cs_mutex);
 
 	return (0);
 }
@@ -1636,9 +1655,7 @@ mem_cache_del (
 		csmgr_stat_hdl, entry->name, entry->name_len,
 		entry->chunk_num, entry->pay_len);
 
-	free (entry->msg);
-	free (entry->name);
-	free (entry);
+	mem_entry_release (entry);
 	pthread_mutex_unlock (&mem_cs_mutex);
 
 	return (0);
@@ -1684,7 +1701,7 @@ mem_cache_lifetime_get (
 
 		for (idx = rcd->min_seq; idx <= rcd->max_seq; idx++) {
 			trg_key_len = csmgrd_name_chunknum_concatenate (name, name_len, idx, trg_key);
-			entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+			entry = cef_mem_hash_tbl_item_ref (trg_key, trg_key_len);
 			if (!entry) {
 				continue;
 			}
@@ -1692,6 +1709,7 @@ mem_cache_lifetime_get (
 				oldest_ins_time = entry->ins_time;
 			if (first_expire > entry->expiry)
 				first_expire = entry->expiry;
+			mem_entry_release (entry);
 		}
 		*cache_time = (uint32_t)((nowt - oldest_ins_time) / 1000000);
 		if (first_expire < nowt)
@@ -1700,13 +1718,17 @@ mem_cache_lifetime_get (
 			*lifetime = (uint32_t)((first_expire - nowt) / 1000000);
 		return (1);
 	} else {
-		entry = cef_mem_hash_tbl_item_get (name, name_len);
-		if ((!entry) ||
-			(nowt > entry->expiry)) {
+		entry = cef_mem_hash_tbl_item_ref (name, name_len);
+		if (!entry) {
+			return (-1);
+		}
+		if (nowt > entry->expiry) {
+			mem_entry_release (entry);
 			return (-1);
 		}
 		*cache_time = (uint32_t)((nowt - entry->ins_time) / 1000000);
 		*lifetime   = (uint32_t)((entry->expiry - nowt) / 1000000);
+		mem_entry_release (entry);
 		return (1);
 	}
 	return (-1);
@@ -1793,45 +1815,42 @@ cef_mem_hash_tbl_item_set (
 	hash = cef_mem_hash_number_create (key, klen);
 	y = hash % ht->tabl_max;
 
-	if (ht->tbl[y] == NULL) {
-		ht->tbl[y] = (CefT_Mem_Hash_Cell* )calloc (1, sizeof (CefT_Mem_Hash_Cell) + klen);
-		if (ht->tbl[y] == NULL) {
-			return (-1);
-		}
-		ht->tbl[y]->key = ((unsigned char*)ht->tbl[y]) + sizeof (CefT_Mem_Hash_Cell);
-		cp = ht->tbl[y];
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		ht->elem_num++;
-		return (1);
-	} else {
-		/* exist check & replace */
-		for (cp = ht->tbl[y]; cp != NULL; cp = cp->next) {
-			if ((cp->klen == klen) &&
-			   (memcmp (cp->key, key, klen) == 0)) {
-				*old_elem = cp->elem;
-				cp->elem = elem;
-				return (1);
-		   }
-		}
-		/* insert */
-		wcp = ht->tbl[y];
-		ht->tbl[y] = (CefT_Mem_Hash_Cell* )calloc (1, sizeof (CefT_Mem_Hash_Cell) + klen);
-		if (ht->tbl[y] == NULL) {
-			return (-1);
-		}
-		ht->tbl[y]->key = ((unsigned char*)ht->tbl[y]) + sizeof (CefT_Mem_Hash_Cell);
-		cp = ht->tbl[y];
-		cp->next = wcp;
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-
-		ht->elem_num++;
-		return (1);
+	/* The cell is prepared before the bucket is locked 		*/
+	cp = (CefT_Mem_Hash_Cell* )calloc (1, sizeof (CefT_Mem_Hash_Cell) + klen);
+	if (cp == NULL) {
+		return (-1);
+	}
+	cp->key = ((unsigned char*)cp) + sizeof (CefT_Mem_Hash_Cell);
+	cp->elem = elem;
+	cp->klen = klen;
+	memcpy (cp->key, key, klen);
+
+	mem_hash_stripe_lock (y);
+
+	/* exist check & replace */
+	for (wcp = ht->tbl[y]; wcp != NULL; wcp = wcp->next) {
+		if ((wcp->klen == klen) &&
+		   (memcmp (wcp->key, key, klen) == 0)) {
+			*old_elem = wcp->elem;
+			wcp->elem = elem;
+			mem_hash_stripe_unlock (y);
+			free (cp);
+			return (1);
+	   }
 	}
+	/* insert */
+	cp->next = ht->tbl[y];
+	ht->tbl[y] = cp;
+	ht->elem_num++;
+
+	mem_hash_stripe_unlock (y);
+
+	return (1);
 }
+/*--------------------------------------------------------------------------------------
+	Looks up the entry without the reference
+	  NOTE: The caller must hold mem_cs_mutex, which the removers of the entries hold
+----------------------------------------------------------------------------------------*/
 static CsmgrdT_Content_Mem_Entry*
 cef_mem_hash_tbl_item_get (
 	const unsigned char* key,
@@ -1861,6 +1880,40 @@ cef_mem_hash_tbl_item_get (
 
 	return (NULL);
 }
+/*--------------------------------------------------------------------------------------
+	Looks up the entry and takes the reference to it
+	  NOTE: The caller must release the entry by mem_entry_release
+----------------------------------------------------------------------------------------*/
+static CsmgrdT_Content_Mem_Entry*
+cef_mem_hash_tbl_item_ref (
+	const unsigned char* key,
+	uint32_t klen
+) {
+	CefT_Mem_Hash* ht = (CefT_Mem_Hash*) mem_hash_tbl;
+	uint32_t hash = 0;
+	uint32_t y;
+	CefT_Mem_Hash_Cell* cp;
+	CsmgrdT_Content_Mem_Entry* elem = NULL;
+
+	if ((klen > MemC_Max_KLen) || (ht == NULL)) {
+		return (NULL);
+	}
+	hash = cef_mem_hash_number_create (key, klen);
+	y = hash % ht->tabl_max;
+
+	mem_hash_stripe_lock (y);
+	for (cp = ht->tbl[y]; cp != NULL; cp = cp->next) {
+		if ((cp->klen == klen) &&
+		   (memcmp (cp->key, key, klen) == 0)) {
+			elem = cp->elem;
+			__atomic_add_fetch (&elem->refcnt, 1, __ATOMIC_RELAXED);
+			break;
+		}
+	}
+	mem_hash_stripe_unlock (y);
+
+	return (elem);
+}
 
 static CsmgrdT_Content_Mem_Entry*
 cef_mem_hash_tbl_item_remove (
@@ -1881,35 +1934,55 @@ cef_mem_hash_tbl_item_remove (
 	hash = cef_mem_hash_number_create (key, klen);
 	y = hash % ht->tabl_max;
 
+	mem_hash_stripe_lock (y);
 	cp = ht->tbl[y];
 	if (cp == NULL) {
+		mem_hash_stripe_unlock (y);
 		return (NULL);
 	}
-	if (cp != NULL) {
-		if ((cp->klen == klen) &&
-		   (memcmp (cp->key, key, klen) == 0)) {
-		   	ht->tbl[y] = cp->next;
-			ht->elem_num--;
-		   	ret_elem = cp->elem;
-		   	free (cp);
-		   	return (ret_elem);
-		} else {
-			for (; cp->next != NULL; cp = cp->next) {
-				if ((cp->next->klen == klen) &&
-				   (memcmp (cp->next->key, key, klen) == 0)) {
-				   	wcp = cp->next;
-				   	cp->next = cp->next->next;
-					ht->elem_num--;
-				   	ret_elem = wcp->elem;
-					free (wcp);
-					return (ret_elem);
-				}
+	if ((cp->klen == klen) &&
+	   (memcmp (cp->key, key, klen) == 0)) {
+		ht->tbl[y] = cp->next;
+		ht->elem_num--;
+		mem_hash_stripe_unlock (y);
+		ret_elem = cp->elem;
+		free (cp);
+		return (ret_elem);
+	} else {
+		for (; cp->next != NULL; cp = cp->next) {
+			if ((cp->next->klen == klen) &&
+			   (memcmp (cp->next->key, key, klen) == 0)) {
+				wcp = cp->next;
+				cp->next = cp->next->next;
+				ht->elem_num--;
+				mem_hash_stripe_unlock (y);
+				ret_elem = wcp->elem;
+				free (wcp);
+				return (ret_elem);
 			}
 		}
 	}
+	mem_hash_stripe_unlock (y);
 
 	return (NULL);
 }
+/*--------------------------------------------------------------------------------------
+	Releases the reference to the entry and frees it when the last one is released
+----------------------------------------------------------------------------------------*/
+static void
+mem_entry_release (
+	CsmgrdT_Content_Mem_Entry* entry
+) {
+	if (__atomic_sub_fetch (&entry->refcnt, 1, __ATOMIC_ACQ_REL) != 0) {
+		return;
+	}
+	free (entry->msg);
+	free (entry->name);
+	if (entry->ver_len) {
+		free (entry->version);
+	}
+	free (entry);
+}
 
 
 static uint32_t
@@ -1917,13 +1990,7 @@ cef_mem_hash_number_create (
 	const unsigned char* key,
 	uint32_t klen
 ) {
-	uint32_t hash;
-	unsigned char out[MD5_DIGEST_LENGTH];
-
-	MD5 (key, klen, out);
-	memcpy (&hash, &out[12], sizeof (uint32_t));
-
-	return (hash);
+	return (cef_hash_key_hashv_create (key, klen));
 }
 
 int												/* length of the created key 			*/
@@ -2041,6 +2108,9 @@ mem_cache_delete_thread (
 				trg_key_len = csmgrd_name_chunknum_concatenate (del_name, del_name_len, n, trg_key);
 
 				entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+				if (entry == NULL) {
+					continue;
+				}
 				rc = cef_csmgr_cache_version_compare (del_version, del_ver_len, entry->version, entry->ver_len);
 				if (rc == CefC_CV_Same) {
 					entry = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
@@ -2049,11 +2119,7 @@ mem_cache_delete_thread (
 							(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
 						}
 						hdl->cache_cobs--;
-						free (entry->msg);
-						free (entry->name);
-						if (entry->ver_len)
-							free (entry->version);
-						free (entry);
+						mem_entry_release (entry);
 					}
 				}
 			}
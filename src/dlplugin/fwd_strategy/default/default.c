@@ -169,8 +169,6 @@ void
 fwd_default_forward_object (
 	CefT_FwdStrtgy_Param* fwdstr
 ) {
-	uint32_t			seqnum;
-	uint16_t			new_buff_len = 0;
 	CefT_Down_Faces*	face;
 	int					fidx;
 	uint16_t			fid;
@@ -207,10 +205,8 @@ fwd_default_forward_object (
 
 		if (cef_face_check_active (face->faceid) > 0) {
 
-			seqnum = cef_face_get_seqnum_from_faceid (face->faceid);
-			new_buff_len = cef_frame_seqence_update (fwdstr->msg, seqnum);
-
-			cef_face_object_send (face->faceid, fwdstr->msg, new_buff_len, fwdstr->pm);
+			cef_face_object_send_seqnum (face->faceid, fwdstr->msg,
+				fwdstr->payload_len + fwdstr->header_len, fwdstr->pm);
 
 #ifdef CefC_Debug
 			cef_dbg_write (CefC_Dbg_Finest, LOGTAG"Forward the ContentObject to Face#%d\n", face->faceid);
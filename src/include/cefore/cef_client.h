@@ -52,6 +52,7 @@
 
 #include <cefore/cef_define.h>
 #include <cefore/cef_frame.h>
+#include <cefore/cef_shmring.h>
 
 /****************************************************************************************
  Macros
@@ -86,6 +87,7 @@ typedef struct {
 	int 	sock;							/* File descriptor 							*/
 	struct addrinfo* ai;					/* addrinfo of this connection 				*/
 	uint32_t seqnum;
+	CefT_Shmring* shm;						/* Shared memory ring instead of the socket	*/
 } CefT_Connect;
 
 /****************************************************************************************
@@ -182,6 +184,16 @@ cef_client_message_input (
 	unsigned char* msg,							/* message 								*/
 	size_t len									/* length of message 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Sets the deferred signatures of the Content Objects in the buffer
+----------------------------------------------------------------------------------------*/
+int												/* number of the signed messages, or 	*/
+												/* -1 if any message is not signed 		*/
+cef_client_objects_sign (
+	unsigned char* msg,							/* Content Objects created while 		*/
+												/* cef_frame_set_sign_defer_f is set 	*/
+	size_t len									/* length of the messages 				*/
+);
 /*--------------------------------------------------------------------------------------
 	Inputs the interest to the cefnetd
 ----------------------------------------------------------------------------------------*/
@@ -72,6 +72,7 @@
 													/* to send							*/
 #define CefC_CnpbDefault_Valid_Alg			"NONE"	/* Specify the Validation Algorithm	*/
 													/* to be added to Content Object	*/
+#define CefC_CnpbDefault_Manifest			0		/* Sign only the Manifest			*/
 #define CefC_CnpbDefault_Contents_num		1024	/* Total content					*/
 #define CefC_CnpbDefault_Contents_Capacity	4294967296
 													/* Total content capacity 			*/
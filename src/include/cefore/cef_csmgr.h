@@ -41,6 +41,7 @@
 
 #include <cefore/cef_plugin.h>
 #include <cefore/cef_rngque.h>
+#include <cefore/cef_pktbuf.h>
 #include <cefore/cef_hash.h>
 #include <cefore/cef_pit.h>
 
@@ -80,7 +81,6 @@
 													/* conpubd Config file name			*/
 #define CefC_Csmgr_Max_Table_Num		65535		/* Max size of table				*/
 #define CefC_Csmgr_Max_Table_Margin		10000		/* Margin size of table				*/
-#define CefC_Csmgr_Max_Send_Num			16
 #if 0
 #define CefC_Csmgr_Max_Wait_Response	2000		/* Wait time(msec)					*/
 #else
@@ -91,12 +91,6 @@
 #define CefC_Csmgr_Cmd_MaxLen			1024
 #define CefC_Csmgr_Cmd_ConnOK			"CMD://CsmgrConnOK"
 
-/*------------------------------------------------------------------*/
-/* type of queue entry												*/
-/*------------------------------------------------------------------*/
-#define CefC_Cs_Tx_Elem_Type_Invalid	0x00		/* Type Invalid						*/
-#define CefC_Cs_Tx_Elem_Type_Cob 		0x01		/* Type Content Object				*/
-
 /*------------------------------------------------------------------*/
 /* type of csmgr message											*/
 /*------------------------------------------------------------------*/
@@ -218,11 +212,6 @@ typedef struct {
 	/********** Content Object Table		***********/
 	CefT_Hash_Handle	cob_table;				/* Content Object Table					*/
 
-	/********** Tx Message Queue		***********/
-	CefT_Mp_Handle		tx_cob_mp;				/* for CefT_Cs_Tx_Elem_Cob 				*/
-	CefT_Mp_Handle 		tx_que_mp;				/* for CefT_Cs_Tx_Elem 					*/
-	CefT_Rngque* 		tx_que;					/* TX ring buffer 						*/
-
 	/********** CS memory pool 		***********/
 	CefT_Mp_Handle	cs_cob_entry_mp;		/* for cob entry							*/
 
@@ -254,6 +243,8 @@ typedef struct {
 	/********** Content Object Information			***********/
 //20210824	unsigned char	msg[CefC_Max_Msg_Size];		/* Receive message						*/
 /*0.8.3c*/	unsigned char*	msg;			/* Receive message						*/
+	CefT_Pktbuf*	pb;						/* Buffer which holds msg, which is 	*/
+											/* shared with the Faces 				*/
 	uint16_t		msg_len;				/* Length of message 					*/
 	uint32_t		chunk_num;				/* Chunk Num							*/
 	uint64_t		expiry;
@@ -262,14 +253,6 @@ typedef struct {
 	uint16_t		ver_len;				/* Length of Version					*/
 } CefT_Cob_Entry;
 
-/***** Insert to data of CefT_Cs_Tx_Elem_Cob	*****/
-typedef struct {
-
-	CefT_Cob_Entry		cob;					/* Content Object						*/
-	int					faceid;					/* Interest arrived face id				*/
-
-} CefT_Cs_Tx_Elem_Cob;
-
 /***** Content information	*****/
 typedef struct {
 	unsigned char	msg[CefC_Max_Msg_Size];
@@ -286,19 +269,14 @@ typedef struct {
 /* for cache information field										*/
 /*------------------------------------------------------------------*/
 
-/***** Tx Queue Element 	*****/
-typedef struct {
-
-	int 					type;					/* Type of the element 				*/
-	void* 					data;					/* Information 						*/
-
-} CefT_Cs_Tx_Elem;
-
 struct CefT_Csmgr_Status_Hdr {
 
 	uint16_t 		node_num;
 	uint32_t 		con_num;
-
+	uint64_t 		ingest_num;					/* Cobs passed to the cache plugin		*/
+	uint64_t 		ingest_drop;				/* Cobs dropped by csmgrd 				*/
+	uint64_t 		ingest_block;				/* Times csmgrd stopped reading cefnetd	*/
+												/* because no chunk was free 			*/
 } __attribute__((__packed__));
 
 struct CefT_Csmgr_Status_Rep {
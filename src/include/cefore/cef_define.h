@@ -99,6 +99,7 @@
 #define CefC_ParamName_PitSize			"PIT_SIZE"
 #define CefC_ParamName_FibSize			"FIB_SIZE"
 #define CefC_ParamName_LocalSockId		"LOCAL_SOCK_ID"
+#define CefC_ParamName_LocalShmSize		"LOCAL_SHM_SIZE"
 #define CefC_ParamName_PrvKey			"PRIVATE_KEY"
 #define CefC_ParamName_NbrSize			"NBR_SIZE"
 #define CefC_ParamName_NbrMngInterval	"NBR_INTERVAL"
@@ -130,6 +131,12 @@
 #define CefC_ParamName_IR_Enabled		"ENABLED_RETURN_CODE"
 //20220311
 #define CefC_ParamName_SELECTIVE_MAX	"SELECTIVE_INTEREST_MAX_RANGE"
+#define CefC_ParamName_UDP_BATCH_SIZE	"UDP_BATCH_SIZE"
+#define CefC_ParamName_FACE_OUTQ_SIZE	"FACE_OUTQ_SIZE"
+#define CefC_ParamName_FACE_OUTQ_POLICY	"FACE_OUTQ_POLICY"
+#define CefC_ParamName_HASH_HIGH_WATER	"HASH_HIGH_WATER"
+#define CefC_ParamName_HASH_LOW_WATER	"HASH_LOW_WATER"
+#define CefC_ParamName_FWD_WORKERS		"FORWARDING_WORKERS"
 
 #define CefC_ParamName_CcninfoAccessPolicy	"CCNINFO_ACCESS_POLICY"
 #define CefC_ParamName_CcninfoFullDiscovery	"CCNINFO_FULL_DISCOVERY"
@@ -164,6 +171,12 @@
 #define CefC_Default_CSMGR_ACCESS_RW	0
 #define CefC_Default_CSMGR_ACCESS_RO	1
 #define CefC_Default_BUFFER_CACHE_TIME	10000
+#define CefC_Default_UDP_BATCH_SIZE		1			/* 1: one datagram per syscall 		*/
+#define CefC_Default_FACE_OUTQ_SIZE		1048576		/* Bytes queued per Face 			*/
+#define CefC_Default_FACE_OUTQ_POLICY	0			/* 0: drop tail, 1: drop head 		*/
+#define CefC_Default_LocalShmSize		0			/* 0: local apps use the socket 	*/
+#define CefC_Default_FWD_WORKERS		0			/* 0: the main thread forwards all 	*/
+#define CefC_FWD_WORKERS_Max			16
 
 #define CefC_Default_CcninfoAccessPolicy	0
 #define CefC_Default_CcninfoFullDiscovery	0
@@ -53,6 +53,8 @@
 
 #include <cefore/cef_hash.h>
 #include <cefore/cef_define.h>
+#include <cefore/cef_shmring.h>
+#include <cefore/cef_pktbuf.h>
 #include <cefore/cef_frame.h>
 
 /****************************************************************************************
@@ -81,20 +83,60 @@
 /********** Neighbor Management				**********/
 #define CefC_Max_RTT 				1000000		/* Maximum RTT (us) 					*/
 
+/********** Batched UDP I/O (recvmmsg/sendmmsg)	**********/
+#ifdef __linux__
+#define CefC_Face_Batch_Enable
+#endif // __linux__
+#define CefC_Face_Batch_Max			64			/* Upper limit of UDP_BATCH_SIZE		*/
+#define CefC_Face_Batch_Hist_Num	7			/* 1,2-3,4-7,8-15,16-31,32-63,64 		*/
+
+/********** Output Queue of the Face		**********/
+#define CefC_Face_Outq_Drop_Tail	0			/* Drops the message to queue 			*/
+#define CefC_Face_Outq_Drop_Head	1			/* Drops the oldest unsent messages 	*/
+#define CefC_Face_Outq_Size_Max		67108864	/* Upper limit of FACE_OUTQ_SIZE 		*/
+#define CefC_Face_Outq_Iov_Max		64			/* Messages sent by one sendmsg 		*/
+
 /****************************************************************************************
  Structure Declarations
  ****************************************************************************************/
 
+/****** Message waiting to be sent to the Face *****/
+/* The header of the Face is followed by the body shared with the other Faces 	*/
+typedef struct CefT_Face_Outq_Msg {
+	struct CefT_Face_Outq_Msg* 	next;
+	uint32_t 					len;			/* Length of the message 				*/
+	uint32_t 					off;			/* Length already sent 					*/
+	CefT_Pktbuf* 				pb;				/* Buffer which holds the body 			*/
+	unsigned char* 				body;			/* Body of the message in pb 			*/
+	uint16_t 					hdr_len;		/* Length of the header 				*/
+	unsigned char 				hdr[];			/* Header of this Face 					*/
+} CefT_Face_Outq_Msg;
+
+/****** Output Queue of the Face 		*****/
+typedef struct {
+	CefT_Face_Outq_Msg* 	head;
+	CefT_Face_Outq_Msg* 	tail;
+	uint32_t 				num;				/* Number of the queued messages 		*/
+	uint32_t 				bytes;				/* Bytes waiting to be sent 			*/
+	uint8_t 				pend_f;				/* Listed in the pending Faces 			*/
+	uint64_t 				enq;				/* Messages queued so far 				*/
+	uint64_t 				drop;				/* Messages dropped so far 				*/
+} CefT_Face_Outq;
+
 typedef struct {
 	uint16_t		index;
 	int				fd;
 	unsigned char 	rcv_buff[CefC_Max_Length];
-	uint16_t 		len;
+	uint16_t 		head;						/* Offset of the data not handled yet 	*/
+	uint16_t 		len;						/* Length of the data not handled yet 	*/
 	uint8_t 		local_f;
 	uint8_t 		protocol;
 	uint32_t 		seqnum;
 	int 			ifindex;
 	int				bw_stat_i;	//0.8.3
+	uint32_t		fd_gen;						/* Generation when the FD was set 		*/
+	CefT_Face_Outq 	outq;						/* Messages waiting for POLLOUT 		*/
+	CefT_Shmring* 	shm;						/* Shared memory ring of the local app 	*/
 } CefT_Face;
 
 /********** Neighbor Management				**********/
@@ -114,6 +156,21 @@ typedef struct {
 	uint8_t protocol;
 } CefT_Sock;
 
+/****** Datagram received by the batched UDP receive *****/
+typedef struct {
+	unsigned char* 			buff;				/* Received datagram 					*/
+	int 					len;				/* Length of the datagram 				*/
+	struct sockaddr_storage sas;				/* Source address 						*/
+	socklen_t 				sas_len;			/* Length of the source address 		*/
+} CefT_Face_Rx_Dgram;
+
+/****** Statistics of the batched UDP I/O 	*****/
+typedef struct {
+	uint64_t 	rx_hist[CefC_Face_Batch_Hist_Num];	/* Datagrams per recvmmsg 			*/
+	uint64_t 	tx_hist[CefC_Face_Batch_Hist_Num];	/* Datagrams per sendmmsg 			*/
+	uint64_t 	tx_drop;							/* Datagrams given up to send 		*/
+} CefT_Face_Batch_Stat;
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -261,6 +318,15 @@ cef_face_frame_send_forced (
 	unsigned char* 	msg, 					/* a message to send						*/
 	size_t			msg_len					/* length of the message to send 			*/
 );
+/*--------------------------------------------------------------------------------------
+	Sends the message in the packet buffer via the specified Face
+----------------------------------------------------------------------------------------*/
+void
+cef_face_pktbuf_send_forced (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	CefT_Pktbuf* 	pb, 					/* Packet buffer of the message 			*/
+	int 			seqnum_f				/* sets the sequence number of the Face 	*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains the Face structure from the specified Face-ID
 ----------------------------------------------------------------------------------------*/
@@ -306,6 +372,16 @@ cef_face_object_send (
 	size_t			msg_len,				/* length of the message to send 			*/
 	CefT_CcnMsg_MsgBdy* pm 				/* Parsed message 							*/
 );
+/*--------------------------------------------------------------------------------------
+	Sends a Content Object with the sequence number of the specified Face
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_object_send_seqnum (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	unsigned char* 	msg, 					/* a message to send						*/
+	size_t			msg_len,				/* length of the message to send 			*/
+	CefT_CcnMsg_MsgBdy* pm 				/* Parsed message 							*/
+);
 /*--------------------------------------------------------------------------------------
 	Sends a Content Object if the specified is local Face
 ----------------------------------------------------------------------------------------*/
@@ -404,5 +480,86 @@ cef_face_ip_route_get (
 	char*	ip_addr_str,
 	char*	if_name
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the Face Table, which changes when a FD is set to a Face
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* generation of the Face Table 			*/
+cef_face_generation_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Enables the batched UDP I/O with the specified batch size
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_batch_init (
+	int batch_num							/* Max datagrams per syscall (1:disabled) 	*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the batch size of the UDP I/O
+----------------------------------------------------------------------------------------*/
+int											/* Max datagrams per syscall 				*/
+cef_face_batch_size_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Receives the datagrams from the specified UDP socket at once
+----------------------------------------------------------------------------------------*/
+int											/* Number of the received datagrams 		*/
+cef_face_udp_batch_recv (
+	int fd, 								/* UDP socket 								*/
+	CefT_Face_Rx_Dgram** dgrams				/* set the received datagrams 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the queued UDP datagrams
+----------------------------------------------------------------------------------------*/
+void
+cef_face_udp_batch_flush (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Sets the size and the drop policy of the output queues of the Faces
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_outq_init (
+	int size,								/* Max bytes queued per Face 				*/
+	int policy								/* CefC_Face_Outq_Drop_XXX 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages of the Faces whose sockets are writable
+----------------------------------------------------------------------------------------*/
+void
+cef_face_outq_flush (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the Faces which have the messages waiting to be sent
+----------------------------------------------------------------------------------------*/
+int											/* Number of the Faces 						*/
+cef_face_outq_pending_get (
+	uint16_t faceids[],						/* set the Face-IDs 						*/
+	int max									/* size of faceids 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Sets the shared memory ring which replaces the socket of the local Face
+----------------------------------------------------------------------------------------*/
+void
+cef_face_shmring_set (
+	uint16_t faceid,						/* Face-ID of the local app 				*/
+	CefT_Shmring* sr						/* ring pair, it is destroyed with the Face	*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the shared memory ring of the local Face
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* ring pair, or NULL if the socket is used */
+cef_face_shmring_get (
+	uint16_t faceid							/* Face-ID of the local app 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the batched UDP I/O
+----------------------------------------------------------------------------------------*/
+void
+cef_face_batch_stat_get (
+	CefT_Face_Batch_Stat* stat				/* set the statistics 						*/
+);
 
 #endif // __CEF_FACE_HEADER__
@@ -99,6 +99,15 @@ typedef struct {
 
 } CefT_Fib_Entry;
 
+/***** Route in the snapshot of the FIB 	*****/
+typedef struct {
+	uint16_t 		face_num;				/* number of the Faces 						*/
+	uint16_t 		faceids[CefC_Fib_UpFace_Max];	/* Faces in the order of the entry 	*/
+} CefT_Fib_Snap_Route;
+
+/***** Snapshot of the FIB (see cef_fib_snapshot_create) 	*****/
+typedef struct CefT_Fib_Snapshot CefT_Fib_Snapshot;
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -129,6 +138,29 @@ cef_fib_entry_search (
 	unsigned char* name, 					/* Key of the FIB entry						*/
 	uint16_t name_len						/* Length of Key							*/
 );
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry matching the specified Key with the hash values of its
+	prefixes which the caller has created (e.g. name_hashv of the parsed message)
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Entry* 							/* FIB entry 								*/
+cef_fib_entry_search_with_hashv (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len,						/* Length of Key							*/
+	const uint16_t pfx_ends[],				/* Length of each prefix of the Key 		*/
+	const uint32_t pfx_hashv[],				/* Hash value of each prefix of the Key 	*/
+	int pfx_num								/* Number of the prefixes, 0 if not hashed	*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry by removing the name components one by one. It is the
+	fallback of cef_fib_entry_search for the Keys which cannot be indexed.
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Entry* 							/* FIB entry 								*/
+cef_fib_entry_search_linear (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len						/* Length of Key							*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains Face-ID(s) to forward the Interest matching the specified FIB entry
 ----------------------------------------------------------------------------------------*/
@@ -227,6 +259,50 @@ int
 cef_fib_check_addr(
 	const char *addr						// Ip address
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the FIB, which changes whenever a route changes
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_fib_generation_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Creates the read-only copy of the routes in the FIB. The copy does not refer to
+	the FIB, so that other threads can search it while the FIB changes.
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Snapshot* 							/* the snapshot, or NULL if it fails 		*/
+cef_fib_snapshot_create (
+	CefT_Hash_Handle fib					/* FIB										*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches the route matching the specified Key in the snapshot by the longest
+	prefix match of cef_fib_entry_search_with_hashv
+----------------------------------------------------------------------------------------*/
+int 										/* 0 if searched, -1 if the snapshot can not */
+											/* decide (the caller must use the FIB) 	*/
+cef_fib_snapshot_search (
+	const CefT_Fib_Snapshot* snap,			/* snapshot 								*/
+	const unsigned char* name, 				/* Key 										*/
+	uint16_t name_len,						/* Length of Key							*/
+	const uint16_t pfx_ends[],				/* Length of each prefix of the Key 		*/
+	const uint32_t pfx_hashv[],				/* Hash value of each prefix of the Key 	*/
+	int pfx_num,							/* Number of the prefixes, 0 if not hashed	*/
+	const CefT_Fib_Snap_Route** route		/* set the route, or NULL if no route 		*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the FIB from which the snapshot was created
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_fib_snapshot_generation_get (
+	const CefT_Fib_Snapshot* snap			/* snapshot 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Destroys the snapshot
+----------------------------------------------------------------------------------------*/
+void
+cef_fib_snapshot_destroy (
+	CefT_Fib_Snapshot* snap					/* snapshot 								*/
+);
 
 
 #endif // __CEF_FIB_HEADER__
@@ -615,6 +615,7 @@ typedef struct _CefT_CcnMsg_OptHdr_t {
 /* Parameters to CEFORE message									*/
 /*--------------------------------------------------------------*/
 #define	CefC_HashVal_Len	32
+#define	CefC_Name_Hash_Num	128				/* Max prefixes hashed at parsing			*/
 typedef struct _CefT_CcnMsg_MsgBdy_t {
 
 	/***** Fixed Header 	*****/
@@ -635,6 +636,12 @@ typedef struct _CefT_CcnMsg_MsgBdy_t {
 	uint16_t		end_chunk_len;				/* Length of End Chunk Number 			*/
 	uint32_t		end_chunk_num;				/* End Chunk Number						*/
 
+	/***** Hash values of the Name prefixes	*****/
+	uint16_t		name_hash_num;				/* Number of the hashed prefixes 		*/
+												/* 0 if they are not hashed 			*/
+	uint16_t		name_hash_end[CefC_Name_Hash_Num];	/* Length of each prefix 		*/
+	uint32_t		name_hashv[CefC_Name_Hash_Num];		/* Hash value of each prefix 	*/
+
 	/***** for NDN TLV		*****/
 	uint8_t 		nonce_f;					/* flag to set Nonce 					*/
 	uint64_t		nonce;						/* Nonce 								*/
@@ -681,6 +688,43 @@ typedef struct _CefT_CcnMsg_MsgBdy_t {
 #define Cef_Int_ReguLong(msg)    {(msg).org.symbolic_f=0; (msg).org.longlife_f=1;}
 #define Cef_Int_Symbolic(msg)    {(msg).org.symbolic_f=1; (msg).org.longlife_f=1;}
 
+/*--------------------------------------------------------------*/
+/* View of a received CEFORE message							*/
+/*   It records where the TLVs are in the received frame, and	*/
+/*   each TLV is decoded when it is asked for. Unlike 			*/
+/*   CefT_CcnMsg_MsgBdy, neither the Name nor the Payload is	*/
+/*   copied and the view needs no clearing.						*/
+/*--------------------------------------------------------------*/
+#define CefC_View_Name_Decoded		0x0001		/* name/chunk_num are decoded	*/
+
+typedef struct {
+	unsigned char*	value;						/* Value in the frame, NULL if absent	*/
+	uint16_t		offset;						/* Offset of the TLV from the top 		*/
+	uint16_t		length;						/* Length of the value					*/
+} CefT_CcnMsg_View_Tlv;
+
+typedef struct _CefT_CcnMsg_View_t {
+
+	unsigned char*	msg;						/* Top of the received frame			*/
+	uint16_t		payload_len;				/* Payload Length of the message		*/
+	uint16_t		header_len;					/* Header Length of the message			*/
+	uint16_t 		top_level_type;				/* Top-Level Type 						*/
+	uint8_t			hoplimit;					/* Hop Limit of Interest 				*/
+	uint16_t		decoded;					/* CefC_View_Xxx_Decoded				*/
+
+	CefT_CcnMsg_View_Tlv	tlv[CefC_T_MSG_TLV_NUM];	/* TLVs indexed by the type		*/
+	CefT_CcnMsg_View_Tlv	org;				/* ORG TLV								*/
+
+	/***** Decoded by cef_frame_view_name_get	*****/
+	unsigned char*	name;						/* Name with 4 bytes chunk at the tail	*/
+	uint16_t		name_len;					/* Length of Name 						*/
+	uint8_t			chunk_num_f;				/* 1 if Name has Chunk Number			*/
+	uint16_t		chunk_len;					/* Length of Chunk Number in the frame	*/
+	uint32_t		chunk_num;					/* Chunk Number 						*/
+	unsigned char	name_buf[CefC_Max_Length];	/* Used only when the Chunk Number in	*/
+												/* the frame is not 4 bytes at the tail	*/
+} CefT_CcnMsg_View;
+
 /*--------------------------------------------------------------*/
 /* Parsed Ccninfo message										*/
 /*--------------------------------------------------------------*/
@@ -854,6 +898,17 @@ cef_frame_seqence_update (
 	unsigned char* buff, 					/* packet									*/
 	uint32_t seqnum
 );
+/*--------------------------------------------------------------------------------------
+	Builds the header which carries the sequence number of the Face
+----------------------------------------------------------------------------------------*/
+uint16_t									/* length of the built header, or 0 if the	*/
+											/* packet is sent as it is 					*/
+cef_frame_seqnum_hdr_build (
+	const unsigned char* buff, 				/* packet									*/
+	uint32_t seqnum,
+	unsigned char* hdr,						/* buffer of CefC_Max_Header_Size bytes 	*/
+	uint16_t* skip							/* set length of the original header 		*/
+);
 /*--------------------------------------------------------------------------------------
 	Update cache time
 ----------------------------------------------------------------------------------------*/
@@ -874,6 +929,55 @@ cef_frame_message_parse (
 	CefT_CcnMsg_MsgBdy* pm, 				/* Structure to set parsed CEFORE message	*/
 	int target_type							/* Type of the message to expect			*/
 );
+/*--------------------------------------------------------------------------------------
+	Parses a message into the view. The Option Header(s) are parsed into poh, and
+	only the positions of the TLVs in the CEFORE message are recorded.
+----------------------------------------------------------------------------------------*/
+int 										/* Returns a negative value if it fails 	*/
+cef_frame_message_view_parse (
+	unsigned char* msg, 					/* the message to parse						*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len, 					/* Header Length of this message			*/
+	CefT_CcnMsg_OptHdr* poh, 				/* Structure to set parsed Option Header(s)	*/
+	CefT_CcnMsg_View* view, 				/* View to set the positions of the TLVs	*/
+	int target_type							/* Type of the message to expect			*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the Name in the view, decoding it at the first call
+----------------------------------------------------------------------------------------*/
+unsigned char* 								/* Name, NULL if the message has no Name	*/
+cef_frame_view_name_get (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	uint16_t* name_len						/* Length of the Name						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the Payload in the view
+----------------------------------------------------------------------------------------*/
+unsigned char* 								/* Payload, NULL if it is absent			*/
+cef_frame_view_payload_get (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	uint16_t* payload_len					/* Length of the Payload					*/
+);
+/*--------------------------------------------------------------------------------------
+	Sets the parsed CEFORE message from the view. pm needs no clearing. The Payload
+	and the Disc Reply are not copied, only their offsets and lengths are set.
+----------------------------------------------------------------------------------------*/
+int 										/* Returns a negative value if it fails 	*/
+cef_frame_view_msgbdy_fill (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the hash value of the Name (or its prefix) in the parsed message.
+	The value hashed at parsing is returned if the key is one of the prefixes
+	of pm->name, otherwise the key is hashed.
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* Hash value of the key 					*/
+cef_frame_name_hashv_get (
+	CefT_CcnMsg_MsgBdy* pm, 				/* Parsed CEFORE message					*/
+	const unsigned char* name, 				/* Key (pm->name or the other Name)			*/
+	uint16_t name_len						/* Length of the key						*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains a Link Request message
 ----------------------------------------------------------------------------------------*/
@@ -962,6 +1066,13 @@ uint16_t
 cef_frame_get_opt_seqnum_f (
 	void
 );
+/*--------------------------------------------------------------------------------------
+	Set flag whether to defer RSA-SHA256 signing of Content Objects
+----------------------------------------------------------------------------------------*/
+void
+cef_frame_set_sign_defer_f (
+	int				defer_f				/* 1 to defer, 0 to sign in creating messages	*/
+);
 /*--------------------------------------------------------------------------------------
 	get Name without chunkno
 ----------------------------------------------------------------------------------------*/
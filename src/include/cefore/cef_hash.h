@@ -72,28 +72,26 @@
 #define CefC_Hash_Coef_Cache		1			/* for Work Buffer, Memory Cache(conpubd/csmgrd),  */
 												/*     Cache Algorithm(csmgrd/conpubd/local cache) */
 
+/* [Hash functions used to index the hash tables]                                   */
+#define CefC_Hash_Alg_MD5			0			/* MD5 digest (legacy)                             */
+#define CefC_Hash_Alg_XXH64			1			/* xxHash64 keyed with the per-process seed        */
+#define CefC_Hash_Alg_Default		CefC_Hash_Alg_XXH64
+
+/* [Water marks of the resizable hash tables (load factor in percent)]              */
+#define CefC_Hash_High_Water_Def	75			/* Grows when the load exceeds this                */
+#define CefC_Hash_Low_Water_Def		20			/* Shrinks when the load falls below this          */
+
 /****************************************************************************************
  Structure Declarations
  ****************************************************************************************/
 typedef size_t CefT_Hash_Handle;
 
-#if 1
-typedef struct CefT_Hash_Table {
-	uint32_t 		hash;
-	unsigned char 	key[CefC_Max_KLen + 1];
-	void* 			elem;
-	uint32_t 		klen;
-	uint8_t			opt_f;
-} CefT_Hash_Table;
-
-typedef struct CefT_Hash {
-	uint32_t 			seed;
-	CefT_Hash_Table*	tbl;
-	uint32_t 			elem_max;			/* Prime numbers larger than the user defined maximum size */
-	uint32_t 			elem_num;
-	uint32_t 			def_elem_max;		/* User defined maximum size	*/
-} CefT_Hash;
-#endif
+typedef uint32_t (*CefT_Hash_Func) (
+	uint32_t seed,
+	const unsigned char* key,
+	uint32_t klen
+);
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -115,6 +113,23 @@ cef_hash_tbl_create_ext (
 	uint8_t coef
 );
 
+CefT_Hash_Handle
+cef_hash_tbl_create_with_alg (
+	uint32_t table_size,
+	uint8_t coef,
+	int alg
+);
+
+/*--------------------------------------------------------------------------------------
+	Creates the table which grows and shrinks with the load. The indexes of the
+	entries are valid only until the next set or remove by key.
+----------------------------------------------------------------------------------------*/
+CefT_Hash_Handle
+cef_hash_tbl_create_resizable (
+	uint32_t table_size,
+	uint8_t coef
+);
+
 void
 cef_hash_tbl_destroy (
 	CefT_Hash_Handle handle
@@ -188,6 +203,10 @@ int
 cef_hash_tbl_item_max_idx_get (
 	CefT_Hash_Handle handle
 );
+int
+cef_hash_tbl_capacity_get (
+	CefT_Hash_Handle handle
+);
 void*
 cef_hash_tbl_elem_get (
 	CefT_Hash_Handle handle,
@@ -225,6 +244,41 @@ cef_hash_tbl_item_get_prg (
 	const unsigned char* key,
 	uint32_t klen
 );
+/*--------------------------------------------------------------------------------------
+	Same as the functions without _with_hashv, but they use the hash value which
+	the caller has already created for the key. The hash value must be created with
+	the default algorithm and the process seed (e.g. cef_hash_key_hashv_create).
+	It is created again if the table uses the other algorithm.
+----------------------------------------------------------------------------------------*/
+void*
+cef_hash_tbl_item_get_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+);
+void*
+cef_hash_tbl_item_get_for_app_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+);
+void* 
+cef_hash_tbl_item_set_prg_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv,
+	void* elem
+);
+void* 
+cef_hash_tbl_item_get_prg_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+);
 
 CefT_Hash_Handle
 cef_lhash_tbl_create (
@@ -237,6 +291,13 @@ cef_lhash_tbl_create_ext (
 	uint8_t coef
 );
 
+CefT_Hash_Handle
+cef_lhash_tbl_create_with_alg (
+	uint32_t table_size,
+	uint8_t coef,
+	int alg
+);
+
 CefT_Hash_Handle
 cef_lhash_tbl_create_u32 (
 	uint32_t table_size
@@ -248,6 +309,12 @@ cef_lhash_tbl_create_u32_ext (
 	uint8_t coef
 );
 
+CefT_Hash_Handle
+cef_lhash_tbl_create_resizable (
+	uint32_t table_size,
+	uint8_t coef
+);
+
 void
 cef_lhash_tbl_destroy (
 	CefT_Hash_Handle handle
@@ -288,6 +355,11 @@ cef_lhash_tbl_item_max_idx_get (
 	CefT_Hash_Handle handle
 );
 
+int
+cef_lhash_tbl_capacity_get (
+	CefT_Hash_Handle handle
+);
+
 void*
 cef_lhash_tbl_elem_get (
 	CefT_Hash_Handle handle,
@@ -332,4 +404,75 @@ cef_lhash_tbl_item_check_exact (
 	uint32_t klen
 );
 //----- 0.9.0b : 2022.07.11
+int
+cef_lhash_tbl_item_set_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv,
+	void* elem
+);
+void*
+cef_lhash_tbl_item_get_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+);
+void*
+cef_lhash_tbl_item_remove_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+);
+
+/*--------------------------------------------------------------------------------------
+	Returns the hash function of the specified algorithm
+----------------------------------------------------------------------------------------*/
+CefT_Hash_Func
+cef_hash_func_get (
+	int alg
+);
+/*--------------------------------------------------------------------------------------
+	Returns the per-process seed shared by the hash tables
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_hash_seed_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Creates the hash value of the key with the default algorithm and the process seed
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_hash_key_hashv_create (
+	const unsigned char* key,
+	uint32_t klen
+);
+/*--------------------------------------------------------------------------------------
+	Creates the hash values of the prefixes of the key in one pass. The i-th value
+	is the same as cef_hash_key_hashv_create (key, ends[i]).
+----------------------------------------------------------------------------------------*/
+void
+cef_hash_key_prefix_hashv_create (
+	const unsigned char* key,
+	const uint16_t ends[],					/* lengths of the prefixes in ascending order	*/
+	uint32_t hashv[],						/* set the hash value of each prefix 		*/
+	int num									/* number of the prefixes 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns the number of the keys hashed by the calling thread
+----------------------------------------------------------------------------------------*/
+uint64_t
+cef_hash_count_get (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Sets the water marks (load factor in percent) of the resizable tables
+----------------------------------------------------------------------------------------*/
+void
+cef_hash_water_mark_set (
+	uint32_t high,
+	uint32_t low
+);
 #endif // __CEF_HASH_HEADER__
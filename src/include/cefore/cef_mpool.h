@@ -40,6 +40,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 #include <cefore/cef_define.h>
@@ -54,13 +55,25 @@
 /****************************************************************************************
  Macros
  ****************************************************************************************/
-
+#define CefC_Mp_Pool_Max			64		/* Max number of the memory pools 			*/
 
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 typedef size_t CefT_Mp_Handle;
 
+/*
+ * Statistics of a memory pool.
+ */
+typedef struct CefT_Mp_Stat {
+	char 					key[32];		/* key of the memory pool 					*/
+	size_t					size;			/* size of one memory block 				*/
+	uint64_t 				total;			/* number of the pooled blocks 				*/
+	uint64_t 				in_use;			/* number of the allocated blocks 			*/
+	uint64_t 				high_water;		/* max number of the blocks taken out of 	*/
+											/* the global depot 						*/
+} CefT_Mp_Stat;
+
 /****************************************************************************************
  Function declaration
  ****************************************************************************************/
@@ -86,4 +99,13 @@ cef_mpool_free (
 	CefT_Mp_Handle ph,
 	void* ptr
 );
+
+/*
+ * Obtains the statistics of the memory pools in this process.
+ */
+int 										/* number of the pools set to stats 		*/
+cef_mpool_stat_get (
+	CefT_Mp_Stat stats[],
+	int max
+);
 #endif // __CEF_MPOOL_HEADER__
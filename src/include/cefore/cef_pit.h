@@ -56,6 +56,17 @@
 											/* registered in 1 Down Face Entry (other than AnyVer) */
 
 #define	CefC_Pit_CleaningTime		1000000U
+
+#define CefC_Pit_Inline_DnFace_Num		4	/* Down Face entries embedded in a PIT entry	*/
+#define CefC_Pit_Inline_UpFace_Num		2	/* Up Face entries embedded in a PIT entry		*/
+#define CefC_Pit_Inline_Name_Len		128	/* Names up to this length are stored in the	*/
+											/* PIT entry itself 							*/
+#define CefC_Pit_Slab_Increment			256	/* Number of objects allocated at one time		*/
+
+#define CefC_Pit_Tw_Tick_Us				1000	/* Resolution of the PIT timing wheel (usec)*/
+#define CefC_Pit_Tw_Bits				8		/* log2 of slots in 1 level of the wheel	*/
+#define CefC_Pit_Tw_Slot_Num			(1 << CefC_Pit_Tw_Bits)
+#define CefC_Pit_Tw_Level_Num			4		/* Levels of the wheel						*/
 #define	CefC_Pit_WithoutLOCK	0
 #define	CefC_Pit_WithLOCK		(~CefC_Pit_WithoutLOCK)
 
@@ -116,9 +127,7 @@ typedef struct CefT_Up_Faces {
 /* PIT entry														*/
 /*------------------------------------------------------------------*/
 
-typedef struct {
-
-	unsigned char 		resv4malloc[16];	/* reserved area for malloc					*/
+typedef struct CefT_Pit_Entry {
 
 	unsigned char* 		key;				/* Key of the PIT entry 					*/
 	unsigned int 		klen;				/* Length of this key 						*/
@@ -146,8 +155,40 @@ typedef struct {
 #ifdef	CefC_PitEntryMutex
 	pthread_mutex_t 	pe_mutex_pt;		/* mutex for thread safe for Pthread 		*/
 #endif	// CefC_PitEntryMutex
+
+	/*--------------------------------------------
+		Inline storage. Face entries are taken from these slots first and
+		spill to the slab only when the slots are used up.
+	----------------------------------------------*/
+	uint8_t				dnface_slot_num;	/* Number of used Down Face slots 			*/
+	uint8_t				upface_slot_num;	/* Number of used Up Face slots 			*/
+	CefT_Down_Faces		dnface_slot[CefC_Pit_Inline_DnFace_Num];
+	CefT_Up_Faces		upface_slot[CefC_Pit_Inline_UpFace_Num];
+
+	/*--------------------------------------------
+		Timing wheel which expires the entry
+	----------------------------------------------*/
+	struct CefT_Pit_Entry* tw_next;			/* next entry in the same slot 				*/
+	struct CefT_Pit_Entry* tw_prev;			/* previous entry in the same slot 			*/
+	uint64_t			tw_expire;			/* tick at which the entry expires 			*/
+	uint16_t			tw_slot;			/* slot index + 1, 0 if not scheduled 		*/
+	uint8_t				tw_enabled;			/* set if the wheel drives this entry 		*/
+
+	unsigned char		key_buf[CefC_Pit_Inline_Name_Len];
 } CefT_Pit_Entry;
 
+/*------------------------------------------------------------------*/
+/* Statistics of the PIT slab allocator								*/
+/*------------------------------------------------------------------*/
+
+typedef struct {
+	uint64_t			entry_num;			/* PIT entries in use 						*/
+	uint64_t			entry_pooled;		/* PIT entries allocated by the slab 		*/
+	uint64_t			dnface_spill_num;	/* Down Face entries outside of the slots 	*/
+	uint64_t			upface_spill_num;	/* Up Face entries outside of the slots 	*/
+	uint64_t			name_spill_num;		/* Names longer than the inline buffer 		*/
+} CefT_Pit_Slab_Stat;
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -356,6 +397,49 @@ cef_pit_entry_up_face_search (
 	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
 	uint16_t faceid 						/* Face-ID									*/
 );
+/*--------------------------------------------------------------------------------------
+	Initializes the timing wheel which expires the entries of the specified PIT
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_init (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec) 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Schedules the specified PIT entry at the earliest lifetime of its Down Faces
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_schedule (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes the specified PIT entry from the timing wheel
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_cancel (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Advances the timing wheel and returns one of the expired PIT entries
+----------------------------------------------------------------------------------------*/
+CefT_Pit_Entry* 							/* expired entry, or NULL if none remains	*/
+cef_pit_timer_expired_get (
+	uint64_t nowt							/* current time (usec) 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the time at which cef_pit_timer_expired_get should be called next
+----------------------------------------------------------------------------------------*/
+uint64_t 									/* time (usec), UINT64_MAX if no entry 		*/
+cef_pit_timer_next_get (
+	uint64_t nowt							/* current time (usec) 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the PIT slab allocator
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_slab_stat_get (
+	CefT_Pit_Slab_Stat* stat				/* statistics to return						*/
+);
 /*--------------------------------------------------------------------------------------
 	Lock/Unlock the specified PIT entry
 ----------------------------------------------------------------------------------------*/
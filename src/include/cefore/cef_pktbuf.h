@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_pktbuf.h
+ */
+
+#ifndef __CEF_PKTBUF_HEADER__
+#define __CEF_PKTBUF_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/****************************************************************************************
+ Structure Declarations
+ ****************************************************************************************/
+
+/***** Packet buffer shared by the Faces, the Content Store and the csmgrd upload *****/
+/* The message is never rewritten once the buffer is created. The bytes which differ */
+/* for each Face are sent from the buffer of the Face before the message. 			*/
+typedef struct {
+
+	uint32_t 		refcnt;							/* Holders of the buffer 			*/
+	uint16_t 		len;							/* Length of the message 			*/
+	unsigned char 	data[];							/* Message 							*/
+
+} CefT_Pktbuf;
+
+/****************************************************************************************
+ Global Variables
+ ****************************************************************************************/
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the packet buffer which holds the copy of the message
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* Created buffer (the caller holds it) 	*/
+cef_pktbuf_create (
+	const unsigned char* msg,				/* Message 									*/
+	uint16_t len							/* Length of the message 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Adds the holder of the packet buffer
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* The specified buffer 					*/
+cef_pktbuf_ref (
+	CefT_Pktbuf* pb							/* Packet buffer 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes the holder of the packet buffer, and frees it if it is the last one
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_unref (
+	CefT_Pktbuf* pb							/* Packet buffer, or NULL 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Sets the message which is being handled by cefnetd
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_cur_set (
+	const unsigned char* msg,				/* Message in the receive buffer 			*/
+	uint16_t len							/* Length of the message 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the message set by cef_pktbuf_cur_set
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_cur_clear (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the packet buffer to keep the message after the caller returns.
+	All the holders of the message being handled share one copy of it.
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* Packet buffer (the caller holds it), 	*/
+											/* or NULL if it fails 						*/
+cef_pktbuf_cur_ref (
+	const unsigned char* msg,				/* Message 									*/
+	uint16_t len							/* Length of the message 					*/
+);
+
+#endif // __CEF_PKTBUF_HEADER__
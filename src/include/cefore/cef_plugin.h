@@ -46,6 +46,7 @@
 #include <cefore/cef_fib.h>
 #include <cefore/cef_pit.h>
 #include <cefore/cef_face.h>
+#include <cefore/cef_pktbuf.h>
 
 /****************************************************************************************
  Macros
@@ -158,8 +159,8 @@ typedef struct {
 													/* header relating to this plugin	*/
 													/* valiant 							*/
 	uint16_t 				ophdr_len;				/* length of ophder value field 	*/
-	unsigned char			msg[CefC_Max_Msg_Size];
-													/* message 							*/
+	unsigned char*			msg;					/* message, which is valid only 	*/
+													/* during the callback 				*/
 	uint16_t 				msg_len;				/* length of the message 			*/
 	uint16_t 				out_faceids[CefC_Elem_Face_Num];
 													/* outgoing FaceIDs that were 		*/
@@ -181,9 +182,8 @@ typedef struct {
 typedef struct {
 
 	int 			type;							/* CefC_Elem_Type_XXX 				*/
-	unsigned char	msg[CefC_Max_Msg_Size]; 		/* message 							*/
+	CefT_Pktbuf* 	pb; 							/* message, which the element holds	*/
 
-	uint16_t 		msg_len;						/* length of the message 			*/
 	uint16_t 		faceids[CefC_Elem_Face_Num];	/* outgoing FaceIDs that were 		*/
 													/* searched from PIT/FIB 			*/
 	int				faceid_num;						/* number of outgoing FaceID		*/
@@ -38,12 +38,18 @@
  ****************************************************************************************/
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <pthread.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
+#define CefC_Rngque_Cache_Line		64		/* Size of cache line (bytes) 				*/
+
+/*----- Producers of Ring Queue -----*/
+#define CefC_Rngque_Mode_Spsc		0		/* Single producer and single consumer 		*/
+#define CefC_Rngque_Mode_Mpsc		1		/* Multiple producers and single consumer 	*/
 
 /****************************************************************************************
  Structure Declarations
@@ -55,15 +61,26 @@ typedef struct {
 
 } CefT_Rngque_Elem;
 
-/********** Tx queue (ring buffer) 	**********/
+/********** Tx queue (lock-free ring buffer) 	**********/
+/* The indexes run freely and are masked when the elements are accessed. Each	*/
+/* side is placed in its own cache line not to bounce the line between cores. 	*/
 typedef struct {
 
-	int top;						/* top of the ring buffer 							*/
-	int bottom;						/* bottom of the ring buffer 						*/
-	int mask;						/* capacity of the ring buffer 						*/
+	/*----- Consumer side -----*/
+	volatile uint32_t top			/* top of the ring buffer 							*/
+		__attribute__ ((aligned (CefC_Rngque_Cache_Line)));
+
+	/*----- Producer side -----*/
+	volatile uint32_t bottom		/* bottom of the ring buffer (published) 			*/
+		__attribute__ ((aligned (CefC_Rngque_Cache_Line)));
+	volatile uint32_t reserve;		/* bottom reserved by the producers (MPSC only) 	*/
+
+	/*----- Read only -----*/
+	uint32_t mask					/* capacity of the ring buffer - 1 					*/
+		__attribute__ ((aligned (CefC_Rngque_Cache_Line)));
+	int mode;						/* CefC_Rngque_Mode_XXX 							*/
 	CefT_Rngque_Elem* que;			/* line buffer 										*/
-	pthread_mutex_t mutex;			/* mutex for thread safe 							*/
-	
+
 } CefT_Rngque;
 
 /****************************************************************************************
@@ -76,16 +93,27 @@ typedef struct {
  Function Declarations
  ****************************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue which multiple threads can push to
+----------------------------------------------------------------------------------------*/
 CefT_Rngque* 								/* Created Ring Queue Information 			*/
 cef_rngque_create (
 	int capacity							/* Capacity of Ring queue 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue with the specified mode
+----------------------------------------------------------------------------------------*/
+CefT_Rngque* 								/* Created Ring Queue Information 			*/
+cef_rngque_create_with_mode (
+	int capacity,							/* Capacity of Ring queue 					*/
+	int mode								/* CefC_Rngque_Mode_XXX 					*/
+);
 void
 cef_rngque_destroy (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 );
 
-int
+int											/* 1 if pushed, 0 if the queue is full 		*/
 cef_rngque_push (
 	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
 	void* item
@@ -95,6 +123,15 @@ void*										/* item which is removed from queue 		*/
 cef_rngque_pop (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Removes the items from the top of Ring Queue at once
+----------------------------------------------------------------------------------------*/
+int											/* number of the removed items 				*/
+cef_rngque_pop_bulk (
+	CefT_Rngque* qp,						/* Ring Queue Information 					*/
+	void* items[],							/* buffer to set the removed items 			*/
+	int max									/* size of items 							*/
+);
 /*--------------------------------------------------------------------------------------
 	Read the value (int) from the top of Ring Queue
 ----------------------------------------------------------------------------------------*/
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_shmring.h
+ */
+
+#ifndef __CEF_SHMRING_HEADER__
+#define __CEF_SHMRING_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#ifdef __linux__
+#define CefC_Shmring_Enable
+#endif // __linux__
+
+#define CefC_Shmring_Cache_Line		64			/* Size of cache line (bytes) 			*/
+#define CefC_Shmring_Magic			0x43455352	/* "CESR" 								*/
+#define CefC_Shmring_Size_Min		65536		/* Lower limit of LOCAL_SHM_SIZE 		*/
+#define CefC_Shmring_Size_Max		67108864	/* Upper limit of LOCAL_SHM_SIZE 		*/
+#define CefC_Shmring_Fd_Num			3			/* memfd, eventfds of app and cefnetd	*/
+
+/*----- Messages to negotiate the ring over the local socket -----*/
+#define CefC_Shmring_Req			"/SHM:Attach"
+#define CefC_Shmring_Ack			"/SHM:Attached"
+#define CefC_Shmring_Nak			"/SHM:Refused"
+
+/*----- Sides of the connection -----*/
+#define CefC_Shmring_Side_App		0			/* writes ring 0 and reads ring 1 		*/
+#define CefC_Shmring_Side_Netd		1			/* writes ring 1 and reads ring 0 		*/
+
+/****************************************************************************************
+ Structure Declarations
+ ****************************************************************************************/
+
+/********** Control of a ring in the shared memory 	**********/
+/* Each ring is a byte stream from one writer to one reader, which replaces the	*/
+/* local socket. The offsets run freely and are wrapped by the size of the ring.	*/
+typedef struct {
+
+	/*----- Writer side -----*/
+	volatile uint64_t head			/* offset written next 								*/
+		__attribute__ ((aligned (CefC_Shmring_Cache_Line)));
+	volatile uint32_t full_f;		/* the writer waits for the free space 				*/
+
+	/*----- Reader side -----*/
+	volatile uint64_t tail			/* offset read next 								*/
+		__attribute__ ((aligned (CefC_Shmring_Cache_Line)));
+
+} CefT_Shmring_Ctrl;
+
+/********** Header of the shared memory 	**********/
+typedef struct {
+
+	uint32_t 			magic;
+	uint32_t 			size;		/* size of each ring (bytes) 						*/
+	CefT_Shmring_Ctrl 	ring[2]		/* 0: app to cefnetd, 1: cefnetd to app 			*/
+		__attribute__ ((aligned (CefC_Shmring_Cache_Line)));
+
+} CefT_Shmring_Hdr;
+
+/********** Ring pair mapped by one side 	**********/
+typedef struct {
+
+	CefT_Shmring_Hdr* 	hdr;
+	size_t 				map_len;
+	CefT_Shmring_Ctrl* 	tx;			/* ring this side writes 							*/
+	CefT_Shmring_Ctrl* 	rx;			/* ring this side reads 							*/
+	unsigned char* 		tx_data;
+	unsigned char* 		rx_data;
+	uint32_t 			size;
+	int 				efd;		/* eventfd which wakes up this side 				*/
+	int 				peer_efd;	/* eventfd which wakes up the peer 					*/
+
+} CefT_Shmring;
+
+/****************************************************************************************
+ Global Variables
+ ****************************************************************************************/
+
+
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the ring pair in the shared memory (app side)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* created ring pair, or NULL 				*/
+cef_shmring_create (
+	uint32_t size,							/* size of each ring (bytes) 				*/
+	int fds[]								/* set the FDs to pass to cefnetd 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Maps the ring pair created by the app (cefnetd side)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* mapped ring pair, or NULL 				*/
+cef_shmring_attach (
+	int fds[]								/* FDs received from the app 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Checks the FDs passed by the app before mapping them (cefnetd side)
+----------------------------------------------------------------------------------------*/
+int											/* 1 if the FDs can be attached 			*/
+cef_shmring_fds_check (
+	int fds[]								/* FDs received from the app 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Unmaps the ring pair and closes its eventfds
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_destroy (
+	CefT_Shmring* sr						/* ring pair 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Writes the bytes to the ring
+----------------------------------------------------------------------------------------*/
+int											/* written bytes, 0 if the ring is full 	*/
+cef_shmring_write (
+	CefT_Shmring* sr,						/* ring pair 								*/
+	const unsigned char* msg,				/* bytes to write 							*/
+	int len									/* length of the bytes 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Reads the bytes from the ring
+----------------------------------------------------------------------------------------*/
+int											/* read bytes, 0 if the ring is empty 		*/
+cef_shmring_read (
+	CefT_Shmring* sr,						/* ring pair 								*/
+	unsigned char* buff,					/* buffer to set the bytes 					*/
+	int len									/* size of the buffer 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the bytes written but not read by the peer yet
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* bytes in the ring this side writes 		*/
+cef_shmring_tx_pending (
+	CefT_Shmring* sr						/* ring pair 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Clears the wakeup of this side. The rings have to be checked again after this.
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_wakeup_clear (
+	CefT_Shmring* sr						/* ring pair 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Wakes up this side, when it stops reading before the ring becomes empty
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_wakeup_self (
+	CefT_Shmring* sr						/* ring pair 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the message with the FDs over the local socket
+----------------------------------------------------------------------------------------*/
+int											/* sent bytes, or a negative value 			*/
+cef_shmring_fds_send (
+	int sock,								/* local socket 							*/
+	const void* msg,						/* message to send 							*/
+	int len,								/* length of the message 					*/
+	int fds[],								/* FDs to pass 								*/
+	int fd_num								/* number of the FDs 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Receives the message and the FDs passed with it from the local socket
+----------------------------------------------------------------------------------------*/
+int											/* received bytes, as recv 					*/
+cef_shmring_fds_recv (
+	int sock,								/* local socket 							*/
+	void* buff,								/* buffer to set the message 				*/
+	int len,								/* size of the buffer 						*/
+	int fds[],								/* set the passed FDs 						*/
+	int* fd_num								/* set the number of the passed FDs 		*/
+);
+
+#endif // __CEF_SHMRING_HEADER__
@@ -38,15 +38,40 @@
  ****************************************************************************************/
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
+#define CefC_Valid_Pool_Thread_Max	32		/* Max threads of the sign/verify pool 		*/
+
+/*----- Kernels of cef_valid_crc32_calc 	-----*/
+#define CefC_Valid_Crc_Kernel_Byte		0		/* byte-at-a-time table (reference) 	*/
+#define CefC_Valid_Crc_Kernel_Sb8		1		/* slicing-by-8 						*/
+#define CefC_Valid_Crc_Kernel_Pclmul	2		/* PCLMUL folding 						*/
+
 /****************************************************************************************
  Structure Declarations
  ****************************************************************************************/
 
+/********** Statistics of the signature verification 	**********/
+typedef struct {
+	uint64_t 		verify_num;				/* RSA-SHA256 verifications 				*/
+	uint64_t 		verify_ok;				/* verifications which succeeded 			*/
+	uint64_t 		verify_per_sec;			/* verifications in the last second 		*/
+	uint64_t 		key_cache_hit;			/* public keys found in the cache 			*/
+	uint64_t 		key_cache_miss;			/* public keys decoded 						*/
+} CefT_Valid_Stat;
+
+/********** Message which is signed or verified in a batch 	**********/
+typedef struct {
+	unsigned char* 	msg;					/* message (starts with the fixed header) 	*/
+	int 			msg_len;				/* length of the message 					*/
+	int 			res;					/* result of cef_valid_msg_sign or 			*/
+											/* cef_valid_msg_verify 					*/
+} CefT_Valid_Job;
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -80,6 +105,16 @@ cef_valid_crc32_calc (
 	const unsigned char* buf,
 	size_t len
 );
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32 with the specified kernel, so that the kernels can be compared
+----------------------------------------------------------------------------------------*/
+int 										/* -1 if the kernel is not available 		*/
+cef_valid_crc32_calc_with_kernel (
+	int kernel,								/* CefC_Valid_Crc_Kernel_XXX 				*/
+	const unsigned char* buf,
+	size_t len,
+	uint32_t* crc							/* calculated CRC32 						*/
+);
 int
 cef_valid_get_pubkey (
 	const unsigned char* msg,
@@ -107,6 +142,48 @@ cef_valid_msg_verify (
 	const unsigned char* msg,
 	int msg_len
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the length of the signature created with the key for the name
+----------------------------------------------------------------------------------------*/
+int 								/* length of the signature, 0 if no key 			*/
+cef_valid_sign_len_get (
+	const unsigned char* name,
+	int name_len
+);
+/*--------------------------------------------------------------------------------------
+	Sets the signature into the Validation Payload reserved by the deferred signing
+	(see cef_frame_sign_defer_set)
+----------------------------------------------------------------------------------------*/
+int 								/* 1 if signed, otherwise 0 						*/
+cef_valid_msg_sign (
+	unsigned char* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	Starts the threads which sign or verify the messages of a batch
+----------------------------------------------------------------------------------------*/
+int 								/* number of the started threads, or -1 			*/
+cef_valid_pool_init (
+	int thread_num
+);
+void
+cef_valid_pool_destroy (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Signs or verifies the messages of a batch with the thread pool. The result of
+	each message is set to jobs[n].res, so the results are in the order of jobs.
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_batch_sign (
+	CefT_Valid_Job jobs[],
+	int job_num
+);
+void
+cef_valid_batch_verify (
+	CefT_Valid_Job jobs[],
+	int job_num
+);
 
 int
 cef_valid_keyid_create_forccninfo (
@@ -139,6 +216,13 @@ cef_valid_remove_valdsegs_fr_msg_forccninfo (
 	const unsigned char* msg,
 	int msg_len
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the signature verification
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_stat_get (
+	CefT_Valid_Stat* stat
+);
 
 
 #endif // __CEF_VALID_HEADER__
@@ -48,11 +48,17 @@
 #include <cefore/cef_face.h>
 #include <cefore/cef_frame.h>
 #include <cefore/cef_log.h>
+#include <cefore/cef_valid.h>
+#include <cefore/cef_shmring.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
+#define CefC_Client_Sign_Batch		256		/* messages passed to cef_valid at once 	*/
+#define CefC_Client_Shm_Wait		1000	/* Waits for cefnetd on the ring (msec) 	*/
+#define CefC_Client_Shm_Drain_Max	1000	/* Waits for cefnetd to read the ring at 	*/
+											/* close (msec) 							*/
 
 /****************************************************************************************
  Structures Declaration
@@ -72,6 +78,7 @@ static char cbd_lsock_name[2048] = {"/tmp/cbd_9896.0"};
 static char cef_conf_dir[PATH_MAX*2] = {"/usr/local/cefore"};
 static int  cef_port_num = CefC_Default_PortNum;
 static unsigned char* work_buff = NULL;
+static int  cef_shm_size = CefC_Default_LocalShmSize;
 
 /****************************************************************************************
  Static Function Declaration
@@ -86,6 +93,32 @@ cef_client_trim_line_string (
 	char* p2,									/* name string after trimming			*/
 	char* p3									/* value string after trimming			*/
 );
+/*--------------------------------------------------------------------------------------
+	Asks cefnetd to exchange the messages by the shared memory ring
+----------------------------------------------------------------------------------------*/
+static void
+cef_client_shmring_negotiate (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Writes the message to the shared memory ring
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cef_client_shmring_send (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	const unsigned char* msg,					/* message 								*/
+	size_t len									/* length of message 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Reads the message from the shared memory ring or the socket
+----------------------------------------------------------------------------------------*/
+static int										/* length of read buffer 				*/
+cef_client_shmring_recv (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	unsigned char* buff, 						/* buffer to write the message 			*/
+	int len, 									/* length of buffer 					*/
+	int timeout									/* timeout of poll (msec) 				*/
+);
 
 
 /****************************************************************************************
@@ -164,6 +197,13 @@ cef_client_init (
 			}
 		} else if (strcmp (pname, CefC_ParamName_LocalSockId) == 0) {
 			strcpy (lsock_id, ws);
+		} else if (strcmp (pname, CefC_ParamName_LocalShmSize) == 0) {
+			/* cefnetd rejects the wrong value, so the ring is not used here 	*/
+			res = atoi (ws);
+			if ((res < CefC_Shmring_Size_Min) || (res > CefC_Shmring_Size_Max)) {
+				res = 0;
+			}
+			cef_shm_size = res;
 		}
 	}
 	if (port_num == CefC_Unset_Port) {
@@ -295,6 +335,10 @@ cef_client_connect (
 	memset (conn, 0, sizeof (CefT_Connect));
 	conn->sock = sock;
 
+	if (cef_shm_size > 0) {
+		cef_client_shmring_negotiate (conn);
+	}
+
 	return ((CefT_Client_Handle) conn);
 }
 CefT_Client_Handle 								/* created client handle 				*/
@@ -501,12 +545,21 @@ cef_client_close (
 	CefT_Client_Handle fhdl 					/* client handle to be destroyed 		*/
 ) {
 	CefT_Connect* conn = (CefT_Connect*) fhdl;
+	int i;
 
 	if (conn->ai) {
 		free (conn);
 	} else {
+		if (conn->shm) {
+			/* Lets cefnetd read the rest of the ring before the face is closed */
+			for (i = 0 ; (i < CefC_Client_Shm_Drain_Max) &&
+						(cef_shmring_tx_pending (conn->shm) > 0) ; i++) {
+				usleep (1000);
+			}
+		}
 		send (conn->sock, CefC_Face_Close, strlen (CefC_Face_Close), 0);
 		close (conn->sock);
+		cef_shmring_destroy (conn->shm);
 		free (conn);
 	}
 	if (work_buff) {
@@ -552,6 +605,8 @@ cef_client_name_reg (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 					, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -595,6 +650,8 @@ cef_client_prefix_reg (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 					, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -638,6 +695,8 @@ cef_client_prefix_reg_for_pit (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 					, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -660,6 +719,10 @@ cef_client_message_input (
 		if (conn->ai) {
 			sendto (conn->sock, msg, len
 					, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if ((conn->shm) && (msg[0] == CefC_Version)) {
+			/* Only the CCNx frames go through the ring, cefnetd handles the 	*/
+			/* control messages (e.g. /CTRL) on the socket 						*/
+			return (cef_client_shmring_send (conn, msg, len));
 		} else {
 #if 0
 			slen = send (conn->sock, msg, len, 0);
@@ -723,6 +786,61 @@ RSEND:;
 	return (1);
 }
 
+/*--------------------------------------------------------------------------------------
+	Sets the deferred signatures of the Content Objects in the buffer. The messages
+	are signed in parallel by the threads started with cef_valid_pool_init.
+----------------------------------------------------------------------------------------*/
+int												/* number of the signed messages, or 	*/
+												/* -1 if any message is not signed 		*/
+cef_client_objects_sign (
+	unsigned char* msg,							/* Content Objects created while 		*/
+												/* cef_frame_set_sign_defer_f is set 	*/
+	size_t len									/* length of the messages 				*/
+) {
+	CefT_Valid_Job jobs[CefC_Client_Sign_Batch];
+	struct fixed_hdr* fixed_hp;
+	uint16_t pkt_len;
+	size_t index = 0;
+	int job_num = 0;
+	int signed_num = 0;
+	int fail_f = 0;
+	int i;
+
+	while ((index < len) || (job_num > 0)) {
+		if (index + CefC_S_Fix_Header <= len) {
+			fixed_hp = (struct fixed_hdr*) &msg[index];
+			pkt_len = ntohs (fixed_hp->pkt_len);
+			if ((pkt_len < CefC_S_Fix_Header) || (index + pkt_len > len)) {
+				fail_f = 1;
+				index = len;
+			} else {
+				jobs[job_num].msg 		= &msg[index];
+				jobs[job_num].msg_len 	= pkt_len;
+				jobs[job_num].res 		= 0;
+				job_num++;
+				index += pkt_len;
+				if (job_num < CefC_Client_Sign_Batch) {
+					continue;
+				}
+			}
+		} else {
+			index = len;
+		}
+		cef_valid_batch_sign (jobs, job_num);
+
+		for (i = 0 ; i < job_num ; i++) {
+			if (jobs[i].res == 1) {
+				signed_num++;
+			} else {
+				fail_f = 1;
+			}
+		}
+		job_num = 0;
+	}
+
+	return (fail_f ? -1 : signed_num);
+}
+
 /*--------------------------------------------------------------------------------------
 	Inputs the interest to the cefnetd
 ----------------------------------------------------------------------------------------*/
@@ -741,6 +859,8 @@ cef_client_interest_input (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 					, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -772,6 +892,8 @@ cef_client_object_input (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 				, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -800,6 +922,8 @@ cef_client_ccninfo_input (
 		if (conn->ai) {
 			sendto (conn->sock, buff, len
 				, 0, conn->ai->ai_addr, conn->ai->ai_addrlen);
+		} else if (conn->shm) {
+			cef_client_shmring_send (conn, buff, len);
 		} else {
 			send (conn->sock, buff, len, 0);
 		}
@@ -823,6 +947,9 @@ cef_client_read (
 	struct sockaddr_storage sas;
 	socklen_t sas_len = (socklen_t) sizeof (struct sockaddr_storage);
 
+	if (conn->shm) {
+		return (cef_client_shmring_recv (conn, buff, len, 1000));
+	}
 	infds[0].fd = conn->sock;
 	infds[0].events = POLLIN | POLLERR;
 
@@ -866,6 +993,9 @@ cef_client_read2 (
 	struct sockaddr_storage sas;
 	socklen_t sas_len = (socklen_t) sizeof (struct sockaddr_storage);
 
+	if (conn->shm) {
+		return (cef_client_shmring_recv (conn, buff, len, 1));
+	}
 	infds[0].fd = conn->sock;
 	infds[0].events = POLLIN | POLLERR;
 
@@ -1226,16 +1356,20 @@ cef_client_present_timeus_calc (
 ) {
 	struct timeval t;
 
+	uint64_t now;
+
 	gettimeofday (&t, NULL);
-	nowtus = t.tv_sec * 1000000llu + t.tv_usec;
+	now = t.tv_sec * 1000000llu + t.tv_usec;
+	/* cefnetd workers update the time too 	*/
+	__atomic_store_n (&nowtus, now, __ATOMIC_RELAXED);
 
-	return (nowtus);
+	return (now);
 }
 uint64_t
 cef_client_present_timeus_get (
 	void
 ) {
-	return (nowtus);
+	return (__atomic_load_n (&nowtus, __ATOMIC_RELAXED));
 }
 
 uint64_t
@@ -1266,6 +1400,130 @@ cef_client_ntohb (
 	return (cef_frame_htonb (x));
 }
 
+/*--------------------------------------------------------------------------------------
+	Asks cefnetd to exchange the messages by the shared memory ring
+----------------------------------------------------------------------------------------*/
+static void
+cef_client_shmring_negotiate (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+) {
+	CefT_Shmring* sr;
+	int fds[CefC_Shmring_Fd_Num];
+	unsigned char buff[64];
+	struct pollfd pfd;
+	int len;
+
+	sr = cef_shmring_create ((uint32_t) cef_shm_size, fds);
+	if (sr == NULL) {
+		return;
+	}
+	len = cef_shmring_fds_send (conn->sock, CefC_Shmring_Req,
+				(int) strlen (CefC_Shmring_Req), fds, CefC_Shmring_Fd_Num);
+
+	/* cefnetd maps the memory with the passed FD 	*/
+	close (fds[0]);
+
+	if (len > 0) {
+		/* The socket is used as before if cefnetd does not answer 	*/
+		pfd.fd 		= conn->sock;
+		pfd.events 	= POLLIN;
+		pfd.revents = 0;
+		if (poll (&pfd, 1, CefC_Client_Shm_Wait) > 0) {
+			len = recv (conn->sock, buff, sizeof (buff), 0);
+			if ((len == (int) strlen (CefC_Shmring_Ack)) &&
+				(memcmp (buff, CefC_Shmring_Ack, len) == 0)) {
+				conn->shm = sr;
+				return;
+			}
+		}
+	}
+	cef_log_write (CefC_Log_Info, "[client] Uses the local socket instead of the ring\n");
+	cef_shmring_destroy (sr);
+}
+/*--------------------------------------------------------------------------------------
+	Writes the message to the shared memory ring
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cef_client_shmring_send (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	const unsigned char* msg,					/* message 								*/
+	size_t len									/* length of message 					*/
+) {
+	struct pollfd fds[2];
+	int cleared_f = 0;
+	int res;
+
+	while (len > 0) {
+		res = cef_shmring_write (conn->shm, msg, (int) len);
+		if (res > 0) {
+			msg += res;
+			len -= (size_t) res;
+			continue;
+		}
+		/* cefnetd may free the space before the wakeup is cleared, so the ring 	*/
+		/* is checked once more before waiting 										*/
+		if (cleared_f == 0) {
+			cef_shmring_wakeup_clear (conn->shm);
+			cleared_f = 1;
+			continue;
+		}
+		cleared_f = 0;
+
+		/* Waits until cefnetd frees the space of the ring 		*/
+		fds[0].fd 		= conn->shm->efd;
+		fds[0].events 	= POLLIN;
+		fds[1].fd 		= conn->sock;
+		fds[1].events 	= POLLERR;
+		fds[0].revents 	= 0;
+		fds[1].revents 	= 0;
+		res = poll (fds, 2, CefC_Client_Shm_Wait);
+		if ((res <= 0) || (fds[1].revents & (POLLERR | POLLHUP | POLLNVAL))) {
+			cef_log_write (CefC_Log_Warn,
+				"%s(%u) cefnetd does not read the ring\n", __func__, __LINE__);
+			return (-1);
+		}
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Reads the message from the shared memory ring or the socket
+----------------------------------------------------------------------------------------*/
+static int										/* length of read buffer 				*/
+cef_client_shmring_recv (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	unsigned char* buff, 						/* buffer to write the message 			*/
+	int len, 									/* length of buffer 					*/
+	int timeout									/* timeout of poll (msec) 				*/
+) {
+	struct pollfd fds[2];
+	int res;
+
+	res = cef_shmring_read (conn->shm, buff, len);
+	if (res > 0) {
+		return (res);
+	}
+	cef_shmring_wakeup_clear (conn->shm);
+	res = cef_shmring_read (conn->shm, buff, len);
+	if (res > 0) {
+		return (res);
+	}
+
+	fds[0].fd 		= conn->shm->efd;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= conn->sock;
+	fds[1].events 	= POLLIN | POLLERR;
+	fds[0].revents 	= 0;
+	fds[1].revents 	= 0;
+	poll (fds, 2, timeout);
+
+	/* cefnetd answers the control messages by the socket 	*/
+	if (fds[1].revents != 0) {
+		return (recv (conn->sock, buff, len, 0));
+	}
+
+	return (cef_shmring_read (conn->shm, buff, len));
+}
 /*--------------------------------------------------------------------------------------
 	Trims the string buffer read from the config file
 ----------------------------------------------------------------------------------------*/
@@ -64,18 +64,35 @@ uint32_t bchunk = 0xFFFF;
 
 #define	DEMO_RETRY_NUM	10
 
+/*----- Upload Requests to csmgrd -----*/
+#define CefC_Csmgr_Upload_Max		256		/* Requests sent by one sendmsg 			*/
+#define CefC_Csmgr_Upload_Que_Size	64		/* Batches waiting for the sender thread	*/
+#define CefC_Csmgr_Upload_Meta_Size	(BUFF_SIZE + CefC_Max_Length)
+
 
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** Upload Requests which are sent to csmgrd at once 	*****/
+/* Each request is sent with three iovecs; the fields before the Cob, the Cob shared	*/
+/* with the Faces and the Content Store, and the fields after the Cob. 				*/
+typedef struct {
+	int 			num;								/* Number of the requests 		*/
+	int 			len;								/* Length of the requests 		*/
+	int 			meta_len;							/* Used length of meta 			*/
+	CefT_Pktbuf* 	pbs[CefC_Csmgr_Upload_Max];			/* Cobs of the requests 		*/
+	struct iovec 	iov[CefC_Csmgr_Upload_Max * 3];
+	unsigned char 	meta[CefC_Csmgr_Upload_Meta_Size];	/* Fields other than the Cobs 	*/
+} CefT_Csmgr_Upload;
+
 
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
 
-static unsigned char* 	cefnetd_msg_buff 		= NULL;
-static int 				cefnetd_msg_buff_index 	= 0;
+static CefT_Csmgr_Upload* 	upload_cur 		= NULL;		/* Requests being gathered 		*/
+static CefT_Rngque* 		upload_que 		= NULL;		/* Batches to the sender thread */
 static unsigned char* 	work_msg_buff 			= NULL;
 
 /****************************************************************************************
@@ -118,6 +135,37 @@ cef_csmgr_send_msg_to_csmgr (
 	unsigned char* msg,						/* send message								*/
 	int msg_len								/* message length							*/
 );
+/*--------------------------------------------------------------------------------------
+	Hands the gathered Upload Requests to the sender thread
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_flush (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Frees the Upload Requests
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_free (
+	CefT_Csmgr_Upload* up					/* Upload Requests 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the Upload Requests to csmgrd
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_send (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	CefT_Csmgr_Upload* up					/* Upload Requests 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the data pointed by the iovecs to the socket
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_iov_send (
+	int sock,								/* socket to csmgrd 						*/
+	struct iovec* iov,						/* data to send 							*/
+	int iov_cnt								/* number of iov 							*/
+);
 
 
 /****************************************************************************************
@@ -143,7 +191,6 @@ cef_csmgr_stat_create (
 		return (NULL);
 	}
 	memset (cs_stat, 0, sizeof (CefT_Cs_Stat));
-	cs_stat->tx_que = NULL;
 	cs_stat->local_sock = -1;
 	cs_stat->tcp_sock 	= -1;
 	cs_stat->pipe_fd[0] = -1;
@@ -211,6 +258,16 @@ cef_csmgr_stat_create (
 							, __func__, strerror(errno));
 			return (NULL);
 		}
+		/* The Upload Requests are passed to the thread without copying the Cobs */
+		if (upload_que == NULL) {
+			upload_que = cef_rngque_create_with_mode (
+								CefC_Csmgr_Upload_Que_Size, CefC_Rngque_Mode_Spsc);
+			if (upload_que == NULL) {
+				cef_csmgr_stat_destroy (&cs_stat);
+				cef_log_write (CefC_Log_Error, "%s (create upload queue)\n", __func__);
+				return (NULL);
+			}
+		}
 		pthread_t cef_csmgr_send_csmgrd_th;
 		if (pthread_create(&cef_csmgr_send_csmgrd_th, NULL
 				, &cef_csmgr_send_to_csmgrd_thread, (cs_stat)) == -1) {
@@ -275,26 +332,6 @@ cef_csmgr_stat_create (
 
 	/* Create memory cache */
 	if (cs_stat->cache_type != CefC_Default_Cache_Type) {
-		/* create Cs_Tx_Que */
-		cs_stat->tx_que = cef_rngque_create (CefC_Tx_Que_Size);
-		cs_stat->tx_cob_mp = cef_mpool_init (
-										"CefCsCobQue",
-										sizeof (CefT_Cs_Tx_Elem_Cob),
-										CefC_Tx_Que_Size);
-		if (cs_stat->tx_cob_mp == 0) {
-			cef_csmgr_stat_destroy (&cs_stat);
-			cef_log_write (CefC_Log_Error, "%s (mpool CefCsCobQue)\n", __func__);
-			return (NULL);
-		}
-
-		cs_stat->tx_que_mp =
-				cef_mpool_init ("CefCsTxQue", sizeof (CefT_Cs_Tx_Elem), CefC_Tx_Que_Size);
-		if (cs_stat->tx_que_mp == 0) {
-			cef_csmgr_stat_destroy (&cs_stat);
-			cef_log_write (CefC_Log_Error, "%s (mpool CefCsTxQue)\n", __func__);
-			return (NULL);
-		}
-
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine, "CACHE_TYPE     != CefC_Default_Cache_Type\n");
 		cef_dbg_write (CefC_Dbg_Fine, "CACHE_CAPACITY =  "FMTU64"\n", cs_stat->cache_cap);
@@ -359,16 +396,8 @@ cef_csmgr_stat_create (
 #endif  //CefC_CefnetdCache
 	}
 
-	if (cefnetd_msg_buff) {
-		free (cefnetd_msg_buff);
-	}
-	cefnetd_msg_buff = malloc (sizeof (unsigned char) * CefC_Cefnetd_Buff_Max);
-	if (cefnetd_msg_buff == NULL) {
-		cef_csmgr_stat_destroy (&cs_stat);
-		cef_log_write (CefC_Log_Error, "%s (alloc message buffer)\n", __func__);
-		return (NULL);
-	}
-	cefnetd_msg_buff_index = 0;
+	cef_csmgr_upload_free (upload_cur);
+	upload_cur = NULL;
 	cef_csmgr_buffer_init ();
 
 	return (cs_stat);
@@ -852,15 +881,6 @@ cef_csmgr_stat_destroy (
 		if (stat->cob_table != (CefT_Hash_Handle)NULL) {
 			cef_hash_tbl_destroy (stat->cob_table);
 		}
-		if (stat->tx_que != NULL) {
-			cef_rngque_destroy (stat->tx_que);
-		}
-		if (stat->tx_cob_mp != 0) {
-			cef_mpool_destroy (stat->tx_cob_mp);
-		}
-		if (stat->tx_que_mp != 0) {
-			cef_mpool_destroy (stat->tx_que_mp);
-		}
 		if (stat->cs_cob_entry_mp != 0) {
 			cef_mpool_destroy (stat->cs_cob_entry_mp);
 		}
@@ -885,11 +905,10 @@ cef_csmgr_stat_destroy (
 		*cs_stat = NULL;
 	}
 
-	if (cefnetd_msg_buff) {
-		free (cefnetd_msg_buff);
-		cefnetd_msg_buff = NULL;
-	}
-	cefnetd_msg_buff_index = 0;
+	/* The sender thread keeps reading upload_que, so only the requests which	*/
+	/* are not handed to it are freed 											*/
+	cef_csmgr_upload_free (upload_cur);
+	upload_cur = NULL;
 
 
 	return;
@@ -925,7 +944,8 @@ cef_csmgr_cache_lookup (
 		/* Searches content entry 	*/
 		if (cs_stat->cob_table) {
 			cob_entry = (CefT_Cob_Entry*)
-				cef_hash_tbl_item_get_prg (cs_stat->cob_table, pm->name, pm->name_len);
+				cef_hash_tbl_item_get_prg_with_hashv (cs_stat->cob_table, pm->name, pm->name_len,
+						cef_frame_name_hashv_get (pm, pm->name, pm->name_len));
 		}
 		if (cob_entry) {
 			nowt = cef_client_present_timeus_get ();
@@ -1032,7 +1052,8 @@ cef_csmgr_cache_insert (
 		//0.8.3c E
 
 		old_entry = (CefT_Cob_Entry*)
-			cef_hash_tbl_item_get_prg (cs_stat->cob_table, pm->name, pm->name_len);
+			cef_hash_tbl_item_get_prg_with_hashv (cs_stat->cob_table, pm->name, pm->name_len,
+						cef_frame_name_hashv_get (pm, pm->name, pm->name_len));
 #ifdef __WORKBUFF_VERSION__
 		fprintf (stderr, "*** INSERT ***\n");
 		fprintf (stderr, "IN[");
@@ -1103,11 +1124,13 @@ cef_csmgr_cache_insert (
 		if (new_entry == NULL) {
 			return;
 		}
-		new_entry->msg = (unsigned char*)malloc( sizeof(unsigned char)*msg_len);	//20210823
-		if ( new_entry->msg == NULL ) {												//20210823
-			return;																	//20210823
-		}																			//20210823
-		memcpy (new_entry->msg, msg, msg_len);										//20210823
+		/* The Faces to which the Cob is forwarded share the buffer 	*/
+		new_entry->pb = cef_pktbuf_cur_ref (msg, msg_len);
+		if (new_entry->pb == NULL) {
+			cef_mpool_free (cs_stat->cs_cob_entry_mp, new_entry);
+			return;
+		}
+		new_entry->msg = new_entry->pb->data;
 		new_entry->msg_len = msg_len;
 		new_entry->chunk_num = pm->chunk_num;
 		new_entry->cache_time = nowt + cs_stat->buffer_cache_time;
@@ -1116,6 +1139,8 @@ cef_csmgr_cache_insert (
 			if (pm->org.version_len) {
 				new_entry->version = (unsigned char*)malloc( sizeof(unsigned char) * pm->org.version_len);
 				if (new_entry->version == NULL) {
+					cef_pktbuf_unref (new_entry->pb);
+					cef_mpool_free (cs_stat->cs_cob_entry_mp, new_entry);
 					return;
 				}
 				memcpy (new_entry->version, pm->org.version_val, pm->org.version_len);
@@ -1129,14 +1154,16 @@ cef_csmgr_cache_insert (
 		}
 
 		/* Insert Cob Table and delete old entry */
-		old_entry = (CefT_Cob_Entry*) cef_hash_tbl_item_set_prg (
-				cs_stat->cob_table, pm->name, pm->name_len, new_entry);
+		old_entry = (CefT_Cob_Entry*) cef_hash_tbl_item_set_prg_with_hashv (
+				cs_stat->cob_table, pm->name, pm->name_len,
+				cef_frame_name_hashv_get (pm, pm->name, pm->name_len), new_entry);
 #ifdef __WORKBUFF_VERSION__
 		fprintf (stderr, "    Insert\n");
 #endif //__WORKBUFF_VERSION__
 		if (old_entry) {
-			free( old_entry->msg );	//20210823
-			old_entry->msg = NULL;	//20210823
+			cef_pktbuf_unref (old_entry->pb);
+			old_entry->pb = NULL;
+			old_entry->msg = NULL;
 			if (old_entry->ver_len) {
 				free (old_entry->version);
 				old_entry->ver_len = 0;
@@ -1216,6 +1243,139 @@ cef_csmgr_send_msg_to_csmgr (
 	return (0);
 
 }
+/*--------------------------------------------------------------------------------------
+	Hands the gathered Upload Requests to the sender thread
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_flush (
+	void
+) {
+	CefT_Csmgr_Upload* up = upload_cur;
+
+	upload_cur = NULL;
+	if (up == NULL) {
+		return;
+	}
+	if ((up->num < 1) ||
+		(upload_que == NULL) ||
+		(cef_rngque_push (upload_que, up) < 1)) {
+		cef_csmgr_upload_free (up);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Frees the Upload Requests
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_free (
+	CefT_Csmgr_Upload* up					/* Upload Requests 							*/
+) {
+	int i;
+
+	if (up == NULL) {
+		return;
+	}
+	for (i = 0 ; i < up->num ; i++) {
+		cef_pktbuf_unref (up->pbs[i]);
+	}
+	free (up);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the Upload Requests to csmgrd
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_upload_send (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	CefT_Csmgr_Upload* up					/* Upload Requests 							*/
+) {
+	char port_str[NI_MAXSERV];
+
+	if (cs_stat->local_sock != -1) {
+		cef_csmgr_iov_send (cs_stat->local_sock, up->iov, up->num * 3);
+		return;
+	}
+	if (cs_stat->tcp_sock == -1) {
+		sprintf (port_str, "%d", cs_stat->tcp_port_num);
+		cs_stat->tcp_sock
+				= cef_csmgr_connect_tcp_to_csmgr (cs_stat->peer_id_str, port_str);
+	}
+	if (cs_stat->tcp_sock != -1) {
+		cef_csmgr_iov_send (cs_stat->tcp_sock, up->iov, up->num * 3);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Sends the data pointed by the iovecs to the socket
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_iov_send (
+	int sock,								/* socket to csmgrd 						*/
+	struct iovec* iov,						/* data to send 							*/
+	int iov_cnt								/* number of iov 							*/
+) {
+	struct msghdr mh;
+	fd_set fds, writefds;
+	struct timeval timeout;
+	int send_count = 0;
+	ssize_t res;
+	int n;
+
+	memset (&mh, 0, sizeof (mh));
+	mh.msg_iov 		= iov;
+	mh.msg_iovlen 	= iov_cnt;
+
+	res = sendmsg (sock, &mh, MSG_DONTWAIT);
+	if (res <= 0) {
+		if (errno == EAGAIN) {
+			usleep (CEF_CSMGR_SEND_USLEEP);
+		}
+		return;
+	}
+	send_count++;
+
+	while (1) {
+		/* Skips the iovecs which have been sent 	*/
+		while ((mh.msg_iovlen > 0) && (res >= (ssize_t) mh.msg_iov->iov_len)) {
+			res -= mh.msg_iov->iov_len;
+			mh.msg_iov++;
+			mh.msg_iovlen--;
+		}
+		if (mh.msg_iovlen == 0) {
+			break;
+		}
+		mh.msg_iov->iov_base = (unsigned char*) mh.msg_iov->iov_base + res;
+		mh.msg_iov->iov_len -= res;
+		res = 0;
+
+		timeout.tv_sec  = 0;
+		timeout.tv_usec = CEF_CSMGR_SEND_TIMEOUT;
+		FD_ZERO (&writefds);
+		FD_SET (sock, &writefds);
+		memcpy (&fds, &writefds, sizeof (fds));
+		n = select (sock + 1, NULL, &fds, NULL, &timeout);
+		if (n > 0) {
+			if (FD_ISSET (sock, &fds)) {
+				res = sendmsg (sock, &mh, MSG_DONTWAIT);
+				if (res <= 0) {
+					res = 0;
+					if (errno == EAGAIN) {
+						usleep (CEF_CSMGR_SEND_USLEEP);
+					}
+				}
+				send_count++;
+				if (send_count > DEMO_RETRY_NUM) {
+					break;
+				}
+			}
+		} else {
+			if (send_count > DEMO_RETRY_NUM) {
+				break;
+			}
+			send_count++;
+			if (errno == EAGAIN) {
+				usleep (CEF_CSMGR_SEND_USLEEP);
+			}
+		}
+	}
+}
 /*--------------------------------------------------------------------------------------
 	Puts Content Object to excache
 ----------------------------------------------------------------------------------------*/
@@ -1228,12 +1388,17 @@ cef_csmgr_excache_item_put (
 	CefT_CcnMsg_MsgBdy* pm,				/* Parsed CEFORE message					*/
 	CefT_CcnMsg_OptHdr* poh				/* Parsed Option header						*/
 ) {
-	unsigned char buff[CefC_Max_Length];
+	CefT_Csmgr_Upload* up;
+	CefT_Pktbuf* pb;
+	unsigned char* buff;
+	unsigned char* sfx;
 	uint16_t index = 0;
+	uint16_t sfx_index = 0;
 	uint16_t value16;
 	uint32_t value32;
 	uint64_t value64;
 	int chunk_field_len = CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum;
+	int meta_len;
 	uint16_t value16_namelen;
 	struct in_addr node;
 	CefT_Face* face = NULL;
@@ -1267,6 +1432,40 @@ cef_csmgr_excache_item_put (
 			return;
 		}
 
+		if (!pm->chunk_num_f) {
+			return;
+		}
+		value16_namelen = pm->name_len - chunk_field_len;
+		meta_len = CefC_Csmgr_Msg_HeaderLen + CefC_S_Length * 3 + value16_namelen
+					+ CefC_S_ChunkNum + CefC_S_Cachetime + CefC_S_Expiry
+					+ sizeof (struct in_addr) + 3;
+
+		/* Sends the gathered requests at once 	*/
+		if ((upload_cur != NULL) &&
+			((upload_cur->len > BUFF_SIZE) ||
+			 (upload_cur->num == CefC_Csmgr_Upload_Max) ||
+			 (upload_cur->meta_len + meta_len > CefC_Csmgr_Upload_Meta_Size))) {
+			cef_csmgr_upload_flush ();
+		}
+		if (upload_cur == NULL) {
+			upload_cur = (CefT_Csmgr_Upload*) malloc (sizeof (CefT_Csmgr_Upload));
+			if (upload_cur == NULL) {
+				cef_log_write (CefC_Log_Warn, "%s (alloc upload requests)\n", __func__);
+				return;
+			}
+			upload_cur->num 		= 0;
+			upload_cur->len 		= 0;
+			upload_cur->meta_len 	= 0;
+		}
+		up = upload_cur;
+
+		/* The Cob is shared with the Faces and the Content Store 	*/
+		pb = cef_pktbuf_cur_ref (msg, msg_len);
+		if (pb == NULL) {
+			return;
+		}
+		buff = &up->meta[up->meta_len];
+
 		/* Creates Upload Request message 		*/
 		/* set header */
 		buff[CefC_O_Fix_Ver]  = CefC_Version;
@@ -1281,35 +1480,29 @@ cef_csmgr_excache_item_put (
 		/* set cob message */
 		value16 = htons (msg_len);
 		memcpy (buff + index, &value16, CefC_S_Length);
-		memcpy (buff + index + CefC_S_Length, msg, msg_len);
-		index += CefC_S_Length + msg_len;
+		index += CefC_S_Length;
+		sfx = buff + index;
 
 		/* set cob name */
-		if (pm->chunk_num_f) {
-			value16_namelen = pm->name_len - chunk_field_len;
-			value16 = htons (value16_namelen);
-			memcpy (buff + index, &value16, CefC_S_Length);
-			memcpy (buff + index + CefC_S_Length, pm->name, value16_namelen);
-			index += CefC_S_Length + value16_namelen;
-		} else {
-			return;
-		}
-
+		value16 = htons (value16_namelen);
+		memcpy (sfx + sfx_index, &value16, CefC_S_Length);
+		memcpy (sfx + sfx_index + CefC_S_Length, pm->name, value16_namelen);
+		sfx_index += CefC_S_Length + value16_namelen;
 
 		/* set chunk num */
 		value32 = htonl (pm->chunk_num);
-		memcpy (buff + index, &value32, CefC_S_ChunkNum);
-		index += CefC_S_ChunkNum;
+		memcpy (sfx + sfx_index, &value32, CefC_S_ChunkNum);
+		sfx_index += CefC_S_ChunkNum;
 
 		/* set cache time */
 		value64 = cef_client_htonb (poh->cachetime);
-		memcpy (buff + index, &value64, CefC_S_Cachetime);
-		index += CefC_S_Cachetime;
+		memcpy (sfx + sfx_index, &value64, CefC_S_Cachetime);
+		sfx_index += CefC_S_Cachetime;
 
 		/* set expiry */
 		value64 = cef_client_htonb (pm->expiry);
-		memcpy (buff + index, &value64, CefC_S_Expiry);
-		index += CefC_S_Expiry;
+		memcpy (sfx + sfx_index, &value64, CefC_S_Expiry);
+		sfx_index += CefC_S_Expiry;
 		/* get address */
 		/* check local face flag */
 		face = cef_face_get_face_from_faceid (faceid);
@@ -1330,28 +1523,30 @@ cef_csmgr_excache_item_put (
 			}
 		}
 		/* set address */
-		memcpy (buff + index, &node, sizeof (struct in_addr));
-		index += sizeof (struct in_addr);
+		memcpy (sfx + sfx_index, &node, sizeof (struct in_addr));
+		sfx_index += sizeof (struct in_addr);
 
-		/* set Length */
-		value16 = htons (index);
-		memcpy (buff + CefC_O_Length, &value16, CefC_S_Length);
 		/* ADD MAGIC */
-		value16 = htons (index+3);
+		sfx[sfx_index]   = 0x63;
+		sfx[sfx_index+1] = 0x6f;
+		sfx[sfx_index+2] = 0x62;
+		sfx_index += 3;
+
+		/* set Length */
+		value16 = htons (index + msg_len + sfx_index);
 		memcpy (buff + CefC_O_Length, &value16, CefC_S_Length);
-		buff[index]   = 0x63;
-		buff[index+1] = 0x6f;
-		buff[index+2] = 0x62;
-		index += 3;
 
-		/* send message */
-	    if(cefnetd_msg_buff_index > BUFF_SIZE){
-			cef_csmgr_send_msg_to_csmgr (
-					cs_stat, cefnetd_msg_buff, cefnetd_msg_buff_index);
-			cefnetd_msg_buff_index = 0;
-		}
-		memcpy (&cefnetd_msg_buff[cefnetd_msg_buff_index], buff, index);
-		cefnetd_msg_buff_index += index;
+		/* queue the request */
+		up->pbs[up->num] = pb;
+		up->iov[up->num * 3].iov_base 		= buff;
+		up->iov[up->num * 3].iov_len 		= index;
+		up->iov[up->num * 3 + 1].iov_base 	= pb->data;
+		up->iov[up->num * 3 + 1].iov_len 	= msg_len;
+		up->iov[up->num * 3 + 2].iov_base 	= sfx;
+		up->iov[up->num * 3 + 2].iov_len 	= sfx_index;
+		up->num++;
+		up->meta_len += index + sfx_index;
+		up->len += index + msg_len + sfx_index;
 	}
 
 	return;
@@ -1364,10 +1559,8 @@ cef_csmgr_excache_item_push (
 	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
 ) {
 
-	if (cefnetd_msg_buff_index > 0) {
-		cef_csmgr_send_msg_to_csmgr (cs_stat, cefnetd_msg_buff, cefnetd_msg_buff_index);
-		cefnetd_msg_buff_index = 0;
-
+	if (upload_cur != NULL) {
+		cef_csmgr_upload_flush ();
 	}
 
 	return;
@@ -2695,6 +2888,7 @@ cef_csmgr_send_to_csmgrd_thread (
 	struct pollfd 				poll_fds[1];
 	unsigned char				msg[CefC_Max_Length*2];
 	int							msg_len;
+	CefT_Csmgr_Upload*			up;
 
 	cs_stat = (CefT_Cs_Stat*)p;
 
@@ -2709,6 +2903,12 @@ cef_csmgr_send_to_csmgrd_thread (
 
 	while (1){
 	    poll(poll_fds, 1, 1);
+		/* Sends the Upload Requests before the messages on the pipe, in the order 	*/
+		/* they were queued by cefnetd 												*/
+		while ((up = (CefT_Csmgr_Upload*) cef_rngque_pop (upload_que)) != NULL) {
+			cef_csmgr_upload_send (cs_stat, up);
+			cef_csmgr_upload_free (up);
+		}
 	    if (poll_fds[0].revents & POLLIN) {
 			if((msg_len = read(read_fd, msg, sizeof(msg))) < 1){
 				continue;
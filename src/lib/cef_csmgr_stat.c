@@ -44,7 +44,7 @@ static time_t BTIME=0;
  Include Files
  ****************************************************************************************/
 
-#include <openssl/md5.h>
+#include <cefore/cef_hash.h>
 
 #include <cefore/cef_csmgr_stat.h>
 
@@ -1388,12 +1388,6 @@ csmgr_stat_hash_number_create (
 	const unsigned char* key, 
 	uint16_t klen
 ) {
-	unsigned char out[MD5_DIGEST_LENGTH];
-	uint32_t hash;
-	
-	MD5 (key, klen, out);
-	memcpy (&hash, &out[12], sizeof (uint32_t));
-	
-	return (hash);
+	return (cef_hash_key_hashv_create (key, klen));
 }
 
@@ -32,7 +32,8 @@
 
 #define __CEF_FACE_SOURECE__
 
-#define		CEF_FACE_SEND_USLEEP	100000
+#define _GNU_SOURCE
+
 #define		CEF_FACE_SEND_TIMEOUT	10000
 
 //#define	__INTEREST__
@@ -45,6 +46,7 @@
 #include <assert.h>
 
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 
 #include <cefore/cef_hash.h>
@@ -67,10 +69,39 @@
 
 #define	DEMO_RETRY_NUM	10
 
+/*----- Direct-mapped cache of the peer address to Face-ID -----*/
+#define CefC_Face_Peer_Cache_Bits	8
+#define CefC_Face_Peer_Cache_Size	(1 << CefC_Face_Peer_Cache_Bits)
+#define CefC_Face_Peer_Usrid_Len	64			/* numeric IPv6 address with scope id	*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** Entry of the peer Face cache 	*****/
+typedef struct {
+	int 		faceid;							/* Face-ID (0: the slot is empty)		*/
+	int 		protocol;						/* CefC_Face_Type_XXX					*/
+	sa_family_t	family;							/* AF_INET or AF_INET6					*/
+	in_port_t	port;							/* Port number (network byte order)		*/
+	uint32_t	scope_id;						/* Scope ID of the IPv6 address			*/
+	uint8_t 	addr[16];						/* Binary address						*/
+	char 		usr_id[CefC_Face_Peer_Usrid_Len];
+												/* Numeric host string of the peer		*/
+} CefT_Face_Peer_Cache;
+
+/***** Message handed to the send functions 	*****/
+/* The header of the Face replaces the first skip bytes of the message. The message	*/
+/* is copied to the packet buffer only when it is kept to send later. 				*/
+typedef struct {
+	unsigned char* 	hdr;						/* Header of the Face, or NULL 			*/
+	uint16_t 		hdr_len;					/* Length of the header 				*/
+	unsigned char* 	msg;						/* Message 								*/
+	uint16_t 		msg_len;					/* Length of the message 				*/
+	uint16_t 		skip;						/* Length of msg replaced by hdr 		*/
+	CefT_Pktbuf* 	pb;							/* Buffer which holds msg, or NULL 		*/
+} CefT_Face_Tx_Frame;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -91,10 +122,161 @@ static int babel_sock_path_len = 0;
 static int my_udp_listen_port_num = 0;
 static int my_tcp_listen_port_num = 0;
 
+static CefT_Face_Peer_Cache peer_cache[CefC_Face_Peer_Cache_Size];
+												/* Peer address to Face-ID cache		*/
+static uint32_t face_generation = 0;			/* Incremented when a FD of Face changes*/
+
+static int face_batch_num = 1;					/* Max datagrams per syscall			*/
+static CefT_Face_Batch_Stat face_batch_stat;	/* Statistics of the batched UDP I/O	*/
+#ifdef CefC_Face_Batch_Enable
+static struct mmsghdr* face_batch_rx_msgs = NULL;
+static struct iovec* face_batch_rx_iovs = NULL;
+static CefT_Face_Rx_Dgram* face_batch_rx_dgrams = NULL;
+static struct mmsghdr* face_batch_tx_msgs = NULL;
+static struct iovec* face_batch_tx_iovs = NULL;
+static struct sockaddr_storage* face_batch_tx_addrs = NULL;
+static int* face_batch_tx_socks = NULL;
+static unsigned char* face_batch_tx_hdrs = NULL;	/* Headers of the Faces 				*/
+static CefT_Pktbuf** face_batch_tx_pbs = NULL;	/* Buffers of the queued datagrams		*/
+static int face_batch_tx_num = 0;				/* Number of the queued datagrams		*/
+#endif // CefC_Face_Batch_Enable
+
+static uint32_t face_outq_size = CefC_Default_FACE_OUTQ_SIZE;
+												/* Max bytes queued per Face			*/
+static int face_outq_policy = CefC_Face_Outq_Drop_Tail;
+												/* Drop policy when the queue is full	*/
+static uint16_t* face_outq_pend = NULL;			/* Faces which have the queued messages	*/
+static int face_outq_pend_num = 0;
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+	Records the number of datagrams handled by one syscall to the histogram
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_batch_hist_record (
+	uint64_t hist[],						/* Histogram								*/
+	int num									/* Number of datagrams						*/
+);
+#ifdef CefC_Face_Batch_Enable
+/*--------------------------------------------------------------------------------------
+	Queues the UDP datagram to send at cef_face_udp_batch_flush
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_udp_batch_push (
+	CefT_Sock* entry,						/* Socket to send							*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+);
+#endif // CefC_Face_Batch_Enable
+/*--------------------------------------------------------------------------------------
+	Sends a message via the Face of the specified socket
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+cef_face_tx_frame_send (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Sock* entry,						/* Socket of the Face 						*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the packet buffer to keep the message to send later
+----------------------------------------------------------------------------------------*/
+static CefT_Pktbuf* 						/* Packet buffer (the caller holds it) 		*/
+cef_face_tx_frame_hold (
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+);
+/*--------------------------------------------------------------------------------------
+	Sets the header and the body of the message to the iovec
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the set iovec 					*/
+cef_face_tx_frame_iov (
+	CefT_Face_Tx_Frame* fr,					/* a message to send						*/
+	struct iovec iov[2]
+);
+/*--------------------------------------------------------------------------------------
+	Sends a message to the stream (TCP or local) Face without blocking
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+cef_face_stream_send (
+	uint16_t faceid,						/* Face-ID									*/
+	int sock,								/* Socket of the Face 						*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends a datagram to the UDP Face without blocking
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_udp_send (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Sock* entry,						/* Socket to send							*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the rest of the message to send when the socket becomes writable
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if dropped 		*/
+cef_face_outq_push (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Face_Tx_Frame* fr,					/* a message to send						*/
+	size_t sent								/* length already sent 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Sets the rest of the queued message to the iovec
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the set iovec 					*/
+cef_face_outq_msg_iov (
+	CefT_Face_Outq_Msg* m,					/* Queued message 							*/
+	struct iovec iov[2]
+);
+/*--------------------------------------------------------------------------------------
+	Frees the queued message
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_outq_msg_free (
+	CefT_Face_Outq_Msg* m					/* Queued message 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages of the specified Face
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the queue remains, 0 if it is empty	*/
+cef_face_outq_face_flush (
+	uint16_t faceid							/* Face-ID									*/
+);
+/*--------------------------------------------------------------------------------------
+	Writes the queued messages of the specified Face to its shared memory ring
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the queue remains, 0 if it is empty	*/
+cef_face_outq_shmring_flush (
+	uint16_t faceid							/* Face-ID									*/
+);
+/*--------------------------------------------------------------------------------------
+	Frees the queued messages of the specified Face
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_outq_clear (
+	uint16_t faceid,						/* Face-ID									*/
+	int drop_f								/* counts the freed messages as dropped 	*/
+);
+/*--------------------------------------------------------------------------------------
+	Looks up the peer Face cache with the binary peer address
+----------------------------------------------------------------------------------------*/
+static CefT_Face_Peer_Cache*				/* slot of the cache, or NULL if the address*/
+											/* can not be cached 						*/
+cef_face_peer_cache_slot_get (
+	const struct sockaddr* sa, 				/* peer address								*/
+	socklen_t sa_len,						/* length of the peer address				*/
+	int protocol,
+	int* hit_f								/* set 1 if the slot holds the address 		*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes the specified Face-ID from the peer Face cache
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_peer_cache_purge (
+	int faceid								/* Face-ID									*/
+);
+
 /*--------------------------------------------------------------------------------------
 	Deallocates the specified addrinfo
 ----------------------------------------------------------------------------------------*/
@@ -204,6 +386,12 @@ cef_face_init (
 		face_tbl[i].ifindex = -1;
 		face_tbl[i].bw_stat_i = -1;	//0.8.3
 	}
+	face_outq_pend = (uint16_t*) malloc (sizeof (uint16_t) * max_tbl_size);
+	if (face_outq_pend == NULL) {
+		cef_log_write (CefC_Log_Error, "%s (face_outq_pend)\n", __func__);
+		return (-1);
+	}
+	face_outq_pend_num = 0;
 	sock_tbl = cef_hash_tbl_create ((uint16_t) max_tbl_size);
 
 	local_sock_path_len = cef_client_local_sock_name_get (local_sock_path);
@@ -337,6 +525,15 @@ cef_face_lookup_peer_faceid (
 	char port_str[32];
 	char peer_id[512];
 	char usr_id[512];
+	CefT_Face_Peer_Cache* slot;
+	int 	hit_f = 0;
+
+	/* Fast path: looks up the cache with the binary address 	*/
+	slot = cef_face_peer_cache_slot_get ((struct sockaddr*) sas, sas_len, protocol, &hit_f);
+	if (hit_f) {
+		strcpy (user_id, slot->usr_id);
+		return (slot->faceid);
+	}
 
 	/* Obtains the source node's information 	*/
 	result = getnameinfo ((struct sockaddr*) sas, sas_len,
@@ -358,7 +555,8 @@ cef_face_lookup_peer_faceid (
 		cef_dbg_write (CefC_Dbg_Finest,
 			"[face] Lookup the Face#%d for %s\n", entry->faceid, peer_id);
 #endif // CefC_Debug
-		return (entry->faceid);
+		faceid = entry->faceid;
+		goto SET_CACHE;
 	}
 
 	faceid = cef_face_lookup_faceid (protocol, peer_id, usr_id, port_str, NULL);
@@ -368,6 +566,13 @@ cef_face_lookup_peer_faceid (
 		"[face] Creation the new Face#%d for %s.\n", faceid, peer_id);
 #endif // CefC_Debug
 
+SET_CACHE:;
+	if ((slot != NULL) && (faceid > 0) && (face_tbl[faceid].fd > 0) &&
+		(strlen (usr_id) < CefC_Face_Peer_Usrid_Len)) {
+		slot->faceid = faceid;
+		strcpy (slot->usr_id, usr_id);
+	}
+
 	return (faceid);
 }
 /*--------------------------------------------------------------------------------------
@@ -419,6 +624,7 @@ cef_face_lookup_local_faceid (
 	/* Registers the created entry into Face Table	*/
 	face_tbl[faceid].index = index;
 	face_tbl[faceid].fd = entry->sock;
+	face_tbl[faceid].fd_gen = ++face_generation;
 	face_tbl[faceid].local_f = 1;
 
 #ifdef CefC_Debug
@@ -445,8 +651,19 @@ cef_face_close (
 		cef_dbg_write (CefC_Dbg_Finer,
 			"[face] Close the Face#%d (FD#%d)\n", faceid, face_tbl[entry->faceid].fd);
 #endif // CefC_Debug
+		/* The queued datagrams may refer to the socket to close 	*/
+		cef_face_udp_batch_flush ();
+		cef_face_peer_cache_purge (faceid);
+		cef_face_outq_clear ((uint16_t) faceid, 0);
+		face_tbl[faceid].outq.enq 	= 0;
+		face_tbl[faceid].outq.drop 	= 0;
+		cef_shmring_destroy (face_tbl[faceid].shm);
+		face_tbl[faceid].shm 		= NULL;
 		face_tbl[faceid].index 		= 0;
 		face_tbl[faceid].fd 		= 0;
+		face_tbl[faceid].head 		= 0;
+		face_tbl[faceid].len 		= 0;
+		face_generation++;
 		face_tbl[faceid].protocol 	= CefC_Face_Type_Invalid;
 		face_tbl[faceid].ifindex 	= -1;	//0.8.3
 		face_tbl[faceid].bw_stat_i 	= -1;	//0.8.3
@@ -473,7 +690,10 @@ cef_face_close_for_down (
 		cef_dbg_write (CefC_Dbg_Finer,
 			"[face] Close the Face#%d (only FD#%d)\n", faceid, face_tbl[entry->faceid].fd);
 #endif // CefC_Debug
+		cef_face_peer_cache_purge (faceid);
+		cef_face_outq_clear ((uint16_t) faceid, 1);
 		close (entry->sock);
+		face_generation++;
 	}
 
 	return (1);
@@ -496,7 +716,11 @@ cef_face_down (
 		cef_dbg_write (CefC_Dbg_Finer,
 			"[face] Down the Face#%d (FD#%d)\n", faceid, face_tbl[entry->faceid].fd);
 #endif // CefC_Debug
+		cef_face_outq_clear ((uint16_t) faceid, 1);
 		face_tbl[faceid].fd = 0;
+		face_tbl[faceid].head = 0;
+		face_tbl[faceid].len = 0;
+		face_generation++;
 		face_tbl[faceid].ifindex 	= -1;	//0.8.3
 		face_tbl[faceid].bw_stat_i 	= -1;	//0.8.3
 	}
@@ -895,6 +1119,7 @@ cef_face_accept_connect (
 			sock_tbl, (const unsigned char*) peer_str, strlen (peer_str), entry);
 		face_tbl[entry->faceid].index = index;
 		face_tbl[entry->faceid].fd = entry->sock;
+		face_tbl[entry->faceid].fd_gen = ++face_generation;
 		face_tbl[entry->faceid].protocol = CefC_Face_Type_Tcp;
 		return (entry->faceid);
 	 }
@@ -916,6 +1141,7 @@ cef_face_accept_connect (
 					sock_tbl, (const unsigned char*) peer_str, strlen (peer_str), entry);
 				face_tbl[entry->faceid].index = index;
 				face_tbl[entry->faceid].fd = entry->sock;
+				face_tbl[entry->faceid].fd_gen = ++face_generation;
 				face_tbl[entry->faceid].protocol = CefC_Face_Type_Tcp;
 				return (entry->faceid);
 			}
@@ -940,6 +1166,7 @@ cef_face_accept_connect (
 	}
 	face_tbl[faceid].index = index;
 	face_tbl[faceid].fd = entry->sock;
+	face_tbl[faceid].fd_gen = ++face_generation;
 	face_tbl[faceid].protocol = CefC_Face_Type_Tcp;
 
 #if 0
@@ -1041,6 +1268,7 @@ cef_face_local_face_create (
 		entry);
 	face_tbl[CefC_Faceid_Local].index 	= index;
 	face_tbl[CefC_Faceid_Local].fd 		= entry->sock;
+	face_tbl[CefC_Faceid_Local].fd_gen = ++face_generation;
 	face_tbl[CefC_Faceid_Local].local_f	= 1;
 
 	return (CefC_Faceid_Local);
@@ -1160,7 +1388,7 @@ cef_face_frame_send_forced (
 	size_t			msg_len					/* length of the message to send 			*/
 ) {
 	CefT_Sock* entry;
-	int res;
+	CefT_Face_Tx_Frame fr;
 
 	entry = (CefT_Sock*) cef_hash_tbl_item_get_from_index (
 										sock_tbl, face_tbl[faceid].index);
@@ -1168,168 +1396,43 @@ cef_face_frame_send_forced (
 		return;
 	}
 
-	if (face_tbl[faceid].local_f) {
-		int	send_count = 0;
-		res = 0;
-    	unsigned char* p = msg;
-    	int len = msg_len;
-		fd_set fds, writefds;
-		int n;
-		struct timeval timeout;
-
-		res = send (entry->sock, msg, msg_len, 0);
-		if ( res <= 0 ) {
-			return;
-		}
-		len -= res;
-		p += res;
-		send_count++;
-
-		while( len > 0 ){
-			timeout.tv_sec  = 0;
-			timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-			FD_ZERO (&writefds);
-			FD_SET (entry->sock, &writefds);
-			memcpy (&fds, &writefds, sizeof (fds));
-			n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-			if (n > 0) {
-				if (FD_ISSET (entry->sock, &fds)) {
-					res = send (entry->sock, msg, msg_len, 0);
-					if(res > 0) {
-						len -= res;
-						p += res;
-					} else {
-						if ( errno == EAGAIN ) {
-							usleep(CEF_FACE_SEND_USLEEP);
-						}
-					}
-					send_count++;
-					if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-				}
-			} else {
-				if ( send_count == 0 ) {
-					break;
-				} else if ( send_count > DEMO_RETRY_NUM ) {
-					break;
-				}
-				send_count++;
-				if ( errno == EAGAIN ) {
-					usleep(CEF_FACE_SEND_USLEEP);
-				}
-			}
-		}
-	} else {
-		if (face_tbl[faceid].protocol != CefC_Face_Type_Tcp) {
-			int	send_count = 0;
-			res = 0;
-    		unsigned char* p = msg;
-    		int len = msg_len;
-			fd_set fds, writefds;
-			int n;
-			struct timeval timeout;
-
-			res = sendto (entry->sock, msg, msg_len
-							, 0, entry->ai_addr, entry->ai_addrlen);
-			if ( res <= 0 ) {
-				return;
-			}
-			len -= res;
-			p += res;
-			send_count++;
-
-			while( len > 0 ){
-				timeout.tv_sec  = 0;
-				timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-				FD_ZERO (&writefds);
-				FD_SET (entry->sock, &writefds);
-				memcpy (&fds, &writefds, sizeof (fds));
-				n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-				if (n > 0) {
-					if (FD_ISSET (entry->sock, &fds)) {
-						res = sendto (entry->sock, msg, msg_len
-								, 0, entry->ai_addr, entry->ai_addrlen);
-						if(res > 0) {
-							len -= res;
-							p += res;
-						} else {
-							if ( errno == EAGAIN ) {
-								usleep(CEF_FACE_SEND_USLEEP);
-							}
-						}
-						send_count++;
-						if ( send_count > DEMO_RETRY_NUM ) {
-							break;
-						}
-					}
-				} else {
-					if ( send_count == 0 ) {
-						break;
-					} else if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-					send_count++;
-					if ( errno == EAGAIN ) {
-						usleep(CEF_FACE_SEND_USLEEP);
-					}
-				}
-			}
-		} else {
-			int	send_count = 0;
-			res = 0;
-    		unsigned char* p = msg;
-	    	int len = msg_len;
-			fd_set fds, writefds;
-			int n;
-			struct timeval timeout;
-
-			res = write (entry->sock, msg, msg_len);
-			if ( res <= 0 ) {
-				return;
-			}
-			len -= res;
-			p += res;
-			send_count++;
-
-			while( len > 0 ){
-				timeout.tv_sec  = 0;
-				timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-				FD_ZERO (&writefds);
-				FD_SET (entry->sock, &writefds);
-				memcpy (&fds, &writefds, sizeof (fds));
-				n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-				if (n > 0) {
-					if (FD_ISSET (entry->sock, &fds)) {
-						res = write (entry->sock, msg, msg_len);
-						if(res > 0) {
-							len -= res;
-							p += res;
-						} else {
-							if ( errno == EAGAIN ) {
-								usleep(CEF_FACE_SEND_USLEEP);
-							}
-						}
-						send_count++;
-						if ( send_count > DEMO_RETRY_NUM ) {
-							break;
-						}
-					}
-				} else {
-					if ( send_count == 0 ) {
-						break;
-					} else if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-					send_count++;
-					if ( errno == EAGAIN ) {
-						usleep(CEF_FACE_SEND_USLEEP);
-					}
-				}
-			}
-		}
+	memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+	fr.msg 		= msg;
+	fr.msg_len 	= (uint16_t) msg_len;
+	cef_face_tx_frame_send (faceid, entry, &fr);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Sends the message in the packet buffer via the specified Face
+----------------------------------------------------------------------------------------*/
+void
+cef_face_pktbuf_send_forced (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	CefT_Pktbuf* 	pb, 					/* Packet buffer of the message 			*/
+	int 			seqnum_f				/* sets the sequence number of the Face 	*/
+) {
+	CefT_Sock* entry;
+	CefT_Face_Tx_Frame fr;
+	unsigned char hdr[CefC_Max_Header_Size];
+
+	entry = (CefT_Sock*) cef_hash_tbl_item_get_from_index (
+										sock_tbl, face_tbl[faceid].index);
+	if (entry == NULL) {
+		return;
 	}
 
+	memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+	fr.msg 		= pb->data;
+	fr.msg_len 	= pb->len;
+	fr.pb 		= pb;
+	if (seqnum_f) {
+		fr.hdr 		= hdr;
+		fr.hdr_len 	= cef_frame_seqnum_hdr_build (
+			pb->data, cef_face_get_seqnum_from_faceid (faceid), hdr, &fr.skip);
+	}
+	cef_face_tx_frame_send (faceid, entry, &fr);
+
 	return;
 }
 /*--------------------------------------------------------------------------------------
@@ -1343,7 +1446,7 @@ cef_face_object_send (
 	CefT_CcnMsg_MsgBdy* pm 				/* Parsed message 							*/
 ) {
 	CefT_Sock* entry;
-	int res;
+	CefT_Face_Tx_Frame fr;
 
 	if (face_tbl[faceid].fd < 3) {
 		return (-1);
@@ -1354,149 +1457,50 @@ cef_face_object_send (
 		return (-1);
 	}
 
-	if (face_tbl[faceid].local_f) {
-		int	send_count = 0;
-		res = 0;
-    	unsigned char* p = msg;
-    	int len = msg_len;
-		fd_set fds, writefds;
-		int n;
-		struct timeval timeout;
-
-		res = send (entry->sock, msg, msg_len, 0);
-		if ( res <= 0 ) {
-				return( -1 );
-		}
-		len -= res;
-		p += res;
-		send_count++;
-
-		while( len > 0 ){
-			timeout.tv_sec  = 0;
-			timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-			FD_ZERO (&writefds);
-			FD_SET (entry->sock, &writefds);
-			memcpy (&fds, &writefds, sizeof (fds));
-			n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-			if (n > 0) {
-				if (FD_ISSET (entry->sock, &fds)) {
-					res = send (entry->sock, msg, msg_len, 0);
-					if(res > 0) {
-						len -= res;
-						p += res;
-					} else {
-						if ( errno == EAGAIN ) {
-							usleep(CEF_FACE_SEND_USLEEP);
-						}
-					}
-					send_count++;
-					if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-				}
-			} else {
-				if ( send_count == 0 ) {
-					break;
-				} else if ( send_count > DEMO_RETRY_NUM ) {
-					break;
-				}
-				send_count++;
-				if ( errno == EAGAIN ) {
-					usleep(CEF_FACE_SEND_USLEEP);
-				}
-			}
-		}
-	} else {
-		if (face_tbl[faceid].protocol != CefC_Face_Type_Tcp) {
-			int	send_count = 0;
-			res = 0;
-    		unsigned char* p = msg;
-	    	int len = msg_len;
-			fd_set fds, writefds;
-			int n;
-			struct timeval timeout;
-
-			while( len > 0 ){
-				timeout.tv_sec  = 0;
-				timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-				FD_ZERO (&writefds);
-				FD_SET (entry->sock, &writefds);
-				memcpy (&fds, &writefds, sizeof (fds));
-				n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-				if (n > 0) {
-					if (FD_ISSET (entry->sock, &fds)) {
-						res = sendto (entry->sock, msg, msg_len
-								, 0, entry->ai_addr, entry->ai_addrlen);
-						if(res > 0) {
-							len -= res;
-							p += res;
-						} else {
-							if ( errno == EAGAIN ) {
-								usleep(CEF_FACE_SEND_USLEEP);
-							}
-						}
-						send_count++;
-						if ( send_count > DEMO_RETRY_NUM ) {
-							break;
-						}
-					}
-				} else {
-					if ( send_count == 0 ) {
-						break;
-					} else if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-					send_count++;
-					if ( errno == EAGAIN ) {
-						usleep(CEF_FACE_SEND_USLEEP);
-					}
-				}
-			}
-		} else {
-			int	send_count = 0;
-			res = 0;
-    		unsigned char* p = msg;
-	    	int len = msg_len;
-			fd_set fds, writefds;
-			int n;
-			struct timeval timeout;
-
-			while( len > 0 ){
-				timeout.tv_sec  = 0;
-				timeout.tv_usec = CEF_FACE_SEND_TIMEOUT;
-				FD_ZERO (&writefds);
-				FD_SET (entry->sock, &writefds);
-				memcpy (&fds, &writefds, sizeof (fds));
-				n = select(entry->sock+1, NULL, &fds, NULL, &timeout);
-				if (n > 0) {
-					if (FD_ISSET (entry->sock, &fds)) {
-						res = write (entry->sock, msg, msg_len);
-						if(res > 0) {
-							len -= res;
-							p += res;
-						} else {
-							if ( errno == EAGAIN ) {
-								usleep(CEF_FACE_SEND_USLEEP);
-							}
-						}
-						send_count++;
-						if ( send_count > DEMO_RETRY_NUM ) {
-							break;
-						}
-					}
-				} else {
-					if ( send_count == 0 ) {
-						break;
-					} else if ( send_count > DEMO_RETRY_NUM ) {
-						break;
-					}
-					send_count++;
-					if ( errno == EAGAIN ) {
-						usleep(CEF_FACE_SEND_USLEEP);
-					}
-				}
-			}
-		}
+	memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+	fr.msg 		= msg;
+	fr.msg_len 	= (uint16_t) msg_len;
+	if (cef_face_tx_frame_send (faceid, entry, &fr) < 0) {
+		return (-1);
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Sends a Content Object with the sequence number of the specified Face
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_object_send_seqnum (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	unsigned char* 	msg, 					/* a message to send						*/
+	size_t			msg_len,				/* length of the message to send 			*/
+	CefT_CcnMsg_MsgBdy* pm 				/* Parsed message 							*/
+) {
+	CefT_Sock* entry;
+	CefT_Face_Tx_Frame fr;
+	unsigned char hdr[CefC_Max_Header_Size];
+	uint32_t seqnum;
+
+	/* The message is shared by the Faces, so the header which has the sequence	*/
+	/* number is built for each Face instead of rewriting the message 			*/
+	seqnum = cef_face_get_seqnum_from_faceid (faceid);
+
+	if (face_tbl[faceid].fd < 3) {
+		return (-1);
+	}
+	entry = (CefT_Sock*) cef_hash_tbl_item_get_from_index (
+										sock_tbl, face_tbl[faceid].index);
+	if (entry == NULL) {
+		return (-1);
+	}
+
+	memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+	fr.msg 		= msg;
+	fr.msg_len 	= (uint16_t) msg_len;
+	fr.hdr 		= hdr;
+	fr.hdr_len 	= cef_frame_seqnum_hdr_build (msg, seqnum, hdr, &fr.skip);
+	if (cef_face_tx_frame_send (faceid, entry, &fr) < 0) {
+		return (-1);
 	}
 
 	return (1);
@@ -1511,6 +1515,7 @@ cef_face_object_send_iflocal (
 	size_t			msg_len					/* length of the message to send 			*/
 ) {
 	CefT_Sock* entry;
+	CefT_Face_Tx_Frame fr;
 	int res;
 
 	if (face_tbl[faceid].fd < 3) {
@@ -1524,7 +1529,10 @@ cef_face_object_send_iflocal (
 	}
 
 	if (face_tbl[faceid].local_f) {
-		send (entry->sock, msg, msg_len, 0);
+		memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+		fr.msg 		= msg;
+		fr.msg_len 	= (uint16_t) msg_len;
+		cef_face_stream_send (faceid, entry->sock, &fr);
 		res = 1;
 	} else {
 		res = 0;
@@ -1569,6 +1577,7 @@ cef_face_apimsg_send_iflocal (
 	size_t			payload_len				/* length of the message to send 			*/
 ) {
 	CefT_Sock* entry;
+	CefT_Face_Tx_Frame fr;
 	unsigned char api_frame[CefC_Max_Length];
 	int ret = 1;
 
@@ -1587,7 +1596,10 @@ cef_face_apimsg_send_iflocal (
 		if ( payload && 0 < payload_len )
 			memcpy (api_frame + api_hdr_len, payload, payload_len);
 
-		ret = send (entry->sock, api_frame, (api_hdr_len + payload_len), 0);
+		memset (&fr, 0, sizeof (CefT_Face_Tx_Frame));
+		fr.msg 		= api_frame;
+		fr.msg_len 	= (uint16_t)(api_hdr_len + payload_len);
+		ret = cef_face_stream_send (faceid, entry->sock, &fr);
 
 	} else {
 		ret = 0;
@@ -1630,9 +1642,14 @@ cef_face_all_face_close (
 #endif // CefC_Debug
 			close (face_tbl[i].fd);
 		}
+		cef_face_outq_clear ((uint16_t) i, 0);
+		cef_shmring_destroy (face_tbl[i].shm);
 	}
 
 	free (face_tbl);
+	free (face_outq_pend);
+	face_outq_pend = NULL;
+	face_outq_pend_num = 0;
 
 	max_tbl_size = 0;
 }
@@ -1970,6 +1987,7 @@ cef_face_lookup_faceid (
 										sock_tbl, face_tbl[entry->faceid].index);
 				face_tbl[entry->faceid].index 		= 0;
 				face_tbl[entry->faceid].fd 		= 0;
+				face_generation++;
 				face_tbl[entry->faceid].protocol 	= CefC_Face_Type_Invalid;
 				face_tbl[entry->faceid].ifindex 	= -1;	//0.8.3
 				face_tbl[entry->faceid].bw_stat_i 	= -1;	//0.8.3
@@ -2059,6 +2077,7 @@ RETRY:;
 		}
 		face_tbl[faceid].index = index;
 		face_tbl[faceid].fd = entry->sock;
+		face_tbl[faceid].fd_gen = ++face_generation;
 		face_tbl[faceid].protocol = (uint8_t) protocol;
 
 		if (create_f) {
@@ -2321,5 +2340,835 @@ cef_face_ip_route_get (
 #endif
 	return(len);
 }
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the Face Table, which changes when a FD is set to a Face
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* generation of the Face Table 			*/
+cef_face_generation_get (
+	void
+) {
+	return (face_generation);
+}
+/*--------------------------------------------------------------------------------------
+	Enables the batched UDP I/O with the specified batch size
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_batch_init (
+	int batch_num							/* Max datagrams per syscall (1:disabled) 	*/
+) {
+	memset (&face_batch_stat, 0, sizeof (CefT_Face_Batch_Stat));
+	face_batch_num = 1;
+
+	if (batch_num < 2) {
+		return (0);
+	}
+	if (batch_num > CefC_Face_Batch_Max) {
+		batch_num = CefC_Face_Batch_Max;
+	}
+#ifdef CefC_Face_Batch_Enable
+	{
+		unsigned char* rx_buff;
+		int i;
+
+		face_batch_rx_msgs   = (struct mmsghdr*) calloc (batch_num, sizeof (struct mmsghdr));
+		face_batch_rx_iovs   = (struct iovec*) calloc (batch_num, sizeof (struct iovec));
+		face_batch_rx_dgrams =
+			(CefT_Face_Rx_Dgram*) calloc (batch_num, sizeof (CefT_Face_Rx_Dgram));
+		face_batch_tx_msgs   = (struct mmsghdr*) calloc (batch_num, sizeof (struct mmsghdr));
+		face_batch_tx_iovs   = (struct iovec*) calloc (batch_num * 2, sizeof (struct iovec));
+		face_batch_tx_addrs  =
+			(struct sockaddr_storage*) calloc (batch_num, sizeof (struct sockaddr_storage));
+		face_batch_tx_socks  = (int*) calloc (batch_num, sizeof (int));
+		face_batch_tx_hdrs   =
+			(unsigned char*) malloc ((size_t) batch_num * CefC_Max_Header_Size);
+		face_batch_tx_pbs    = (CefT_Pktbuf**) calloc (batch_num, sizeof (CefT_Pktbuf*));
+		rx_buff              = (unsigned char*) malloc ((size_t) batch_num * CefC_Max_Length);
+
+		if (!face_batch_rx_msgs || !face_batch_rx_iovs || !face_batch_rx_dgrams ||
+			!face_batch_tx_msgs || !face_batch_tx_iovs || !face_batch_tx_addrs ||
+			!face_batch_tx_socks || !face_batch_tx_hdrs || !face_batch_tx_pbs || !rx_buff) {
+			cef_log_write (CefC_Log_Error, "%s(%u) malloc failed\n", __func__, __LINE__);
+			free (face_batch_rx_msgs);
+			free (face_batch_rx_iovs);
+			free (face_batch_rx_dgrams);
+			free (face_batch_tx_msgs);
+			free (face_batch_tx_iovs);
+			free (face_batch_tx_addrs);
+			free (face_batch_tx_socks);
+			free (face_batch_tx_hdrs);
+			free (face_batch_tx_pbs);
+			free (rx_buff);
+			face_batch_rx_msgs   = NULL;
+			face_batch_rx_iovs   = NULL;
+			face_batch_rx_dgrams = NULL;
+			face_batch_tx_msgs   = NULL;
+			face_batch_tx_iovs   = NULL;
+			face_batch_tx_addrs  = NULL;
+			face_batch_tx_socks  = NULL;
+			face_batch_tx_hdrs   = NULL;
+			face_batch_tx_pbs    = NULL;
+			return (-1);
+		}
+
+		for (i = 0 ; i < batch_num ; i++) {
+			face_batch_rx_dgrams[i].buff = rx_buff + (size_t) i * CefC_Max_Length;
+			face_batch_rx_iovs[i].iov_base = face_batch_rx_dgrams[i].buff;
+			face_batch_rx_iovs[i].iov_len  = CefC_Max_Length;
+		}
+		face_batch_tx_num = 0;
+		face_batch_num = batch_num;
+	}
+#else // CefC_Face_Batch_Enable
+	cef_log_write (CefC_Log_Warn,
+		"Batched UDP I/O is not supported on this platform, UDP_BATCH_SIZE is ignored\n");
+#endif // CefC_Face_Batch_Enable
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the batch size of the UDP I/O
+----------------------------------------------------------------------------------------*/
+int											/* Max datagrams per syscall 				*/
+cef_face_batch_size_get (
+	void
+) {
+	return (face_batch_num);
+}
+/*--------------------------------------------------------------------------------------
+	Receives the datagrams from the specified UDP socket at once
+----------------------------------------------------------------------------------------*/
+int											/* Number of the received datagrams 		*/
+cef_face_udp_batch_recv (
+	int fd, 								/* UDP socket 								*/
+	CefT_Face_Rx_Dgram** dgrams				/* set the received datagrams 				*/
+) {
+#ifdef CefC_Face_Batch_Enable
+	int res;
+	int i;
+
+	if (face_batch_num < 2) {
+		return (-1);
+	}
+	for (i = 0 ; i < face_batch_num ; i++) {
+		memset (&face_batch_rx_msgs[i].msg_hdr, 0, sizeof (struct msghdr));
+		face_batch_rx_msgs[i].msg_hdr.msg_name    = &face_batch_rx_dgrams[i].sas;
+		face_batch_rx_msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		face_batch_rx_msgs[i].msg_hdr.msg_iov     = &face_batch_rx_iovs[i];
+		face_batch_rx_msgs[i].msg_hdr.msg_iovlen  = 1;
+	}
+
+	/* Drains the datagrams which are already queued without blocking 	*/
+	res = recvmmsg (fd, face_batch_rx_msgs, face_batch_num, MSG_DONTWAIT, NULL);
+	if (res <= 0) {
+		return (res);
+	}
+	for (i = 0 ; i < res ; i++) {
+		face_batch_rx_dgrams[i].len     = (int) face_batch_rx_msgs[i].msg_len;
+		face_batch_rx_dgrams[i].sas_len = face_batch_rx_msgs[i].msg_hdr.msg_namelen;
+	}
+	cef_face_batch_hist_record (face_batch_stat.rx_hist, res);
+	*dgrams = face_batch_rx_dgrams;
+
+	return (res);
+#else // CefC_Face_Batch_Enable
+	return (-1);
+#endif // CefC_Face_Batch_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Sends the queued UDP datagrams
+----------------------------------------------------------------------------------------*/
+void
+cef_face_udp_batch_flush (
+	void
+) {
+#ifdef CefC_Face_Batch_Enable
+	int head = 0;
+	int tail;
+	int retry;
+	int res;
+	int i;
+
+	while (head < face_batch_tx_num) {
+		/* sendmmsg takes one socket, so sends the run of the same socket at once */
+		tail = head + 1;
+		while ((tail < face_batch_tx_num) &&
+			   (face_batch_tx_socks[tail] == face_batch_tx_socks[head])) {
+			tail++;
+		}
+		retry = 0;
+
+		while (head < tail) {
+			res = sendmmsg (face_batch_tx_socks[head],
+							&face_batch_tx_msgs[head], tail - head, MSG_DONTWAIT);
+			if (res > 0) {
+				cef_face_batch_hist_record (face_batch_stat.tx_hist, res);
+				head += res;
+				retry = 0;
+				continue;
+			}
+			if ((errno == EINTR) && (retry < DEMO_RETRY_NUM)) {
+				retry++;
+				continue;
+			}
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)) {
+				/* A datagram is sent whole or lost, so the rest for the full 	*/
+				/* socket is dropped instead of waiting in the event loop 		*/
+				face_batch_stat.tx_drop += tail - head;
+				head = tail;
+				continue;
+			}
+			/* Gives up the datagram at the head and goes on with the rest 	*/
+			face_batch_stat.tx_drop++;
+			head++;
+			retry = 0;
+		}
+	}
+	for (i = 0 ; i < face_batch_tx_num ; i++) {
+		cef_pktbuf_unref (face_batch_tx_pbs[i]);
+		face_batch_tx_pbs[i] = NULL;
+	}
+	face_batch_tx_num = 0;
+#endif // CefC_Face_Batch_Enable
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the batched UDP I/O
+----------------------------------------------------------------------------------------*/
+void
+cef_face_batch_stat_get (
+	CefT_Face_Batch_Stat* stat				/* set the statistics 						*/
+) {
+	memcpy (stat, &face_batch_stat, sizeof (CefT_Face_Batch_Stat));
+}
+/*--------------------------------------------------------------------------------------
+	Sets the size and the drop policy of the output queues of the Faces
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_face_outq_init (
+	int size,								/* Max bytes queued per Face 				*/
+	int policy								/* CefC_Face_Outq_Drop_XXX 					*/
+) {
+	if ((size < 0) || (size > CefC_Face_Outq_Size_Max)) {
+		return (-1);
+	}
+	if ((policy != CefC_Face_Outq_Drop_Tail) &&
+		(policy != CefC_Face_Outq_Drop_Head)) {
+		return (-1);
+	}
+	face_outq_size 		= (uint32_t) size;
+	face_outq_policy 	= policy;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages of the Faces whose sockets are writable
+----------------------------------------------------------------------------------------*/
+void
+cef_face_outq_flush (
+	void
+) {
+	uint16_t faceid;
+	int i;
+	int n = 0;
+
+	for (i = 0 ; i < face_outq_pend_num ; i++) {
+		faceid = face_outq_pend[i];
+
+		if (cef_face_outq_face_flush (faceid) > 0) {
+			face_outq_pend[n++] = faceid;
+		} else {
+			face_tbl[faceid].outq.pend_f = 0;
+		}
+	}
+	face_outq_pend_num = n;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the Faces which have the messages waiting to be sent
+----------------------------------------------------------------------------------------*/
+int											/* Number of the Faces 						*/
+cef_face_outq_pending_get (
+	uint16_t faceids[],						/* set the Face-IDs 						*/
+	int max									/* size of faceids 							*/
+) {
+	uint16_t faceid;
+	int i;
+	int n = 0;
 
+	for (i = 0 ; (i < face_outq_pend_num) && (n < max) ; i++) {
+		faceid = face_outq_pend[i];
 
+		/* The ring wakes up cefnetd with its eventfd instead of POLLOUT 	*/
+		if ((face_tbl[faceid].outq.head != NULL) && (face_tbl[faceid].fd > 0) &&
+			(face_tbl[faceid].shm == NULL)) {
+			faceids[n++] = faceid;
+		}
+	}
+
+	return (n);
+}
+/*--------------------------------------------------------------------------------------
+	Sets the shared memory ring which replaces the socket of the local Face
+----------------------------------------------------------------------------------------*/
+void
+cef_face_shmring_set (
+	uint16_t faceid,						/* Face-ID of the local app 				*/
+	CefT_Shmring* sr						/* ring pair, it is destroyed with the Face	*/
+) {
+	cef_shmring_destroy (face_tbl[faceid].shm);
+	face_tbl[faceid].shm = sr;
+	face_generation++;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the shared memory ring of the local Face
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* ring pair, or NULL if the socket is used */
+cef_face_shmring_get (
+	uint16_t faceid							/* Face-ID of the local app 				*/
+) {
+	return (face_tbl[faceid].shm);
+}
+/*--------------------------------------------------------------------------------------
+	Records the number of datagrams handled by one syscall to the histogram
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_batch_hist_record (
+	uint64_t hist[],						/* Histogram								*/
+	int num									/* Number of datagrams						*/
+) {
+	int idx = 0;
+
+	while ((num > 1) && (idx < CefC_Face_Batch_Hist_Num - 1)) {
+		num >>= 1;
+		idx++;
+	}
+	hist[idx]++;
+}
+#ifdef CefC_Face_Batch_Enable
+/*--------------------------------------------------------------------------------------
+	Queues the UDP datagram to send at cef_face_udp_batch_flush
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_udp_batch_push (
+	CefT_Sock* entry,						/* Socket to send							*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+) {
+	struct msghdr* hdr;
+	struct iovec* iov;
+	CefT_Pktbuf* pb;
+	size_t msg_len = fr->hdr_len + fr->msg_len - fr->skip;
+	int n;
+
+	if ((msg_len == 0) || (msg_len > CefC_Max_Length) ||
+		(fr->hdr_len > CefC_Max_Header_Size) ||
+		(entry->ai_addrlen > sizeof (struct sockaddr_storage))) {
+		return;
+	}
+	if (face_batch_tx_num == face_batch_num) {
+		cef_face_udp_batch_flush ();
+	}
+	n = face_batch_tx_num;
+
+	/* The caller reuses its buffer, so the datagram holds the packet buffer	*/
+	/* which the other Faces share, and the header of this Face is copied 		*/
+	pb = cef_face_tx_frame_hold (fr);
+	if (pb == NULL) {
+		face_batch_stat.tx_drop++;
+		return;
+	}
+	face_batch_tx_pbs[n] = pb;
+	iov = &face_batch_tx_iovs[n * 2];
+	if (fr->hdr_len > 0) {
+		memcpy (face_batch_tx_hdrs + (size_t) n * CefC_Max_Header_Size,
+				fr->hdr, fr->hdr_len);
+	}
+	iov[0].iov_base = face_batch_tx_hdrs + (size_t) n * CefC_Max_Header_Size;
+	iov[0].iov_len  = fr->hdr_len;
+	iov[1].iov_base = pb->data + fr->skip;
+	iov[1].iov_len  = fr->msg_len - fr->skip;
+	memcpy (&face_batch_tx_addrs[n], entry->ai_addr, entry->ai_addrlen);
+	face_batch_tx_socks[n] = entry->sock;
+
+	hdr = &face_batch_tx_msgs[n].msg_hdr;
+	memset (hdr, 0, sizeof (struct msghdr));
+	hdr->msg_name    = &face_batch_tx_addrs[n];
+	hdr->msg_namelen = entry->ai_addrlen;
+	hdr->msg_iov     = (fr->hdr_len > 0) ? &iov[0] : &iov[1];
+	hdr->msg_iovlen  = (fr->hdr_len > 0) ? 2 : 1;
+	face_batch_tx_num++;
+}
+#endif // CefC_Face_Batch_Enable
+/*--------------------------------------------------------------------------------------
+	Sends a message via the Face of the specified socket
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+cef_face_tx_frame_send (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Sock* entry,						/* Socket of the Face 						*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+) {
+	if ((face_tbl[faceid].local_f) ||
+		(face_tbl[faceid].protocol == CefC_Face_Type_Tcp)) {
+		if (cef_face_stream_send (faceid, entry->sock, fr) < 0) {
+			return (-1);
+		}
+	} else {
+#ifdef CefC_Face_Batch_Enable
+		if (face_batch_num > 1) {
+			cef_face_udp_batch_push (entry, fr);
+			return (0);
+		}
+#endif // CefC_Face_Batch_Enable
+		cef_face_udp_send (faceid, entry, fr);
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the packet buffer to keep the message to send later
+----------------------------------------------------------------------------------------*/
+static CefT_Pktbuf* 						/* Packet buffer (the caller holds it) 		*/
+cef_face_tx_frame_hold (
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+) {
+	if (fr->pb) {
+		return (cef_pktbuf_ref (fr->pb));
+	}
+	/* The Faces which keep the message being handled by cefnetd share one copy */
+	return (cef_pktbuf_cur_ref (fr->msg, fr->msg_len));
+}
+/*--------------------------------------------------------------------------------------
+	Sets the header and the body of the message to the iovec
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the set iovec 					*/
+cef_face_tx_frame_iov (
+	CefT_Face_Tx_Frame* fr,					/* a message to send						*/
+	struct iovec iov[2]
+) {
+	int n = 0;
+
+	if (fr->hdr_len > 0) {
+		iov[n].iov_base = fr->hdr;
+		iov[n].iov_len  = fr->hdr_len;
+		n++;
+	}
+	if (fr->msg_len > fr->skip) {
+		iov[n].iov_base = fr->msg + fr->skip;
+		iov[n].iov_len  = fr->msg_len - fr->skip;
+		n++;
+	}
+
+	return (n);
+}
+/*--------------------------------------------------------------------------------------
+	Sends a message to the stream (TCP or local) Face without blocking
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+cef_face_stream_send (
+	uint16_t faceid,						/* Face-ID									*/
+	int sock,								/* Socket of the Face 						*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+) {
+	struct iovec iov[2];
+	struct msghdr hdr;
+	size_t msg_len = fr->hdr_len + fr->msg_len - fr->skip;
+	ssize_t res = 0;
+	int wlen;
+	int n;
+	int i;
+
+	if (msg_len == 0) {
+		return (0);
+	}
+
+	/* The message goes behind the queued ones to keep the order 	*/
+	if (face_tbl[faceid].outq.head == NULL) {
+		n = cef_face_tx_frame_iov (fr, iov);
+
+		if (face_tbl[faceid].shm) {
+			for (i = 0 ; i < n ; i++) {
+				wlen = cef_shmring_write (
+					face_tbl[faceid].shm, iov[i].iov_base, (int) iov[i].iov_len);
+				res += wlen;
+				if (wlen < (int) iov[i].iov_len) {
+					break;
+				}
+			}
+		} else {
+			memset (&hdr, 0, sizeof (struct msghdr));
+			hdr.msg_iov 	= iov;
+			hdr.msg_iovlen 	= n;
+
+			res = sendmsg (sock, &hdr, MSG_DONTWAIT);
+			if (res < 0) {
+				if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+					face_tbl[faceid].outq.drop++;
+					return (-1);
+				}
+				res = 0;
+			}
+		}
+		if (res == (ssize_t) msg_len) {
+			return ((int) res);
+		}
+	}
+	if (cef_face_outq_push (faceid, fr, (size_t) res) < 0) {
+		return (-1);
+	}
+
+	return ((int) msg_len);
+}
+/*--------------------------------------------------------------------------------------
+	Sends a datagram to the UDP Face without blocking
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_udp_send (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Sock* entry,						/* Socket to send							*/
+	CefT_Face_Tx_Frame* fr					/* a message to send						*/
+) {
+	struct iovec iov[2];
+	struct msghdr hdr;
+
+	memset (&hdr, 0, sizeof (struct msghdr));
+	hdr.msg_name 	= entry->ai_addr;
+	hdr.msg_namelen = entry->ai_addrlen;
+	hdr.msg_iov 	= iov;
+	hdr.msg_iovlen 	= cef_face_tx_frame_iov (fr, iov);
+
+	/* A datagram is sent whole or lost, so it is not queued 	*/
+	if (sendmsg (entry->sock, &hdr, MSG_DONTWAIT) < 0) {
+		face_tbl[faceid].outq.drop++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Queues the rest of the message to send when the socket becomes writable
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if dropped 		*/
+cef_face_outq_push (
+	uint16_t faceid,						/* Face-ID									*/
+	CefT_Face_Tx_Frame* fr,					/* a message to send						*/
+	size_t sent								/* length already sent 						*/
+) {
+	CefT_Face_Outq* q = &face_tbl[faceid].outq;
+	CefT_Face_Outq_Msg* m;
+	CefT_Face_Outq_Msg* prev = NULL;
+	CefT_Face_Outq_Msg* next;
+	size_t msg_len = fr->hdr_len + fr->msg_len - fr->skip;
+	uint32_t rest = (uint32_t)(msg_len - sent);
+
+	/* The rest of the message partly sent is always queued, or the peer 	*/
+	/* loses the framing of the stream 										*/
+	if ((sent == 0) && (q->bytes + rest > face_outq_size)) {
+		if (face_outq_policy == CefC_Face_Outq_Drop_Head) {
+			/* Drops the oldest messages which are not sent at all 	*/
+			m = q->head;
+			while ((m != NULL) && (q->bytes + rest > face_outq_size)) {
+				next = m->next;
+				if (m->off > 0) {
+					prev = m;
+				} else {
+					if (prev) {
+						prev->next = next;
+					} else {
+						q->head = next;
+					}
+					if (q->tail == m) {
+						q->tail = prev;
+					}
+					q->bytes -= m->len;
+					q->num--;
+					q->drop++;
+					cef_face_outq_msg_free (m);
+				}
+				m = next;
+			}
+		}
+		if (q->bytes + rest > face_outq_size) {
+			q->drop++;
+			return (-1);
+		}
+	}
+
+	/* Only the header of the Face is copied, and the body is shared 	*/
+	m = (CefT_Face_Outq_Msg*) malloc (sizeof (CefT_Face_Outq_Msg) + fr->hdr_len);
+	if (m == NULL) {
+		cef_log_write (CefC_Log_Error, "%s(%u) malloc failed\n", __func__, __LINE__);
+		q->drop++;
+		return (-1);
+	}
+	m->pb = cef_face_tx_frame_hold (fr);
+	if (m->pb == NULL) {
+		cef_log_write (CefC_Log_Error, "%s(%u) malloc failed\n", __func__, __LINE__);
+		free (m);
+		q->drop++;
+		return (-1);
+	}
+	if (fr->hdr_len > 0) {
+		memcpy (m->hdr, fr->hdr, fr->hdr_len);
+	}
+	m->hdr_len 	= fr->hdr_len;
+	m->body 	= m->pb->data + fr->skip;
+	m->len 		= (uint32_t) msg_len;
+	m->off 		= (uint32_t) sent;
+	m->next 	= NULL;
+
+	if (q->tail) {
+		q->tail->next = m;
+	} else {
+		q->head = m;
+	}
+	q->tail = m;
+	q->num++;
+	q->bytes += rest;
+	q->enq++;
+
+	if (q->pend_f == 0) {
+		q->pend_f = 1;
+		face_outq_pend[face_outq_pend_num++] = faceid;
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Sets the rest of the queued message to the iovec
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the set iovec 					*/
+cef_face_outq_msg_iov (
+	CefT_Face_Outq_Msg* m,					/* Queued message 							*/
+	struct iovec iov[2]
+) {
+	int n = 0;
+
+	if (m->off < m->hdr_len) {
+		iov[n].iov_base = m->hdr + m->off;
+		iov[n].iov_len  = m->hdr_len - m->off;
+		n++;
+		iov[n].iov_base = m->body;
+		iov[n].iov_len  = m->len - m->hdr_len;
+	} else {
+		iov[n].iov_base = m->body + (m->off - m->hdr_len);
+		iov[n].iov_len  = m->len - m->off;
+	}
+	if (iov[n].iov_len > 0) {
+		n++;
+	}
+
+	return (n);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the queued message
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_outq_msg_free (
+	CefT_Face_Outq_Msg* m					/* Queued message 							*/
+) {
+	cef_pktbuf_unref (m->pb);
+	free (m);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages of the specified Face
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the queue remains, 0 if it is empty	*/
+cef_face_outq_face_flush (
+	uint16_t faceid							/* Face-ID									*/
+) {
+	CefT_Face_Outq* q = &face_tbl[faceid].outq;
+	CefT_Face_Outq_Msg* m;
+	struct iovec iov[CefC_Face_Outq_Iov_Max];
+	struct msghdr hdr;
+	size_t total;
+	size_t rest;
+	ssize_t res;
+	int full_f;
+	int n;
+
+	while (q->head != NULL) {
+		if (face_tbl[faceid].fd < 3) {
+			cef_face_outq_clear (faceid, 1);
+			return (0);
+		}
+		if (face_tbl[faceid].shm) {
+			return (cef_face_outq_shmring_flush (faceid));
+		}
+
+		/* Sends the queued messages with one syscall 		*/
+		total = 0;
+		for (m = q->head, n = 0 ; (m != NULL) && (n + 2 <= CefC_Face_Outq_Iov_Max) ;
+			 m = m->next) {
+			n += cef_face_outq_msg_iov (m, &iov[n]);
+			total += m->len - m->off;
+		}
+		memset (&hdr, 0, sizeof (struct msghdr));
+		hdr.msg_iov 	= iov;
+		hdr.msg_iovlen 	= n;
+
+		res = sendmsg (face_tbl[faceid].fd, &hdr, MSG_DONTWAIT);
+		if (res < 0) {
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+				return (1);
+			}
+			cef_face_outq_clear (faceid, 1);
+			return (0);
+		}
+		q->bytes -= (uint32_t) res;
+		full_f = ((size_t) res < total);
+
+		/* Frees the messages sent whole 		*/
+		while ((res > 0) && (q->head != NULL)) {
+			m = q->head;
+			rest = m->len - m->off;
+			if ((size_t) res < rest) {
+				m->off += (uint32_t) res;
+				break;
+			}
+			res -= (ssize_t) rest;
+			q->head = m->next;
+			q->num--;
+			cef_face_outq_msg_free (m);
+		}
+		if (q->head == NULL) {
+			q->tail = NULL;
+		}
+
+		/* Waits for the next POLLOUT when the socket is full 	*/
+		if (full_f) {
+			return (q->head != NULL);
+		}
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Writes the queued messages of the specified Face to its shared memory ring
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the queue remains, 0 if it is empty	*/
+cef_face_outq_shmring_flush (
+	uint16_t faceid							/* Face-ID									*/
+) {
+	CefT_Face_Outq* q = &face_tbl[faceid].outq;
+	CefT_Face_Outq_Msg* m;
+	struct iovec iov[2];
+	int res;
+
+	while ((m = q->head) != NULL) {
+		/* Writes the header and the body in turn 		*/
+		while (m->off < m->len) {
+			cef_face_outq_msg_iov (m, iov);
+			res = cef_shmring_write (face_tbl[faceid].shm,
+									iov[0].iov_base, (int) iov[0].iov_len);
+			if (res <= 0) {
+				return (1);
+			}
+			q->bytes -= (uint32_t) res;
+			m->off += (uint32_t) res;
+		}
+		q->head = m->next;
+		q->num--;
+		cef_face_outq_msg_free (m);
+	}
+	q->tail = NULL;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the queued messages of the specified Face
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_outq_clear (
+	uint16_t faceid,						/* Face-ID									*/
+	int drop_f								/* counts the freed messages as dropped 	*/
+) {
+	CefT_Face_Outq* q = &face_tbl[faceid].outq;
+	CefT_Face_Outq_Msg* m;
+
+	while (q->head != NULL) {
+		m = q->head;
+		q->head = m->next;
+		cef_face_outq_msg_free (m);
+		if (drop_f) {
+			q->drop++;
+		}
+	}
+	q->tail 	= NULL;
+	q->num 		= 0;
+	q->bytes 	= 0;
+}
+/*--------------------------------------------------------------------------------------
+	Looks up the peer Face cache with the binary peer address
+----------------------------------------------------------------------------------------*/
+static CefT_Face_Peer_Cache*				/* slot of the cache, or NULL if the address*/
+											/* can not be cached 						*/
+cef_face_peer_cache_slot_get (
+	const struct sockaddr* sa, 				/* peer address								*/
+	socklen_t sa_len,						/* length of the peer address				*/
+	int protocol,
+	int* hit_f								/* set 1 if the slot holds the address 		*/
+) {
+	CefT_Face_Peer_Cache* slot;
+	uint8_t addr[16];
+	uint32_t words[4];
+	uint32_t scope_id = 0;
+	uint32_t hv;
+	in_port_t port;
+	int addr_len;
+
+	*hit_f = 0;
+
+	if ((sa->sa_family == AF_INET) && (sa_len >= sizeof (struct sockaddr_in))) {
+		const struct sockaddr_in* sin = (const struct sockaddr_in*) sa;
+		addr_len = 4;
+		memcpy (addr, &sin->sin_addr, addr_len);
+		port = sin->sin_port;
+	} else if ((sa->sa_family == AF_INET6) && (sa_len >= sizeof (struct sockaddr_in6))) {
+		const struct sockaddr_in6* sin6 = (const struct sockaddr_in6*) sa;
+		addr_len = 16;
+		memcpy (addr, &sin6->sin6_addr, addr_len);
+		port = sin6->sin6_port;
+		scope_id = sin6->sin6_scope_id;
+	} else {
+		return (NULL);
+	}
+	memset (addr + addr_len, 0, sizeof (addr) - addr_len);
+	memcpy (words, addr, sizeof (words));
+
+	/* Multiplicative hash of the folded address, port and protocol 	*/
+	hv = words[0] ^ words[1] ^ words[2] ^ words[3] ^ scope_id;
+	hv ^= ((uint32_t) port << 16) | (uint32_t) protocol;
+	hv *= 0x9E3779B1;
+	slot = &peer_cache[hv >> (32 - CefC_Face_Peer_Cache_Bits)];
+
+	if ((slot->faceid > 0) &&
+		(slot->family == sa->sa_family) && (slot->port == port) &&
+		(slot->protocol == protocol) && (slot->scope_id == scope_id) &&
+		(memcmp (slot->addr, addr, sizeof (addr)) == 0) &&
+		(face_tbl[slot->faceid].fd > 0)) {
+		*hit_f = 1;
+		return (slot);
+	}
+
+	/* Prepares the slot; the Face-ID is set after the slow path succeeds 	*/
+	slot->faceid   = 0;
+	slot->family   = sa->sa_family;
+	slot->port     = port;
+	slot->protocol = protocol;
+	slot->scope_id = scope_id;
+	memcpy (slot->addr, addr, sizeof (addr));
+
+	return (slot);
+}
+/*--------------------------------------------------------------------------------------
+	Removes the specified Face-ID from the peer Face cache
+----------------------------------------------------------------------------------------*/
+static void
+cef_face_peer_cache_purge (
+	int faceid								/* Face-ID									*/
+) {
+	int i;
+
+	for (i = 0 ; i < CefC_Face_Peer_Cache_Size ; i++) {
+		if (peer_cache[i].faceid == faceid) {
+			peer_cache[i].faceid = 0;
+		}
+	}
+}
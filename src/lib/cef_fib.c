@@ -63,16 +63,46 @@
 #define CefC_Fib_Default_Len	4
 #define CefC_Fib_Addr_Max		32
 
+/*----- LPM index (prefix-depth counts and counting Bloom filter over prefixes) -----*/
+#define CefC_Fib_Lpm_Depth_Max	128				/* max components handled by the index	*/
+#define CefC_Fib_Lpm_Bloom_Bits	20
+#define CefC_Fib_Lpm_Bloom_Size	(1 << CefC_Fib_Lpm_Bloom_Bits)
+#define CefC_Fib_Lpm_Bloom_Mask	(CefC_Fib_Lpm_Bloom_Size - 1)
+#define CefC_Fib_Lpm_Bloom_Sat	0xFF			/* saturated counters are never lowered	*/
+/* Two indexes of the Bloom filter from the hash value of the prefix 			*/
+#define CefC_Fib_Lpm_Bloom_Idx1(hv)	((hv) & CefC_Fib_Lpm_Bloom_Mask)
+#define CefC_Fib_Lpm_Bloom_Idx2(hv)	\
+	((uint32_t)((hv) * 0x9E3779B1U) >> (32 - CefC_Fib_Lpm_Bloom_Bits))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** Read-only copy of the routes for the forwarding workers 	*****/
+struct CefT_Fib_Snapshot {
+	CefT_Hash_Handle 		tbl;			/* Key -> route 							*/
+	CefT_Fib_Snap_Route* 	routes;			/* routes of all entries 					*/
+	CefT_Fib_Snap_Route* 	def_route;		/* route of the default entry, or NULL 		*/
+	uint32_t 				depth_num[CefC_Fib_Lpm_Depth_Max + 1];
+	uint32_t 				irregular_num;	/* keys which the LPM can not handle 		*/
+	uint32_t 				generation;		/* cef_fib_generation_get at the creation 	*/
+};
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
 static CefT_Fib_Entry* default_entry = NULL;
 static char prot_str[3][16] = {"invalid", "tcp", "udp"};
 
+/* Number of FIB entries per name depth (components), index 0 is unused 		*/
+static uint32_t fib_lpm_depth_num[CefC_Fib_Lpm_Depth_Max + 1];
+/* Counting Bloom filter over the hashes of the registered prefixes 			*/
+static uint8_t fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Size];
+/* Number of FIB entries whose key can not be indexed (malformed or too deep) 	*/
+static uint32_t fib_lpm_irregular_num = 0;
+/* Changed whenever an entry or a Face of an entry is added or removed 		*/
+static uint32_t fib_generation = 0;
+
 #ifdef CefC_Debug
 static char 	fib_dbg_msg[2048];
 #endif // CefC_Debug
@@ -81,6 +111,28 @@ static char 	fib_dbg_msg[2048];
  Static Function Declaration
  ****************************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+	Splits the name into components and hashes every prefix of it
+----------------------------------------------------------------------------------------*/
+static int									/* number of prefixes, or -1 if the name 	*/
+											/* can not be handled by the LPM index 		*/
+cef_fib_lpm_prefix_parse (
+	const unsigned char* name, 				/* Name TLVs (without the Name T/L) 		*/
+	uint16_t name_len,						/* Length of Name							*/
+	uint16_t ends[],						/* set end offset of each prefix 			*/
+	uint32_t hashes[]						/* set hash value of each prefix 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Registers/Unregisters the key of the FIB entry to/from the LPM index
+----------------------------------------------------------------------------------------*/
+static void
+cef_fib_lpm_index_add (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+);
+static void
+cef_fib_lpm_index_del (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+);
 /*--------------------------------------------------------------------------------------
 	Reads the FIB configuration file
 ----------------------------------------------------------------------------------------*/
@@ -166,15 +218,62 @@ cef_fib_entry_search (
 	CefT_Hash_Handle fib,					/* FIB										*/
 	unsigned char* name, 					/* Key of the FIB entry						*/
 	uint16_t name_len						/* Length of Key							*/
+) {
+	return (cef_fib_entry_search_with_hashv (fib, name, name_len, NULL, NULL, 0));
+}
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry matching the specified Key with the hash values of its
+	prefixes which the caller has created (e.g. name_hashv of the parsed message)
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Entry* 							/* FIB entry 								*/
+cef_fib_entry_search_with_hashv (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len,						/* Length of Key							*/
+	const uint16_t pfx_ends[],				/* Length of each prefix of the Key 		*/
+	const uint32_t pfx_hashv[],				/* Hash value of each prefix of the Key 	*/
+	int pfx_num								/* Number of the prefixes, 0 if not hashed	*/
 ) {
 	CefT_Fib_Entry* entry;
-	unsigned char* msp;
-	unsigned char* mep;
-	uint16_t len = name_len;
-	uint16_t length;
+	uint16_t ends_buf[CefC_Fib_Lpm_Depth_Max];
+	uint32_t hashes_buf[CefC_Fib_Lpm_Depth_Max];
+	const uint16_t* ends = pfx_ends;
+	const uint32_t* hashes = pfx_hashv;
+	uint32_t hv;
+	int depth = 0;
+
+	if (fib_lpm_irregular_num > 0) {
+		return (cef_fib_entry_search_linear (fib, name, name_len));
+	}
 
-	while (len > 0) {
-		entry = (CefT_Fib_Entry*) cef_hash_tbl_item_get (fib, name, len);
+	/* The given prefixes may be longer than the Key (e.g. with Chunk Number) 	*/
+	while ((depth < pfx_num) && (depth < CefC_Fib_Lpm_Depth_Max) &&
+		   (pfx_ends[depth] <= name_len)) {
+		depth++;
+	}
+	if ((depth == 0) || (pfx_ends[depth - 1] != name_len)) {
+		ends   = ends_buf;
+		hashes = hashes_buf;
+		depth  = cef_fib_lpm_prefix_parse (name, name_len, ends_buf, hashes_buf);
+		if (depth < 0) {
+			return (cef_fib_entry_search_linear (fib, name, name_len));
+		}
+	}
+
+	/* Probes the hash table only for the prefixes which may be registered 	*/
+	while (depth > 0) {
+		if (fib_lpm_depth_num[depth] == 0) {
+			depth--;
+			continue;
+		}
+		hv = hashes[depth - 1];
+		if ((fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx1 (hv)] == 0) ||
+			(fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx2 (hv)] == 0)) {
+			depth--;
+			continue;
+		}
+		entry = (CefT_Fib_Entry*)
+			cef_hash_tbl_item_get_with_hashv (fib, name, ends[depth - 1], hv);
 
 		if (entry != NULL) {
 #ifdef CefC_Debug
@@ -191,20 +290,7 @@ cef_fib_entry_search (
 #endif // CefC_Debug
 			return (entry);
 		}
-
-		msp = name;
-		mep = name + len - 1;
-		while (msp < mep) {
-			memcpy (&length, &msp[CefC_S_Length], CefC_S_Length);
-			length = ntohs (length);
-
-			if (msp + CefC_S_Type + CefC_S_Length + length < mep) {
-				msp += CefC_S_Type + CefC_S_Length + length;
-			} else {
-				break;
-			}
-		}
-		len = msp - name;
+		depth--;
 	}
 
 	return (default_entry);
@@ -317,6 +403,7 @@ cef_fib_faceid_remove (
 			prev->next = face->next;
 			free (face);
 			remove_f = 1;
+			fib_generation++;
 			break;
 		}
 		prev = face;
@@ -325,6 +412,7 @@ cef_fib_faceid_remove (
 	/* check fib entry */
 	if (entry->faces.next == NULL) {
 		entry = (CefT_Fib_Entry*) cef_hash_tbl_item_remove (fib, entry->key, entry->klen);
+		cef_fib_lpm_index_del (entry);
 		if (entry->klen == CefC_Fib_Default_Len) {
 			default_entry = NULL;
 		}
@@ -376,6 +464,7 @@ cef_fib_faceid_insert (
 	memset(face->next, 0x00, sizeof (CefT_Fib_Face));
 	face->next->faceid = faceid;
 	face->next->next = NULL;
+	fib_generation++;
 
 	return (1);
 }
@@ -400,6 +489,7 @@ cef_fib_entry_lookup (
 		}
 		entry = cef_fib_entry_create (name, name_len);
 		cef_hash_tbl_item_set (fib, name, name_len, entry);
+		cef_fib_lpm_index_add (entry);
 
 		if (name_len == CefC_Fib_Default_Len) {
 			default_entry = entry;
@@ -433,6 +523,7 @@ cef_fib_faceid_cleanup (
 				if (cef_face_check_close (face->faceid)) {
 					prev->next = face->next;
 					free (face);
+					fib_generation++;
 					break;
 				}
 				prev = face;
@@ -440,6 +531,7 @@ cef_fib_faceid_cleanup (
 
 			if (entry->faces.next == NULL) {
 				work = (CefT_Fib_Entry*) cef_hash_tbl_item_remove_from_index (fib, index);
+				cef_fib_lpm_index_del (work);
 
 				if (work->klen == CefC_Fib_Default_Len) {
 					default_entry = NULL;
@@ -688,6 +780,7 @@ OWN_ID:
 			}
 			entry = cef_fib_entry_create (name, res);
 			cef_hash_tbl_item_set (fib, name, res, entry);
+			cef_fib_lpm_index_add (entry);
 		}
 
 		if (res == CefC_Fib_Default_Len) {
@@ -856,6 +949,7 @@ cef_fib_entry_destroy (
 	if (entry == NULL) {
 		return (0);
 	}
+	cef_fib_lpm_index_del (entry);
 
 	face = entry->faces.next;
 
@@ -903,6 +997,7 @@ cef_fib_set_faceid_to_entry (
 	face->next->tx_int_types[0] = 0;
 	face->next->tx_int_types[1] = 0;
 	face->next->tx_int_types[2] = 0;
+	fib_generation++;
 	if ( fib_metric != NULL ) {
 		memcpy(&(face->next->metric), fib_metric, sizeof(CefT_Fib_Metric));
 	}
@@ -931,6 +1026,7 @@ cef_fib_remove_faceid_from_entry (
 			if (type > face->type) {
 				prev->next = face->next;
 				free (face);
+				fib_generation++;
 			}
 			return (1);
 		}
@@ -1266,6 +1362,7 @@ cef_fib_route_add (
 		/* create new entry */
 		entry = cef_fib_entry_create (name, res);
 		cef_hash_tbl_item_set (fib, name, res, entry);
+		cef_fib_lpm_index_add (entry);
 	}
 	cef_log_write (CefC_Log_Info,
 		"Insert the FIB entry: URI=%s, Prot=%s, Next=%s, Face=%d\n",
@@ -1370,6 +1467,7 @@ cef_fib_route_del (
 
 		/* fib entry is empty */
 		fib_entry = (CefT_Fib_Entry*) cef_hash_tbl_item_remove (fib, name, name_len);
+		cef_fib_lpm_index_del (fib_entry);
 		free (fib_entry->key);
 		fib_entry->key = NULL;
 		free (fib_entry);
@@ -1462,3 +1560,302 @@ cef_fib_info_get (
 endfunc:;
 	return (strlen (info_buff));
 }
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry by removing the name components one by one
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Entry* 							/* FIB entry 								*/
+cef_fib_entry_search_linear (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len						/* Length of Key							*/
+) {
+	CefT_Fib_Entry* entry;
+	unsigned char* msp;
+	unsigned char* mep;
+	uint16_t len = name_len;
+	uint16_t length;
+
+	while (len > 0) {
+		entry = (CefT_Fib_Entry*) cef_hash_tbl_item_get (fib, name, len);
+
+		if (entry != NULL) {
+#ifdef CefC_Debug
+			{
+				int dbg_x;
+				int len = 0;
+
+				len = sprintf (fib_dbg_msg, "[fib] matched to the entry [");
+				for (dbg_x = 0 ; dbg_x < entry->klen ; dbg_x++) {
+					len = len + sprintf (fib_dbg_msg + len, " %02X", entry->key[dbg_x]);
+				}
+				cef_dbg_write (CefC_Dbg_Finest, "%s ]\n", fib_dbg_msg);
+			}
+#endif // CefC_Debug
+			return (entry);
+		}
+
+		msp = name;
+		mep = name + len - 1;
+		while (msp < mep) {
+			memcpy (&length, &msp[CefC_S_Length], CefC_S_Length);
+			length = ntohs (length);
+
+			if (msp + CefC_S_Type + CefC_S_Length + length < mep) {
+				msp += CefC_S_Type + CefC_S_Length + length;
+			} else {
+				break;
+			}
+		}
+		len = msp - name;
+	}
+
+	return (default_entry);
+}
+/*--------------------------------------------------------------------------------------
+	Splits the name into components and hashes every prefix of it
+----------------------------------------------------------------------------------------*/
+static int									/* number of prefixes, or -1 if the name 	*/
+											/* can not be handled by the LPM index 		*/
+cef_fib_lpm_prefix_parse (
+	const unsigned char* name, 				/* Name TLVs (without the Name T/L) 		*/
+	uint16_t name_len,						/* Length of Name							*/
+	uint16_t ends[],						/* set end offset of each prefix 			*/
+	uint32_t hashes[]						/* set hash value of each prefix 			*/
+) {
+	uint32_t off = 0;
+	uint32_t next;
+	uint16_t length;
+	int num = 0;
+
+	while (off < name_len) {
+		if (off + CefC_S_Type + CefC_S_Length > name_len) {
+			return (-1);
+		}
+		memcpy (&length, &name[off + CefC_S_Type], CefC_S_Length);
+		next = off + CefC_S_Type + CefC_S_Length + ntohs (length);
+		if ((next > name_len) || (num == CefC_Fib_Lpm_Depth_Max)) {
+			return (-1);
+		}
+
+		ends[num] = (uint16_t) next;
+		off = next;
+		num++;
+	}
+
+	/* Same hash values as the FIB hash table, so that they are also used 	*/
+	/* to probe it 															*/
+	cef_hash_key_prefix_hashv_create (name, ends, hashes, num);
+
+	return (num);
+}
+/*--------------------------------------------------------------------------------------
+	Registers the key of the FIB entry to the LPM index
+----------------------------------------------------------------------------------------*/
+static void
+cef_fib_lpm_index_add (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+) {
+	uint16_t ends[CefC_Fib_Lpm_Depth_Max];
+	uint32_t hashes[CefC_Fib_Lpm_Depth_Max];
+	uint8_t* cnt;
+	int depth;
+
+	fib_generation++;
+	depth = cef_fib_lpm_prefix_parse (entry->key, entry->klen, ends, hashes);
+	if (depth < 1) {
+		fib_lpm_irregular_num++;
+		return;
+	}
+	fib_lpm_depth_num[depth]++;
+
+	cnt = &fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx1 (hashes[depth - 1])];
+	if (*cnt < CefC_Fib_Lpm_Bloom_Sat) {
+		(*cnt)++;
+	}
+	cnt = &fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx2 (hashes[depth - 1])];
+	if (*cnt < CefC_Fib_Lpm_Bloom_Sat) {
+		(*cnt)++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Unregisters the key of the FIB entry from the LPM index
+----------------------------------------------------------------------------------------*/
+static void
+cef_fib_lpm_index_del (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+) {
+	uint16_t ends[CefC_Fib_Lpm_Depth_Max];
+	uint32_t hashes[CefC_Fib_Lpm_Depth_Max];
+	uint8_t* cnt;
+	int depth;
+
+	fib_generation++;
+	depth = cef_fib_lpm_prefix_parse (entry->key, entry->klen, ends, hashes);
+	if (depth < 1) {
+		if (fib_lpm_irregular_num > 0) {
+			fib_lpm_irregular_num--;
+		}
+		return;
+	}
+	if (fib_lpm_depth_num[depth] > 0) {
+		fib_lpm_depth_num[depth]--;
+	}
+
+	cnt = &fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx1 (hashes[depth - 1])];
+	if ((*cnt > 0) && (*cnt < CefC_Fib_Lpm_Bloom_Sat)) {
+		(*cnt)--;
+	}
+	cnt = &fib_lpm_bloom[CefC_Fib_Lpm_Bloom_Idx2 (hashes[depth - 1])];
+	if ((*cnt > 0) && (*cnt < CefC_Fib_Lpm_Bloom_Sat)) {
+		(*cnt)--;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the FIB, which changes whenever a route changes
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_fib_generation_get (
+	void
+) {
+	return (fib_generation);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the read-only copy of the routes in the FIB. The copy does not refer to
+	the FIB, so that other threads can search it while the FIB changes.
+----------------------------------------------------------------------------------------*/
+CefT_Fib_Snapshot* 							/* the snapshot, or NULL if it fails 		*/
+cef_fib_snapshot_create (
+	CefT_Hash_Handle fib					/* FIB										*/
+) {
+	CefT_Fib_Snapshot* snap;
+	CefT_Fib_Entry* entry;
+	CefT_Fib_Face* face;
+	CefT_Fib_Snap_Route* route;
+	uint16_t ends[CefC_Fib_Lpm_Depth_Max];
+	uint32_t hashes[CefC_Fib_Lpm_Depth_Max];
+	uint32_t index = 0;
+	uint32_t num;
+	uint32_t i = 0;
+	int depth;
+
+	snap = (CefT_Fib_Snapshot*) calloc (1, sizeof (CefT_Fib_Snapshot));
+	if (snap == NULL) {
+		return (NULL);
+	}
+	num = (uint32_t) cef_hash_tbl_item_num_get (fib);
+	snap->tbl = cef_hash_tbl_create (num + 1);
+	snap->routes = (CefT_Fib_Snap_Route*) calloc (num + 1, sizeof (CefT_Fib_Snap_Route));
+	if ((snap->tbl == (CefT_Hash_Handle) NULL) || (snap->routes == NULL)) {
+		cef_fib_snapshot_destroy (snap);
+		return (NULL);
+	}
+	snap->generation = fib_generation;
+
+	do {
+		entry = (CefT_Fib_Entry*) cef_hash_tbl_item_check_from_index (fib, &index);
+		if ((entry == NULL) || (i == num)) {
+			break;
+		}
+		route = &snap->routes[i];
+		face = entry->faces.next;
+		while ((face != NULL) && (route->face_num < CefC_Fib_UpFace_Max)) {
+			route->faceids[route->face_num] = (uint16_t) face->faceid;
+			route->face_num++;
+			face = face->next;
+		}
+		if (cef_hash_tbl_item_set (snap->tbl, entry->key, entry->klen, route) < 0) {
+			cef_fib_snapshot_destroy (snap);
+			return (NULL);
+		}
+		if (entry == default_entry) {
+			snap->def_route = route;
+		}
+		depth = cef_fib_lpm_prefix_parse (entry->key, entry->klen, ends, hashes);
+		if (depth < 1) {
+			snap->irregular_num++;
+		} else {
+			snap->depth_num[depth]++;
+		}
+		i++;
+		index++;
+	} while (entry);
+
+	return (snap);
+}
+/*--------------------------------------------------------------------------------------
+	Searches the route matching the specified Key in the snapshot by the longest
+	prefix match of cef_fib_entry_search_with_hashv
+----------------------------------------------------------------------------------------*/
+int 										/* 0 if searched, -1 if the snapshot can not */
+											/* decide (the caller must use the FIB) 	*/
+cef_fib_snapshot_search (
+	const CefT_Fib_Snapshot* snap,			/* snapshot 								*/
+	const unsigned char* name, 				/* Key 										*/
+	uint16_t name_len,						/* Length of Key							*/
+	const uint16_t pfx_ends[],				/* Length of each prefix of the Key 		*/
+	const uint32_t pfx_hashv[],				/* Hash value of each prefix of the Key 	*/
+	int pfx_num,							/* Number of the prefixes, 0 if not hashed	*/
+	const CefT_Fib_Snap_Route** route		/* set the route, or NULL if no route 		*/
+) {
+	uint16_t ends_buf[CefC_Fib_Lpm_Depth_Max];
+	uint32_t hashes_buf[CefC_Fib_Lpm_Depth_Max];
+	const uint16_t* ends = pfx_ends;
+	const uint32_t* hashes = pfx_hashv;
+	int depth = 0;
+
+	*route = NULL;
+	if (snap->irregular_num > 0) {
+		return (-1);
+	}
+	while ((depth < pfx_num) && (depth < CefC_Fib_Lpm_Depth_Max) &&
+		   (pfx_ends[depth] <= name_len)) {
+		depth++;
+	}
+	if ((depth == 0) || (pfx_ends[depth - 1] != name_len)) {
+		ends   = ends_buf;
+		hashes = hashes_buf;
+		depth  = cef_fib_lpm_prefix_parse (name, name_len, ends_buf, hashes_buf);
+		if (depth < 0) {
+			return (-1);
+		}
+	}
+
+	while (depth > 0) {
+		if (snap->depth_num[depth] > 0) {
+			*route = (const CefT_Fib_Snap_Route*) cef_hash_tbl_item_get_with_hashv (
+				snap->tbl, name, ends[depth - 1], hashes[depth - 1]);
+			if (*route != NULL) {
+				return (0);
+			}
+		}
+		depth--;
+	}
+	*route = snap->def_route;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the FIB from which the snapshot was created
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_fib_snapshot_generation_get (
+	const CefT_Fib_Snapshot* snap			/* snapshot 								*/
+) {
+	return (snap->generation);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the snapshot
+----------------------------------------------------------------------------------------*/
+void
+cef_fib_snapshot_destroy (
+	CefT_Fib_Snapshot* snap					/* snapshot 								*/
+) {
+	if (snap == NULL) {
+		return;
+	}
+	if (snap->tbl) {
+		cef_hash_tbl_destroy (snap->tbl);
+	}
+	free (snap->routes);
+	free (snap);
+}
@@ -62,6 +62,7 @@
 #include <cefore/cef_log.h>
 #include <cefore/cef_plugin.h>
 #include <cefore/cef_valid.h>
+#include <cefore/cef_hash.h>
 
 #ifdef DEB_CCNINFO
 #include <ctype.h>
@@ -102,6 +103,9 @@
 		} while (_range > 0);								\
 	} while (0)
 
+/* OPT_SEQNUM of the Face is not written to the Content Object 			*/
+#define CefC_Frame_Seqnum_Disabled	1		/* 2023/08/16 Disabled for debugging 	*/
+
 #define Opt_T_Org_exist				0x0100
 #define Opt_T_OrgSeq_exist			0x0010
 #define Opt_T_OrgOther_exist		0x0001
@@ -122,6 +126,9 @@ static size_t ccnprefix2_len = sizeof (ccnprefix2) - 1; /* without NULL */
 
 static int cef_opt_seqnum_f = CefC_OptSeqnum_NotUse;
 
+/* When set, RSA-SHA256 signatures are reserved and set by cef_valid_msg_sign 	*/
+static int cef_sign_defer_f = 0;
+
 /*------------------------------------------------------------------
 	the Link Message template
  -------------------------------------------------------------------*/
@@ -592,6 +599,35 @@ cef_frame_message_user_tlv_parse (
 	unsigned char* value,					/* Value of this TLV						*/
 	uint16_t offset							/* Offset from the top of message 			*/
 );
+/*--------------------------------------------------------------------------------------
+	Parses the Option Header(s)
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_opheader_parse (
+	unsigned char* msg, 					/* the message to parse						*/
+	CefT_CcnMsg_OptHdr* poh 				/* Structure to set parsed Option Header(s)	*/
+);
+/*--------------------------------------------------------------------------------------
+	Decodes the Name in the view
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_view_name_decode (
+	CefT_CcnMsg_View* view 					/* View of the message						*/
+);
+/*--------------------------------------------------------------------------------------
+	Initializes the fields of the parsed CEFORE message except the buffers
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_msgbdy_fields_init (
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+);
+/*--------------------------------------------------------------------------------------
+	Hashes the prefixes of the Name in the parsed message
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_name_hashv_set (
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+);
 /*--------------------------------------------------------------------------------------
 	Sets T_ORG Field to OptionHeader from the specified Parameters
 ----------------------------------------------------------------------------------------*/
@@ -729,16 +765,11 @@ cef_frame_message_parse (
 
 	CEF_DBG_OUT("type=%d, header_len=%u, payload_len=%u\n", target_type, header_len, payload_len);
 
-	//poh init
-	poh->lifetime_f = 0;
-	poh->cachetime_f = 0;
-	poh->app_reg_f = 0;
-	poh->nodeid_len = 0;
-	poh->org.tp_variant = 0;
 	//pm init
 	pm->name_f = 0;
 	pm->chunk_num_f = 0;
 	pm->end_chunk_num_f = 0;
+	pm->name_hash_num = 0;
 	pm->nonce_f = 0;
 	pm->nonce = 0;
 	pm->payload_f = 0;
@@ -764,26 +795,7 @@ cef_frame_message_parse (
 	/*----------------------------------------------------------------------*/
 	/* Parses Option Header				 									*/
 	/*----------------------------------------------------------------------*/
-	smp = msg + CefC_S_Fix_Header;
-	offset = CefC_S_Fix_Header;
-	length = msg[CefC_O_Fix_HeaderLength] - CefC_S_Fix_Header;
-
-	wmp = smp;
-	emp = smp + length;
-
-	while (wmp < emp) {
-		thdr = (struct tlv_hdr*) &wmp[CefC_O_Type];
-		type   = ntohs (thdr->type);
-		length = ntohs (thdr->length);
-
-		if ((type > CefC_T_OPT_INVALID) && (type < CefC_T_OPT_TLV_NUM)) {
-			(*cef_frame_opheader_tlv_parse[type])(poh, length, &wmp[4], offset);
-		} else if ((type >= CefC_T_OPT_ORG) && (type < CefC_T_OPT_USR_TLV_NUM)) {
-			cef_frame_opheader_user_tlv_parse (poh, type, length, &wmp[4], offset);
-		}
-		wmp += CefC_S_TLF + length;
-		offset += CefC_S_TLF + length;
-	}
+	cef_frame_opheader_parse (msg, poh);
 
 	/*----------------------------------------------------------------------*/
 	/* Parses CEFORE message 												*/
@@ -838,6 +850,410 @@ cef_frame_message_parse (
 
 	return (1);
 }
+/*--------------------------------------------------------------------------------------
+	Parses the Option Header(s)
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_opheader_parse (
+	unsigned char* msg, 					/* the message to parse						*/
+	CefT_CcnMsg_OptHdr* poh 				/* Structure to set parsed Option Header(s)	*/
+) {
+	unsigned char* wmp;
+	unsigned char* emp;
+	uint16_t length;
+	uint16_t type;
+	uint16_t offset;
+	struct tlv_hdr* thdr;
+
+	//poh init
+	poh->lifetime_f = 0;
+	poh->cachetime_f = 0;
+	poh->app_reg_f = 0;
+	poh->nodeid_len = 0;
+	poh->org.tp_variant = 0;
+
+	wmp = msg + CefC_S_Fix_Header;
+	offset = CefC_S_Fix_Header;
+	length = msg[CefC_O_Fix_HeaderLength] - CefC_S_Fix_Header;
+	emp = wmp + length;
+
+	while (wmp < emp) {
+		thdr = (struct tlv_hdr*) &wmp[CefC_O_Type];
+		type   = ntohs (thdr->type);
+		length = ntohs (thdr->length);
+
+		if ((type > CefC_T_OPT_INVALID) && (type < CefC_T_OPT_TLV_NUM)) {
+			(*cef_frame_opheader_tlv_parse[type])(poh, length, &wmp[4], offset);
+		} else if ((type >= CefC_T_OPT_ORG) && (type < CefC_T_OPT_USR_TLV_NUM)) {
+			cef_frame_opheader_user_tlv_parse (poh, type, length, &wmp[4], offset);
+		}
+		wmp += CefC_S_TLF + length;
+		offset += CefC_S_TLF + length;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Parses a message into the view. The Option Header(s) are parsed into poh, and
+	only the positions of the TLVs in the CEFORE message are recorded.
+----------------------------------------------------------------------------------------*/
+int 										/* Returns a negative value if it fails 	*/
+cef_frame_message_view_parse (
+	unsigned char* msg, 					/* the message to parse						*/
+	uint16_t payload_len, 					/* Payload Length of this message			*/
+	uint16_t header_len, 					/* Header Length of this message			*/
+	CefT_CcnMsg_OptHdr* poh, 				/* Structure to set parsed Option Header(s)	*/
+	CefT_CcnMsg_View* view, 				/* View to set the positions of the TLVs	*/
+	int target_type							/* Type of the message to expect			*/
+) {
+	unsigned char* wmp;
+	unsigned char* emp;
+	uint16_t length;
+	uint16_t type;
+	uint16_t offset;
+	struct tlv_hdr* thdr;
+	CefT_CcnMsg_View_Tlv* tlv;
+
+	/*----------------------------------------------------------------------*/
+	/* Parses Option Header				 									*/
+	/*----------------------------------------------------------------------*/
+	cef_frame_opheader_parse (msg, poh);
+
+	/*----------------------------------------------------------------------*/
+	/* Records the TLVs of CEFORE message 									*/
+	/*----------------------------------------------------------------------*/
+	view->msg 			= msg;
+	view->payload_len 	= payload_len;
+	view->header_len 	= header_len;
+	view->hoplimit 		= 0;
+	view->decoded 		= 0;
+	memset (view->tlv, 0, sizeof (view->tlv));
+	memset (&view->org, 0, sizeof (view->org));
+
+	thdr = (struct tlv_hdr*) &msg[header_len + CefC_O_Type];
+	view->top_level_type = ntohs (thdr->type);
+	length = ntohs (thdr->length);
+
+	if (length + CefC_S_TLF > payload_len) {
+		return (-1);
+	}
+
+	wmp = msg + header_len + CefC_S_TLF;
+	emp = wmp + length;
+	offset = header_len + CefC_S_TLF;
+
+	while (wmp < emp) {
+		thdr = (struct tlv_hdr*) &wmp[CefC_O_Type];
+		type   = ntohs (thdr->type);
+		length = ntohs (thdr->length);
+
+		/* The value is read from the frame later, so it must be inside 	*/
+		if (wmp + CefC_S_TLF + length > emp) {
+			return (-1);
+		}
+		if (type < CefC_T_MSG_TLV_NUM) {
+			tlv = &view->tlv[type];
+		} else if (type == CefC_T_ORG) {
+			tlv = &view->org;
+		} else {
+			tlv = NULL;
+		}
+		if (tlv) {
+			tlv->value 	= &wmp[CefC_O_Value];
+			tlv->offset = offset;
+			tlv->length = length;
+		}
+		wmp += CefC_S_TLF + length;
+		offset += CefC_S_TLF + length;
+	}
+
+	/*----------------------------------------------------------------------*/
+	/* Parses Fixed Header			 										*/
+	/*----------------------------------------------------------------------*/
+	if ((target_type == CefC_PT_INTEREST) ||
+		(target_type == CefC_PT_REQUEST)) {
+		view->hoplimit = msg[CefC_O_Fix_HopLimit];
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Decodes the Name in the view
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_view_name_decode (
+	CefT_CcnMsg_View* view 					/* View of the message						*/
+) {
+	CefT_CcnMsg_View_Tlv* tlv = &view->tlv[CefC_T_NAME];
+	struct tlv_hdr* thdr;
+	uint16_t sub_type;
+	uint16_t sub_length;
+	uint16_t index = 0;
+	uint16_t name_len = 0;
+	uint16_t chunk_idx = 0;
+	uint32_t chunk_num_wk;
+	uint16_t chunk_len_wk;
+	int i;
+
+	view->decoded |= CefC_View_Name_Decoded;
+	view->name 			= NULL;
+	view->name_len 		= 0;
+	view->chunk_num_f 	= 0;
+	view->chunk_len 	= 0;
+	view->chunk_num 	= 0;
+
+	if (tlv->value == NULL) {
+		return;
+	}
+
+	/* Same as cef_frame_message_name_tlv_parse, the Chunk Number is moved to 	*/
+	/* the tail of the Name with 4 bytes length									*/
+	while (index < tlv->length) {
+		thdr = (struct tlv_hdr*) &tlv->value[index];
+		sub_type 	= ntohs (thdr->type);
+		sub_length  = ntohs (thdr->length);
+		index += CefC_S_TLF;
+
+		if (sub_type == CefC_T_CHUNK) {
+			view->chunk_num = 0;
+			for (i = 0 ; i < sub_length ; i++) {
+				view->chunk_num = (view->chunk_num << 8) | tlv->value[index + i];
+			}
+			view->chunk_num_f = 1;
+			view->chunk_len = sub_length;
+			chunk_idx = index - CefC_S_TLF;
+		} else {
+			name_len += CefC_S_TLF + sub_length;
+		}
+		index += sub_length;
+	}
+
+	if (view->chunk_num_f == 0) {
+		view->name 		= tlv->value;
+		view->name_len 	= name_len;
+		return;
+	}
+	view->name_len = name_len + CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum;
+
+	/* The Name in the frame is used as it is if the Chunk Number is at the 	*/
+	/* tail with 4 bytes length, which is the way cefore creates it 			*/
+	if ((chunk_idx == name_len) && (view->chunk_len == CefC_S_ChunkNum)) {
+		view->name = tlv->value;
+		return;
+	}
+
+	memcpy (view->name_buf, tlv->value, name_len);
+	chunk_num_wk = htonl (view->chunk_num);
+	chunk_len_wk = htons (CefC_S_ChunkNum);
+	memcpy (&view->name_buf[name_len], &ftvn_chunk, CefC_S_Type);
+	memcpy (&view->name_buf[name_len + CefC_S_Type], &chunk_len_wk, CefC_S_Length);
+	memcpy (&view->name_buf[name_len + CefC_S_TLF], &chunk_num_wk, CefC_S_ChunkNum);
+	view->name = view->name_buf;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the Name in the view, decoding it at the first call
+----------------------------------------------------------------------------------------*/
+unsigned char* 								/* Name, NULL if the message has no Name	*/
+cef_frame_view_name_get (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	uint16_t* name_len						/* Length of the Name						*/
+) {
+	if (!(view->decoded & CefC_View_Name_Decoded)) {
+		cef_frame_view_name_decode (view);
+	}
+	if (name_len) {
+		*name_len = view->name_len;
+	}
+	return (view->name);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the Payload in the view
+----------------------------------------------------------------------------------------*/
+unsigned char* 								/* Payload, NULL if it is absent			*/
+cef_frame_view_payload_get (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	uint16_t* payload_len					/* Length of the Payload					*/
+) {
+	if (payload_len) {
+		*payload_len = view->tlv[CefC_T_PAYLOAD].length;
+	}
+	return (view->tlv[CefC_T_PAYLOAD].value);
+}
+/*--------------------------------------------------------------------------------------
+	Initializes the fields of the parsed CEFORE message except the buffers
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_msgbdy_fields_init (
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+) {
+	pm->hoplimit 		= 0;
+	pm->ping_retcode 	= 0;
+	pm->top_level_type 	= 0;
+	pm->name_f 			= 0;
+	pm->name_len 		= 0;
+	pm->chunk_num_f 	= 0;
+	pm->chunk_len 		= 0;
+	pm->chunk_num 		= 0;
+	pm->end_chunk_num_f = 0;
+	pm->end_chunk_len 	= 0;
+	pm->end_chunk_num 	= 0;
+	pm->name_hash_num 	= 0;
+	pm->nonce_f 		= 0;
+	pm->nonce 			= 0;
+	pm->payload_f 		= 0;
+	pm->payload_len 	= 0;
+	pm->discreply_f 	= 0;
+	pm->discreply_len 	= 0;
+	pm->expiry_f 		= 0;
+	pm->expiry 			= 0;
+	pm->seqnum 			= 0;
+	pm->org_len 		= 0;
+
+	pm->org.symbolic_f 			= 0;
+	pm->org.longlife_f 			= 0;
+	pm->org.selective_f 		= 0;
+	pm->org.req_chunk 			= 0;
+	pm->org.first_chunk 		= 0;
+	pm->org.last_chunk_f 		= 0;
+	pm->org.last_chunk 			= 0;
+	pm->org.version_f 			= 0;
+	pm->org.version_len 		= 0;
+	pm->org.version_val[0] 		= 0x00;
+	pm->org.putverify_f 		= 0;
+	pm->org.putverify_msgtype 	= 0;
+	pm->org.from_pub_f 			= 0;
+
+	memset (&pm->alg, 0, sizeof (pm->alg));
+	pm->InterestType 	= CefC_PIT_TYPE_Rgl;
+	pm->KeyIdRester_f 	= 0;
+	pm->KeyIdRester_len = 0;
+	memset (pm->KeyIdRester_val, 0, CefC_HashVal_Len);
+	pm->ObjHash_f 		= 0;
+	pm->ObjHash_len 	= 0;
+	memset (pm->ObjHash_val, 0, CefC_HashVal_Len);
+}
+/*--------------------------------------------------------------------------------------
+	Sets the parsed CEFORE message from the view. pm needs no clearing. The Payload
+	and the Disc Reply are not copied, only their offsets and lengths are set.
+----------------------------------------------------------------------------------------*/
+int 										/* Returns a negative value if it fails 	*/
+cef_frame_view_msgbdy_fill (
+	CefT_CcnMsg_View* view, 				/* View of the message						*/
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+) {
+	CefT_CcnMsg_View_Tlv* tlv;
+	unsigned char* name;
+	uint16_t name_len;
+	int type;
+	int res;
+
+	cef_frame_msgbdy_fields_init (pm);
+	pm->top_level_type 	= view->top_level_type;
+	pm->hoplimit 		= view->hoplimit;
+
+	/* Name 			*/
+	name = cef_frame_view_name_get (view, &name_len);
+	if (name) {
+		pm->name_f 		= view->tlv[CefC_T_NAME].offset;
+		pm->name_len 	= name_len;
+		pm->chunk_num_f = view->chunk_num_f;
+		pm->chunk_len 	= view->chunk_len;
+		pm->chunk_num 	= view->chunk_num;
+		memcpy (pm->name, name, name_len);
+		cef_frame_name_hashv_set (pm);
+	}
+
+	/* Payload and Disc Reply stay in the frame 		*/
+	tlv = &view->tlv[CefC_T_PAYLOAD];
+	if (tlv->value) {
+		pm->payload_f 	= tlv->offset;
+		pm->payload_len = tlv->length;
+	}
+	tlv = &view->tlv[CefC_T_DISC_REQ];		/* see cef_frame_message_tlv_parse */
+	if (tlv->value) {
+		pm->discreply_f 	= tlv->offset;
+		pm->discreply_len 	= tlv->length;
+	}
+
+	/* The other TLVs are small and decoded as cef_frame_message_parse does 	*/
+	for (type = CefC_T_NAME + 1 ; type < CefC_T_MSG_TLV_NUM ; type++) {
+		tlv = &view->tlv[type];
+		if ((tlv->value == NULL) ||
+			(type == CefC_T_PAYLOAD) || (type == CefC_T_DISC_REQ)) {
+			continue;
+		}
+		res = (*cef_frame_message_tlv_parse[type])(
+								pm, tlv->length, tlv->value, tlv->offset);
+		if (res < 0) {
+			return (-1);
+		}
+	}
+	if (view->org.value) {
+		res = cef_frame_message_user_tlv_parse (
+						pm, view->org.length, view->org.value, view->org.offset);
+		if (res < 0) {
+			return (-1);
+		}
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Hashes the prefixes of the Name in the parsed message
+----------------------------------------------------------------------------------------*/
+static void
+cef_frame_name_hashv_set (
+	CefT_CcnMsg_MsgBdy* pm 					/* Structure to set parsed CEFORE message	*/
+) {
+	uint32_t off = 0;
+	uint32_t next;
+	uint16_t length;
+	int num = 0;
+
+	pm->name_hash_num = 0;
+
+	while (off < pm->name_len) {
+		if ((off + CefC_S_TLF > pm->name_len) || (num == CefC_Name_Hash_Num)) {
+			/* The tables hash the Name by themselves 		*/
+			return;
+		}
+		memcpy (&length, &pm->name[off + CefC_S_Type], CefC_S_Length);
+		next = off + CefC_S_TLF + ntohs (length);
+		if (next > pm->name_len) {
+			return;
+		}
+		pm->name_hash_end[num] = (uint16_t) next;
+		num++;
+		off = next;
+	}
+	cef_hash_key_prefix_hashv_create (
+						pm->name, pm->name_hash_end, pm->name_hashv, num);
+	pm->name_hash_num = (uint16_t) num;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the hash value of the Name (or its prefix) in the parsed message.
+	The value hashed at parsing is returned if the key is one of the prefixes
+	of pm->name, otherwise the key is hashed.
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* Hash value of the key 					*/
+cef_frame_name_hashv_get (
+	CefT_CcnMsg_MsgBdy* pm, 				/* Parsed CEFORE message					*/
+	const unsigned char* name, 				/* Key (pm->name or the other Name)			*/
+	uint16_t name_len						/* Length of the key						*/
+) {
+	int i;
+
+	if (name == pm->name) {
+		/* The whole Name or the Name without Chunk Number is looked up mostly 	*/
+		for (i = (int) pm->name_hash_num - 1 ; i >= 0 ; i--) {
+			if (pm->name_hash_end[i] == name_len) {
+				return (pm->name_hashv[i]);
+			}
+			if (pm->name_hash_end[i] < name_len) {
+				break;
+			}
+		}
+	}
+	return (cef_hash_key_hashv_create (name, name_len));
+}
 /*--------------------------------------------------------------------------------------
 	Parses a payload form the specified message
 ----------------------------------------------------------------------------------------*/
@@ -2769,7 +3185,7 @@ cef_frame_seqence_update (
 	unsigned char* buff, 					/* packet									*/
 	uint32_t seqnum
 ) {
-#if	1	// 2023/08/16 Disabled for debugging
+#ifdef CefC_Frame_Seqnum_Disabled
 	struct fixed_hdr* fix_hdr = (struct fixed_hdr*) buff;
 	return ntohs (fix_hdr->pkt_len);
 #else
@@ -2949,6 +3365,116 @@ cef_frame_seqence_update (
 	}
 #endif
 }
+/*--------------------------------------------------------------------------------------
+	Builds the header which carries the sequence number of the Face. The Faces
+	send the built header and the rest of the packet after the original header,
+	so that the packet shared by the Faces is not rewritten.
+----------------------------------------------------------------------------------------*/
+uint16_t									/* length of the built header, or 0 if the	*/
+											/* packet is sent as it is 					*/
+cef_frame_seqnum_hdr_build (
+	const unsigned char* buff, 				/* packet									*/
+	uint32_t seqnum,
+	unsigned char* hdr,						/* buffer of CefC_Max_Header_Size bytes 	*/
+	uint16_t* skip							/* set length of the original header 		*/
+) {
+#ifdef CefC_Frame_Seqnum_Disabled
+	*skip = 0;
+	return (0);
+#else
+	struct fixed_hdr* fix_hdr = (struct fixed_hdr*) buff;
+	uint16_t pkt_len = ntohs (fix_hdr->pkt_len);
+	uint16_t hdr_len = fix_hdr->hdr_len;
+	size_t st32tlv_size = sizeof (struct value32_tlv);
+	struct value32_tlv value32_fld;
+	struct tlv_hdr* thdr;
+	uint8_t t_org_index = 0;
+	uint8_t seq_index = 0;
+	uint16_t org_len;
+	uint16_t ret;
+	uint16_t idx;
+	uint16_t n;
+
+	*skip = 0;
+
+	/* Search the position of T_ORTG and T_SEQNUM in ContentObject */
+	ret = cef_frame_opheader_seqnum_pos_search (
+								(unsigned char*) buff, &t_org_index, &seq_index);
+	if (ret & Opt_T_Org_exist) {
+		thdr = (struct tlv_hdr*) &buff[t_org_index];
+		org_len = ntohs (thdr->length);
+	} else {
+		org_len = 0;
+	}
+	value32_fld.type   = ftvn_seqnum;
+	value32_fld.length = flvn_seqnum;
+	value32_fld.value  = htonl (seqnum);
+
+	if (cef_frame_get_opt_seqnum_f ()) {
+		if ((ret & Opt_T_Org_exist) && (ret & Opt_T_OrgSeq_exist)) {
+			/* update T_SEQNUM 		*/
+			memcpy (hdr, buff, hdr_len);
+			memcpy (&hdr[seq_index], &value32_fld, st32tlv_size);
+			n = hdr_len;
+		} else if (ret & Opt_T_Org_exist) {
+			/* set T_SEQNUM at the end of T_ORG 		*/
+			if (hdr_len + st32tlv_size > CefC_Max_Header_Size) {
+				return (0);
+			}
+			idx = t_org_index + CefC_S_TLF + org_len;
+			memcpy (hdr, buff, idx);
+			memcpy (&hdr[idx], &value32_fld, st32tlv_size);
+			memcpy (&hdr[idx + st32tlv_size], &buff[idx], hdr_len - idx);
+			thdr = (struct tlv_hdr*) &hdr[t_org_index];
+			thdr->length = htons (org_len + st32tlv_size);
+			n = hdr_len + st32tlv_size;
+		} else {
+			/* set T_ORG and T_SEQNUM 		*/
+			if (hdr_len + CefC_S_TLF + sizeof (pen_nict) + st32tlv_size
+					> CefC_Max_Header_Size) {
+				return (0);
+			}
+			memcpy (hdr, buff, hdr_len);
+			n = hdr_len;
+			thdr = (struct tlv_hdr*) &hdr[n];
+			thdr->type   = htons (CefC_T_ORG);
+			thdr->length = htons (sizeof (pen_nict) + st32tlv_size);
+			n += CefC_S_TLF;
+			memcpy (&hdr[n], pen_nict, sizeof (pen_nict));
+			n += sizeof (pen_nict);
+			memcpy (&hdr[n], &value32_fld, st32tlv_size);
+			n += st32tlv_size;
+		}
+	} else {
+		if ((ret & Opt_T_OrgSeq_exist) && (ret & Opt_T_OrgOther_exist)) {
+			/* Remove OPT_SEQNUM from this frame 		*/
+			idx = seq_index + st32tlv_size;
+			memcpy (hdr, buff, seq_index);
+			memcpy (&hdr[seq_index], &buff[idx], hdr_len - idx);
+			thdr = (struct tlv_hdr*) &hdr[t_org_index];
+			thdr->length = htons (org_len - st32tlv_size);
+			n = hdr_len - st32tlv_size;
+		} else if (ret & Opt_T_OrgSeq_exist) {
+			/* Remove OPT_SEQNUM (and T_ORG) from this frame 		*/
+			idx = t_org_index + CefC_S_TLF + org_len;
+			memcpy (hdr, buff, t_org_index);
+			memcpy (&hdr[t_org_index], &buff[idx], hdr_len - idx);
+			n = hdr_len - (CefC_S_TLF + org_len);
+		} else {
+			/* This frame is not attached with OPT_SEQNUM 		*/
+			return (0);
+		}
+	}
+
+	/* Sets Length 		*/
+	fix_hdr = (struct fixed_hdr*) hdr;
+	fix_hdr->hdr_len = (uint8_t) n;
+	fix_hdr->pkt_len = htons (pkt_len - hdr_len + n);
+	*skip = hdr_len;
+
+	return (n);
+#endif // CefC_Frame_Seqnum_Disabled
+}
 /*--------------------------------------------------------------------------------------
 	Search the position of T_ORTG and T_SEQNUM in ContentObject
 ----------------------------------------------------------------------------------------*/
@@ -3598,7 +4124,17 @@ cef_frame_validation_pld_tlv_create (
 
 	} else if (tlvs->valid_type == CefC_T_RSA_SHA256) {
 
-		res = cef_valid_dosign (buff, buff_len, name, name_len, sign, &sign_len);
+		if (cef_sign_defer_f) {
+			/* Reserves the signature which is set later in a batch 	*/
+			res = cef_valid_sign_len_get (name, name_len);
+			if (res > 0) {
+				sign_len = (unsigned int) res;
+				memset (sign, 0, sizeof (sign));
+				res = 1;
+			}
+		} else {
+			res = cef_valid_dosign (buff, buff_len, name, name_len, sign, &sign_len);
+		}
 
 		if (res == 1) {
 			if (sign_len > 256) {
@@ -4807,6 +5343,16 @@ cef_frame_get_opt_seqnum_f (
 ) {
 	return(cef_opt_seqnum_f);
 }
+/*--------------------------------------------------------------------------------------
+	Set flag whether to defer RSA-SHA256 signing of Content Objects. The deferred
+	signatures are set by cef_valid_msg_sign or cef_valid_batch_sign.
+----------------------------------------------------------------------------------------*/
+void
+cef_frame_set_sign_defer_f (
+	int				defer_f				/* 1 to defer, 0 to sign in creating messages	*/
+) {
+	cef_sign_defer_f = defer_f;
+}
 /*--------------------------------------------------------------------------------------
 	get Name without chunkno
 ----------------------------------------------------------------------------------------*/
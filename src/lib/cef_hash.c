@@ -36,7 +36,14 @@
  Include Files
  ****************************************************************************************/
 #include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
 #include <openssl/md5.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
 
 #include <cefore/cef_hash.h>
 
@@ -50,14 +57,96 @@
 #define CefC_Cleanup_Smax	 		4
 #endif
 
+/* xxHash64 (XXH64) constants 		*/
+#define CefC_Xxh_Prime1		0x9E3779B185EBCA87ULL
+#define CefC_Xxh_Prime2		0xC2B2AE3D27D4EB4FULL
+#define CefC_Xxh_Prime3		0x165667B19E3779F9ULL
+#define CefC_Xxh_Prime4		0x85EBCA77C2B2AE63ULL
+#define CefC_Xxh_Prime5		0x27D4EB2F165667C5ULL
+#define CefC_Xxh_Rotl(x, r)	(((x) << (r)) | ((x) >> (64 - (r))))
+
+/* Control byte of each slot. The full slot holds the low 7 bits of its hash value, */
+/* so that a group of slots is matched against the hash value at once.				*/
+#define CefC_Hash_Ctrl_Empty		0x80
+#define CefC_Hash_Ctrl_Deleted		0xFE
+#define CefC_Hash_Group_Shift		4
+#define CefC_Hash_Group_Width		(1 << CefC_Hash_Group_Shift)	/* Slots probed at once	*/
+#define CefC_Hash_H1(hash)			((hash) >> 7)				/* Selects the home group	*/
+#define CefC_Hash_H2(hash)			((uint8_t)((hash) & 0x7F))	/* Fingerprint of the slot	*/
+#define cef_hash_ctrl_is_full(c)	(((c) & 0x80) == 0)
+
+/* Key chunks of the arena. The chunks are rounded up to the unit and recycled per	*/
+/* size class, so that the slots do not have to embed the maximum key length.		*/
+#define CefC_Hash_Arena_Unit		16
+#define CefC_Hash_Arena_Class_Num	(CefC_Max_KLen / CefC_Hash_Arena_Unit + 1)
+#define CefC_Hash_Arena_Block_Size	65536
+#define CefC_Hash_Arena_Block_Head	16			/* Link to the next block and padding	*/
+#define cef_hash_arena_class(klen) \
+	((klen) ? ((klen) + CefC_Hash_Arena_Unit - 1) / CefC_Hash_Arena_Unit : 1)
+
+/* Resizable tables. The entries are migrated a few at a time by set and remove,	*/
+/* so that resizing does not stop the caller for the whole table.					*/
+#define CefC_Hash_Resize_Init		1024		/* Initial entries of the resizable table	*/
+#define CefC_Hash_Resize_Step		64			/* Slots or buckets migrated per operation	*/
+#define CefC_Hash_Slots_Max			((uint32_t) 1 << 31)
+#define CefC_Hash_Slots_Max_Load	87			/* Open addressing keeps 1/8 of the slots free */
+#define CefC_Hash_Bulk_Min			65536		/* Arrays from this size are mapped apart	*/
+												/* from the heap of the entries 			*/
+#define cef_hash_tbl_high_water \
+	((cef_hash_high_water < CefC_Hash_Slots_Max_Load) ? \
+		cef_hash_high_water : CefC_Hash_Slots_Max_Load)
+
+/* The hash value given by the caller is valid only for the table which uses the	*/
+/* default algorithm and the process seed											*/
+#define cef_hash_hashv_adoptable(ht) \
+	(((ht)->hfunc == cef_hash_xxh64_number_create) && ((ht)->seed == cef_hash_seed))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+typedef struct CefT_Hash_Arena {
+	unsigned char*		free_chunk[CefC_Hash_Arena_Class_Num];	/* Freed chunks per class	*/
+	unsigned char*		block;				/* Allocated blocks 				*/
+	unsigned char*		cur;				/* Unused area of the current block	*/
+	uint32_t 			rest;
+} CefT_Hash_Arena;
+
+typedef struct CefT_Hash_Table {
+	uint32_t 		hash;
+	uint32_t 		klen;
+	unsigned char* 	key;					/* Key chunk in the arena of the table	*/
+	void* 			elem;
+	uint8_t			opt_f;
+} CefT_Hash_Table;
+
+typedef struct CefT_Hash_Slots {
+	uint8_t*			ctrl;				/* Control bytes of the slots			*/
+	CefT_Hash_Table*	tbl;
+	uint32_t 			elem_max;			/* Power of two number of the slots		*/
+	uint32_t 			group_mask;			/* Number of the groups - 1				*/
+	uint32_t 			elem_num;
+	uint32_t 			tomb_num;			/* Number of the deleted slots			*/
+	uint32_t 			tomb_limit;			/* Deleted slots which start the cleanup	*/
+} CefT_Hash_Slots;
+
+typedef struct CefT_Hash {
+	uint32_t 			seed;
+	CefT_Hash_Slots		cur;				/* Slots where the new entries are stored	*/
+	CefT_Hash_Slots		old;				/* Slots being migrated while resizing	*/
+	uint32_t 			mig_pos;			/* Next slot of old to be migrated		*/
+	uint32_t 			min_max;			/* Slots do not shrink below this size	*/
+											/* (0 if the table is not resizable)	*/
+	uint32_t 			def_elem_max;		/* User defined maximum size	*/
+	CefT_Hash_Func		hfunc;				/* Hash function selected at creation	*/
+	CefT_Hash_Arena		arena;				/* Keys of the slots 					*/
+} CefT_Hash;
+
 typedef struct CefT_List_Hash_Cell {
 	unsigned char* 			key;
 	void* 					elem;
 	uint32_t 				klen;
+	uint32_t 				hash;		/* Hash value which selected the bucket	*/
 	uint8_t					opt_f;		//only use at app, c3
 	struct CefT_List_Hash_Cell*	next;
 } CefT_List_Hash_Cell;
@@ -67,28 +156,231 @@ typedef struct CefT_List_Hash {
 	uint32_t 			elem_max;
 	uint32_t 			elem_num;
 	uint32_t 			def_elem_max;		/* User defined maximum size	*/
+	uint32_t 			seed;
+	CefT_Hash_Func		hfunc;				/* Hash function selected at creation	*/
+	CefT_List_Hash_Cell**	old_tbl;		/* Buckets being migrated while resizing	*/
+	uint32_t 			old_max;
+	uint32_t 			mig_pos;			/* Next bucket of old_tbl to be migrated	*/
+	uint32_t 			min_max;			/* Buckets do not shrink below this size	*/
+											/* (0 if the table is not resizable)	*/
 } CefT_List_Hash;
 
 
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
+static pthread_once_t cef_hash_seed_once = PTHREAD_ONCE_INIT;
+static uint32_t cef_hash_seed = 0;
+static __thread uint64_t cef_hash_count = 0;		/* Keys hashed by this thread 		*/
+static uint32_t cef_hash_high_water = CefC_Hash_High_Water_Def;
+static uint32_t cef_hash_low_water = CefC_Hash_Low_Water_Def;
 
 
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
 static uint32_t
-cef_hash_number_create (
-	uint32_t hash,
+cef_hash_md5_number_create (
+	uint32_t seed,
 	const unsigned char* key,
 	uint32_t klen
 );
 static uint32_t
-cef_lhash_number_create (
+cef_hash_xxh64_number_create (
+	uint32_t seed,
+	const unsigned char* key,
+	uint32_t klen
+);
+static void
+cef_hash_seed_init (
+	void
+);
+static inline void
+cef_hash_xxh64_stripe (
+	uint64_t v[],
+	const unsigned char* p
+);
+static inline uint64_t
+cef_hash_xxh64_converge (
+	uint64_t v[]
+);
+static inline uint32_t
+cef_hash_xxh64_finalize (
+	uint64_t h64,
+	const unsigned char* p,
+	const unsigned char* end,
+	uint32_t klen
+);
+static CefT_Hash_Handle
+cef_hash_tbl_alloc (
+	uint64_t table_size,
+	uint32_t def_tbl_size,
+	int resizable_f
+);
+static int
+cef_hash_tbl_item_insert (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	void* elem,
+	uint8_t opt,
+	int replace_f
+);
+static int
+cef_hash_tbl_lookup (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	CefT_Hash_Slots** slp
+);
+static unsigned char*
+cef_hash_tbl_key_dup (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen
+);
+static void*
+cef_hash_tbl_slot_remove (
+	CefT_Hash* ht,
+	CefT_Hash_Slots* sl,
+	uint32_t index
+);
+static inline uint32_t
+cef_hash_tbl_index_max (
+	CefT_Hash* ht
+);
+static CefT_Hash_Slots*
+cef_hash_tbl_index_slots (
+	CefT_Hash* ht,
+	uint32_t* index
+);
+static int
+cef_hash_tbl_full_index_find (
+	CefT_Hash* ht,
+	uint32_t from,
+	uint32_t to
+);
+static void
+cef_hash_tbl_resize_start (
+	CefT_Hash* ht,
+	uint32_t elem_max
+);
+static void
+cef_hash_tbl_resize_step (
+	CefT_Hash* ht
+);
+static int
+cef_hash_slots_init (
+	CefT_Hash_Slots* sl,
+	uint32_t elem_max
+);
+static void
+cef_hash_slots_free (
+	CefT_Hash_Slots* sl
+);
+static inline uint32_t
+cef_hash_group_match (
+	const uint8_t* ctrl,
+	uint8_t v
+);
+static inline uint32_t
+cef_hash_group_match_free (
+	const uint8_t* ctrl
+);
+static inline uint32_t
+cef_hash_slots_prg_index (
+	CefT_Hash_Slots* sl,
+	uint32_t hash
+);
+static int
+cef_hash_slots_probe (
+	CefT_Hash_Slots* sl,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	int* free_index
+);
+static int
+cef_hash_slots_free_find (
+	CefT_Hash_Slots* sl,
+	uint32_t hash
+);
+static void
+cef_hash_slots_fill (
+	CefT_Hash_Slots* sl,
+	uint32_t index,
+	uint32_t hash,
+	unsigned char* kp,
+	uint32_t klen,
+	void* elem,
+	uint8_t opt
+);
+static void
+cef_hash_slots_clear (
+	CefT_Hash_Slots* sl,
+	uint32_t index
+);
+static void
+cef_hash_slots_tomb_cleanup (
+	CefT_Hash_Slots* sl
+);
+static void*
+cef_hash_slots_app_match (
+	CefT_Hash_Slots* sl,
 	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash
+);
+static inline CefT_List_Hash_Cell**
+cef_lhash_tbl_bucket_get (
+	CefT_List_Hash* ht,
+	uint32_t hash
+);
+static inline CefT_List_Hash_Cell**
+cef_lhash_tbl_bucket_at (
+	CefT_List_Hash* ht,
+	uint32_t index
+);
+static void
+cef_lhash_tbl_resize_check (
+	CefT_List_Hash* ht,
+	int set_f
+);
+static void
+cef_lhash_tbl_resize_start (
+	CefT_List_Hash* ht,
+	uint32_t elem_max
+);
+static void
+cef_lhash_tbl_resize_step (
+	CefT_List_Hash* ht
+);
+static unsigned char*
+cef_hash_arena_alloc (
+	CefT_Hash_Arena* arena,
+	uint32_t klen
+);
+static void
+cef_hash_arena_free (
+	CefT_Hash_Arena* arena,
+	unsigned char* chunk,
 	uint32_t klen
 );
+static void
+cef_hash_arena_destroy (
+	CefT_Hash_Arena* arena
+);
+static void*
+cef_hash_bulk_alloc (
+	size_t size
+);
+static void
+cef_hash_bulk_free (
+	void* ptr,
+	size_t size
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -96,53 +388,7 @@ CefT_Hash_Handle
 cef_hash_tbl_create (
 	uint32_t table_size
 ) {
-	CefT_Hash* ht = NULL;
-	int i, n;
-	int flag;
-	int def_tbl_size = table_size;
-	
-	/* A prime number larger than the maximum size defined by the user	*/
-	/* is set as the table size.										*/
-	/* The maximum size defined by the user is set to "def_elem_max".	*/
-	for (i = table_size ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size ; n++) {
-			if (table_size % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size++;
-		} else {
-			break;
-		}
-	}
-	
-	if (table_size > UINT_MAX) {
-		return ((CefT_Hash_Handle) NULL);
-	}
-
-	ht = (CefT_Hash*) malloc (sizeof (CefT_Hash));
-	if (ht == NULL) {
-		return ((CefT_Hash_Handle) NULL);
-	}
-	memset (ht, 0, sizeof (CefT_Hash));
-
-	ht->tbl = (CefT_Hash_Table*) malloc (sizeof (CefT_Hash_Table) * table_size);
-	if (ht->tbl == NULL) {
-		free (ht);
-		return ((CefT_Hash_Handle) NULL);
-	}
-	memset (ht->tbl, 0, sizeof (CefT_Hash_Table) * table_size);
-
-	srand ((unsigned) time (NULL));
-	ht->seed = (uint32_t)(rand () + 1);
-	ht->elem_max = table_size;
-	ht->def_elem_max = def_tbl_size;
-
-	return ((CefT_Hash_Handle) ht);
+	return (cef_hash_tbl_alloc ((uint64_t) table_size, table_size, 0));
 }
 
 CefT_Hash_Handle
@@ -150,59 +396,39 @@ cef_hash_tbl_create_ext (
 	uint32_t table_size,
 	uint8_t coef
 ) {
-	CefT_Hash* ht = NULL;
-	int i, n;
-	int flag;
-	uint32_t def_tbl_size = table_size;
-	uint64_t table_size64;
-	
-	table_size64 = table_size * coef;
-	
-	/* A prime number larger than the maximum size defined by the user	*/
-	/* is set as the table size.										*/
-	/* The maximum size defined by the user is set to "def_elem_max".	*/
-	for (i = table_size64 ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size64 ; n++) {
-			if (table_size64 % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size64++;
-		} else {
-			break;
-		}
-	}
-	
-	if (table_size64 > UINT32_MAX) {
-		table_size64 = UINT32_MAX;
-	}
-	table_size = (uint32_t)table_size64;
+	return (cef_hash_tbl_alloc ((uint64_t) table_size * coef, table_size, 0));
+}
 
-	ht = (CefT_Hash*) malloc (sizeof (CefT_Hash));
-	if (ht == NULL) {
-		return ((CefT_Hash_Handle) NULL);
-	}
-	memset (ht, 0, sizeof (CefT_Hash));
+CefT_Hash_Handle
+cef_hash_tbl_create_with_alg (
+	uint32_t table_size,
+	uint8_t coef,
+	int alg
+) {
+	CefT_Hash* ht;
 
-	ht->tbl = (CefT_Hash_Table*) malloc (sizeof (CefT_Hash_Table) * table_size);
-	if (ht->tbl == NULL) {
-		free (ht);
+	ht = (CefT_Hash*) cef_hash_tbl_create_ext (table_size, coef);
+	if (ht == NULL) {
 		return ((CefT_Hash_Handle) NULL);
 	}
-	memset (ht->tbl, 0, sizeof (CefT_Hash_Table) * table_size);
-
-	srand ((unsigned) time (NULL));
-	ht->seed = (uint32_t)(rand () + 1);
-	ht->elem_max = table_size;
-	ht->def_elem_max = def_tbl_size;
+	ht->hfunc = cef_hash_func_get (alg);
 
 	return ((CefT_Hash_Handle) ht);
 }
 
+/*--------------------------------------------------------------------------------------
+	Creates the table which starts small and grows or shrinks with the load.
+	The slots move while resizing, so the indexes are valid only until the next
+	set or remove by key.
+----------------------------------------------------------------------------------------*/
+CefT_Hash_Handle
+cef_hash_tbl_create_resizable (
+	uint32_t table_size,					/* User defined maximum size 				*/
+	uint8_t coef
+) {
+	return (cef_hash_tbl_alloc ((uint64_t) table_size * coef, table_size, 1));
+}
+
 void
 cef_hash_tbl_destroy (
 	CefT_Hash_Handle handle
@@ -212,7 +438,9 @@ cef_hash_tbl_destroy (
 	if (ht == NULL) {
 		return;
 	}
-	free (ht->tbl);
+	cef_hash_arena_destroy (&ht->arena);
+	cef_hash_slots_free (&ht->old);
+	cef_hash_slots_free (&ht->cur);
 	free (ht);
 
 	return;
@@ -226,81 +454,12 @@ cef_hash_tbl_item_set (
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	uint32_t empty_index = 0;
-	uint32_t empty_ff = 0;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_Faile);
 	}
-
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-	if (ht->tbl[index].klen == 0) {
-		ht->tbl[index].hash = hash;
-		ht->tbl[index].elem = elem;
-		ht->tbl[index].klen = klen;
-		memcpy (ht->tbl[index].key, key, klen);
-		ht->elem_num++;
-		return (index);
-	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].elem = elem;
-			
-			return (i);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-
-	for (i = 0 ; i < index ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].elem = elem;
-			return (i);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-	
-	if (empty_ff) {
-		ht->tbl[empty_index].hash = hash;
-		ht->tbl[empty_index].elem = elem;
-		ht->tbl[empty_index].klen = klen;
-		memcpy (ht->tbl[empty_index].key, key, klen);
-		ht->elem_num++;
-		return (empty_index);
-	}
-	return (CefC_Hash_Faile);
+	return (cef_hash_tbl_item_insert (
+				ht, key, klen, ht->hfunc (ht->seed, key, klen), elem, 0, 1));
 }
 
 int
@@ -312,148 +471,127 @@ cef_hash_tbl_item_set_for_app (
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	uint32_t empty_index = 0;
-	uint32_t empty_ff = 0;
-	int		 res;
-
-	/*--------------------------*/
-	/* Temporary Implimentation */
-	/*--------------------------*/
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_Faile);
 	}
-	res = cef_hash_tbl_item_check_exact( handle, key, klen );
-	if ( res > 0 ) {
-		return (CefC_Hash_Faile);
-	}
-
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if (ht->tbl[index].klen == 0) {
-		ht->tbl[index].hash = hash;
-		ht->tbl[index].elem = elem;
-		ht->tbl[index].klen = klen;
-		ht->tbl[index].opt_f = opt;
-		memcpy (ht->tbl[index].key, key, klen);
-		ht->elem_num++;
-		return (index);
-	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			ht->tbl[i].opt_f = opt;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return (CefC_Hash_Faile);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
+	/* The key which has already been registered is not overwritten 	*/
+	return (cef_hash_tbl_item_insert (
+				ht, key, klen, ht->hfunc (ht->seed, key, klen), elem, opt, 0));
+}
 
-	for (i = 0 ; i < index ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			ht->tbl[i].opt_f = opt;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return (CefC_Hash_Faile);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
+void*
+cef_hash_tbl_item_set_prg (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	void* elem
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
 
-	if (empty_ff) {
-		ht->tbl[empty_index].hash = hash;
-		ht->tbl[empty_index].elem = elem;
-		ht->tbl[empty_index].klen = klen;
-		ht->tbl[empty_index].opt_f = opt;
-		memcpy (ht->tbl[empty_index].key, key, klen);
-		ht->elem_num++;
-		return (empty_index);
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
 	}
-
-	return (CefC_Hash_Faile);
+	return (cef_hash_tbl_item_set_prg_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen), elem));
 }
 
-void* 
-cef_hash_tbl_item_set_prg (
+void*
+cef_hash_tbl_item_set_prg_with_hashv (
 	CefT_Hash_Handle handle,
 	const unsigned char* key,
 	uint32_t klen,
+	uint32_t hashv,
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
+	CefT_Hash_Slots* sl;
+	uint32_t hash = hashv;
 	uint32_t index;
+	unsigned char* kp;
 	void* old_elem = (void*) NULL;
-	
+
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-	
-	if (ht->tbl[index].klen != 0 && ht->tbl[index].klen != -1) {
-		old_elem = ht->tbl[index].elem;
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
 	}
-	ht->tbl[index].hash = hash;
-	ht->tbl[index].elem = elem;
-	ht->tbl[index].klen = klen;
-	memcpy (ht->tbl[index].key, key, klen);
-	
+	sl = &ht->cur;
+	index = cef_hash_slots_prg_index (sl, hash);
+
+	if (!cef_hash_ctrl_is_full (sl->ctrl[index])) {
+		kp = cef_hash_tbl_key_dup (ht, key, klen);
+		if (kp) {
+			cef_hash_slots_fill (sl, index, hash, kp, klen, elem, 0);
+		}
+		return ((void*) NULL);
+	}
+
+	/* Purges the entry in the slot and reuses its key chunk if it fits 	*/
+	old_elem = sl->tbl[index].elem;
+	kp = sl->tbl[index].key;
+	if (cef_hash_arena_class (klen) != cef_hash_arena_class (sl->tbl[index].klen)) {
+		kp = cef_hash_arena_alloc (&ht->arena, klen);
+		if (kp == NULL) {
+			return ((void*) NULL);
+		}
+		cef_hash_arena_free (&ht->arena, sl->tbl[index].key, sl->tbl[index].klen);
+	}
+	memcpy (kp, key, klen);
+	sl->ctrl[index] = CefC_Hash_H2 (hash);
+	sl->tbl[index].hash = hash;
+	sl->tbl[index].key = kp;
+	sl->tbl[index].klen = klen;
+	sl->tbl[index].elem = elem;
+	sl->tbl[index].opt_f = 0;
+
 	return (old_elem);
 }
 
-void* 
+void*
 cef_hash_tbl_item_get_prg (
 	CefT_Hash_Handle handle,
 	const unsigned char* key,
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
+
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
+	}
+	return (cef_hash_tbl_item_get_prg_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen)));
+}
+
+void*
+cef_hash_tbl_item_get_prg_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
+	CefT_Hash_Slots* sl;
+	uint32_t hash = hashv;
 	uint32_t index;
-	
+
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
-	
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-	
-	if (ht->tbl[index].hash == hash) {
-		if ((ht->tbl[index].klen == klen) && 
-			(memcmp (key, ht->tbl[index].key, klen) == 0)) {
-			return ((void*) ht->tbl[index].elem);
-		}
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
 	}
-	
+	sl = &ht->cur;
+	index = cef_hash_slots_prg_index (sl, hash);
+
+	if ((sl->ctrl[index] == CefC_Hash_H2 (hash)) &&
+		(sl->tbl[index].hash == hash) &&
+		(sl->tbl[index].klen == klen) &&
+		(memcmp (key, sl->tbl[index].key, klen) == 0)) {
+		return ((void*) sl->tbl[index].elem);
+	}
+
 	return ((void*) NULL);
 }
 
@@ -468,7 +606,7 @@ cef_hash_tbl_hashv_get (
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (0);
 	}
-	return (cef_hash_number_create (ht->seed, key, klen));
+	return (ht->hfunc (ht->seed, key, klen));
 }
 
 void*
@@ -478,46 +616,37 @@ cef_hash_tbl_item_get (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
+	return (cef_hash_tbl_item_get_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen)));
+}
 
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
+void*
+cef_hash_tbl_item_get_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
+	CefT_Hash_Slots* sl;
+	uint32_t hash = hashv;
+	int index;
 
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) &&
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		return ((void*) ht->tbl[index].elem);
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
 	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return ((void*) ht->tbl[i].elem);
-		}
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
 	}
-
-	for (i = 0 ; i < index ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return ((void*) ht->tbl[i].elem);
-		}
+	index = cef_hash_tbl_lookup (ht, key, klen, hash, &sl);
+	if (index < 0) {
+		return ((void*) NULL);
 	}
-
-	return ((void*) NULL);
+	return ((void*) sl->tbl[index].elem);
 }
 
 void*
@@ -527,51 +656,39 @@ cef_hash_tbl_item_get_for_app (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t i;
-	uint32_t entry_klen = 0;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
-	
-	/* for exact match */
-	hash = cef_hash_number_create (ht->seed, key, klen);
+	return (cef_hash_tbl_item_get_for_app_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen)));
+}
 
-	for (i = 0 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0 || ht->tbl[i].klen == -1)
-			continue;
-		
-		if (ht->tbl[i].opt_f) {
-			/* prefix match */
-			entry_klen = ht->tbl[i].klen;
-			if ((entry_klen <= klen) &&
-				(memcmp (ht->tbl[i].key, key, entry_klen) == 0)) {
-				if (entry_klen == klen) {
-					return ((void*) ht->tbl[i].elem);
-				} else if (entry_klen + 5 <= klen) {
-					/* eg) ccn:/test, ccn:/test/a */
-					/*                         ^^ */
-					/* separator(4) and prefix(more than 1) */
-					if ((key[entry_klen] == 0x00) &&
-						(key[entry_klen + 1] == 0x01)) {
-						return ((void*) ht->tbl[i].elem);
-					}
-				} else {
-					continue;
-				}
-			}
-		} else {
-			/* exact match */
-			if ((ht->tbl[i].hash == hash) &&
-				(ht->tbl[i].klen == klen) &&
-				(memcmp (ht->tbl[i].key, key, klen) == 0)) {
-				return ((void*) ht->tbl[i].elem);
-			}
-		}
+void*
+cef_hash_tbl_item_get_for_app_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
+	uint32_t hash = hashv;
+	void* elem;
+
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
 	}
 
-	return ((void*) NULL);
+	/* for exact match */
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
+	}
+
+	elem = cef_hash_slots_app_match (&ht->cur, key, klen, hash);
+	if ((elem == NULL) && (ht->old.tbl)) {
+		elem = cef_hash_slots_app_match (&ht->old, key, klen, hash);
+	}
+	return (elem);
 }
 
 
@@ -581,12 +698,14 @@ cef_hash_tbl_item_get_from_index (
 	uint32_t index
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
+	CefT_Hash_Slots* sl;
 
-	if (index > ht->elem_max) {
+	sl = cef_hash_tbl_index_slots (ht, &index);
+	if (sl == NULL) {
 		return ((void*) NULL);
 	}
 
-	return ((void*) ht->tbl[index].elem);
+	return ((void*) sl->tbl[index].elem);
 }
 
 void*
@@ -596,106 +715,32 @@ cef_hash_tbl_item_remove (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
+	CefT_Hash_Slots* sl;
 	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	void* rtc = (void*) NULL;
-	int removed_f = 0;
-	int si;
-	uint32_t removed_indx;
+	int index;
+	void* elem;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_False);
 	}
-
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) &&
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		ht->tbl[index].hash = 0;
-		ht->tbl[index].klen = -1;
-		ht->tbl[index].opt_f = 0;
-		ht->elem_num--;
-		rtc = (void*) ht->tbl[index].elem;
-		ht->tbl[index].elem = NULL;
-		removed_f = 1;
-		removed_indx = index;
-		goto ENDFUNC;
-	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if(ht->tbl[i].klen == 0){
-			rtc = (void*) NULL;
-			goto ENDFUNC;
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].hash = 0;
-			ht->tbl[i].klen = -1;
-			ht->tbl[i].opt_f = 0;
-			ht->elem_num--;
-			rtc = (void*) ht->tbl[i].elem;
-			ht->tbl[i].elem = NULL;
-			removed_f = 1;
-			removed_indx = i;
-			goto ENDFUNC;
-		}
+	if (ht->old.tbl) {
+		cef_hash_tbl_resize_step (ht);
 	}
 
-	for (i = 0 ; i < index ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].hash = 0;
-			ht->tbl[i].klen = -1;
-			ht->tbl[i].opt_f = 0;
-			ht->elem_num--;
-			rtc = (void*) ht->tbl[i].elem;
-			ht->tbl[i].elem = NULL;
-			removed_f = 1;
-			removed_indx = i;
-			goto ENDFUNC;
-		}
+	hash = ht->hfunc (ht->seed, key, klen);
+	index = cef_hash_tbl_lookup (ht, key, klen, hash, &sl);
+	if (index < 0) {
+		return ((void*) NULL);
 	}
+	elem = cef_hash_tbl_slot_remove (ht, sl, index);
 
-ENDFUNC:
-	if(removed_f == 1){
-		/* compaction */
-		if(removed_indx == (ht->elem_max-1)){
-			if(ht->tbl[0].klen == 0){
-				ht->tbl[removed_indx].klen = 0;
-			}
-		} else {
-			if(ht->tbl[removed_indx+1].klen == 0){
-				ht->tbl[removed_indx].klen = 0;
-			}
-		}
-		if(ht->tbl[removed_indx].klen == 0){
-			for(si = (removed_indx-1); si >= 0; si--){
-				if(ht->tbl[si].klen == -1){
-					ht->tbl[si].klen = 0;
-				} else {
-					break;
-				}
-			}
-			if(ht->tbl[0].klen == 0){
-				for(si = (ht->elem_max-1); si > removed_indx; si--){
-					if(ht->tbl[si].klen == -1){
-						ht->tbl[si].klen = 0;
-					} else {
-						break;
-					}
-				}
-			}
-		}
+	/* Shrinks the slots when the load falls below the low water mark 	*/
+	if ((ht->min_max) && (ht->old.tbl == NULL) &&
+		(ht->cur.elem_max > ht->min_max) &&
+		((uint64_t) ht->cur.elem_num * 100 < (uint64_t) ht->cur.elem_max * cef_hash_low_water)) {
+		cef_hash_tbl_resize_start (ht, ht->cur.elem_max / 2);
 	}
-	return (rtc);
+	return (elem);
 }
 
 void*
@@ -704,17 +749,17 @@ cef_hash_tbl_item_check_from_index (
 	uint32_t* index
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t i;
+	uint32_t index_max = cef_hash_tbl_index_max (ht);
+	int i;
 
-	if (*index > ht->elem_max) {
+	if (*index > index_max) {
 		return ((void*) NULL);
 	}
 
-	for (i = *index ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1){
-			*index = i;
-			return ((void*) ht->tbl[i].elem);
-		}
+	i = cef_hash_tbl_full_index_find (ht, *index, index_max);
+	if (i >= 0) {
+		*index = (uint32_t) i;
+		return (cef_hash_tbl_item_get_from_index (handle, *index));
 	}
 	*index = 0;
 	return ((void*) NULL);
@@ -726,19 +771,15 @@ cef_hash_tbl_item_remove_from_index (
 	uint32_t index
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	void* rtc = (void*) NULL;
+	CefT_Hash_Slots* sl;
 
-	if (index > ht->elem_max) {
+	sl = cef_hash_tbl_index_slots (ht, &index);
+	if (sl == NULL) {
 		return ((void*) NULL);
 	}
 
-	if (ht->tbl[index].klen != 0 && ht->tbl[index].klen != -1) {
-		ht->tbl[index].hash = 0;
-		ht->tbl[index].klen = -1;
-		ht->elem_num--;
-		rtc = (void*) ht->tbl[index].elem;
-		ht->tbl[index].elem = NULL;
-		return (rtc);
+	if (cef_hash_ctrl_is_full (sl->ctrl[index])) {
+		return (cef_hash_tbl_slot_remove (ht, sl, index));
 	}
 
 	return ((void*) NULL);
@@ -748,7 +789,9 @@ int
 cef_hash_tbl_item_num_get (
 	CefT_Hash_Handle handle
 ) {
-	return ((int)(((CefT_Hash*) handle)->elem_num));
+	CefT_Hash* ht = (CefT_Hash*) handle;
+
+	return ((int)(ht->cur.elem_num + ht->old.elem_num));
 }
 
 /* Get user defined maximum size	*/
@@ -763,7 +806,15 @@ int
 cef_hash_tbl_item_max_idx_get (
 	CefT_Hash_Handle handle
 ) {
-	return ((int)(((CefT_Hash*) handle)->elem_max));
+	return ((int) cef_hash_tbl_index_max ((CefT_Hash*) handle));
+}
+
+/* Get number of slots where the new entries are stored	*/
+int
+cef_hash_tbl_capacity_get (
+	CefT_Hash_Handle handle
+) {
+	return ((int)(((CefT_Hash*) handle)->cur.elem_max));
 }
 
 void*
@@ -772,27 +823,23 @@ cef_hash_tbl_elem_get (
 	uint32_t* index
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t i;
+	uint32_t index_max = cef_hash_tbl_index_max (ht);
+	int i;
 
-	if (*index > ht->elem_max) {
+	if (*index > index_max) {
 		return ((void*) NULL);
 	}
 
-	for (i = *index ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1) {
-			*index = i;
-			return ((void*) ht->tbl[i].elem);
-		}
+	i = cef_hash_tbl_full_index_find (ht, *index, index_max);
+	if (i < 0) {
+		i = cef_hash_tbl_full_index_find (ht, 0, *index);
 	}
-
-	for (i = 0 ; i < *index ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1) {
-			*index = i;
-			return ((void*) ht->tbl[i].elem);
-		}
+	if (i >= 0) {
+		*index = (uint32_t) i;
+		return (cef_hash_tbl_item_get_from_index (handle, *index));
 	}
 	*index = 0;
-	
+
 	return ((void*) NULL);
 }
 
@@ -803,25 +850,35 @@ cef_hash_tbl_no_col_item_get (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
+	CefT_Hash_Slots* sl;
 	uint32_t hash;
+	uint32_t grp;
+	uint32_t bits;
 	uint32_t index;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
 
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
+	/* Looks up only the home group of the key 	*/
+	hash = ht->hfunc (ht->seed, key, klen);
+	sl = &ht->cur;
+	grp = (CefC_Hash_H1 (hash) & sl->group_mask) << CefC_Hash_Group_Shift;
+	bits = cef_hash_group_match (&sl->ctrl[grp], CefC_Hash_H2 (hash));
 
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) && 
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		return ((void*) ht->tbl[index].elem);
+	while (bits) {
+		index = grp + __builtin_ctz (bits);
+		if ((sl->tbl[index].hash == hash) &&
+			(sl->tbl[index].klen == klen) &&
+			(memcmp(sl->tbl[index].key, key, klen) == 0)) {
+			return ((void*) sl->tbl[index].elem);
+		}
+		bits &= bits - 1;
 	}
 	return ((void*) NULL);
 }
 
-void* 
+void*
 cef_hash_tbl_item_check (
 	CefT_Hash_Handle handle,
 	const unsigned char* key,
@@ -829,11 +886,11 @@ cef_hash_tbl_item_check (
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
 
-	
+
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
-	
+
 	return ((void*) cef_hash_tbl_item_get(handle, key, klen));
 }
 int
@@ -844,7 +901,7 @@ cef_hash_tbl_item_check_exact (
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
 
-	
+
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (-1);
 	}
@@ -898,6 +955,8 @@ cef_lhash_tbl_create (
 	
 	ht->def_elem_max = def_tbl_size;
 	ht->elem_max = table_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
 
 	return ((CefT_Hash_Handle) ht);
 }
@@ -951,6 +1010,25 @@ cef_lhash_tbl_create_ext (
 	
 	ht->def_elem_max = def_tbl_size;
 	ht->elem_max = table_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
+
+	return ((CefT_Hash_Handle) ht);
+}
+
+CefT_Hash_Handle
+cef_lhash_tbl_create_with_alg (
+	uint32_t table_size,
+	uint8_t coef,
+	int alg
+) {
+	CefT_List_Hash* ht;
+
+	ht = (CefT_List_Hash*) cef_lhash_tbl_create_ext (table_size, coef);
+	if (ht == NULL) {
+		return ((CefT_Hash_Handle) NULL);
+	}
+	ht->hfunc = cef_hash_func_get (alg);
 
 	return ((CefT_Hash_Handle) ht);
 }
@@ -999,6 +1077,8 @@ cef_lhash_tbl_create_u32 (
 	
 	ht->elem_max = table_size;
 	ht->def_elem_max = def_tbl_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
 
 	return ((CefT_Hash_Handle) ht);
 }
@@ -1052,17 +1132,59 @@ cef_lhash_tbl_create_u32_ext (
 	
 	ht->elem_max = table_size;
 	ht->def_elem_max = def_tbl_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
+
+	return ((CefT_Hash_Handle) ht);
+}
+
+/*--------------------------------------------------------------------------------------
+	Creates the list hash table which starts small and grows or shrinks with
+	the load. The buckets move while resizing, so the indexes are valid only
+	until the next set or remove.
+----------------------------------------------------------------------------------------*/
+CefT_Hash_Handle
+cef_lhash_tbl_create_resizable (
+	uint32_t table_size,					/* User defined maximum size 				*/
+	uint8_t coef
+) {
+	CefT_List_Hash* ht = NULL;
+	uint64_t table_size64 = (uint64_t) table_size * coef;
+	uint32_t elem_max = CefC_Hash_Group_Width;
+
+	while ((elem_max < table_size64) && (elem_max < CefC_Hash_Resize_Init)) {
+		elem_max <<= 1;
+	}
+
+	ht = (CefT_List_Hash*) malloc (sizeof (CefT_List_Hash));
+	if (ht == NULL) {
+		return ((CefT_Hash_Handle) NULL);
+	}
+	memset (ht, 0, sizeof (CefT_List_Hash));
+
+	ht->tbl = (CefT_List_Hash_Cell**)
+		cef_hash_bulk_alloc ((size_t) elem_max * sizeof (CefT_List_Hash_Cell*));
+	if (ht->tbl == NULL) {
+		free (ht);
+		return ((CefT_Hash_Handle) NULL);
+	}
+
+	ht->elem_max = elem_max;
+	ht->min_max = elem_max;
+	ht->def_elem_max = table_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
 
 	return ((CefT_Hash_Handle) ht);
 }
 
 void
-cef_lhash_tbl_destroy ( 
+cef_lhash_tbl_destroy (
 	CefT_Hash_Handle handle
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
 	uint32_t i;
-	
+
 	if (ht == NULL) {
 		return;
 	}
@@ -1076,7 +1198,23 @@ cef_lhash_tbl_destroy (
 			cp = wcp;
 		}
 	}
-	free (ht->tbl);
+	for (i = ht->mig_pos ; i < ht->old_max ; i++) {
+		CefT_List_Hash_Cell* cp;
+		CefT_List_Hash_Cell* wcp;
+		cp = ht->old_tbl[i];
+		while (cp != NULL) {
+			wcp = cp->next;
+			free(cp);
+			cp = wcp;
+		}
+	}
+	if (ht->min_max) {
+		/* Buckets of the resizable table 	*/
+		cef_hash_bulk_free (ht->old_tbl, (size_t) ht->old_max * sizeof (CefT_List_Hash_Cell*));
+		cef_hash_bulk_free (ht->tbl, (size_t) ht->elem_max * sizeof (CefT_List_Hash_Cell*));
+	} else {
+		free (ht->tbl);
+	}
 	free (ht);
 
 	return;
@@ -1090,55 +1228,59 @@ cef_lhash_tbl_item_set (
 	void* elem
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
+
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return (CefC_Hash_Faile);
+	}
+	return (cef_lhash_tbl_item_set_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen), elem));
+}
+
+int
+cef_lhash_tbl_item_set_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv,
+	void* elem
+) {
+	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
+	uint32_t hash = hashv;
+	CefT_List_Hash_Cell** bucket;
 	CefT_List_Hash_Cell* cp;
-	CefT_List_Hash_Cell* wcp;
 
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_Faile);
 	}
-	
-	hash = cef_lhash_number_create (key, klen);
-	index = hash % ht->elem_max;
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
+	}
+	cef_lhash_tbl_resize_check (ht, 1);
+	bucket = cef_lhash_tbl_bucket_get (ht, hash);
 
-	if(ht->tbl[index] == NULL){
-		ht->tbl[index] = (CefT_List_Hash_Cell* )calloc(1, sizeof(CefT_List_Hash_Cell) + klen);
-		if (ht->tbl[index] == NULL) {
-			return (-1);
-		}
-		ht->tbl[index]->key = ((unsigned char*)ht->tbl[index]) + sizeof(CefT_List_Hash_Cell);
-		cp = ht->tbl[index];
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		ht->elem_num++;
-		return (0);
-	} else {
-		/* exist check & replace */
-		for (cp = ht->tbl[index]; cp != NULL; cp = cp->next) {
-			if((cp->klen == klen) &&
-			   (memcmp (cp->key, key, klen) == 0)){
-				cp->elem = elem;
-				return (0);
-		   }
-		}
-		/* insert */
-		wcp = ht->tbl[index];
-		ht->tbl[index] = (CefT_List_Hash_Cell* )calloc(1, sizeof(CefT_List_Hash_Cell) + klen);
-		if (ht->tbl[index] == NULL) {
-			return (-1);
-		}
-		ht->tbl[index]->key = ((unsigned char*)ht->tbl[index]) + sizeof(CefT_List_Hash_Cell);
-		cp = ht->tbl[index];
-		cp->next = wcp;
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		ht->elem_num++;
-		return (0);
+	/* exist check & replace */
+	for (cp = *bucket; cp != NULL; cp = cp->next) {
+		if((cp->klen == klen) &&
+		   (memcmp (cp->key, key, klen) == 0)){
+			cp->elem = elem;
+			return (0);
+	   }
 	}
+	/* insert */
+	cp = (CefT_List_Hash_Cell* )calloc(1, sizeof(CefT_List_Hash_Cell) + klen);
+	if (cp == NULL) {
+		return (-1);
+	}
+	cp->key = ((unsigned char*)cp) + sizeof(CefT_List_Hash_Cell);
+	cp->next = *bucket;
+	cp->elem = elem;
+	cp->klen = klen;
+	cp->hash = hash;
+	memcpy (cp->key, key, klen);
+	*bucket = cp;
+	ht->elem_num++;
+	return (0);
 }
 
 void*
@@ -1148,22 +1290,33 @@ cef_lhash_tbl_item_get (
 	uint32_t klen
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	CefT_List_Hash_Cell* cp;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
+	return (cef_lhash_tbl_item_get_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen)));
+}
 
-	hash = cef_lhash_number_create (key, klen);
-	index = hash % ht->elem_max;
+void*
+cef_lhash_tbl_item_get_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+) {
+	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
+	uint32_t hash = hashv;
+	CefT_List_Hash_Cell* cp;
 
-	cp = ht->tbl[index];
-	if(cp == NULL){
-		return (NULL);
-	} 
-	for (cp = ht->tbl[index]; cp != NULL; cp = cp->next) {
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
+	}
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
+	}
+
+	for (cp = *cef_lhash_tbl_bucket_get (ht, hash); cp != NULL; cp = cp->next) {
 		if((cp->klen == klen) &&
 		   (memcmp (cp->key, key, klen) == 0)){
 		   	return ((void*) cp->elem);
@@ -1179,44 +1332,44 @@ cef_lhash_tbl_item_remove (
 	uint32_t klen
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
+
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return (CefC_Hash_False);
+	}
+	return (cef_lhash_tbl_item_remove_with_hashv (
+				handle, key, klen, ht->hfunc (ht->seed, key, klen)));
+}
+
+void*
+cef_lhash_tbl_item_remove_with_hashv (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hashv
+) {
+	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
+	uint32_t hash = hashv;
 	void* ret_elem;
+	CefT_List_Hash_Cell** pp;
 	CefT_List_Hash_Cell* cp;
-	CefT_List_Hash_Cell* wcp;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_False);
 	}
-
-	hash = cef_lhash_number_create (key, klen);
-	index = hash % ht->elem_max;
-	
-	cp = ht->tbl[index];
-	if(cp == NULL){
-		return (NULL);
+	if (!cef_hash_hashv_adoptable (ht)) {
+		hash = ht->hfunc (ht->seed, key, klen);
 	}
-	if (cp != NULL) {
+	cef_lhash_tbl_resize_check (ht, 0);
+
+	for (pp = cef_lhash_tbl_bucket_get (ht, hash); *pp != NULL; pp = &(*pp)->next) {
+		cp = *pp;
 		if ((cp->klen == klen) &&
 			(memcmp (cp->key, key, klen) == 0)){
-			ht->tbl[index] = cp->next;
+			*pp = cp->next;
 			ht->elem_num--;
 			ret_elem = cp->elem;
 			free(cp);
 			return ((void *)ret_elem);
-		} else {
-			cp = ht->tbl[index];
-			for (; cp->next != NULL; cp = cp->next) {
-				if ((cp->next->klen == klen) &&
-					(memcmp (cp->next->key, key, klen) == 0)){
-					wcp = cp->next;
-					cp->next = cp->next->next;
-					ht->elem_num--;
-					ret_elem = wcp->elem;
-					free(wcp);
-					return ((void *)ret_elem);
-				}
-			}
 		}
 	}
 
@@ -1241,6 +1394,16 @@ cef_lhash_tbl_def_max_get (
 int
 cef_lhash_tbl_item_max_idx_get (
 	CefT_Hash_Handle handle
+) {
+	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
+
+	return ((int)(ht->elem_max + ht->old_max));
+}
+
+/* Get number of buckets where the new entries are stored	*/
+int
+cef_lhash_tbl_capacity_get (
+	CefT_Hash_Handle handle
 ) {
 	return ((int)(((CefT_List_Hash*) handle)->elem_max));
 }
@@ -1252,39 +1415,43 @@ cef_lhash_tbl_elem_get (
 	uint32_t* elem_num
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
+	uint32_t index_max = ht->elem_max + ht->old_max;
 	uint32_t i, cnt;
 	CefT_List_Hash_Cell* cp;
-	
-	if (*index > ht->elem_max) {
+	CefT_List_Hash_Cell* bp;
+
+	if (*index > index_max) {
 		return ((void*) NULL);
 	}
-	
+
 	cnt = 0;
-	for (i = *index ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i] != NULL) {
+	for (i = *index ; i < index_max ; i++) {
+		bp = *cef_lhash_tbl_bucket_at (ht, i);
+		if (bp != NULL) {
 			*index = i;
 			cnt++;
-			for (cp = ht->tbl[i]; cp->next != NULL; cp = cp->next) {
+			for (cp = bp; cp->next != NULL; cp = cp->next) {
 				cnt++;
 			}
 			*elem_num = cnt;
-			return ((void*) ht->tbl[i]->elem);
+			return ((void*) bp->elem);
 		}
 	}
 
 	for (i = 0 ; i < *index ; i++) {
-		if (ht->tbl[i] != NULL) {
+		bp = *cef_lhash_tbl_bucket_at (ht, i);
+		if (bp != NULL) {
 			*index = i;
 			cnt++;
-			for (cp = ht->tbl[i]; cp->next != NULL; cp = cp->next) {
+			for (cp = bp; cp->next != NULL; cp = cp->next) {
 				cnt++;
 			}
 			*elem_num = cnt;
-			return ((void*) ht->tbl[i]->elem);
+			return ((void*) bp->elem);
 		}
 	}
 	*index = 0;
-	
+
 	return ((void*) NULL);
 }
 
@@ -1299,7 +1466,7 @@ cef_lhash_tbl_hashv_get (
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (0);
 	}
-	return (cef_lhash_number_create (key, klen));
+	return (ht->hfunc (ht->seed, key, klen));
 }
 
 void*
@@ -1312,16 +1479,16 @@ cef_lhash_tbl_item_get_from_index (
 	uint32_t cnt = 0;
 	CefT_List_Hash_Cell* cp;
 
-	if (index > ht->elem_max) {
+	if (index >= ht->elem_max + ht->old_max) {
 		return ((void*) NULL);
 	}
-	
-	cp = ht->tbl[index];
-	
+
+	cp = *cef_lhash_tbl_bucket_at (ht, index);
+
 	if (cp == NULL) {
 		return ((void*) NULL);
 	}
-	
+
 	if (cp->klen != 0 && cp->klen != -1) {
 		for (cnt = 0; cp != NULL; cp = cp->next, cnt++) {
 			if (cnt == lindex) {
@@ -1345,9 +1512,8 @@ cef_lhash_tbl_item_set_for_app (
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
 	uint32_t hash;
-	uint32_t index;
+	CefT_List_Hash_Cell** bucket;
 	CefT_List_Hash_Cell* cp;
-	CefT_List_Hash_Cell* wcp;
 	int res;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
@@ -1358,48 +1524,34 @@ cef_lhash_tbl_item_set_for_app (
 		return (CefC_Hash_Faile);
 	}
 
-	hash = cef_lhash_number_create (key, klen);
-	index = hash % ht->elem_max;
+	hash = ht->hfunc (ht->seed, key, klen);
+	cef_lhash_tbl_resize_check (ht, 1);
+	bucket = cef_lhash_tbl_bucket_get (ht, hash);
 
-	if(ht->tbl[index] == NULL){
-		ht->tbl[index] = (CefT_List_Hash_Cell*) calloc (1, sizeof(CefT_List_Hash_Cell) + klen);
-		if (ht->tbl[index] == NULL) {
-			return (-1);
-		}
-		ht->tbl[index]->key = ((unsigned char*)ht->tbl[index]) + sizeof(CefT_List_Hash_Cell);
-		cp = ht->tbl[index];
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		cp->opt_f = opt;
-		ht->elem_num++;
-		return (0);
-	} else {
-		/* exist check & replace */
-		for (cp = ht->tbl[index]; cp != NULL; cp = cp->next) {
-			if((cp->klen == klen) &&
-			   (memcmp (cp->key, key, klen) == 0)){
-				cp->elem = elem;
-				cp->opt_f = opt;
-				return (0);
-		   }
-		}
-		/* insert */
-		wcp = ht->tbl[index];
-		ht->tbl[index] = (CefT_List_Hash_Cell*) calloc (1, sizeof(CefT_List_Hash_Cell) + klen);
-		if (ht->tbl[index] == NULL) {
-			return (-1);
-		}
-		ht->tbl[index]->key = ((unsigned char*)ht->tbl[index]) + sizeof(CefT_List_Hash_Cell);
-		cp = ht->tbl[index];
-		cp->next = wcp;
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		cp->opt_f = opt;
-		ht->elem_num++;
-		return (0);
+	/* exist check & replace */
+	for (cp = *bucket; cp != NULL; cp = cp->next) {
+		if((cp->klen == klen) &&
+		   (memcmp (cp->key, key, klen) == 0)){
+			cp->elem = elem;
+			cp->opt_f = opt;
+			return (0);
+	   }
+	}
+	/* insert */
+	cp = (CefT_List_Hash_Cell*) calloc (1, sizeof(CefT_List_Hash_Cell) + klen);
+	if (cp == NULL) {
+		return (-1);
 	}
+	cp->key = ((unsigned char*)cp) + sizeof(CefT_List_Hash_Cell);
+	cp->next = *bucket;
+	cp->elem = elem;
+	cp->klen = klen;
+	cp->hash = hash;
+	memcpy (cp->key, key, klen);
+	cp->opt_f = opt;
+	*bucket = cp;
+	ht->elem_num++;
+	return (0);
 }
 
 void*
@@ -1410,21 +1562,15 @@ cef_lhash_tbl_item_get_for_app (
 ) {
 	CefT_List_Hash* ht = (CefT_List_Hash*) handle;
 	uint32_t hash;
-	uint32_t index;
 	CefT_List_Hash_Cell* cp;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
 
-	hash = cef_lhash_number_create (key, klen);
-	index = hash % ht->elem_max;
+	hash = ht->hfunc (ht->seed, key, klen);
 
-	cp = ht->tbl[index];
-	if(cp == NULL){
-		return (NULL);
-	} 
-	for (cp = ht->tbl[index]; cp != NULL; cp = cp->next) {
+	for (cp = *cef_lhash_tbl_bucket_get (ht, hash); cp != NULL; cp = cp->next) {
 		if (cp->opt_f) {
 			/* prefix match */
 			//entry_klen = cp->klen;
@@ -1474,45 +1620,1087 @@ cef_lhash_tbl_item_check_exact (
 }
 //----- 0.9.0b : 2022.07.11
 
-/****************************************************************************************
- ****************************************************************************************/
-
-static uint32_t
-cef_hash_number_create (
-	uint32_t hash,
+/*--------------------------------------------------------------------------------------
+	Returns the hash function of the specified algorithm
+----------------------------------------------------------------------------------------*/
+CefT_Hash_Func
+cef_hash_func_get (
+	int alg
+) {
+	switch (alg) {
+		case CefC_Hash_Alg_MD5: {
+			return (cef_hash_md5_number_create);
+		}
+		case CefC_Hash_Alg_XXH64:
+		default: {
+			return (cef_hash_xxh64_number_create);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Returns the per-process seed shared by the hash tables
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_hash_seed_get (
+	void
+) {
+	pthread_once (&cef_hash_seed_once, cef_hash_seed_init);
+	return (cef_hash_seed);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the hash value of the key with the default algorithm and the process seed
+----------------------------------------------------------------------------------------*/
+uint32_t
+cef_hash_key_hashv_create (
 	const unsigned char* key,
 	uint32_t klen
 ) {
-#if 0
+	return (cef_hash_xxh64_number_create (cef_hash_seed_get (), key, klen));
+}
+/*--------------------------------------------------------------------------------------
+	Creates the hash values of the prefixes of the key in one pass. The i-th value
+	is the same as cef_hash_key_hashv_create (key, ends[i]).
+----------------------------------------------------------------------------------------*/
+void
+cef_hash_key_prefix_hashv_create (
+	const unsigned char* key,
+	const uint16_t ends[],					/* lengths of the prefixes in ascending order	*/
+	uint32_t hashv[],						/* set the hash value of each prefix 		*/
+	int num									/* number of the prefixes 					*/
+) {
+	const unsigned char* p = key;
+	const unsigned char* end;
+	uint32_t seed = cef_hash_seed_get ();
+	uint64_t v[4];
+	uint64_t h64;
 	int i;
-	char* p = (char*) key;
-
-	hash += p[0];
-	hash += p[klen - 1];
-	hash += p[(klen - 1) / 2];
 
-	for (i = 0 ; i < klen ; i++) {
-		hash = hash * 33 + p[i];
+	cef_hash_count++;
+
+	v[0] = seed + CefC_Xxh_Prime1 + CefC_Xxh_Prime2;
+	v[1] = seed + CefC_Xxh_Prime2;
+	v[2] = seed + 0;
+	v[3] = seed - CefC_Xxh_Prime1;
+
+	/* The stripes of the shorter prefix are shared by the longer ones, so	*/
+	/* only the tail of each prefix is hashed again						*/
+	for (i = 0 ; i < num ; i++) {
+		end = key + ends[i];
+		if (ends[i] >= 32) {
+			while (p + 32 <= end) {
+				cef_hash_xxh64_stripe (v, p);
+				p += 32;
+			}
+			h64 = cef_hash_xxh64_converge (v);
+		} else {
+			h64 = seed + CefC_Xxh_Prime5;
+		}
+		hashv[i] = cef_hash_xxh64_finalize (h64, p, end, ends[i]);
 	}
-#endif
-	unsigned char out[MD5_DIGEST_LENGTH];
-	
-	MD5 (key, klen, out);
-	memcpy (&hash, &out[12], sizeof (uint32_t));
+}
+/*--------------------------------------------------------------------------------------
+	Returns the number of the keys hashed by the calling thread
+----------------------------------------------------------------------------------------*/
+uint64_t
+cef_hash_count_get (
+	void
+) {
+	return (cef_hash_count);
+}
+/*--------------------------------------------------------------------------------------
+	Sets the water marks of the resizable tables. The table grows when its load
+	exceeds the high water mark and shrinks when it falls below the low one.
+----------------------------------------------------------------------------------------*/
+void
+cef_hash_water_mark_set (
+	uint32_t high,							/* Load factor in percent 					*/
+	uint32_t low							/* Load factor in percent 					*/
+) {
+	cef_hash_high_water = high;
+	cef_hash_low_water  = low;
+}
 
-	return (hash);
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Initializes the per-process seed.
+	The seed keeps remote peers from predicting the bucket of a name, so that
+	a flood of colliding names cannot degrade the tables to a linear search.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_seed_init (
+	void
+) {
+	uint32_t seed = 0;
+	int fd;
+
+	fd = open ("/dev/urandom", O_RDONLY);
+	if (fd >= 0) {
+		if (read (fd, &seed, sizeof (seed)) != sizeof (seed)) {
+			seed = 0;
+		}
+		close (fd);
+	}
+	if (seed == 0) {
+		seed = (uint32_t) time (NULL) ^ ((uint32_t) getpid () << 16);
+	}
+	cef_hash_seed = seed;
 }
 
 static uint32_t
-cef_lhash_number_create (
+cef_hash_md5_number_create (
+	uint32_t seed,
 	const unsigned char* key,
 	uint32_t klen
 ) {
 	uint32_t hash;
 	unsigned char out[MD5_DIGEST_LENGTH];
 	
+	cef_hash_count++;
 	MD5 (key, klen, out);
 	memcpy (&hash, &out[12], sizeof (uint32_t));
 
 	return (hash);
 }
+
+/*--------------------------------------------------------------------------------------
+	xxHash64 (XXH64) folded to 32 bits
+----------------------------------------------------------------------------------------*/
+static inline uint64_t
+cef_hash_xxh64_round (
+	uint64_t acc,
+	uint64_t input
+) {
+	acc += input * CefC_Xxh_Prime2;
+	acc  = CefC_Xxh_Rotl (acc, 31);
+	acc *= CefC_Xxh_Prime1;
+	return (acc);
+}
+
+static inline uint64_t
+cef_hash_xxh64_merge (
+	uint64_t acc,
+	uint64_t val
+) {
+	acc ^= cef_hash_xxh64_round (0, val);
+	acc  = acc * CefC_Xxh_Prime1 + CefC_Xxh_Prime4;
+	return (acc);
+}
+
+static inline void
+cef_hash_xxh64_stripe (
+	uint64_t v[],
+	const unsigned char* p
+) {
+	uint64_t k64;
+
+	memcpy (&k64, p, 8);
+	v[0] = cef_hash_xxh64_round (v[0], k64);
+	memcpy (&k64, p + 8, 8);
+	v[1] = cef_hash_xxh64_round (v[1], k64);
+	memcpy (&k64, p + 16, 8);
+	v[2] = cef_hash_xxh64_round (v[2], k64);
+	memcpy (&k64, p + 24, 8);
+	v[3] = cef_hash_xxh64_round (v[3], k64);
+}
+
+static inline uint64_t
+cef_hash_xxh64_converge (
+	uint64_t v[]
+) {
+	uint64_t h64;
+
+	h64 = CefC_Xxh_Rotl (v[0], 1) + CefC_Xxh_Rotl (v[1], 7)
+			+ CefC_Xxh_Rotl (v[2], 12) + CefC_Xxh_Rotl (v[3], 18);
+	h64 = cef_hash_xxh64_merge (h64, v[0]);
+	h64 = cef_hash_xxh64_merge (h64, v[1]);
+	h64 = cef_hash_xxh64_merge (h64, v[2]);
+	h64 = cef_hash_xxh64_merge (h64, v[3]);
+	return (h64);
+}
+
+static inline uint32_t
+cef_hash_xxh64_finalize (
+	uint64_t h64,
+	const unsigned char* p,
+	const unsigned char* end,
+	uint32_t klen
+) {
+	uint64_t k64;
+	uint32_t k32;
+
+	h64 += (uint64_t) klen;
+
+	while (p + 8 <= end) {
+		memcpy (&k64, p, 8);
+		h64 ^= cef_hash_xxh64_round (0, k64);
+		h64  = CefC_Xxh_Rotl (h64, 27) * CefC_Xxh_Prime1 + CefC_Xxh_Prime4;
+		p += 8;
+	}
+	if (p + 4 <= end) {
+		memcpy (&k32, p, 4);
+		h64 ^= (uint64_t) k32 * CefC_Xxh_Prime1;
+		h64  = CefC_Xxh_Rotl (h64, 23) * CefC_Xxh_Prime2 + CefC_Xxh_Prime3;
+		p += 4;
+	}
+	while (p < end) {
+		h64 ^= (*p) * CefC_Xxh_Prime5;
+		h64  = CefC_Xxh_Rotl (h64, 11) * CefC_Xxh_Prime1;
+		p++;
+	}
+
+	h64 ^= h64 >> 33;
+	h64 *= CefC_Xxh_Prime2;
+	h64 ^= h64 >> 29;
+	h64 *= CefC_Xxh_Prime3;
+	h64 ^= h64 >> 32;
+
+	return ((uint32_t)(h64 ^ (h64 >> 32)));
+}
+
+static uint32_t
+cef_hash_xxh64_number_create (
+	uint32_t seed,
+	const unsigned char* key,
+	uint32_t klen
+) {
+	const unsigned char* p = key;
+	const unsigned char* end = key + klen;
+	uint64_t h64;
+	uint64_t v[4];
+
+	cef_hash_count++;
+
+	if (klen >= 32) {
+		const unsigned char* limit = end - 32;
+		v[0] = seed + CefC_Xxh_Prime1 + CefC_Xxh_Prime2;
+		v[1] = seed + CefC_Xxh_Prime2;
+		v[2] = seed + 0;
+		v[3] = seed - CefC_Xxh_Prime1;
+		do {
+			cef_hash_xxh64_stripe (v, p);
+			p += 32;
+		} while (p <= limit);
+
+		h64 = cef_hash_xxh64_converge (v);
+	} else {
+		h64 = seed + CefC_Xxh_Prime5;
+	}
+
+	return (cef_hash_xxh64_finalize (h64, p, end, klen));
+}
+
+/*--------------------------------------------------------------------------------------
+	Allocates the table which has the power of two slots for the specified size.
+	The slots are kept under 7/8 full so that the probe stops at an empty slot soon.
+----------------------------------------------------------------------------------------*/
+static CefT_Hash_Handle
+cef_hash_tbl_alloc (
+	uint64_t table_size,					/* Number of the entries to be stored 		*/
+	uint32_t def_tbl_size,					/* User defined maximum size 				*/
+	int resizable_f							/* 1 if the slots grow and shrink 			*/
+) {
+	CefT_Hash* ht = NULL;
+	uint64_t elem_max = CefC_Hash_Group_Width;
+
+	if ((resizable_f) && (table_size > CefC_Hash_Resize_Init)) {
+		table_size = CefC_Hash_Resize_Init;
+	}
+	table_size += table_size / 7;
+	while ((elem_max < table_size) && (elem_max < CefC_Hash_Slots_Max)) {
+		elem_max <<= 1;
+	}
+
+	ht = (CefT_Hash*) malloc (sizeof (CefT_Hash));
+	if (ht == NULL) {
+		return ((CefT_Hash_Handle) NULL);
+	}
+	memset (ht, 0, sizeof (CefT_Hash));
+
+	if (cef_hash_slots_init (&ht->cur, (uint32_t) elem_max) < 0) {
+		free (ht);
+		return ((CefT_Hash_Handle) NULL);
+	}
+
+	srand ((unsigned) time (NULL));
+	if (resizable_f) {
+		ht->min_max = ht->cur.elem_max;
+	}
+	ht->def_elem_max = def_tbl_size;
+	ht->seed = cef_hash_seed_get ();
+	ht->hfunc = cef_hash_func_get (CefC_Hash_Alg_Default);
+
+	return ((CefT_Hash_Handle) ht);
+}
+/*--------------------------------------------------------------------------------------
+	Stores the entry, or updates the entry if the key exists and replace_f is set
+----------------------------------------------------------------------------------------*/
+static int									/* index of the entry, or CefC_Hash_Faile 	*/
+cef_hash_tbl_item_insert (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	void* elem,
+	uint8_t opt,
+	int replace_f
+) {
+	CefT_Hash_Slots* sl = &ht->cur;
+	unsigned char* kp;
+	int index;
+	int free_index;
+
+	if (ht->old.tbl) {
+		cef_hash_tbl_resize_step (ht);
+	} else if ((ht->min_max) &&
+		((uint64_t)(sl->elem_num + 1) * 100 > (uint64_t) sl->elem_max * cef_hash_tbl_high_water)) {
+		/* Grows the slots when the load exceeds the high water mark 	*/
+		cef_hash_tbl_resize_start (ht, sl->elem_max * 2);
+	} else if ((ht->min_max) && (sl->tomb_num > sl->tomb_limit)) {
+		/* Rehashes into the slots of the same size to drop the deleted slots. 	*/
+		/* The entries are migrated by the bounded steps as well as resizing. 	*/
+		cef_hash_tbl_resize_start (ht, sl->elem_max);
+		if (ht->old.tbl == NULL) {
+			/* Retries after more slots are deleted 	*/
+			sl->tomb_limit = sl->tomb_num + sl->elem_max / 8;
+		}
+	} else if (sl->tomb_num > sl->tomb_limit) {
+		/* The callers of the fixed size tables keep the indexes of the entries 	*/
+		cef_hash_slots_tomb_cleanup (sl);
+	}
+
+	index = cef_hash_slots_probe (sl, key, klen, hash, &free_index);
+	if ((index < 0) && (ht->old.tbl)) {
+		index = cef_hash_slots_probe (&ht->old, key, klen, hash, NULL);
+		if (index >= 0) {
+			sl = &ht->old;
+		}
+	}
+	if (index >= 0) {
+		if (!replace_f) {
+			return (CefC_Hash_Faile);
+		}
+		sl->tbl[index].elem = elem;
+		return ((sl == &ht->cur) ? index : (int)(ht->cur.elem_max + index));
+	}
+
+	if (free_index < 0) {
+		return (CefC_Hash_Faile);
+	}
+	kp = cef_hash_tbl_key_dup (ht, key, klen);
+	if (kp == NULL) {
+		return (CefC_Hash_Faile);
+	}
+	cef_hash_slots_fill (sl, free_index, hash, kp, klen, elem, opt);
+
+	return (free_index);
+}
+/*--------------------------------------------------------------------------------------
+	Looks up the key in the current slots, then in the slots being migrated
+----------------------------------------------------------------------------------------*/
+static int									/* index of the key, or -1 if not found 	*/
+cef_hash_tbl_lookup (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	CefT_Hash_Slots** slp					/* set the slots which have the key 		*/
+) {
+	int index;
+
+	index = cef_hash_slots_probe (&ht->cur, key, klen, hash, NULL);
+	if (index >= 0) {
+		*slp = &ht->cur;
+		return (index);
+	}
+	if (ht->old.tbl) {
+		index = cef_hash_slots_probe (&ht->old, key, klen, hash, NULL);
+		if (index >= 0) {
+			*slp = &ht->old;
+			return (index);
+		}
+	}
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Copies the key into the arena of the table
+----------------------------------------------------------------------------------------*/
+static unsigned char*
+cef_hash_tbl_key_dup (
+	CefT_Hash* ht,
+	const unsigned char* key,
+	uint32_t klen
+) {
+	unsigned char* kp;
+
+	kp = cef_hash_arena_alloc (&ht->arena, klen);
+	if (kp) {
+		memcpy (kp, key, klen);
+	}
+	return (kp);
+}
+/*--------------------------------------------------------------------------------------
+	Removes the entry from the full slot and frees its key
+----------------------------------------------------------------------------------------*/
+static void*								/* element of the removed entry 			*/
+cef_hash_tbl_slot_remove (
+	CefT_Hash* ht,
+	CefT_Hash_Slots* sl,
+	uint32_t index
+) {
+	void* elem = sl->tbl[index].elem;
+
+	cef_hash_arena_free (&ht->arena, sl->tbl[index].key, sl->tbl[index].klen);
+	cef_hash_slots_clear (sl, index);
+
+	return (elem);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the number of the indexes. While resizing, the indexes of the slots
+	being migrated follow the indexes of the current slots.
+----------------------------------------------------------------------------------------*/
+static inline uint32_t
+cef_hash_tbl_index_max (
+	CefT_Hash* ht
+) {
+	return (ht->cur.elem_max + ht->old.elem_max);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the slots of the index and converts the index into the slots
+----------------------------------------------------------------------------------------*/
+static CefT_Hash_Slots*
+cef_hash_tbl_index_slots (
+	CefT_Hash* ht,
+	uint32_t* index
+) {
+	if (*index < ht->cur.elem_max) {
+		return (&ht->cur);
+	}
+	if (*index - ht->cur.elem_max < ht->old.elem_max) {
+		*index -= ht->cur.elem_max;
+		return (&ht->old);
+	}
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the first index of the full slot in the range
+----------------------------------------------------------------------------------------*/
+static int									/* index, or -1 if not found 				*/
+cef_hash_tbl_full_index_find (
+	CefT_Hash* ht,
+	uint32_t from,
+	uint32_t to
+) {
+	uint32_t i;
+
+	for (i = from ; (i < to) && (i < ht->cur.elem_max) ; i++) {
+		if (cef_hash_ctrl_is_full (ht->cur.ctrl[i])) {
+			return ((int) i);
+		}
+	}
+	for ( ; i < to ; i++) {
+		if (cef_hash_ctrl_is_full (ht->old.ctrl[i - ht->cur.elem_max])) {
+			return ((int) i);
+		}
+	}
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Starts the migration to the new slots. The current slots become the old ones
+	and the entries are moved a few at a time by the following set and remove.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_tbl_resize_start (
+	CefT_Hash* ht,
+	uint32_t elem_max						/* Number of the new slots 					*/
+) {
+	CefT_Hash_Slots sl;
+
+	if ((elem_max < CefC_Hash_Group_Width) || (elem_max > CefC_Hash_Slots_Max) ||
+		(cef_hash_slots_init (&sl, elem_max) < 0)) {
+		/* Keeps the current slots 	*/
+		return;
+	}
+	ht->old = ht->cur;
+	ht->cur = sl;
+	ht->mig_pos = 0;
+}
+/*--------------------------------------------------------------------------------------
+	Moves the entries of a bounded number of the old slots into the current slots.
+	The key chunks stay in the arena, so only the slots are copied.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_tbl_resize_step (
+	CefT_Hash* ht
+) {
+	CefT_Hash_Slots* old = &ht->old;
+	CefT_Hash_Table* ent;
+	uint32_t end;
+	int index;
+
+	end = ht->mig_pos + CefC_Hash_Resize_Step;
+	if (end > old->elem_max) {
+		end = old->elem_max;
+	}
+	for ( ; ht->mig_pos < end ; ht->mig_pos++) {
+		if (!cef_hash_ctrl_is_full (old->ctrl[ht->mig_pos])) {
+			continue;
+		}
+		ent = &old->tbl[ht->mig_pos];
+		index = cef_hash_slots_free_find (&ht->cur, ent->hash);
+		if (index < 0) {
+			/* Retries when the current slots have room 	*/
+			return;
+		}
+		cef_hash_slots_fill (&ht->cur, (uint32_t) index,
+			ent->hash, ent->key, ent->klen, ent->elem, ent->opt_f);
+		cef_hash_slots_clear (old, ht->mig_pos);
+	}
+
+	if (ht->mig_pos >= old->elem_max) {
+		cef_hash_slots_free (old);
+		ht->mig_pos = 0;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Allocates the power of two slots
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+cef_hash_slots_init (
+	CefT_Hash_Slots* sl,
+	uint32_t elem_max
+) {
+	memset (sl, 0, sizeof (CefT_Hash_Slots));
+
+	sl->ctrl = (uint8_t*) cef_hash_bulk_alloc ((size_t) elem_max);
+	if (sl->ctrl == NULL) {
+		return (-1);
+	}
+	memset (sl->ctrl, CefC_Hash_Ctrl_Empty, (size_t) elem_max);
+
+	sl->tbl = (CefT_Hash_Table*)
+		cef_hash_bulk_alloc ((size_t) elem_max * sizeof (CefT_Hash_Table));
+	if (sl->tbl == NULL) {
+		cef_hash_bulk_free (sl->ctrl, (size_t) elem_max);
+		sl->ctrl = NULL;
+		return (-1);
+	}
+	sl->elem_max = elem_max;
+	sl->group_mask = (elem_max >> CefC_Hash_Group_Shift) - 1;
+	sl->tomb_limit = elem_max / 8;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the slots. The keys in the arena are not freed.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_slots_free (
+	CefT_Hash_Slots* sl
+) {
+	cef_hash_bulk_free (sl->ctrl, (size_t) sl->elem_max);
+	cef_hash_bulk_free (sl->tbl, (size_t) sl->elem_max * sizeof (CefT_Hash_Table));
+	memset (sl, 0, sizeof (CefT_Hash_Slots));
+}
+/*--------------------------------------------------------------------------------------
+	Returns the bits of the slots in the group whose control byte equals the value
+----------------------------------------------------------------------------------------*/
+static inline uint32_t
+cef_hash_group_match (
+	const uint8_t* ctrl,					/* Control bytes of the group 				*/
+	uint8_t v
+) {
+#ifdef __SSE2__
+	__m128i grp = _mm_load_si128 ((const __m128i*) ctrl);
+
+	return ((uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (grp, _mm_set1_epi8 ((char) v))));
+#else // __SSE2__
+	uint32_t bits = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_Hash_Group_Width ; i++) {
+		bits |= (uint32_t)(ctrl[i] == v) << i;
+	}
+	return (bits);
+#endif // __SSE2__
+}
+/*--------------------------------------------------------------------------------------
+	Returns the bits of the empty or deleted slots in the group
+----------------------------------------------------------------------------------------*/
+static inline uint32_t
+cef_hash_group_match_free (
+	const uint8_t* ctrl						/* Control bytes of the group 				*/
+) {
+#ifdef __SSE2__
+	/* Only the empty and the deleted bytes have the top bit 	*/
+	return ((uint32_t) _mm_movemask_epi8 (_mm_load_si128 ((const __m128i*) ctrl)));
+#else // __SSE2__
+	uint32_t bits = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_Hash_Group_Width ; i++) {
+		bits |= (uint32_t)(ctrl[i] >> 7) << i;
+	}
+	return (bits);
+#endif // __SSE2__
+}
+/*--------------------------------------------------------------------------------------
+	Returns the slot which the purge functions use for the hash value.
+	The slot is in the home group, so that the probe also finds the entry.
+----------------------------------------------------------------------------------------*/
+static inline uint32_t
+cef_hash_slots_prg_index (
+	CefT_Hash_Slots* sl,
+	uint32_t hash
+) {
+	return (((CefC_Hash_H1 (hash) & sl->group_mask) << CefC_Hash_Group_Shift)
+				| (hash & (CefC_Hash_Group_Width - 1)));
+}
+/*--------------------------------------------------------------------------------------
+	Probes the groups from the home group of the key until the group which has
+	an empty slot
+----------------------------------------------------------------------------------------*/
+static int									/* index of the key, or -1 if not found 	*/
+cef_hash_slots_probe (
+	CefT_Hash_Slots* sl,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash,
+	int* free_index							/* set the first free slot on the probe 	*/
+											/* sequence (or -1) if not NULL 			*/
+) {
+	uint32_t grp = CefC_Hash_H1 (hash) & sl->group_mask;
+	uint8_t h2 = CefC_Hash_H2 (hash);
+	const uint8_t* ctrl;
+	uint32_t base;
+	uint32_t bits;
+	uint32_t index;
+	uint32_t n;
+
+	if (free_index) {
+		*free_index = -1;
+	}
+
+	for (n = 0 ; n <= sl->group_mask ; n++) {
+		base = grp << CefC_Hash_Group_Shift;
+		ctrl = &sl->ctrl[base];
+
+		bits = cef_hash_group_match (ctrl, h2);
+		while (bits) {
+			index = base + __builtin_ctz (bits);
+			if ((sl->tbl[index].hash == hash) &&
+				(sl->tbl[index].klen == klen) &&
+				(memcmp (sl->tbl[index].key, key, klen) == 0)) {
+				return ((int) index);
+			}
+			bits &= bits - 1;
+		}
+		if ((free_index) && (*free_index < 0)) {
+			bits = cef_hash_group_match_free (ctrl);
+			if (bits) {
+				*free_index = (int)(base + __builtin_ctz (bits));
+			}
+		}
+		if (cef_hash_group_match (ctrl, CefC_Hash_Ctrl_Empty)) {
+			break;
+		}
+		grp = (grp + 1) & sl->group_mask;
+	}
+
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the first free slot on the probe sequence of the hash value
+----------------------------------------------------------------------------------------*/
+static int									/* index, or -1 if the slots are full 		*/
+cef_hash_slots_free_find (
+	CefT_Hash_Slots* sl,
+	uint32_t hash
+) {
+	uint32_t grp = CefC_Hash_H1 (hash) & sl->group_mask;
+	uint32_t bits;
+	uint32_t n;
+
+	for (n = 0 ; n <= sl->group_mask ; n++) {
+		bits = cef_hash_group_match_free (&sl->ctrl[grp << CefC_Hash_Group_Shift]);
+		if (bits) {
+			return ((int)((grp << CefC_Hash_Group_Shift) + __builtin_ctz (bits)));
+		}
+		grp = (grp + 1) & sl->group_mask;
+	}
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Stores the entry whose key is already in the arena into the free slot
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_slots_fill (
+	CefT_Hash_Slots* sl,
+	uint32_t index,
+	uint32_t hash,
+	unsigned char* kp,						/* Key chunk in the arena 					*/
+	uint32_t klen,
+	void* elem,
+	uint8_t opt
+) {
+	if (sl->ctrl[index] == CefC_Hash_Ctrl_Deleted) {
+		sl->tomb_num--;
+	}
+	sl->ctrl[index] = CefC_Hash_H2 (hash);
+	sl->tbl[index].hash = hash;
+	sl->tbl[index].klen = klen;
+	sl->tbl[index].key = kp;
+	sl->tbl[index].elem = elem;
+	sl->tbl[index].opt_f = opt;
+	sl->elem_num++;
+}
+/*--------------------------------------------------------------------------------------
+	Clears the full slot.
+	The slot can be empty if its group has an empty slot, because no probe has
+	passed through such a group. Otherwise it is marked as deleted.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_slots_clear (
+	CefT_Hash_Slots* sl,
+	uint32_t index
+) {
+	uint32_t base = index & ~((uint32_t) CefC_Hash_Group_Width - 1);
+
+	memset (&sl->tbl[index], 0, sizeof (CefT_Hash_Table));
+
+	if (cef_hash_group_match (&sl->ctrl[base], CefC_Hash_Ctrl_Empty)) {
+		sl->ctrl[index] = CefC_Hash_Ctrl_Empty;
+	} else {
+		sl->ctrl[index] = CefC_Hash_Ctrl_Deleted;
+		sl->tomb_num++;
+	}
+	sl->elem_num--;
+}
+/*--------------------------------------------------------------------------------------
+	Turns the deleted slots back into the empty slots where no probe needs to pass.
+	The entries are not moved, so the indexes given to the callers stay valid.
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_slots_tomb_cleanup (
+	CefT_Hash_Slots* sl
+) {
+	uint8_t* pass_f;
+	uint32_t index;
+	uint32_t grp;
+	uint32_t home;
+
+	pass_f = (uint8_t*) calloc (sl->group_mask + 1, sizeof (uint8_t));
+	if (pass_f == NULL) {
+		sl->tomb_limit = sl->tomb_num + sl->elem_max / 8;
+		return;
+	}
+
+	/* Marks the groups between the home group and the group of each entry 	*/
+	for (index = 0 ; index < sl->elem_max ; index++) {
+		if (!cef_hash_ctrl_is_full (sl->ctrl[index])) {
+			continue;
+		}
+		grp = index >> CefC_Hash_Group_Shift;
+		home = CefC_Hash_H1 (sl->tbl[index].hash) & sl->group_mask;
+		while (home != grp) {
+			pass_f[home] = 1;
+			home = (home + 1) & sl->group_mask;
+		}
+	}
+
+	for (index = 0 ; index < sl->elem_max ; index++) {
+		if ((sl->ctrl[index] == CefC_Hash_Ctrl_Deleted) &&
+			(pass_f[index >> CefC_Hash_Group_Shift] == 0)) {
+			sl->ctrl[index] = CefC_Hash_Ctrl_Empty;
+			sl->tomb_num--;
+		}
+	}
+	free (pass_f);
+
+	/* The deleted slots which remain do not start the next cleanup at once 	*/
+	sl->tomb_limit = sl->tomb_num + sl->elem_max / 8;
+}
+/*--------------------------------------------------------------------------------------
+	Looks up the entry registered by cef_hash_tbl_item_set_for_app. The entry
+	whose opt_f is set also matches the names under its prefix.
+----------------------------------------------------------------------------------------*/
+static void*
+cef_hash_slots_app_match (
+	CefT_Hash_Slots* sl,
+	const unsigned char* key,
+	uint32_t klen,
+	uint32_t hash
+) {
+	uint32_t i;
+	uint32_t entry_klen = 0;
+
+	for (i = 0 ; i < sl->elem_max ; i++) {
+		if (!cef_hash_ctrl_is_full (sl->ctrl[i]))
+			continue;
+
+		if (sl->tbl[i].opt_f) {
+			/* prefix match */
+			entry_klen = sl->tbl[i].klen;
+			if ((entry_klen <= klen) &&
+				(memcmp (sl->tbl[i].key, key, entry_klen) == 0)) {
+				if (entry_klen == klen) {
+					return ((void*) sl->tbl[i].elem);
+				} else if (entry_klen + 5 <= klen) {
+					/* eg) ccn:/test, ccn:/test/a */
+					/*                         ^^ */
+					/* separator(4) and prefix(more than 1) */
+					if ((key[entry_klen] == 0x00) &&
+						(key[entry_klen + 1] == 0x01)) {
+						return ((void*) sl->tbl[i].elem);
+					}
+				} else {
+					continue;
+				}
+			}
+		} else {
+			/* exact match */
+			if ((sl->tbl[i].hash == hash) &&
+				(sl->tbl[i].klen == klen) &&
+				(memcmp (sl->tbl[i].key, key, klen) == 0)) {
+				return ((void*) sl->tbl[i].elem);
+			}
+		}
+	}
+
+	return ((void*) NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the bucket of the hash value. While resizing, the bucket of the old
+	table is used until it is migrated.
+----------------------------------------------------------------------------------------*/
+static inline CefT_List_Hash_Cell**
+cef_lhash_tbl_bucket_get (
+	CefT_List_Hash* ht,
+	uint32_t hash
+) {
+	uint32_t index;
+
+	if (ht->old_tbl) {
+		index = hash % ht->old_max;
+		if (index >= ht->mig_pos) {
+			return (&ht->old_tbl[index]);
+		}
+	}
+	return (&ht->tbl[hash % ht->elem_max]);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the bucket of the index. While resizing, the indexes of the old
+	buckets follow the indexes of the current buckets.
+----------------------------------------------------------------------------------------*/
+static inline CefT_List_Hash_Cell**
+cef_lhash_tbl_bucket_at (
+	CefT_List_Hash* ht,
+	uint32_t index
+) {
+	if (index < ht->elem_max) {
+		return (&ht->tbl[index]);
+	}
+	return (&ht->old_tbl[index - ht->elem_max]);
+}
+/*--------------------------------------------------------------------------------------
+	Migrates a few buckets if the table is resizing, otherwise starts resizing
+	when the load crosses the water mark
+----------------------------------------------------------------------------------------*/
+static void
+cef_lhash_tbl_resize_check (
+	CefT_List_Hash* ht,
+	int set_f								/* 1 if an entry is going to be set 		*/
+) {
+	if (ht->old_tbl) {
+		cef_lhash_tbl_resize_step (ht);
+		return;
+	}
+	if (ht->min_max == 0) {
+		return;
+	}
+	if (set_f) {
+		if ((uint64_t)(ht->elem_num + 1) * 100 >
+				(uint64_t) ht->elem_max * cef_hash_high_water) {
+			cef_lhash_tbl_resize_start (ht, ht->elem_max * 2);
+		}
+	} else {
+		if ((ht->elem_max > ht->min_max) &&
+			((uint64_t) ht->elem_num * 100 <
+				(uint64_t) ht->elem_max * cef_hash_low_water)) {
+			cef_lhash_tbl_resize_start (ht, ht->elem_max / 2);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Starts the migration to the new buckets
+----------------------------------------------------------------------------------------*/
+static void
+cef_lhash_tbl_resize_start (
+	CefT_List_Hash* ht,
+	uint32_t elem_max						/* Number of the new buckets 				*/
+) {
+	CefT_List_Hash_Cell** tbl;
+
+	if ((elem_max < CefC_Hash_Group_Width) || (elem_max > CefC_Hash_Slots_Max)) {
+		return;
+	}
+	tbl = (CefT_List_Hash_Cell**)
+		cef_hash_bulk_alloc ((size_t) elem_max * sizeof (CefT_List_Hash_Cell*));
+	if (tbl == NULL) {
+		/* Keeps the current buckets 	*/
+		return;
+	}
+	ht->old_tbl  = ht->tbl;
+	ht->old_max  = ht->elem_max;
+	ht->mig_pos  = 0;
+	ht->tbl 	 = tbl;
+	ht->elem_max = elem_max;
+}
+/*--------------------------------------------------------------------------------------
+	Relinks the cells of a bounded number of the old buckets to the new buckets
+----------------------------------------------------------------------------------------*/
+static void
+cef_lhash_tbl_resize_step (
+	CefT_List_Hash* ht
+) {
+	CefT_List_Hash_Cell** bucket;
+	CefT_List_Hash_Cell* cp;
+	CefT_List_Hash_Cell* wcp;
+	uint32_t end;
+
+	end = ht->mig_pos + CefC_Hash_Resize_Step;
+	if (end > ht->old_max) {
+		end = ht->old_max;
+	}
+	for ( ; ht->mig_pos < end ; ht->mig_pos++) {
+		cp = ht->old_tbl[ht->mig_pos];
+		while (cp != NULL) {
+			wcp = cp->next;
+			bucket = &ht->tbl[cp->hash % ht->elem_max];
+			cp->next = *bucket;
+			*bucket = cp;
+			cp = wcp;
+		}
+		ht->old_tbl[ht->mig_pos] = NULL;
+	}
+
+	if (ht->mig_pos >= ht->old_max) {
+		cef_hash_bulk_free (ht->old_tbl, (size_t) ht->old_max * sizeof (CefT_List_Hash_Cell*));
+		ht->old_tbl = NULL;
+		ht->old_max = 0;
+		ht->mig_pos = 0;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Allocates the chunk of the key from the arena
+----------------------------------------------------------------------------------------*/
+static unsigned char*
+cef_hash_arena_alloc (
+	CefT_Hash_Arena* arena,
+	uint32_t klen
+) {
+	uint32_t cls = cef_hash_arena_class (klen);
+	uint32_t size = cls * CefC_Hash_Arena_Unit;
+	unsigned char* chunk;
+	unsigned char* block;
+
+	/* Reuses the chunk which was freed in the same class 	*/
+	chunk = arena->free_chunk[cls];
+	if (chunk) {
+		memcpy (&arena->free_chunk[cls], chunk, sizeof (unsigned char*));
+		return (chunk);
+	}
+
+	if (arena->rest < size) {
+		block = (unsigned char*) malloc (CefC_Hash_Arena_Block_Size);
+		if (block == NULL) {
+			return (NULL);
+		}
+		memcpy (block, &arena->block, sizeof (unsigned char*));
+		arena->block = block;
+		arena->cur   = block + CefC_Hash_Arena_Block_Head;
+		arena->rest  = CefC_Hash_Arena_Block_Size - CefC_Hash_Arena_Block_Head;
+	}
+	chunk = arena->cur;
+	arena->cur  += size;
+	arena->rest -= size;
+
+	return (chunk);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the chunk of the key to the arena
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_arena_free (
+	CefT_Hash_Arena* arena,
+	unsigned char* chunk,
+	uint32_t klen
+) {
+	uint32_t cls = cef_hash_arena_class (klen);
+
+	if (chunk == NULL) {
+		return;
+	}
+	memcpy (chunk, &arena->free_chunk[cls], sizeof (unsigned char*));
+	arena->free_chunk[cls] = chunk;
+}
+/*--------------------------------------------------------------------------------------
+	Frees all the blocks of the arena
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_arena_destroy (
+	CefT_Hash_Arena* arena
+) {
+	unsigned char* block = arena->block;
+	unsigned char* next;
+
+	while (block) {
+		memcpy (&next, block, sizeof (unsigned char*));
+		free (block);
+		block = next;
+	}
+	memset (arena, 0, sizeof (CefT_Hash_Arena));
+}
+/*--------------------------------------------------------------------------------------
+	Allocates the zero-filled array of the slots or the buckets. A large array is
+	mapped directly, so that resizing does not wait for the heap which is
+	fragmented by the entries, and the untouched pages cost nothing.
+----------------------------------------------------------------------------------------*/
+static void*
+cef_hash_bulk_alloc (
+	size_t size
+) {
+	void* ptr;
+
+	if (size < CefC_Hash_Bulk_Min) {
+		/* The control bytes are loaded by the aligned access 	*/
+		if (posix_memalign (&ptr, CefC_Hash_Group_Width, size) != 0) {
+			return (NULL);
+		}
+		memset (ptr, 0, size);
+		return (ptr);
+	}
+	ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED) {
+		return (NULL);
+	}
+	return (ptr);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the array allocated by cef_hash_bulk_alloc
+----------------------------------------------------------------------------------------*/
+static void
+cef_hash_bulk_free (
+	void* ptr,
+	size_t size
+) {
+	if (ptr == NULL) {
+		return;
+	}
+	if (size < CefC_Hash_Bulk_Min) {
+		free (ptr);
+	} else {
+		munmap (ptr, size);
+	}
+}
@@ -51,7 +51,6 @@
 #include <pthread.h>
 #include <semaphore.h>
 
-#include <openssl/md5.h>
 
 #include <cefore/cef_client.h>
 #include <cefore/cef_csmgr.h>
@@ -754,7 +753,7 @@ cef_mem_cache_fifo_init (
 	cache_entry_tail = (FifoT_Entry*)NULL;
 
     /* Creates lookup table */
-    lookup_table = cef_lhash_tbl_create_u32_ext(capacity, CefC_Hash_Coef_Cache);
+    lookup_table = cef_lhash_tbl_create_resizable(capacity, CefC_Hash_Coef_Cache);
 	if(lookup_table == (CefT_Hash_Handle)NULL){
 		return (-1);
 	}
@@ -1513,13 +1512,7 @@ cef_mem_hash_number_create (
 	const unsigned char* key,
 	uint32_t klen
 ) {
-	uint32_t hash;
-	unsigned char out[MD5_DIGEST_LENGTH];
-
-	MD5 (key, klen, out);
-	memcpy (&hash, &out[12], sizeof (uint32_t));
-
-	return (hash);
+	return (cef_hash_key_hashv_create (key, klen));
 }
 /*--------------------------------------------------------------------------------------
 	Create hash key
@@ -36,6 +36,7 @@
  Include Files
  ****************************************************************************************/
 #include <cefore/cef_mpool.h>
+#include <cefore/cef_log.h>
 #include <errno.h>
 #include <pthread.h>
 
@@ -47,36 +48,101 @@
 #define CefC_Mp_Block_UnitBytes		16
 #define CefC_Mp_Max_Elem_Size		819200
 
+#define CefC_Mp_Mag_Size			32		/* blocks moved between a thread cache and 	*/
+											/* the depot at one time 					*/
+#define CefC_Mp_Cache_Max			(CefC_Mp_Mag_Size * 2)
+#define CefC_Mp_Mag_Chunk			64		/* magazines allocated at one time 			*/
+#define CefC_Mp_Mag_Chunk_Max		8192
+#define CefC_Mp_Cache_Line			64
+
+#define CefC_Mp_Block_Free			0x46524545
+#define CefC_Mp_Block_Used			0x55534544
+
+#define cef_mpool_stack_index(top)	((uint32_t)((top) & 0xFFFFFFFF))
+#define cef_mpool_stack_tag(top)	((uint32_t)((top) >> 32))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/*
+ * Header placed before each memory block, which finds the owner pool in O(1).
+ */
+typedef union CefT_Mp_Block_Hdr {
+	struct {
+		struct CefT_Mp_Mng*	mng;			/* memory pool which owns this block 		*/
+		uint32_t 			state;			/* CefC_Mp_Block_Free/Used 					*/
+	} h;
+	unsigned char 			pad[CefC_Mp_Block_UnitBytes];
+} CefT_Mp_Block_Hdr;
+
+/*
+ * Segment of the memory blocks allocated at one time.
+ */
 typedef struct CefT_Mp_Pool {
-	unsigned char* 			head;
-	unsigned char* 			tail;
 	unsigned char* 			blocks;
+	struct CefT_Mp_Pool* 	next;
 } CefT_Mp_Pool;
 
+/*
+ * Magazine which carries the free blocks between the depot and the thread caches.
+ */
+typedef struct CefT_Mp_Mag {
+	void* 					blocks[CefC_Mp_Mag_Size];
+	uint32_t 				num;			/* number of the blocks in this magazine 	*/
+	uint32_t 				next;			/* index + 1 of the next magazine in stack 	*/
+} CefT_Mp_Mag;
+
+/*
+ * Free blocks cached by a thread.
+ */
+typedef struct CefT_Mp_Tls {
+	struct CefT_Mp_Mng* 	mng;
+	void* 					cache[CefC_Mp_Cache_Max];
+	int 					num;
+	uint64_t 				alloc_num;		/* written by the owner thread only 		*/
+	uint64_t 				free_num;
+	struct CefT_Mp_Tls* 	next;
+} CefT_Mp_Tls;
+
 /*
  * The information to manage a memory pool.
  */
 typedef struct CefT_Mp_Mng {
-	char* 					key;
+	/*----- Global depot, updated by CAS -----*/
+	uint64_t 				full_top		/* stack of the magazines which have blocks	*/
+		__attribute__ ((aligned (CefC_Mp_Cache_Line)));
+	uint64_t 				depot_num;		/* number of the blocks in the depot 		*/
+	uint64_t 				empty_top		/* stack of the empty magazines 			*/
+		__attribute__ ((aligned (CefC_Mp_Cache_Line)));
+
+	/*----- Rarely updated -----*/
+	char* 					key
+		__attribute__ ((aligned (CefC_Mp_Cache_Line)));
 	size_t					klen;
 
 	size_t					size;			/* size of one memory block 				*/
+	size_t 					stride;			/* size of one block with its header 		*/
 	int						increment;		/* number of blocks to allocate at one time	*/
+	int 					id;				/* index in the registry, -1 if not listed 	*/
+	uint32_t 				gen;			/* generation of the registry slot 			*/
 
 	CefT_Mp_Pool*			pool;			/* memory pool 		 						*/
-	size_t 					pool_num;
+	uint64_t 				total;			/* number of the pooled blocks 				*/
+	uint64_t 				high_water;
+
+	CefT_Mp_Mag* 			mag_chunk[CefC_Mp_Mag_Chunk_Max];
+	uint32_t 				mag_num;
+	void* 					spill;			/* free blocks which no magazine could 		*/
+											/* carry, linked through the block body 	*/
 
-	unsigned char**			free;
-	size_t 					head;
-	size_t 					tail;
-	size_t 					block_num;		/* number of allocated memory blocked 		*/
-	size_t 					mask;
-	
-	pthread_mutex_t 		mp_mutex_pt;	/* mutex for thread safe for Pthread 		*/
+	CefT_Mp_Tls* 			tls_list;		/* caches of the threads which use the pool */
+	uint64_t 				retired_alloc;	/* counters of the exited threads 			*/
+	uint64_t 				retired_free;
+	CefT_Mp_Tls 			shared;			/* cache used when the registry is full 	*/
+	pthread_mutex_t 		shared_mutex;
+
+	pthread_mutex_t 		mp_mutex_pt;	/* mutex for growth, caches and statistics	*/
 
 } CefT_Mp_Mng;
 
@@ -84,6 +150,16 @@ typedef struct CefT_Mp_Mng {
  State Variables
  ****************************************************************************************/
 
+/* Memory pools in this process 	*/
+static CefT_Mp_Mng* mp_registry[CefC_Mp_Pool_Max];
+static uint32_t mp_registry_gen = 0;
+static pthread_mutex_t mp_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Thread caches of each memory pool, valid while the generation matches 	*/
+static __thread CefT_Mp_Tls* mp_tls[CefC_Mp_Pool_Max];
+static __thread uint32_t mp_tls_gen[CefC_Mp_Pool_Max];
+static pthread_key_t mp_tls_key;
+static pthread_once_t mp_tls_once = PTHREAD_ONCE_INIT;
 
 /****************************************************************************************
  Static Function Declaration
@@ -105,6 +181,71 @@ cef_mpool_handle_destroy (
 	CefT_Mp_Mng* mpmng
 );
 
+static CefT_Mp_Mag*
+cef_mpool_mag_get (
+	CefT_Mp_Mng* mpmng,
+	uint32_t idx
+);
+
+static uint32_t
+cef_mpool_mag_new (
+	CefT_Mp_Mng* mpmng
+);
+
+static uint32_t
+cef_mpool_stack_pop (
+	CefT_Mp_Mng* mpmng,
+	uint64_t* top
+);
+
+static void
+cef_mpool_stack_push (
+	CefT_Mp_Mng* mpmng,
+	uint64_t* top,
+	uint32_t idx
+);
+
+static int
+cef_mpool_depot_get (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls
+);
+
+static int
+cef_mpool_depot_put (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls,
+	int num
+);
+
+static CefT_Mp_Tls*
+cef_mpool_tls_get (
+	CefT_Mp_Mng* mpmng
+);
+
+static void
+cef_mpool_tls_key_create (
+	void
+);
+
+static void
+cef_mpool_tls_destructor (
+	void* arg
+);
+
+static void*
+cef_mpool_cache_alloc (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls
+);
+
+static void
+cef_mpool_cache_free (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls,
+	void* ptr
+);
+
 /****************************************************************************************
  ****************************************************************************************/
 
@@ -139,80 +280,65 @@ cef_mpool_init (
 	return ((CefT_Mp_Handle) mpmng);
 }
 
+/*
+ * Takes a block from the cache of the calling thread. The cache is refilled
+ * with one magazine from the depot when it is empty.
+ */
 void*
 cef_mpool_alloc (
 	CefT_Mp_Handle mph
 ) {
 	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
-	size_t index;
-	int res;
+	CefT_Mp_Tls* tls;
+	void* ptr;
 
-	while (1) {
-		res = pthread_mutex_trylock (&mpmng->mp_mutex_pt);
-		
-		if (res != 0) {
-			if (res == EBUSY) {
-				continue;
-			}
-			return (NULL);
-		}
-		break;
-	}
-
-	
-	if (mpmng->tail != mpmng->head) {
-		index = mpmng->head;
-		mpmng->head = (mpmng->head + 1) & mpmng->mask;
-		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
-		return ((void*) mpmng->free[index]);
+	if (mpmng == NULL) {
+		return (NULL);
 	}
+	tls = cef_mpool_tls_get (mpmng);
 
-	res = cef_mpool_handle_update (mpmng);
-
-	if (res > 0) {
-		index = mpmng->head;
-		mpmng->head = (mpmng->head + 1) & mpmng->mask;
-		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
-		return ((void*) mpmng->free[index]);
+	if (tls != &mpmng->shared) {
+		return (cef_mpool_cache_alloc (mpmng, tls));
 	}
 
-	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+	pthread_mutex_lock (&mpmng->shared_mutex);
+	ptr = cef_mpool_cache_alloc (mpmng, tls);
+	pthread_mutex_unlock (&mpmng->shared_mutex);
 
-	return ((void*) NULL);
+	return (ptr);
 }
 
+/*
+ * Returns a block to the cache of the calling thread. The owner is checked
+ * from the block header, and the pointers which do not belong to this pool
+ * or are already free are ignored.
+ */
 void
 cef_mpool_free (
 	CefT_Mp_Handle mph,
 	void* ptr
 ) {
 	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
-	int i = 0;
-	int res;
+	CefT_Mp_Block_Hdr* hdr;
+	CefT_Mp_Tls* tls;
 
-	while (1) {
-		res = pthread_mutex_trylock (&mpmng->mp_mutex_pt);
-		
-		if (res != 0) {
-			if (EBUSY == res) {
-				continue;
-			}
-			return;
-		}
-		break;
-	}
-	
-	while (i < mpmng->pool_num) {
-		if (((unsigned char*) ptr > mpmng->pool[i].head) &&
-			((unsigned char*) ptr < mpmng->pool[i].tail)) {
-			mpmng->tail = (mpmng->tail + 1) & mpmng->mask;
-			mpmng->free[mpmng->tail] = ptr;
-			break;
-		}
-		i++;
+	if ((mpmng == NULL) || (ptr == NULL)) {
+		return;
 	}
+	hdr = (CefT_Mp_Block_Hdr*)((unsigned char*) ptr - sizeof (CefT_Mp_Block_Hdr));
+	if ((hdr->h.mng != mpmng) || (hdr->h.state != CefC_Mp_Block_Used)) {
+		return;
+	}
+	tls = cef_mpool_tls_get (mpmng);
 
-	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+	if (tls != &mpmng->shared) {
+		cef_mpool_cache_free (mpmng, tls, ptr);
+		return;
+	}
+
+	pthread_mutex_lock (&mpmng->shared_mutex);
+	cef_mpool_cache_free (mpmng, tls, ptr);
+	pthread_mutex_unlock (&mpmng->shared_mutex);
 
 	return;
 }
@@ -224,14 +350,399 @@ cef_mpool_destroy (
 	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
 
 	if (mpmng) {
+		pthread_mutex_lock (&mp_registry_mutex);
+		if ((mpmng->id >= 0) && (mp_registry[mpmng->id] == mpmng)) {
+			mp_registry[mpmng->id] = NULL;
+		}
+		pthread_mutex_unlock (&mp_registry_mutex);
+
+		pthread_mutex_destroy (&mpmng->shared_mutex);
 		pthread_mutex_destroy (&mpmng->mp_mutex_pt);
 		cef_mpool_handle_destroy (mpmng);
 	}
 }
 
+/*
+ * Obtains the statistics of the memory pools in this process.
+ */
+int 										/* number of the pools set to stats 		*/
+cef_mpool_stat_get (
+	CefT_Mp_Stat stats[],
+	int max
+) {
+	CefT_Mp_Mng* mpmng;
+	CefT_Mp_Tls* tls;
+	uint64_t alloc_num;
+	uint64_t free_num;
+	int num = 0;
+	int i;
+
+	pthread_mutex_lock (&mp_registry_mutex);
+
+	for (i = 0 ; (i < CefC_Mp_Pool_Max) && (num < max) ; i++) {
+		mpmng = mp_registry[i];
+		if (mpmng == NULL) {
+			continue;
+		}
+		pthread_mutex_lock (&mpmng->mp_mutex_pt);
+
+		alloc_num = mpmng->retired_alloc + mpmng->shared.alloc_num;
+		free_num  = mpmng->retired_free + mpmng->shared.free_num;
+		for (tls = mpmng->tls_list ; tls ; tls = tls->next) {
+			alloc_num += tls->alloc_num;
+			free_num  += tls->free_num;
+		}
+
+		memset (&stats[num], 0, sizeof (CefT_Mp_Stat));
+		strncpy (stats[num].key, mpmng->key, sizeof (stats[num].key) - 1);
+		stats[num].size 	= mpmng->size;
+		stats[num].total 	= __atomic_load_n (&mpmng->total, __ATOMIC_RELAXED);
+		stats[num].in_use 	= (alloc_num > free_num) ? alloc_num - free_num : 0;
+		stats[num].high_water
+			= __atomic_load_n (&mpmng->high_water, __ATOMIC_RELAXED);
+		if (stats[num].high_water < stats[num].in_use) {
+			stats[num].high_water = stats[num].in_use;
+		}
+		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+		num++;
+	}
+
+	pthread_mutex_unlock (&mp_registry_mutex);
+
+	return (num);
+}
+
 /*=======================================================================================
  =======================================================================================*/
 
+static void*
+cef_mpool_cache_alloc (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls
+) {
+	void* ptr;
+
+	if (tls->num == 0) {
+		if (cef_mpool_depot_get (mpmng, tls) < 0) {
+			return (NULL);
+		}
+	}
+	ptr = tls->cache[--tls->num];
+	((CefT_Mp_Block_Hdr*)((unsigned char*) ptr
+		- sizeof (CefT_Mp_Block_Hdr)))->h.state = CefC_Mp_Block_Used;
+	tls->alloc_num++;
+
+	return (ptr);
+}
+
+static void
+cef_mpool_cache_free (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls,
+	void* ptr
+) {
+	((CefT_Mp_Block_Hdr*)((unsigned char*) ptr
+		- sizeof (CefT_Mp_Block_Hdr)))->h.state = CefC_Mp_Block_Free;
+	tls->free_num++;
+
+	if (tls->num == CefC_Mp_Cache_Max) {
+		/* keeps the other half to avoid moving magazines back and forth 	*/
+		if (cef_mpool_depot_put (mpmng, tls, CefC_Mp_Mag_Size) < 0) {
+			/* the block is kept on the spill list until depot_get takes it 	*/
+			cef_log_write (CefC_Log_Warn,
+				"%s (%s) no more magazine, spills the block\n", __func__, mpmng->key);
+			pthread_mutex_lock (&mpmng->mp_mutex_pt);
+			memcpy (ptr, &mpmng->spill, sizeof (void*));
+			mpmng->spill = ptr;
+			pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+			return;
+		}
+	}
+	tls->cache[tls->num++] = ptr;
+}
+
+/*
+ * Moves one magazine of blocks from the depot to the thread cache. If the depot
+ * is empty, the spilled blocks are taken first, and then a new segment is allocated.
+ */
+static int
+cef_mpool_depot_get (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls
+) {
+	CefT_Mp_Mag* mag;
+	uint32_t idx;
+	uint64_t out;
+	uint64_t hw;
+
+	idx = cef_mpool_stack_pop (mpmng, &mpmng->full_top);
+
+	if (idx == 0) {
+		pthread_mutex_lock (&mpmng->mp_mutex_pt);
+		idx = cef_mpool_stack_pop (mpmng, &mpmng->full_top);
+		if ((idx == 0) && (mpmng->spill != NULL)) {
+			while ((mpmng->spill != NULL) && (tls->num < CefC_Mp_Mag_Size)) {
+				tls->cache[tls->num++] = mpmng->spill;
+				memcpy (&mpmng->spill, mpmng->spill, sizeof (void*));
+			}
+			pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+			return (1);
+		}
+		if ((idx == 0) && (cef_mpool_handle_update (mpmng) > 0)) {
+			idx = cef_mpool_stack_pop (mpmng, &mpmng->full_top);
+		}
+		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+
+		if (idx == 0) {
+			return (-1);
+		}
+	}
+	mag = cef_mpool_mag_get (mpmng, idx);
+	memcpy (&tls->cache[tls->num], mag->blocks, sizeof (void*) * mag->num);
+	tls->num += mag->num;
+
+	out = __atomic_load_n (&mpmng->total, __ATOMIC_RELAXED)
+			- __atomic_sub_fetch (&mpmng->depot_num, mag->num, __ATOMIC_RELAXED);
+	mag->num = 0;
+	cef_mpool_stack_push (mpmng, &mpmng->empty_top, idx);
+
+	/* records the number of the blocks which are out of the depot 	*/
+	hw = __atomic_load_n (&mpmng->high_water, __ATOMIC_RELAXED);
+	while ((out > hw) &&
+		   (!__atomic_compare_exchange_n (&mpmng->high_water, &hw, out,
+				1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))) {
+		/* retry */;
+	}
+
+	return (1);
+}
+
+/*
+ * Moves the specified number of blocks from the thread cache to the depot.
+ */
+static int
+cef_mpool_depot_put (
+	CefT_Mp_Mng* mpmng,
+	CefT_Mp_Tls* tls,
+	int num
+) {
+	CefT_Mp_Mag* mag;
+	uint32_t idx;
+
+	idx = cef_mpool_stack_pop (mpmng, &mpmng->empty_top);
+
+	if (idx == 0) {
+		pthread_mutex_lock (&mpmng->mp_mutex_pt);
+		idx = cef_mpool_mag_new (mpmng);
+		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+
+		if (idx == 0) {
+			return (-1);
+		}
+	}
+	mag = cef_mpool_mag_get (mpmng, idx);
+
+	tls->num -= num;
+	memcpy (mag->blocks, &tls->cache[tls->num], sizeof (void*) * num);
+	mag->num = (uint32_t) num;
+
+	__atomic_add_fetch (&mpmng->depot_num, num, __ATOMIC_RELAXED);
+	cef_mpool_stack_push (mpmng, &mpmng->full_top, idx);
+
+	return (1);
+}
+
+/*
+ * Pops a magazine from the lock-free stack. The tag in the upper 32 bits is
+ * incremented by each update to avoid the ABA problem. The magazines are never
+ * freed while the pool exists, so reading next of a stale top is safe.
+ */
+static uint32_t 							/* index + 1 of the magazine, 0 if empty 	*/
+cef_mpool_stack_pop (
+	CefT_Mp_Mng* mpmng,
+	uint64_t* top
+) {
+	uint64_t old_top;
+	uint64_t new_top;
+	uint32_t idx;
+	uint32_t next;
+
+	old_top = __atomic_load_n (top, __ATOMIC_ACQUIRE);
+
+	while (1) {
+		idx = cef_mpool_stack_index (old_top);
+		if (idx == 0) {
+			return (0);
+		}
+		next = __atomic_load_n (
+				&cef_mpool_mag_get (mpmng, idx)->next, __ATOMIC_RELAXED);
+		new_top = ((uint64_t)(cef_mpool_stack_tag (old_top) + 1) << 32) | next;
+
+		if (__atomic_compare_exchange_n (top, &old_top, new_top,
+				1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+			return (idx);
+		}
+	}
+}
+
+static void
+cef_mpool_stack_push (
+	CefT_Mp_Mng* mpmng,
+	uint64_t* top,
+	uint32_t idx
+) {
+	CefT_Mp_Mag* mag = cef_mpool_mag_get (mpmng, idx);
+	uint64_t old_top;
+	uint64_t new_top;
+
+	old_top = __atomic_load_n (top, __ATOMIC_RELAXED);
+
+	do {
+		__atomic_store_n (&mag->next,
+				cef_mpool_stack_index (old_top), __ATOMIC_RELAXED);
+		new_top = ((uint64_t)(cef_mpool_stack_tag (old_top) + 1) << 32) | idx;
+	} while (!__atomic_compare_exchange_n (top, &old_top, new_top,
+				1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static CefT_Mp_Mag*
+cef_mpool_mag_get (
+	CefT_Mp_Mng* mpmng,
+	uint32_t idx
+) {
+	idx--;
+	return (&mpmng->mag_chunk[idx / CefC_Mp_Mag_Chunk][idx % CefC_Mp_Mag_Chunk]);
+}
+
+/*
+ * Allocates a new empty magazine. The caller holds mp_mutex_pt.
+ */
+static uint32_t 							/* index + 1 of the magazine, 0 if fails 	*/
+cef_mpool_mag_new (
+	CefT_Mp_Mng* mpmng
+) {
+	uint32_t chunk = mpmng->mag_num / CefC_Mp_Mag_Chunk;
+	CefT_Mp_Mag* mags;
+
+	if ((mpmng->mag_num % CefC_Mp_Mag_Chunk) == 0) {
+		if (chunk >= CefC_Mp_Mag_Chunk_Max) {
+			return (0);
+		}
+		mags = (CefT_Mp_Mag*) calloc (CefC_Mp_Mag_Chunk, sizeof (CefT_Mp_Mag));
+		if (mags == NULL) {
+			return (0);
+		}
+		__atomic_store_n (&mpmng->mag_chunk[chunk], mags, __ATOMIC_RELEASE);
+	}
+	mpmng->mag_num++;
+
+	return (mpmng->mag_num);
+}
+
+/*
+ * Obtains the cache of the calling thread, which is created at the first use.
+ */
+static CefT_Mp_Tls*
+cef_mpool_tls_get (
+	CefT_Mp_Mng* mpmng
+) {
+	CefT_Mp_Tls* tls;
+
+	if (mpmng->id < 0) {
+		return (&mpmng->shared);
+	}
+	if (mp_tls_gen[mpmng->id] == mpmng->gen) {
+		return (mp_tls[mpmng->id]);
+	}
+
+	pthread_once (&mp_tls_once, cef_mpool_tls_key_create);
+
+	tls = (CefT_Mp_Tls*) calloc (1, sizeof (CefT_Mp_Tls));
+	if (tls == NULL) {
+		return (&mpmng->shared);
+	}
+	tls->mng = mpmng;
+
+	pthread_mutex_lock (&mpmng->mp_mutex_pt);
+	tls->next = mpmng->tls_list;
+	mpmng->tls_list = tls;
+	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+
+	mp_tls[mpmng->id] 	  = tls;
+	mp_tls_gen[mpmng->id] = mpmng->gen;
+
+	/* the destructor returns the cached blocks when this thread exits 	*/
+	pthread_setspecific (mp_tls_key, (void*) mp_tls);
+
+	return (tls);
+}
+
+static void
+cef_mpool_tls_key_create (
+	void
+) {
+	pthread_key_create (&mp_tls_key, cef_mpool_tls_destructor);
+}
+
+/*
+ * Returns the blocks cached by the exiting thread to the depot.
+ */
+static void
+cef_mpool_tls_destructor (
+	void* arg
+) {
+	CefT_Mp_Mng* mpmng;
+	CefT_Mp_Tls* tls;
+	CefT_Mp_Tls** pp;
+	uint32_t gen;
+	int i;
+
+	pthread_mutex_lock (&mp_registry_mutex);
+
+	for (i = 0 ; i < CefC_Mp_Pool_Max ; i++) {
+		if (mp_tls_gen[i] == 0) {
+			continue;
+		}
+		mpmng = mp_registry[i];
+		tls = mp_tls[i];
+		gen = mp_tls_gen[i];
+		mp_tls_gen[i] = 0;
+		mp_tls[i] = NULL;
+
+		/* the cache was freed with the pool if the pool was destroyed 	*/
+		if ((mpmng == NULL) || (mpmng->gen != gen)) {
+			continue;
+		}
+		while (tls->num > 0) {
+			if (cef_mpool_depot_put (mpmng, tls,
+					(tls->num < CefC_Mp_Mag_Size) ? tls->num : CefC_Mp_Mag_Size) < 0) {
+				break;
+			}
+		}
+
+		pthread_mutex_lock (&mpmng->mp_mutex_pt);
+		/* the blocks which no magazine could carry are spilled 	*/
+		while (tls->num > 0) {
+			tls->num--;
+			memcpy (tls->cache[tls->num], &mpmng->spill, sizeof (void*));
+			mpmng->spill = tls->cache[tls->num];
+		}
+		for (pp = &mpmng->tls_list ; *pp ; pp = &(*pp)->next) {
+			if (*pp == tls) {
+				*pp = tls->next;
+				break;
+			}
+		}
+		mpmng->retired_alloc += tls->alloc_num;
+		mpmng->retired_free  += tls->free_num;
+		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+
+		free (tls);
+	}
+
+	pthread_mutex_unlock (&mp_registry_mutex);
+}
+
 static CefT_Mp_Mng* 						/* The information to manage a memory pool 	*/
 											/* corresponding to the input key.			*/
 cef_mpool_handle_create (
@@ -241,10 +752,8 @@ cef_mpool_handle_create (
 											/* one time.								*/
 ) {
 	CefT_Mp_Mng* mpmng;
-	size_t i;
-	unsigned char* bp;
-
 	int p;
+	int i;
 
 	increment--;
 
@@ -254,12 +763,14 @@ cef_mpool_handle_create (
 	increment = p + 1;
 
 	/* allocation the memory for the new memory pool 	*/
-	mpmng = (CefT_Mp_Mng*) malloc (sizeof (CefT_Mp_Mng));
-	if (mpmng == NULL) {
+	if (posix_memalign ((void**) &mpmng, CefC_Mp_Cache_Line, sizeof (CefT_Mp_Mng)) != 0) {
 		return (NULL);
 	}
 	memset (mpmng, 0, sizeof (CefT_Mp_Mng));
-
+	mpmng->id = -1;
+	mpmng->shared.mng = mpmng;
+	pthread_mutex_init (&mpmng->mp_mutex_pt, NULL);
+	pthread_mutex_init (&mpmng->shared_mutex, NULL);
 
 	if (key != NULL) {
 		mpmng->klen = (size_t) strlen (key);
@@ -275,6 +786,7 @@ cef_mpool_handle_create (
 	mpmng->size
 		= ((size + CefC_Mp_Block_UnitBytes - 1) / CefC_Mp_Block_UnitBytes)
 			* CefC_Mp_Block_UnitBytes;
+	mpmng->stride = mpmng->size + sizeof (CefT_Mp_Block_Hdr);
 
 	/* record the number of blocks to allocate at one time 		*/
 	mpmng->increment = increment;
@@ -283,137 +795,127 @@ cef_mpool_handle_create (
 	}
 
 	/* allocate the memory pool 	*/
-	mpmng->pool_num = 1;
-	mpmng->pool = (CefT_Mp_Pool*) calloc (mpmng->pool_num, sizeof (CefT_Mp_Pool));
-
-	if (mpmng->pool == NULL) {
-		cef_mpool_handle_destroy (mpmng);
-		return (NULL);
-	}
-	memset (mpmng->pool, 0, sizeof (CefT_Mp_Pool) * mpmng->pool_num);
-
-	mpmng->pool[0].blocks
-		= (unsigned char*) calloc (mpmng->increment, mpmng->size);
-	if (mpmng->pool[0].blocks == NULL) {
+	if (cef_mpool_handle_update (mpmng) < 0) {
 		cef_mpool_handle_destroy (mpmng);
 		return (NULL);
 	}
-	memset (mpmng->pool[0].blocks, 0, mpmng->increment * mpmng->size);
 
-	mpmng->pool[0].head = mpmng->pool[0].blocks - 1;
-	mpmng->pool[0].tail
-		= mpmng->pool[0].blocks + mpmng->increment * (mpmng->size - 1) + 1;
-
-	/* prepare management information 	*/
-	mpmng->block_num = mpmng->increment;
-	mpmng->mask = mpmng->block_num - 1;
-	mpmng->free
-		= (unsigned char**) malloc (sizeof (unsigned char*) * mpmng->block_num);
-	if (mpmng->free == NULL) {
-		cef_mpool_handle_destroy (mpmng);
-		return (NULL);
-	}
-	mpmng->head = 0;
-	mpmng->tail = mpmng->block_num - 1;
-
-	bp = mpmng->pool[0].blocks;
-
-	for (i = 0 ; i < mpmng->block_num ; i++) {
-		mpmng->free[i] = bp;
-		bp += mpmng->size;
+	/* register the pool to be cached by each thread and listed in stats 	*/
+	pthread_mutex_lock (&mp_registry_mutex);
+	for (i = 0 ; i < CefC_Mp_Pool_Max ; i++) {
+		if (mp_registry[i] == NULL) {
+			mp_registry[i] = mpmng;
+			mpmng->id = i;
+			mpmng->gen = ++mp_registry_gen;
+			break;
+		}
 	}
-	pthread_mutex_init (&mpmng->mp_mutex_pt, NULL);
+	pthread_mutex_unlock (&mp_registry_mutex);
 
 	return (mpmng);
 }
 
+/*
+ * Allocates a new segment and pushes its blocks to the depot. The caller holds
+ * mp_mutex_pt except in the creation.
+ */
 static int
 cef_mpool_handle_update (
 	CefT_Mp_Mng* mpmng
 ) {
 	CefT_Mp_Pool* new_pool;
-	unsigned char** new_free;
-	size_t new_block_num;
-	size_t i;
+	CefT_Mp_Block_Hdr* hdr;
+	CefT_Mp_Mag* mag;
 	unsigned char* bp;
+	uint32_t idx;
+	int i;
 
-	/* allocate the memory pool 	*/
-	new_pool = (CefT_Mp_Pool*) calloc (mpmng->pool_num + 1, sizeof (CefT_Mp_Pool));
+	new_pool = (CefT_Mp_Pool*) calloc (1, sizeof (CefT_Mp_Pool));
 	if (new_pool == NULL) {
 		return (-1);
 	}
-	memset (new_pool, 0, sizeof (CefT_Mp_Pool) * (mpmng->pool_num + 1));
-
-	for (i = 0 ; i < mpmng->pool_num ; i++) {
-		new_pool[i].blocks 	= mpmng->pool[i].blocks;
-		new_pool[i].head 	= mpmng->pool[i].head;
-		new_pool[i].tail 	= mpmng->pool[i].tail;
-	}
-	new_pool[i].blocks = (unsigned char*) calloc (mpmng->increment, mpmng->size);
-	if (new_pool[i].blocks == NULL) {
+	new_pool->blocks = (unsigned char*) calloc (mpmng->increment, mpmng->stride);
+	if (new_pool->blocks == NULL) {
 		free (new_pool);
 		return (-1);
 	}
-	memset (new_pool[i].blocks, 0, mpmng->increment * mpmng->size);
-
-	new_pool[i].head = new_pool[i].blocks - 1;
-	new_pool[i].tail = new_pool[i].blocks + mpmng->increment * (mpmng->size - 1) + 1;
-
-
-	free (mpmng->pool);
+	new_pool->next = mpmng->pool;
 	mpmng->pool = new_pool;
-	mpmng->pool_num++;
 
-	/* prepare management information 	*/
-	new_block_num = mpmng->block_num + mpmng->increment;
-	new_free = (unsigned char**) malloc (sizeof (unsigned char*) * new_block_num);
-	if (new_free == NULL) {
-		mpmng->pool_num--;
-		return (-1);
-	}
-
-	bp = mpmng->pool[i].blocks;
-	for (i = mpmng->block_num ; i < new_block_num ; i++) {
-		new_free[i] = bp;
-		bp += mpmng->size;
+	/* increment is a power of two which is not less than the magazine size 	*/
+	bp = new_pool->blocks;
+	idx = 0;
+	mag = NULL;
+
+	for (i = 0 ; i < mpmng->increment ; i++) {
+		if ((i % CefC_Mp_Mag_Size) == 0) {
+			idx = cef_mpool_stack_pop (mpmng, &mpmng->empty_top);
+			if (idx == 0) {
+				idx = cef_mpool_mag_new (mpmng);
+				if (idx == 0) {
+					break;
+				}
+			}
+			mag = cef_mpool_mag_get (mpmng, idx);
+			mag->num = 0;
+		}
+		hdr = (CefT_Mp_Block_Hdr*) bp;
+		hdr->h.mng 	 = mpmng;
+		hdr->h.state = CefC_Mp_Block_Free;
+		mag->blocks[mag->num++] = bp + sizeof (CefT_Mp_Block_Hdr);
+		bp += mpmng->stride;
+
+		if (mag->num == CefC_Mp_Mag_Size) {
+			__atomic_add_fetch (&mpmng->total, mag->num, __ATOMIC_RELAXED);
+			__atomic_add_fetch (&mpmng->depot_num, mag->num, __ATOMIC_RELAXED);
+			cef_mpool_stack_push (mpmng, &mpmng->full_top, idx);
+			idx = 0;
+		}
 	}
-	for (i = 0 ; i < mpmng->block_num ; i++) {
-		new_free[i] = mpmng->free[i];
+	if (idx != 0) {
+		/* no more magazine, pushes the blocks set so far 	*/
+		__atomic_add_fetch (&mpmng->total, mag->num, __ATOMIC_RELAXED);
+		__atomic_add_fetch (&mpmng->depot_num, mag->num, __ATOMIC_RELAXED);
+		cef_mpool_stack_push (mpmng, &mpmng->full_top, idx);
 	}
-	free (mpmng->free);
-	mpmng->free = new_free;
 
-	mpmng->head = mpmng->block_num;
-	mpmng->block_num = new_block_num;
-	mpmng->mask = mpmng->block_num - 1;
-	mpmng->tail = mpmng->block_num - 1;
-
-	return (1);
+	return ((i > 0) ? 1 : -1);
 }
 
 static void
 cef_mpool_handle_destroy (
 	CefT_Mp_Mng* mpmng
 ) {
-	int i;
+	CefT_Mp_Pool* pool;
+	CefT_Mp_Tls* tls;
+	uint32_t i;
 
 	if (mpmng == NULL) {
 		return;
 	}
 
-	if (mpmng->pool) {
-		for (i = 0 ; i < mpmng->pool_num ; i++) {
-			free (mpmng->pool[i].blocks);
+	while (mpmng->pool) {
+		pool = mpmng->pool;
+		mpmng->pool = pool->next;
+		free (pool->blocks);
+		free (pool);
+	}
+
+	for (i = 0 ; i < CefC_Mp_Mag_Chunk_Max ; i++) {
+		if (mpmng->mag_chunk[i] == NULL) {
+			break;
 		}
-		free (mpmng->pool);
+		free (mpmng->mag_chunk[i]);
 	}
 
-	if (mpmng->key) {
-		free (mpmng->key);
+	while (mpmng->tls_list) {
+		tls = mpmng->tls_list;
+		mpmng->tls_list = tls->next;
+		free (tls);
 	}
 
-	if (mpmng->free) {
-		free (mpmng->free);
+	if (mpmng->key) {
+		free (mpmng->key);
 	}
 
 	free (mpmng);
@@ -52,9 +52,7 @@
 #include <cefore/cef_client.h>
 #include <cefore/cef_log.h>
 
-#ifdef	CefC_PitEntryMutex
 #include <pthread.h>
-#endif	// CefC_PitEntryMutex
 
 /****************************************************************************************
  Macros
@@ -68,6 +66,26 @@
  Structures Declaration
  ****************************************************************************************/
 
+/*------------------------------------------------------------------*/
+/* Slab of fixed size objects used by the PIT						*/
+/*------------------------------------------------------------------*/
+typedef struct CefT_Pit_Slab_Obj {
+	struct CefT_Pit_Slab_Obj* next;			/* next free object 						*/
+} CefT_Pit_Slab_Obj;
+
+typedef struct CefT_Pit_Slab_Blk {
+	struct CefT_Pit_Slab_Blk* next;			/* next allocated block 					*/
+} CefT_Pit_Slab_Blk;
+
+typedef struct {
+	size_t				size;				/* size of 1 object 						*/
+	CefT_Pit_Slab_Obj*	free_list;			/* free objects 							*/
+	CefT_Pit_Slab_Blk*	blocks;				/* allocated blocks 						*/
+	uint64_t			used_num;			/* number of objects in use 				*/
+	uint64_t			pooled_num;			/* number of allocated objects 				*/
+	pthread_mutex_t		mutex;
+} CefT_Pit_Slab;
+
 
 /****************************************************************************************
  State Variables
@@ -84,6 +102,34 @@ static uint32_t ccninfo_reply_timeout = CefC_Default_CcninfoReplyTimeout;
 static uint32_t symbolic_max_lifetime;
 static uint32_t regular_max_lifetime;
 
+static CefT_Pit_Slab pit_entry_slab = {
+	sizeof (CefT_Pit_Entry), NULL, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER
+};
+static CefT_Pit_Slab pit_dnface_slab = {
+	sizeof (CefT_Down_Faces), NULL, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER
+};
+static CefT_Pit_Slab pit_upface_slab = {
+	sizeof (CefT_Up_Faces), NULL, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER
+};
+static uint64_t pit_name_spill_num = 0;
+
+/*------------------------------------------------------------------*/
+/* Hierarchical timing wheel which expires the PIT entries			*/
+/*------------------------------------------------------------------*/
+#define CefC_Pit_Tw_Expired_Slot	(CefC_Pit_Tw_Level_Num * CefC_Pit_Tw_Slot_Num)
+#define CefC_Pit_Tw_Max_Delta		\
+	(((uint64_t) 1 << (CefC_Pit_Tw_Bits * CefC_Pit_Tw_Level_Num)) \
+		- ((uint64_t) 1 << (CefC_Pit_Tw_Bits * (CefC_Pit_Tw_Level_Num - 1))) - 1)
+#define CefC_Pit_Tw_Max_Gap			((uint64_t) 1 << 20)
+
+/* Each thread drives the wheel of its own PIT (see cef_pit_timer_init) 	*/
+static __thread struct {
+	CefT_Hash_Handle	pit;				/* PIT driven by the wheel 					*/
+	uint64_t			cur_tick;			/* last processed tick 						*/
+	uint32_t			num;				/* number of the linked entries 			*/
+	CefT_Pit_Entry*		slot[CefC_Pit_Tw_Expired_Slot + 1];
+} pit_tw;
+
 #define	CefC_IR_SUPPORT_NUM			3
 uint8_t	IR_PRIORITY_TBL[CefC_IR_SUPPORT_NUM] = {
 	CefC_IR_HOPLIMIT_EXCEEDED,
@@ -131,6 +177,49 @@ cef_pit_cleanup (
 	CefT_Hash_Handle pit,					/* PIT										*/
 	CefT_Pit_Entry* entry 					/* PIT entry 								*/
 );
+/*--------------------------------------------------------------------------------------
+	Allocates/Frees an object from/to the slab
+----------------------------------------------------------------------------------------*/
+static void*
+cef_pit_slab_alloc (
+	CefT_Pit_Slab* slab						/* slab to allocate from					*/
+);
+static void
+cef_pit_slab_free (
+	CefT_Pit_Slab* slab,					/* slab to return to						*/
+	void* ptr								/* object to free							*/
+);
+/*--------------------------------------------------------------------------------------
+	Allocates a Down/Up Face entry from the inline slots or the slab
+----------------------------------------------------------------------------------------*/
+static CefT_Down_Faces*
+cef_pit_down_face_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+static CefT_Up_Faces*
+cef_pit_up_face_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Frees the Down Face entries in the specified list
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_down_face_list_free (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Down_Faces* dnface					/* head of the list to free					*/
+);
+/*--------------------------------------------------------------------------------------
+	Links/Unlinks the specified PIT entry to/from the timing wheel
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_timer_link (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t expire							/* tick at which the entry expires			*/
+);
+static void
+cef_pit_timer_unlink (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
 /****************************************************************************************
  ****************************************************************************************/
 
@@ -164,6 +253,7 @@ cef_pit_entry_lookup_with_lock (
 ) {
 	CefT_Pit_Entry* entry;
 	int		f_new_entry = 0;
+	uint32_t hashv;
 
 #ifdef	__PIT_DEBUG__
 	fprintf (stderr, "[%s] IN\n",
@@ -171,7 +261,8 @@ cef_pit_entry_lookup_with_lock (
 #endif
 
 	/* Searches a PIT entry 	*/
-	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, name, name_len);
+	hashv = cef_frame_name_hashv_get (pm, name, name_len);
+	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, name, name_len, hashv);
 #ifdef	__PIT_DEBUG__
 	if (entry)
 		fprintf (stderr, "\t entry=%p\n", (void*)entry);
@@ -181,26 +272,36 @@ cef_pit_entry_lookup_with_lock (
 
 	/* allocate a new PIT entry, if it dose not match 	*/
 	if (entry == NULL) {
-		size_t	alloc_size = (((sizeof (CefT_Pit_Entry) + name_len + 15) / 16) * 16);
-
 		if(cef_lhash_tbl_item_num_get(pit) == cef_lhash_tbl_def_max_get(pit)) {
 			cef_log_write (CefC_Log_Warn,
 				"PIT table is full(PIT_SIZE = %d)\n", cef_lhash_tbl_def_max_get(pit));
 			return (NULL);
 		}
 
-		entry = (CefT_Pit_Entry*) malloc (alloc_size);
+		entry = (CefT_Pit_Entry*) cef_pit_slab_alloc (&pit_entry_slab);
 
 #ifdef CefC_Debug_20230404
 cef_dbg_write(CefC_Dbg_Fine, "malloc(CefT_Pit_Entry=%p)\n", entry);
 #endif // CefC_Debug_20230404
 		if ( entry == NULL ){
-			cef_log_write (CefC_Log_Error, "%s(%u) malloc(%ld) failed, %s\n", __func__, __LINE__,
-				alloc_size, strerror(errno));
+			cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_slab_alloc failed, %s\n", __func__, __LINE__,
+				strerror(errno));
 			return (NULL);
 		}
-		memset (entry, 0, alloc_size);
-		entry->key = (unsigned char*)entry + sizeof (CefT_Pit_Entry);
+		/* key_buf is overwritten by the name, so it is not cleared 	*/
+		memset (entry, 0, offsetof (CefT_Pit_Entry, key_buf));
+		if (name_len <= CefC_Pit_Inline_Name_Len) {
+			entry->key = entry->key_buf;
+		} else {
+			entry->key = (unsigned char*) malloc (name_len);
+			if (entry->key == NULL) {
+				cef_log_write (CefC_Log_Error, "%s(%u) malloc(%d) failed, %s\n", __func__, __LINE__,
+					name_len, strerror(errno));
+				cef_pit_slab_free (&pit_entry_slab, entry);
+				return (NULL);
+			}
+			__atomic_fetch_add (&pit_name_spill_num, 1, __ATOMIC_RELAXED);
+		}
 
 #ifdef	CefC_PitEntryMutex
 		pthread_mutex_init (&entry->pe_mutex_pt, NULL);
@@ -216,21 +317,29 @@ cef_dbg_write(CefC_Dbg_Fine, "malloc(CefT_Pit_Entry=%p)\n", entry);
 #ifdef CefC_Debug_20230404
 cef_dbg_write(CefC_Dbg_Fine, "free(CefT_Pit_Entry=%p)\n", entry);
 #endif // CefC_Debug_20230404
-			free(entry);
+			if (entry->key != entry->key_buf) {
+				free (entry->key);
+				__atomic_fetch_sub (&pit_name_spill_num, 1, __ATOMIC_RELAXED);
+			}
+			cef_pit_slab_free (&pit_entry_slab, entry);
 		}
 		return (NULL);
 	}
 
 	/* Creates a new PIT entry, if it dose not match 	*/
 	if (f_new_entry) {
-		int res = cef_lhash_tbl_item_set (pit, name, name_len, entry);
+		int res = cef_lhash_tbl_item_set_with_hashv (pit, name, name_len, hashv, entry);
 		if (res) {
 			cef_log_write (CefC_Log_Warn, "%s(%u) cef_lhash_tbl_item_set=%d\n", __func__, __LINE__, res);
 		}
 
 		entry->klen = name_len;
 		memcpy (entry->key, name, name_len);
-		entry->hashv = cef_lhash_tbl_hashv_get (pit, entry->key, entry->klen);
+		entry->hashv = hashv;
+		if (pit == pit_tw.pit) {
+			entry->tw_enabled = 1;
+			cef_pit_timer_schedule (entry);
+		}
 		entry->clean_us = cef_client_present_timeus_get () + CefC_Pit_CleaningTime;
 		entry->tp_variant = poh->org.tp_variant;
 		entry->nonce = 0;
@@ -353,7 +462,8 @@ cef_pit_entry_search (
 #endif // CefC_Debug
 
 	/* Searches a PIT entry 	*/
-	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, tmp_name, tmp_name_len);
+	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, tmp_name, tmp_name_len,
+						cef_frame_name_hashv_get (pm, tmp_name, tmp_name_len));
 	now = cef_client_present_timeus_get ();
 
 	if (entry != NULL) {
@@ -396,7 +506,8 @@ cef_pit_entry_search (
 	if (pm->chunk_num_f) {
 		uint16_t name_len_wo_chunk;
 		name_len_wo_chunk = tmp_name_len - (CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum);
-		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, tmp_name, name_len_wo_chunk);
+		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, tmp_name, name_len_wo_chunk,
+						cef_frame_name_hashv_get (pm, tmp_name, name_len_wo_chunk));
 
 		if (entry != NULL) {
 			if (entry->longlife_f) {
@@ -510,7 +621,8 @@ cef_pit_entry_search_specified_name (
 	if (pm->chunk_num_f) {
 		uint16_t name_len_wo_chunk;
 		name_len_wo_chunk = name_len - (CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum);
-		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, pm->name, name_len_wo_chunk);
+		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, pm->name, name_len_wo_chunk,
+						cef_frame_name_hashv_get (pm, pm->name, name_len_wo_chunk));
 
 		if (entry != NULL) {
 			if (entry->longlife_f) {
@@ -807,6 +919,7 @@ cef_pit_entry_down_face_update (
 		fprintf (stderr, "\t !(face->lifetime_us > entry->drp_lifetime_us)\n" );
 #endif
 		if (pm->top_level_type == CefC_T_DISCOVERY) {
+			cef_pit_timer_schedule (entry);
 			return (forward_interest_f);
 		}
 
@@ -909,6 +1022,7 @@ cef_pit_entry_down_face_update (
 	fprintf (stderr, "[%s] OUT return(%d) forward (yes=1/no=0)\n",
 			 "cef_pit_entry_down_face_update", forward_interest_f );
 #endif
+	cef_pit_timer_schedule (entry);
 
 	return (forward_interest_f);
 }
@@ -995,7 +1109,10 @@ cef_pit_entry_free (
 	fprintf( stderr, "[%s] IN entry->dnfacenum:%d\n", __func__, entry->dnfacenum );
 #endif
 
-	rm_entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_remove (pit, entry->key, entry->klen);
+	cef_pit_timer_cancel (entry);
+
+	rm_entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_remove_with_hashv (
+											pit, entry->key, entry->klen, entry->hashv);
 	if ( rm_entry != entry ){
 		cef_log_write (CefC_Log_Warn, "%s(%u) cef_lhash_tbl_item_remove() failed, entry=%p, rm_entry=%p.\n",
 			__func__, __LINE__, entry, rm_entry);
@@ -1005,48 +1122,22 @@ cef_pit_entry_free (
 {	CefT_Up_Faces* upface = entry->upfaces.next;
 	while (upface) {
 		CefT_Up_Faces* upface_next = upface->next;
+		if ((upface < &entry->upface_slot[0]) ||
+			(upface >= &entry->upface_slot[CefC_Pit_Inline_UpFace_Num])) {
 #ifdef CefC_Debug_20230404
 cef_dbg_write (CefC_Dbg_Fine, "free(upface=%p)\n", upface);
 #endif // CefC_Debug_20230404
-		free (upface);
+			cef_pit_slab_free (&pit_upface_slab, upface);
+		}
 		upface = upface_next;
 	}
 }
 
 	// =========== free down faces ==============
-{	CefT_Down_Faces* dnface = entry->dnfaces.next;
-	while (dnface) {
-		CefT_Down_Faces* dnface_next = dnface->next;
-		if ( dnface->IR_len > 0 ) {
-#ifdef	__PIT_CLEAN__
-	fprintf( stderr, "\t dnface->IR_len:%d Type:%d\n", dnface->IR_len, dnface->IR_Type );
-#endif
-			free( dnface->IR_msg );
-		}
-#ifdef CefC_Debug_20230404
-cef_dbg_write (CefC_Dbg_Fine, "free(dnface=%p)\n", dnface);
-#endif // CefC_Debug_20230404
-		free (dnface);
-		dnface = dnface_next;
-	}
+	cef_pit_down_face_list_free (entry, entry->dnfaces.next);
 
 	// =========== free cleand down faces ==============
-	dnface = entry->clean_dnfaces.next;
-	while (dnface) {
-		CefT_Down_Faces* dnface_next = dnface->next;
-		if ( dnface->IR_len > 0 ) {
-#ifdef	__PIT_CLEAN__
-	fprintf( stderr, "\t clean dnface->IR_len:%d Type:%d\n", dnface->IR_len, dnface->IR_Type );
-#endif
-			free( dnface->IR_msg );
-		}
-#ifdef CefC_Debug_20230404
-cef_dbg_write (CefC_Dbg_Fine, "free(dnface=%p)\n", dnface);
-#endif // CefC_Debug_20230404
-		free (dnface);
-		dnface = dnface_next;
-	}
-}
+	cef_pit_down_face_list_free (entry, entry->clean_dnfaces.next);
 
 	//0.8.3
 	if ( entry->KIDR_len > 0 ) {
@@ -1059,10 +1150,14 @@ cef_dbg_write (CefC_Dbg_Fine, "free(dnface=%p)\n", dnface);
 	pthread_mutex_destroy (&entry->pe_mutex_pt);
 #endif	// CefC_PitEntryMutex
 
+	if (entry->key != entry->key_buf) {
+		free (entry->key);
+		__atomic_fetch_sub (&pit_name_spill_num, 1, __ATOMIC_RELAXED);
+	}
 #ifdef CefC_Debug_20230404
 cef_dbg_write (CefC_Dbg_Fine, "free(entry=%p)\n", entry);
 #endif // CefC_Debug_20230404
-	free (entry);
+	cef_pit_slab_free (&pit_entry_slab, entry);
 
 	return;
 }
@@ -1111,14 +1206,8 @@ cef_dbg_write (CefC_Dbg_Fine, "dnface=%p, next=%p\n", dnface, dnface->next);
 		return;
 	}
 
-	if (now < entry->clean_us) {
-#ifdef	__PIT_CLEAN__
-	fprintf( stderr, "\t(now < entry->clean_us) RETURN\n" );
-#endif
-		return;
-	}
-	entry->clean_us = now + CefC_Pit_CleaningTime;
-
+	/* The timing wheel calls this function only when a lifetime expired, */
+	/* so the expired Down Faces are removed without waiting clean_us.	*/
 	dnface = &(entry->dnfaces);
 	dnface_prv = dnface;
 
@@ -1189,12 +1278,11 @@ cef_pit_entry_down_face_lookup (
 		}
 	}
 
-	dnface->next = (CefT_Down_Faces*) malloc (sizeof (CefT_Down_Faces));
+	dnface->next = cef_pit_down_face_alloc (entry);
 	if (dnface->next == NULL) {
-		cef_log_write (CefC_Log_Error, "%s(%u) malloc(%ld) failed\n", __func__, __LINE__, sizeof (CefT_Down_Faces));
+		cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_down_face_alloc failed\n", __func__, __LINE__);
 		return (0);
 	}
-	memset (dnface->next, 0, sizeof (CefT_Down_Faces));
 	dnface->next->faceid = faceid;
 	dnface->next->nonce  = nonce;
 	*rt_dnface = dnface->next;
@@ -1202,10 +1290,6 @@ cef_pit_entry_down_face_lookup (
 #ifdef CefC_Debug_20230404
 cef_dbg_write (CefC_Dbg_Fine, "malloc(dnface->next=%p), dnface=%p\n", dnface->next, dnface);
 #endif // CefC_Debug_20230404
-	//0.8.3
-	dnface->next->IR_Type = 0;
-	dnface->next->IR_len  = 0;
-	dnface->next->IR_msg  = NULL;
 
 #ifdef	__INTEREST__
 	fprintf (stderr, "%s New DnFace id:%d\n", __func__, faceid );
@@ -1427,9 +1511,13 @@ cef_pit_entry_up_face_lookup (
 			return (0);
 		}
 	}
-	face->next = (CefT_Up_Faces*) malloc (sizeof (CefT_Up_Faces));
+	face->next = cef_pit_up_face_alloc (entry);
+	if (face->next == NULL) {
+		cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_up_face_alloc failed\n", __func__, __LINE__);
+		*rt_face = NULL;
+		return (0);
+	}
 	face->next->faceid = faceid;
-	face->next->next = NULL;
 
 	*rt_face = face->next;
 
@@ -1523,7 +1611,8 @@ cef_pit_symbolic_pit_check (
 	fprintf (stderr, "%s IN\n", __func__ );
 #endif
 	/* Searches a PIT entry 	*/
-	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, pm->name, pm->name_len);
+	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, pm->name, pm->name_len,
+						cef_frame_name_hashv_get (pm, pm->name, pm->name_len));
 
 	if ( entry == NULL ) {
 #ifdef	__INTEREST__
@@ -1571,7 +1660,8 @@ cef_pit_entry_search_with_chunk (
 #endif // CefC_Debug
 
 	/* Searches a PIT entry 	*/
-	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, pm->name, pm->name_len);
+	entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, pm->name, pm->name_len,
+						cef_frame_name_hashv_get (pm, pm->name, pm->name_len));
 	now = cef_client_present_timeus_get ();
 
 	if (entry != NULL) {
@@ -1646,7 +1736,8 @@ cef_pit_entry_search_without_chunk (
 	if (pm->chunk_num_f) {
 		uint16_t name_len_wo_chunk;
 		name_len_wo_chunk = tmp_name_len - (CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum);
-		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get (pit, pm->name, name_len_wo_chunk);
+		entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_get_with_hashv (pit, pm->name, name_len_wo_chunk,
+						cef_frame_name_hashv_get (pm, pm->name, name_len_wo_chunk));
 
 		if (entry != NULL) {
 			if (entry->longlife_f) {
@@ -1741,6 +1832,402 @@ cef_pit_interest_return_set (
 
 	return(-1);
 }
+/*--------------------------------------------------------------------------------------
+	Initializes the timing wheel which expires the entries of the specified PIT.
+	The wheel belongs to the calling thread, which must be the only user of the PIT.
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_init (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec) 						*/
+) {
+	memset (&pit_tw, 0, sizeof (pit_tw));
+	pit_tw.pit = pit;
+	pit_tw.cur_tick = nowt / CefC_Pit_Tw_Tick_Us;
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Schedules the specified PIT entry at the earliest lifetime of its Down Faces
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_schedule (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	CefT_Down_Faces* dnface;
+	uint64_t deadline;
+	uint64_t expire;
+
+	if (!entry->tw_enabled) {
+		return;
+	}
+
+	/* The entry is removed after drp_lifetime_us, and its Down Faces are 	*/
+	/* cleaned at their own lifetime before that.							*/
+	deadline = entry->drp_lifetime_us;
+	if (deadline == 0) {
+		deadline = cef_client_present_timeus_get () + CefC_Pit_CleaningTime;
+	}
+	dnface = &(entry->dnfaces);
+	while (dnface->next) {
+		dnface = dnface->next;
+		if (dnface->lifetime_us && (dnface->lifetime_us < deadline)) {
+			deadline = dnface->lifetime_us;
+		}
+	}
+
+	expire = deadline / CefC_Pit_Tw_Tick_Us + 1;
+	if (expire <= pit_tw.cur_tick) {
+		expire = pit_tw.cur_tick + 1;
+	}
+	if (entry->tw_slot) {
+		if (entry->tw_expire == expire) {
+			return;
+		}
+		cef_pit_timer_unlink (entry);
+	}
+	cef_pit_timer_link (entry, expire);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Removes the specified PIT entry from the timing wheel
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_timer_cancel (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	if (entry->tw_slot) {
+		cef_pit_timer_unlink (entry);
+	}
+	entry->tw_enabled = 0;
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Advances the timing wheel and returns one of the expired PIT entries
+----------------------------------------------------------------------------------------*/
+CefT_Pit_Entry* 							/* expired entry, or NULL if none remains	*/
+cef_pit_timer_expired_get (
+	uint64_t nowt							/* current time (usec) 						*/
+) {
+	uint64_t now_tick = nowt / CefC_Pit_Tw_Tick_Us;
+	CefT_Pit_Entry* entry;
+	CefT_Pit_Entry* next;
+	uint64_t tick;
+	int level;
+	int idx;
+
+	if (pit_tw.pit == (CefT_Hash_Handle) NULL) {
+		return (NULL);
+	}
+
+	if (now_tick > pit_tw.cur_tick + CefC_Pit_Tw_Max_Gap) {
+		/* The clock jumped. Rebuilds the wheel instead of walking every tick. */
+		pit_tw.cur_tick = now_tick;
+		for (idx = 0 ; idx < CefC_Pit_Tw_Expired_Slot ; idx++) {
+			entry = pit_tw.slot[idx];
+			pit_tw.slot[idx] = NULL;
+			while (entry) {
+				next = entry->tw_next;
+				entry->tw_slot = 0;
+				pit_tw.num--;
+				cef_pit_timer_link (entry, entry->tw_expire);
+				entry = next;
+			}
+		}
+	}
+
+	while (pit_tw.cur_tick < now_tick) {
+		pit_tw.cur_tick++;
+		tick = pit_tw.cur_tick;
+
+		/* Cascades the entries of the upper levels 	*/
+		for (level = 1 ; level < CefC_Pit_Tw_Level_Num ; level++) {
+			if (tick & (((uint64_t) 1 << (CefC_Pit_Tw_Bits * level)) - 1)) {
+				break;
+			}
+			idx = level * CefC_Pit_Tw_Slot_Num
+				+ ((tick >> (CefC_Pit_Tw_Bits * level)) & (CefC_Pit_Tw_Slot_Num - 1));
+			entry = pit_tw.slot[idx];
+			pit_tw.slot[idx] = NULL;
+			while (entry) {
+				next = entry->tw_next;
+				entry->tw_slot = 0;
+				pit_tw.num--;
+				cef_pit_timer_link (entry, entry->tw_expire);
+				entry = next;
+			}
+		}
+
+		/* Moves the entries of this tick to the expired list 	*/
+		idx = (int)(tick & (CefC_Pit_Tw_Slot_Num - 1));
+		entry = pit_tw.slot[idx];
+		pit_tw.slot[idx] = NULL;
+		while (entry) {
+			next = entry->tw_next;
+			entry->tw_slot = 0;
+			pit_tw.num--;
+			cef_pit_timer_link (entry, entry->tw_expire);
+			entry = next;
+		}
+	}
+
+	entry = pit_tw.slot[CefC_Pit_Tw_Expired_Slot];
+	if (entry) {
+		cef_pit_timer_unlink (entry);
+	}
+	return (entry);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the time at which cef_pit_timer_expired_get should be called next
+----------------------------------------------------------------------------------------*/
+uint64_t 									/* time (usec), UINT64_MAX if no entry 		*/
+cef_pit_timer_next_get (
+	uint64_t nowt							/* current time (usec) 						*/
+) {
+	uint64_t tick;
+	uint64_t cascade;
+
+	if ((pit_tw.pit == (CefT_Hash_Handle) NULL) || (pit_tw.num == 0)) {
+		return (UINT64_MAX);
+	}
+	if ((pit_tw.slot[CefC_Pit_Tw_Expired_Slot] != NULL) ||
+		(nowt / CefC_Pit_Tw_Tick_Us > pit_tw.cur_tick + CefC_Pit_Tw_Max_Gap)) {
+		return (nowt);
+	}
+
+	/* A slot of level 0 holds the entries of exactly one tick in the next 	*/
+	/* window, and the upper levels only move down at the cascade tick 		*/
+	cascade = (pit_tw.cur_tick | (CefC_Pit_Tw_Slot_Num - 1)) + 1;
+	for (tick = pit_tw.cur_tick + 1 ; tick < cascade ; tick++) {
+		if (pit_tw.slot[tick & (CefC_Pit_Tw_Slot_Num - 1)] != NULL) {
+			break;
+		}
+	}
+
+	return (tick * CefC_Pit_Tw_Tick_Us);
+}
+/*--------------------------------------------------------------------------------------
+	Links the specified PIT entry to the timing wheel
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_timer_link (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t expire							/* tick at which the entry expires			*/
+) {
+	uint64_t delta;
+	int level;
+	int idx;
+
+	if (expire <= pit_tw.cur_tick) {
+		idx = CefC_Pit_Tw_Expired_Slot;
+	} else {
+		delta = expire - pit_tw.cur_tick;
+		if (delta > CefC_Pit_Tw_Max_Delta) {
+			delta  = CefC_Pit_Tw_Max_Delta;
+			expire = pit_tw.cur_tick + delta;
+		}
+		for (level = 0 ; level < CefC_Pit_Tw_Level_Num - 1 ; level++) {
+			if (delta < ((uint64_t) 1 << (CefC_Pit_Tw_Bits * (level + 1)))) {
+				break;
+			}
+		}
+		idx = level * CefC_Pit_Tw_Slot_Num
+			+ ((expire >> (CefC_Pit_Tw_Bits * level)) & (CefC_Pit_Tw_Slot_Num - 1));
+	}
+
+	entry->tw_expire = expire;
+	entry->tw_slot = (uint16_t)(idx + 1);
+	entry->tw_prev = NULL;
+	entry->tw_next = pit_tw.slot[idx];
+	if (entry->tw_next) {
+		entry->tw_next->tw_prev = entry;
+	}
+	pit_tw.slot[idx] = entry;
+	pit_tw.num++;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Unlinks the specified PIT entry from the timing wheel
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_timer_unlink (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	int idx = entry->tw_slot - 1;
+
+	if (entry->tw_prev) {
+		entry->tw_prev->tw_next = entry->tw_next;
+	} else {
+		pit_tw.slot[idx] = entry->tw_next;
+	}
+	if (entry->tw_next) {
+		entry->tw_next->tw_prev = entry->tw_prev;
+	}
+	entry->tw_next = NULL;
+	entry->tw_prev = NULL;
+	entry->tw_slot = 0;
+	pit_tw.num--;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the PIT slab allocator
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_slab_stat_get (
+	CefT_Pit_Slab_Stat* stat				/* statistics to return						*/
+) {
+	stat->entry_num 		= pit_entry_slab.used_num;
+	stat->entry_pooled 		= pit_entry_slab.pooled_num;
+	stat->dnface_spill_num 	= pit_dnface_slab.used_num;
+	stat->upface_spill_num 	= pit_upface_slab.used_num;
+	stat->name_spill_num 	= __atomic_load_n (&pit_name_spill_num, __ATOMIC_RELAXED);
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates an object from the slab
+----------------------------------------------------------------------------------------*/
+static void*
+cef_pit_slab_alloc (
+	CefT_Pit_Slab* slab						/* slab to allocate from					*/
+) {
+	CefT_Pit_Slab_Obj* obj;
+	CefT_Pit_Slab_Blk* blk;
+	unsigned char* bp;
+	size_t unit;
+	int i;
+
+	pthread_mutex_lock (&slab->mutex);
+
+	if (slab->free_list == NULL) {
+		/* objects are aligned to 16 bytes, and the block header precedes them */
+		unit = ((slab->size + 15) / 16) * 16;
+		blk = (CefT_Pit_Slab_Blk*) malloc (16 + unit * CefC_Pit_Slab_Increment);
+		if (blk == NULL) {
+			pthread_mutex_unlock (&slab->mutex);
+			return (NULL);
+		}
+		blk->next = slab->blocks;
+		slab->blocks = blk;
+
+		bp = (unsigned char*) blk + 16;
+		for (i = CefC_Pit_Slab_Increment - 1 ; i >= 0 ; i--) {
+			obj = (CefT_Pit_Slab_Obj*)(bp + unit * i);
+			obj->next = slab->free_list;
+			slab->free_list = obj;
+		}
+		slab->pooled_num += CefC_Pit_Slab_Increment;
+	}
+	obj = slab->free_list;
+	slab->free_list = obj->next;
+	slab->used_num++;
+
+	pthread_mutex_unlock (&slab->mutex);
+
+	return ((void*) obj);
+}
+/*--------------------------------------------------------------------------------------
+	Frees an object to the slab
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_slab_free (
+	CefT_Pit_Slab* slab,					/* slab to return to						*/
+	void* ptr								/* object to free							*/
+) {
+	CefT_Pit_Slab_Obj* obj = (CefT_Pit_Slab_Obj*) ptr;
+
+	pthread_mutex_lock (&slab->mutex);
+	obj->next = slab->free_list;
+	slab->free_list = obj;
+	slab->used_num--;
+	pthread_mutex_unlock (&slab->mutex);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates a Down Face entry from the inline slots or the slab
+----------------------------------------------------------------------------------------*/
+static CefT_Down_Faces*
+cef_pit_down_face_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	CefT_Down_Faces* dnface;
+
+	/* The slots are not reused until the entry is freed, because the faces	*/
+	/* moved to clean_dnfaces still reference them.							*/
+	if (entry->dnface_slot_num < CefC_Pit_Inline_DnFace_Num) {
+		dnface = &entry->dnface_slot[entry->dnface_slot_num];
+		entry->dnface_slot_num++;
+	} else {
+		dnface = (CefT_Down_Faces*) cef_pit_slab_alloc (&pit_dnface_slab);
+		if (dnface == NULL) {
+			return (NULL);
+		}
+	}
+	memset (dnface, 0, sizeof (CefT_Down_Faces));
+
+	return (dnface);
+}
+/*--------------------------------------------------------------------------------------
+	Allocates an Up Face entry from the inline slots or the slab
+----------------------------------------------------------------------------------------*/
+static CefT_Up_Faces*
+cef_pit_up_face_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	CefT_Up_Faces* upface;
+
+	if (entry->upface_slot_num < CefC_Pit_Inline_UpFace_Num) {
+		upface = &entry->upface_slot[entry->upface_slot_num];
+		entry->upface_slot_num++;
+	} else {
+		upface = (CefT_Up_Faces*) cef_pit_slab_alloc (&pit_upface_slab);
+		if (upface == NULL) {
+			return (NULL);
+		}
+	}
+	memset (upface, 0, sizeof (CefT_Up_Faces));
+
+	return (upface);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the Down Face entries in the specified list
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_down_face_list_free (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Down_Faces* dnface					/* head of the list to free					*/
+) {
+	CefT_Down_Faces* dnface_next;
+	CefT_Pit_Tversion* tver;
+	CefT_Pit_Tversion* tver_next;
+
+	while (dnface) {
+		dnface_next = dnface->next;
+		if ( dnface->IR_len > 0 ) {
+#ifdef	__PIT_CLEAN__
+	fprintf( stderr, "\t dnface->IR_len:%d Type:%d\n", dnface->IR_len, dnface->IR_Type );
+#endif
+			free( dnface->IR_msg );
+		}
+		tver = dnface->tver.tvnext;
+		while (tver) {
+			tver_next = tver->tvnext;
+			free (tver);
+			tver = tver_next;
+		}
+		if ((dnface < &entry->dnface_slot[0]) ||
+			(dnface >= &entry->dnface_slot[CefC_Pit_Inline_DnFace_Num])) {
+#ifdef CefC_Debug_20230404
+cef_dbg_write (CefC_Dbg_Fine, "free(dnface=%p)\n", dnface);
+#endif // CefC_Debug_20230404
+			cef_pit_slab_free (&pit_dnface_slab, dnface);
+		}
+		dnface = dnface_next;
+	}
+	return;
+}
 /*--------------------------------------------------------------------------------------
 	Lock/Unlock the specified PIT entry
 ----------------------------------------------------------------------------------------*/
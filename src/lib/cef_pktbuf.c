@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_pktbuf.c
+ */
+
+#define __CEF_PKTBUF_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <string.h>
+
+#include <cefore/cef_pktbuf.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+/* Message being handled by this thread (the main thread or a forwarding worker) 	*/
+static __thread const unsigned char* cur_msg = NULL;
+static __thread uint16_t cur_len = 0;
+static __thread CefT_Pktbuf* cur_pb = NULL;		/* Copy shared by the holders 			*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the packet buffer which holds the copy of the message
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* Created buffer (the caller holds it) 	*/
+cef_pktbuf_create (
+	const unsigned char* msg,				/* Message 									*/
+	uint16_t len							/* Length of the message 					*/
+) {
+	CefT_Pktbuf* pb;
+
+	pb = (CefT_Pktbuf*) malloc (sizeof (CefT_Pktbuf) + len);
+	if (pb == NULL) {
+		return (NULL);
+	}
+	pb->refcnt = 1;
+	pb->len = len;
+	memcpy (pb->data, msg, len);
+
+	return (pb);
+}
+/*--------------------------------------------------------------------------------------
+	Adds the holder of the packet buffer
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* The specified buffer 					*/
+cef_pktbuf_ref (
+	CefT_Pktbuf* pb							/* Packet buffer 							*/
+) {
+	__atomic_add_fetch (&pb->refcnt, 1, __ATOMIC_RELAXED);
+	return (pb);
+}
+/*--------------------------------------------------------------------------------------
+	Removes the holder of the packet buffer, and frees it if it is the last one
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_unref (
+	CefT_Pktbuf* pb							/* Packet buffer, or NULL 					*/
+) {
+	/* The holders may be in the csmgrd upload thread 		*/
+	if ((pb != NULL) &&
+		(__atomic_sub_fetch (&pb->refcnt, 1, __ATOMIC_ACQ_REL) == 0)) {
+		free (pb);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Sets the message which is being handled by cefnetd
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_cur_set (
+	const unsigned char* msg,				/* Message in the receive buffer 			*/
+	uint16_t len							/* Length of the message 					*/
+) {
+	cef_pktbuf_cur_clear ();
+	cur_msg = msg;
+	cur_len = len;
+}
+/*--------------------------------------------------------------------------------------
+	Releases the message set by cef_pktbuf_cur_set
+----------------------------------------------------------------------------------------*/
+void
+cef_pktbuf_cur_clear (
+	void
+) {
+	cef_pktbuf_unref (cur_pb);
+	cur_pb  = NULL;
+	cur_msg = NULL;
+	cur_len = 0;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the packet buffer to keep the message after the caller returns.
+	All the holders of the message being handled share one copy of it.
+----------------------------------------------------------------------------------------*/
+CefT_Pktbuf* 								/* Packet buffer (the caller holds it), 	*/
+											/* or NULL if it fails 						*/
+cef_pktbuf_cur_ref (
+	const unsigned char* msg,				/* Message 									*/
+	uint16_t len							/* Length of the message 					*/
+) {
+	if ((msg != cur_msg) || (len != cur_len)) {
+		return (cef_pktbuf_create (msg, len));
+	}
+
+	if (cur_pb) {
+		/* The message (e.g. HopLimit, or a TLV rewritten by a plugin) may be 		*/
+		/* changed in the receive buffer after the copy was made, then the copy 	*/
+		/* is not shared any more 													*/
+		if (memcmp (cur_pb->data, msg, len) == 0) {
+			return (cef_pktbuf_ref (cur_pb));
+		}
+		cef_pktbuf_unref (cur_pb);
+	}
+	cur_pb = cef_pktbuf_create (msg, len);
+	if (cur_pb == NULL) {
+		return (NULL);
+	}
+
+	return (cef_pktbuf_ref (cur_pb));
+}
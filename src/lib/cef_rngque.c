@@ -36,14 +36,25 @@
  Include Files
  ****************************************************************************************/
 
+#include <sched.h>
+
 #include <cefore/cef_rngque.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
-#define cef_mpool_mutex_lock		pthread_mutex_lock
-#define cef_mpool_mutex_unlock		pthread_mutex_unlock
+#define cef_rngque_load_acquire(p)		__atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define cef_rngque_load_relaxed(p)		__atomic_load_n ((p), __ATOMIC_RELAXED)
+#define cef_rngque_store_release(p, v)	__atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+
+#define CefC_Rngque_Spin_Max			64		/* Spins before yielding the CPU 			*/
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cef_rngque_cpu_relax()			__builtin_ia32_pause ()
+#else
+#define cef_rngque_cpu_relax()			__atomic_signal_fence (__ATOMIC_SEQ_CST)
+#endif
 
 /****************************************************************************************
  Structures Declaration
@@ -63,11 +74,22 @@
  ****************************************************************************************/
 
 /*--------------------------------------------------------------------------------------
-	Creates Ring Queue
+	Creates Ring Queue which multiple threads can push to
 ----------------------------------------------------------------------------------------*/
 CefT_Rngque* 								/* Created Ring Queue Information 			*/
 cef_rngque_create (
 	int capacity							/* Capacity of Ring queue 					*/
+) {
+	return (cef_rngque_create_with_mode (capacity, CefC_Rngque_Mode_Mpsc));
+}
+
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue with the specified mode
+----------------------------------------------------------------------------------------*/
+CefT_Rngque* 								/* Created Ring Queue Information 			*/
+cef_rngque_create_with_mode (
+	int capacity,							/* Capacity of Ring queue 					*/
+	int mode								/* CefC_Rngque_Mode_XXX 					*/
 ) {
 	int p;
 	CefT_Rngque* qp;
@@ -87,13 +109,19 @@ cef_rngque_create (
 	capacity = p + 1;
 
 	/* Allocates the index queue 			*/
-	qp = (CefT_Rngque*) malloc (sizeof (CefT_Rngque));
+	if (posix_memalign ((void**) &qp, CefC_Rngque_Cache_Line, sizeof (CefT_Rngque)) != 0) {
+		return (NULL);
+	}
 	qp->top = 0;
 	qp->bottom = 0;
-	qp->mask = capacity - 1;
+	qp->reserve = 0;
+	qp->mask = (uint32_t)(capacity - 1);
+	qp->mode = mode;
 	qp->que = (CefT_Rngque_Elem*) malloc (sizeof (CefT_Rngque_Elem) * capacity);
-	
-	pthread_mutex_init (&qp->mutex, NULL);
+	if (qp->que == NULL) {
+		free (qp);
+		return (NULL);
+	}
 
 	return (qp);
 }
@@ -105,49 +133,117 @@ void
 cef_rngque_destroy (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	pthread_mutex_destroy (&qp->mutex);
 	free (qp->que);
 	free (qp);
 }
 
 /*--------------------------------------------------------------------------------------
 	Removes the value (int) from the top of Ring Queue
+	  NOTE: Only one thread may remove the items from a queue
 ----------------------------------------------------------------------------------------*/
 void*										/* item which is removed from queue 		*/
 cef_rngque_pop (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	int value;
-
-	if (qp->bottom != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		value = qp->top;
-		qp->top = (qp->top + 1) & qp->mask;
-		cef_mpool_mutex_unlock (&qp->mutex);
-		return (qp->que[value].body);
+	uint32_t top;
+	void* item;
+
+	top = cef_rngque_load_relaxed (&qp->top);
+
+	/* The acquire pairs with the release of the producer, so the element 	*/
+	/* written before the bottom was published is visible here.				*/
+	if (cef_rngque_load_acquire (&qp->bottom) == top) {
+		return (NULL);
+	}
+	item = qp->que[top & qp->mask].body;
+	cef_rngque_store_release (&qp->top, top + 1);
+
+	return (item);
+}
+
+/*--------------------------------------------------------------------------------------
+	Removes the items from the top of Ring Queue at once
+	  NOTE: Only one thread may remove the items from a queue
+----------------------------------------------------------------------------------------*/
+int											/* number of the removed items 				*/
+cef_rngque_pop_bulk (
+	CefT_Rngque* qp,						/* Ring Queue Information 					*/
+	void* items[],							/* buffer to set the removed items 			*/
+	int max									/* size of items 							*/
+) {
+	uint32_t top;
+	uint32_t num;
+	uint32_t i;
+
+	if (max < 1) {
+		return (0);
+	}
+	top = cef_rngque_load_relaxed (&qp->top);
+	num = cef_rngque_load_acquire (&qp->bottom) - top;
+
+	if (num > (uint32_t) max) {
+		num = (uint32_t) max;
+	}
+	for (i = 0 ; i < num ; i++) {
+		items[i] = qp->que[(top + i) & qp->mask].body;
+	}
+	if (num > 0) {
+		/* Releases all the slots by one store 		*/
+		cef_rngque_store_release (&qp->top, top + num);
 	}
 
-	return (NULL);
+	return ((int) num);
 }
 
 /*--------------------------------------------------------------------------------------
 	Inserts the value (int) to the bottom of Ring Queue
 ----------------------------------------------------------------------------------------*/
-int
+int											/* 1 if pushed, 0 if the queue is full 		*/
 cef_rngque_push (
 	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
 	void* item
 ) {
+	uint32_t pos;
+	int spin = 0;
+
+	if (qp->mode == CefC_Rngque_Mode_Spsc) {
+		pos = cef_rngque_load_relaxed (&qp->bottom);
+
+		if (pos - cef_rngque_load_acquire (&qp->top) > qp->mask) {
+			return (0);
+		}
+		qp->que[pos & qp->mask].body = item;
+		cef_rngque_store_release (&qp->bottom, pos + 1);
 
-	if (((qp->bottom + 1) & qp->mask) != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		qp->que[qp->bottom].body = item;
-		qp->bottom = (qp->bottom + 1) & qp->mask;
-		cef_mpool_mutex_unlock (&qp->mutex);
 		return (1);
 	}
 
-	return (0);
+	/* Reserves a slot. The failed CAS reloads the reserved position. 	*/
+	pos = cef_rngque_load_relaxed (&qp->reserve);
+	do {
+		if (pos - cef_rngque_load_acquire (&qp->top) > qp->mask) {
+			return (0);
+		}
+	} while (!__atomic_compare_exchange_n (&qp->reserve, &pos, pos + 1,
+				1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	qp->que[pos & qp->mask].body = item;
+
+	/* Publishes the slot after the producers which reserved the previous 	*/
+	/* slots, so the consumer never sees a slot which is not written yet.	*/
+	/* The acquire chains their slot writes to the release below.			*/
+	while (cef_rngque_load_acquire (&qp->bottom) != pos) {
+		/* Gives the CPU to the preempted producer if it does not catch up 	*/
+		if (++spin > CefC_Rngque_Spin_Max) {
+			sched_yield ();
+			spin = 0;
+		} else {
+			cef_rngque_cpu_relax ();
+		}
+	}
+	cef_rngque_store_release (&qp->bottom, pos + 1);
+
+	return (1);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -157,14 +253,13 @@ void*										/* item which is removed from queue 		*/
 cef_rngque_read (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	int value;
+	uint32_t top;
+
+	top = cef_rngque_load_relaxed (&qp->top);
 
-	if (qp->bottom != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		value = qp->top;
-		cef_mpool_mutex_unlock (&qp->mutex);
-		return (qp->que[value].body);
+	if (cef_rngque_load_acquire (&qp->bottom) == top) {
+		return (NULL);
 	}
 
-	return (NULL);
+	return (qp->que[top & qp->mask].body);
 }
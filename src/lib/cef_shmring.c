@@ -0,0 +1,602 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_shmring.c
+ */
+
+#define __CEF_SHMRING_SOURECE__
+
+#define _GNU_SOURCE
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif // __linux__
+
+#include <cefore/cef_shmring.h>
+#include <cefore/cef_log.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/* The memfd can not be resized by the app once cefnetd maps it 	*/
+#define CefC_Shmring_Seals			(F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+
+#define cef_shmring_load_acquire(p)		__atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define cef_shmring_load_relaxed(p)		__atomic_load_n ((p), __ATOMIC_RELAXED)
+#define cef_shmring_load_seq(p)			__atomic_load_n ((p), __ATOMIC_SEQ_CST)
+#define cef_shmring_store_seq(p, v)		__atomic_store_n ((p), (v), __ATOMIC_SEQ_CST)
+
+#define CefC_Shmring_Page_Size		4096		/* The rings start at the page boundary */
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Obtains the offset of the rings in the shared memory
+----------------------------------------------------------------------------------------*/
+static size_t
+cef_shmring_data_offset (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Sets the rings of the specified side to the ring pair
+----------------------------------------------------------------------------------------*/
+static CefT_Shmring* 						/* ring pair, or NULL 						*/
+cef_shmring_setup (
+	CefT_Shmring_Hdr* hdr,					/* mapped shared memory 					*/
+	size_t map_len,							/* length of the mapping 					*/
+	uint32_t size,							/* size of each ring (bytes) 				*/
+	int side,								/* CefC_Shmring_Side_XXX 					*/
+	int efd,								/* eventfd which wakes up this side 		*/
+	int peer_efd							/* eventfd which wakes up the peer 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Checks that the FD is an eventfd
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the FD is an eventfd 				*/
+cef_shmring_fd_is_eventfd (
+	int fd									/* FD to check 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Wakes up the side waiting on the specified eventfd
+----------------------------------------------------------------------------------------*/
+static void
+cef_shmring_wakeup (
+	int efd									/* eventfd 									*/
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the ring pair in the shared memory (app side)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* created ring pair, or NULL 				*/
+cef_shmring_create (
+	uint32_t size,							/* size of each ring (bytes) 				*/
+	int fds[]								/* set the FDs to pass to cefnetd 			*/
+) {
+#ifdef CefC_Shmring_Enable
+	CefT_Shmring_Hdr* hdr;
+	CefT_Shmring* sr;
+	size_t map_len;
+	uint32_t p;
+	int mfd;
+	int efd_app;
+	int efd_netd;
+
+	/* The size is a power of 2, so the offsets are wrapped by a mask 	*/
+	if (size < CefC_Shmring_Size_Min) {
+		size = CefC_Shmring_Size_Min;
+	}
+	if (size > CefC_Shmring_Size_Max) {
+		size = CefC_Shmring_Size_Max;
+	}
+	for (p = CefC_Shmring_Size_Min ; p < size ; p <<= 1) {
+		/* NOP */;
+	}
+	size = p;
+	map_len = cef_shmring_data_offset () + (size_t) size * 2;
+
+	mfd = memfd_create ("cefore_shmring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (mfd < 0) {
+		cef_log_write (CefC_Log_Warn, "%s (memfd_create:%s)\n", __func__, strerror (errno));
+		return (NULL);
+	}
+	if (ftruncate (mfd, (off_t) map_len) < 0) {
+		cef_log_write (CefC_Log_Warn, "%s (ftruncate:%s)\n", __func__, strerror (errno));
+		close (mfd);
+		return (NULL);
+	}
+	if (fcntl (mfd, F_ADD_SEALS, CefC_Shmring_Seals) < 0) {
+		cef_log_write (CefC_Log_Warn, "%s (F_ADD_SEALS:%s)\n", __func__, strerror (errno));
+		close (mfd);
+		return (NULL);
+	}
+	hdr = (CefT_Shmring_Hdr*) mmap (NULL, map_len,
+							PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+	if (hdr == MAP_FAILED) {
+		cef_log_write (CefC_Log_Warn, "%s (mmap:%s)\n", __func__, strerror (errno));
+		close (mfd);
+		return (NULL);
+	}
+	memset (hdr, 0, sizeof (CefT_Shmring_Hdr));
+	hdr->magic 	= CefC_Shmring_Magic;
+	hdr->size 	= size;
+
+	efd_app  = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+	efd_netd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((efd_app < 0) || (efd_netd < 0)) {
+		cef_log_write (CefC_Log_Warn, "%s (eventfd:%s)\n", __func__, strerror (errno));
+		if (efd_app >= 0) {
+			close (efd_app);
+		}
+		if (efd_netd >= 0) {
+			close (efd_netd);
+		}
+		munmap (hdr, map_len);
+		close (mfd);
+		return (NULL);
+	}
+
+	sr = cef_shmring_setup (hdr, map_len, size, CefC_Shmring_Side_App, efd_app, efd_netd);
+	if (sr == NULL) {
+		close (efd_app);
+		close (efd_netd);
+		munmap (hdr, map_len);
+		close (mfd);
+		return (NULL);
+	}
+	fds[0] = mfd;
+	fds[1] = efd_app;
+	fds[2] = efd_netd;
+
+	return (sr);
+#else // CefC_Shmring_Enable
+	return (NULL);
+#endif // CefC_Shmring_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Maps the ring pair created by the app (cefnetd side)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring* 								/* mapped ring pair, or NULL 				*/
+cef_shmring_attach (
+	int fds[]								/* FDs received from the app 				*/
+) {
+	CefT_Shmring_Hdr* hdr;
+	CefT_Shmring* sr;
+	struct stat st;
+	size_t map_len;
+	uint32_t size;
+
+	if (cef_shmring_fds_check (fds) < 1) {
+		goto ERROR;
+	}
+	if ((fstat (fds[0], &st) < 0) ||
+		((size_t) st.st_size < cef_shmring_data_offset () + CefC_Shmring_Size_Min * 2)) {
+		goto ERROR;
+	}
+	map_len = (size_t) st.st_size;
+
+	hdr = (CefT_Shmring_Hdr*) mmap (NULL, map_len,
+							PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+	if (hdr == MAP_FAILED) {
+		goto ERROR;
+	}
+	/* The app may pass any memory, so its header is checked before use. The size 	*/
+	/* is read only once, because the app can still rewrite the header. 			*/
+	size = __atomic_load_n (&hdr->size, __ATOMIC_RELAXED);
+	if ((hdr->magic != CefC_Shmring_Magic) ||
+		(size < CefC_Shmring_Size_Min) || (size > CefC_Shmring_Size_Max) ||
+		(size & (size - 1)) ||
+		(cef_shmring_data_offset () + (size_t) size * 2 > map_len)) {
+		munmap (hdr, map_len);
+		goto ERROR;
+	}
+	sr = cef_shmring_setup (hdr, map_len, size, CefC_Shmring_Side_Netd, fds[2], fds[1]);
+	if (sr == NULL) {
+		munmap (hdr, map_len);
+		goto ERROR;
+	}
+	close (fds[0]);
+
+	return (sr);
+
+ERROR:
+	close (fds[0]);
+	close (fds[1]);
+	close (fds[2]);
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Checks the FDs passed by the app before mapping them (cefnetd side)
+----------------------------------------------------------------------------------------*/
+int											/* 1 if the FDs can be attached 			*/
+cef_shmring_fds_check (
+	int fds[]								/* FDs received from the app 				*/
+) {
+#ifdef CefC_Shmring_Enable
+	int seals;
+
+	/* The memfd has to be sealed, or the app can shrink it under the mapping 	*/
+	seals = fcntl (fds[0], F_GET_SEALS);
+	if ((seals < 0) || ((seals & CefC_Shmring_Seals) != CefC_Shmring_Seals)) {
+		return (0);
+	}
+	if (!cef_shmring_fd_is_eventfd (fds[1]) || !cef_shmring_fd_is_eventfd (fds[2])) {
+		return (0);
+	}
+	return (1);
+#else // CefC_Shmring_Enable
+	return (0);
+#endif // CefC_Shmring_Enable
+}
+/*--------------------------------------------------------------------------------------
+	Unmaps the ring pair and closes its eventfds
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_destroy (
+	CefT_Shmring* sr						/* ring pair 								*/
+) {
+	if (sr == NULL) {
+		return;
+	}
+	munmap (sr->hdr, sr->map_len);
+	close (sr->efd);
+	close (sr->peer_efd);
+	free (sr);
+}
+/*--------------------------------------------------------------------------------------
+	Writes the bytes to the ring
+----------------------------------------------------------------------------------------*/
+int											/* written bytes, 0 if the ring is full 	*/
+cef_shmring_write (
+	CefT_Shmring* sr,						/* ring pair 								*/
+	const unsigned char* msg,				/* bytes to write 							*/
+	int len									/* length of the bytes 						*/
+) {
+	uint64_t head;
+	uint64_t used;
+	uint64_t free_len;
+	uint32_t off;
+	uint32_t n1;
+	uint32_t n;
+
+	if (len <= 0) {
+		return (0);
+	}
+	head = cef_shmring_load_relaxed (&sr->tx->head);
+	used = head - cef_shmring_load_acquire (&sr->tx->tail);
+
+	if (used >= sr->size) {
+		/* Asks the reader to wake up this side when it frees the space. The 	*/
+		/* tail is checked again, the reader may free it before seeing the flag	*/
+		cef_shmring_store_seq (&sr->tx->full_f, 1);
+		used = head - cef_shmring_load_seq (&sr->tx->tail);
+
+		/* The peer may corrupt the tail, the writer never overwrites unread bytes */
+		if (used >= sr->size) {
+			return (0);
+		}
+	}
+	free_len = sr->size - used;
+	n = ((uint64_t) len < free_len) ? (uint32_t) len : (uint32_t) free_len;
+	off = (uint32_t)(head & (sr->size - 1));
+	n1 = sr->size - off;
+	if (n1 > n) {
+		n1 = n;
+	}
+	memcpy (sr->tx_data + off, msg, n1);
+	if (n > n1) {
+		memcpy (sr->tx_data, msg + n1, n - n1);
+	}
+	cef_shmring_store_seq (&sr->tx->head, head + n);
+
+	/* Wakes up the reader only when it has read all the bytes before, it 	*/
+	/* reads the ring until it becomes empty after every wakeup				*/
+	if (cef_shmring_load_seq (&sr->tx->tail) == head) {
+		cef_shmring_wakeup (sr->peer_efd);
+	}
+
+	return ((int) n);
+}
+/*--------------------------------------------------------------------------------------
+	Reads the bytes from the ring
+----------------------------------------------------------------------------------------*/
+int											/* read bytes, 0 if the ring is empty 		*/
+cef_shmring_read (
+	CefT_Shmring* sr,						/* ring pair 								*/
+	unsigned char* buff,					/* buffer to set the bytes 					*/
+	int len									/* size of the buffer 						*/
+) {
+	uint64_t tail;
+	uint64_t avail;
+	uint32_t off;
+	uint32_t n1;
+	uint32_t n;
+
+	if (len <= 0) {
+		return (0);
+	}
+	tail = cef_shmring_load_relaxed (&sr->rx->tail);
+	avail = cef_shmring_load_seq (&sr->rx->head) - tail;
+
+	/* The writer may corrupt the offsets, the reader never goes out of the ring */
+	if ((avail == 0) || (avail > sr->size)) {
+		return (0);
+	}
+	n = ((uint64_t) len < avail) ? (uint32_t) len : (uint32_t) avail;
+	off = (uint32_t)(tail & (sr->size - 1));
+	n1 = sr->size - off;
+	if (n1 > n) {
+		n1 = n;
+	}
+	memcpy (buff, sr->rx_data + off, n1);
+	if (n > n1) {
+		memcpy (buff + n1, sr->rx_data, n - n1);
+	}
+	cef_shmring_store_seq (&sr->rx->tail, tail + n);
+
+	/* Wakes up the writer which waits for the free space 	*/
+	if (cef_shmring_load_seq (&sr->rx->full_f)) {
+		cef_shmring_store_seq (&sr->rx->full_f, 0);
+		cef_shmring_wakeup (sr->peer_efd);
+	}
+
+	return ((int) n);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the bytes written but not read by the peer yet
+----------------------------------------------------------------------------------------*/
+uint32_t 									/* bytes in the ring this side writes 		*/
+cef_shmring_tx_pending (
+	CefT_Shmring* sr						/* ring pair 								*/
+) {
+	return ((uint32_t)(cef_shmring_load_relaxed (&sr->tx->head) -
+						cef_shmring_load_acquire (&sr->tx->tail)));
+}
+/*--------------------------------------------------------------------------------------
+	Clears the wakeup of this side. The rings have to be checked again after this.
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_wakeup_clear (
+	CefT_Shmring* sr						/* ring pair 								*/
+) {
+	uint64_t val;
+
+	if (read (sr->efd, &val, sizeof (val)) < 0) {
+		/* NOP: not woken up */;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Wakes up this side, when it stops reading before the ring becomes empty
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_wakeup_self (
+	CefT_Shmring* sr						/* ring pair 								*/
+) {
+	cef_shmring_wakeup (sr->efd);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the message with the FDs over the local socket
+----------------------------------------------------------------------------------------*/
+int											/* sent bytes, or a negative value 			*/
+cef_shmring_fds_send (
+	int sock,								/* local socket 							*/
+	const void* msg,						/* message to send 							*/
+	int len,								/* length of the message 					*/
+	int fds[],								/* FDs to pass 								*/
+	int fd_num								/* number of the FDs 						*/
+) {
+	struct msghdr hdr;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	char cbuf[CMSG_SPACE (sizeof (int) * CefC_Shmring_Fd_Num)];
+
+	if ((fd_num < 1) || (fd_num > CefC_Shmring_Fd_Num)) {
+		return (-1);
+	}
+	memset (&hdr, 0, sizeof (hdr));
+	memset (cbuf, 0, sizeof (cbuf));
+	iov.iov_base 		= (void*) msg;
+	iov.iov_len 		= (size_t) len;
+	hdr.msg_iov 		= &iov;
+	hdr.msg_iovlen 		= 1;
+	hdr.msg_control 	= cbuf;
+	hdr.msg_controllen 	= CMSG_SPACE (sizeof (int) * fd_num);
+
+	cmsg = CMSG_FIRSTHDR (&hdr);
+	cmsg->cmsg_level 	= SOL_SOCKET;
+	cmsg->cmsg_type 	= SCM_RIGHTS;
+	cmsg->cmsg_len 		= CMSG_LEN (sizeof (int) * fd_num);
+	memcpy (CMSG_DATA (cmsg), fds, sizeof (int) * fd_num);
+
+	return ((int) sendmsg (sock, &hdr, 0));
+}
+/*--------------------------------------------------------------------------------------
+	Receives the message and the FDs passed with it from the local socket
+----------------------------------------------------------------------------------------*/
+int											/* received bytes, as recv 					*/
+cef_shmring_fds_recv (
+	int sock,								/* local socket 							*/
+	void* buff,								/* buffer to set the message 				*/
+	int len,								/* size of the buffer 						*/
+	int fds[],								/* set the passed FDs 						*/
+	int* fd_num								/* set the number of the passed FDs 		*/
+) {
+	struct msghdr hdr;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	char cbuf[CMSG_SPACE (sizeof (int) * CefC_Shmring_Fd_Num)];
+	ssize_t res;
+	int n;
+
+	*fd_num = 0;
+	memset (&hdr, 0, sizeof (hdr));
+	iov.iov_base 		= buff;
+	iov.iov_len 		= (size_t) len;
+	hdr.msg_iov 		= &iov;
+	hdr.msg_iovlen 		= 1;
+	hdr.msg_control 	= cbuf;
+	hdr.msg_controllen 	= sizeof (cbuf);
+
+#ifdef MSG_CMSG_CLOEXEC
+	res = recvmsg (sock, &hdr, MSG_CMSG_CLOEXEC);
+#else // MSG_CMSG_CLOEXEC
+	res = recvmsg (sock, &hdr, 0);
+#endif // MSG_CMSG_CLOEXEC
+	if (res < 0) {
+		return ((int) res);
+	}
+	for (cmsg = CMSG_FIRSTHDR (&hdr) ; cmsg != NULL ; cmsg = CMSG_NXTHDR (&hdr, cmsg)) {
+		if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)) {
+			continue;
+		}
+		n = (int)((cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int));
+		if (n > CefC_Shmring_Fd_Num - *fd_num) {
+			n = CefC_Shmring_Fd_Num - *fd_num;
+		}
+		memcpy (&fds[*fd_num], CMSG_DATA (cmsg), sizeof (int) * n);
+		*fd_num += n;
+	}
+
+	return ((int) res);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the offset of the rings in the shared memory
+----------------------------------------------------------------------------------------*/
+static size_t
+cef_shmring_data_offset (
+	void
+) {
+	return ((sizeof (CefT_Shmring_Hdr) + CefC_Shmring_Page_Size - 1) &
+			~((size_t) CefC_Shmring_Page_Size - 1));
+}
+/*--------------------------------------------------------------------------------------
+	Sets the rings of the specified side to the ring pair
+----------------------------------------------------------------------------------------*/
+static CefT_Shmring* 						/* ring pair, or NULL 						*/
+cef_shmring_setup (
+	CefT_Shmring_Hdr* hdr,					/* mapped shared memory 					*/
+	size_t map_len,							/* length of the mapping 					*/
+	uint32_t size,							/* size of each ring (bytes) 				*/
+	int side,								/* CefC_Shmring_Side_XXX 					*/
+	int efd,								/* eventfd which wakes up this side 		*/
+	int peer_efd							/* eventfd which wakes up the peer 			*/
+) {
+	CefT_Shmring* sr;
+	unsigned char* data;
+
+	sr = (CefT_Shmring*) malloc (sizeof (CefT_Shmring));
+	if (sr == NULL) {
+		return (NULL);
+	}
+	data = (unsigned char*) hdr + cef_shmring_data_offset ();
+
+	sr->hdr 		= hdr;
+	sr->map_len 	= map_len;
+	sr->size 		= size;
+	sr->efd 		= efd;
+	sr->peer_efd 	= peer_efd;
+
+	if (side == CefC_Shmring_Side_App) {
+		sr->tx 		= &hdr->ring[0];
+		sr->rx 		= &hdr->ring[1];
+		sr->tx_data = data;
+		sr->rx_data = data + size;
+	} else {
+		sr->tx 		= &hdr->ring[1];
+		sr->rx 		= &hdr->ring[0];
+		sr->tx_data = data + size;
+		sr->rx_data = data;
+	}
+
+	return (sr);
+}
+/*--------------------------------------------------------------------------------------
+	Wakes up the side waiting on the specified eventfd
+----------------------------------------------------------------------------------------*/
+static void
+cef_shmring_wakeup (
+	int efd									/* eventfd 									*/
+) {
+	uint64_t one = 1;
+
+	if (write (efd, &one, sizeof (one)) < 0) {
+		/* NOP: the counter is already set */;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Checks that the FD is an eventfd
+----------------------------------------------------------------------------------------*/
+static int									/* 1 if the FD is an eventfd 				*/
+cef_shmring_fd_is_eventfd (
+	int fd									/* FD to check 								*/
+) {
+	char path[64];
+	char link[PATH_MAX];
+	ssize_t len;
+
+	/* The eventfd is an anonymous inode, which has no other way to be told 	*/
+	sprintf (path, "/proc/self/fd/%d", fd);
+	len = readlink (path, link, sizeof (link) - 1);
+	if (len < 0) {
+		return (0);
+	}
+	link[len] = 0x00;
+
+	return (strcmp (link, "anon_inode:[eventfd]") == 0);
+}
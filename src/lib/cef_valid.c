@@ -38,6 +38,8 @@
 
 #include <string.h>
 #include <limits.h>
+#include <time.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 
 #include <openssl/rsa.h>
@@ -45,6 +47,11 @@
 #include <openssl/objects.h>
 #include <openssl/pem.h>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CefC_Valid_Crc_Pclmul
+#endif // __x86_64__ && __GNUC__
+
 #include <cefore/cef_define.h>
 #include <cefore/cef_log.h>
 #include <cefore/cef_client.h>
@@ -56,6 +63,13 @@
  Macros
  ****************************************************************************************/
 
+#define CefC_Valid_Crc_Slice_Num	8		/* Tables of slicing-by-8 					*/
+#define CefC_Valid_Crc_Fold_Min		64		/* Min length to fold with PCLMUL 			*/
+#define CefC_Valid_Key_Cache_Num	64		/* Decoded public keys to keep 				*/
+
+#define CefC_Valid_Job_Sign			0		/* cef_valid_msg_sign is run for the jobs 	*/
+#define CefC_Valid_Job_Verify		1		/* cef_valid_msg_verify is run for the jobs */
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
@@ -75,11 +89,44 @@ typedef struct {
 
 } CefT_Keys;
 
+/* Public key decoded from T_PUBLICKEY, kept to skip d2i_RSA_PUBKEY 	*/
+typedef struct {
+
+	uint32_t 		hashv;					/* hash of the DER encoded key 				*/
+	unsigned char* 	pub_key_bi;
+	int 			pub_key_bi_len;
+	RSA*  			pub_key;
+	uint64_t 		used;					/* last use, to evict the LRU entry 		*/
+
+} CefT_Valid_Key_Cache;
+
+/* Threads which sign or verify the messages of a batch 	*/
+typedef struct {
+
+	pthread_t 		threads[CefC_Valid_Pool_Thread_Max];
+	int 			thread_num;
+	pthread_mutex_t mutex;
+	pthread_cond_t 	start_cond;				/* signaled when a batch is started 		*/
+	pthread_cond_t 	done_cond;				/* signaled when the threads leave a batch 	*/
+	pthread_mutex_t batch_mutex;			/* serializes the callers of the batch 		*/
+
+	CefT_Valid_Job* jobs;
+	int 			job_num;
+	int 			job_next;				/* next job to take, updated atomically 	*/
+	int 			job_op;					/* CefC_Valid_Job_XXX 						*/
+	uint64_t 		batch_gen;				/* incremented when a batch is started 		*/
+	int 			busy;					/* threads working on the current batch 	*/
+	int 			stop_f;
+
+} CefT_Valid_Pool;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
 
-static uint32_t 			crc_table[256];
+static uint32_t 			crc_table[CefC_Valid_Crc_Slice_Num][256];
+static uint32_t 			(*crc_kernel)(uint32_t, const unsigned char*, size_t) = NULL;
+static pthread_once_t 		crc_once = PTHREAD_ONCE_INIT;
 static CefT_Hash_Handle		key_table;
 static CefT_Keys* 			default_key_entry = NULL;
 static char					ccninfo_sha256_prvkey_path[PATH_MAX*2];
@@ -89,6 +136,20 @@ int 						ccninfo_sha256_pub_key_bi_len;
 RSA*  						ccninfo_sha256_pub_key;
 RSA*  						ccninfo_sha256_prv_key;
 
+static CefT_Valid_Key_Cache	key_cache[CefC_Valid_Key_Cache_Num];
+static uint64_t 			key_cache_clock = 0;
+static CefT_Valid_Stat 		valid_stat;
+static time_t 				valid_rate_sec = 0;		/* second counted in valid_rate_cnt 	*/
+static uint64_t 			valid_rate_cnt = 0;
+static pthread_mutex_t 		valid_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static CefT_Valid_Pool 		valid_pool = {
+	.mutex 			= PTHREAD_MUTEX_INITIALIZER,
+	.start_cond 	= PTHREAD_COND_INITIALIZER,
+	.done_cond 		= PTHREAD_COND_INITIALIZER,
+	.batch_mutex 	= PTHREAD_MUTEX_INITIALIZER,
+};
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
@@ -97,6 +158,30 @@ static void
 cef_valid_crc_init (
 	void
 );
+static void
+cef_valid_crc_table_build (
+	void
+);
+static uint32_t
+cef_valid_crc32_byte (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+);
+static uint32_t
+cef_valid_crc32_sb8 (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+);
+#ifdef CefC_Valid_Crc_Pclmul
+static uint32_t
+cef_valid_crc32_pclmul (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+);
+#endif // CefC_Valid_Crc_Pclmul
 static int
 cef_valid_conf_value_get (
 	const char* p,
@@ -138,6 +223,29 @@ cef_valid_rsa_sha256_verify_forccninfo (
 );
 static int
 cef_valid_create_keyinfo_forccninfo ();
+static RSA*
+cef_valid_pubkey_cache_get (
+	const unsigned char* pub_key_bi,
+	int pub_key_bi_len
+);
+static void
+cef_valid_verify_count (
+	int res
+);
+static void*
+cef_valid_pool_worker (
+	void* arg
+);
+static void
+cef_valid_pool_run (
+	void
+);
+static void
+cef_valid_batch_run (
+	CefT_Valid_Job jobs[],
+	int job_num,
+	int job_op
+);
 
 static int 							/* If the return value is 0 the code is equal, 		*/
 									/* otherwise the code is different. 				*/
@@ -269,14 +377,47 @@ cef_valid_crc32_calc (
 	const unsigned char* buf,
 	size_t len
 ) {
-	uint32_t c = 0xFFFFFFFF;
-	size_t i;
+	cef_valid_crc_init ();
+
+	return (crc_kernel (0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF);
+}
+
+int
+cef_valid_crc32_calc_with_kernel (
+	int kernel,
+	const unsigned char* buf,
+	size_t len,
+	uint32_t* crc
+) {
+	uint32_t (*func)(uint32_t, const unsigned char*, size_t);
 
-	for (i = 0 ; i < len ; i++) {
-		c = crc_table[(c ^ buf[i]) & 0xFF] ^ (c >> 8);
+	cef_valid_crc_init ();
+	switch (kernel) {
+		case CefC_Valid_Crc_Kernel_Byte: {
+			func = cef_valid_crc32_byte;
+			break;
+		}
+		case CefC_Valid_Crc_Kernel_Sb8: {
+			func = cef_valid_crc32_sb8;
+			break;
+		}
+#ifdef CefC_Valid_Crc_Pclmul
+		case CefC_Valid_Crc_Kernel_Pclmul: {
+			/* Selected only when the CPU supports it 	*/
+			if (crc_kernel != cef_valid_crc32_pclmul) {
+				return (-1);
+			}
+			func = cef_valid_crc32_pclmul;
+			break;
+		}
+#endif // CefC_Valid_Crc_Pclmul
+		default: {
+			return (-1);
+		}
 	}
+	*crc = func (0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF;
 
-	return (c ^ 0xFFFFFFFF);
+	return (0);
 }
 
 int
@@ -494,6 +635,113 @@ cef_valid_msg_verify (
 	return (res);
 }
 
+/*--------------------------------------------------------------------------------------
+	Obtains the length of the signature created with the key for the name
+----------------------------------------------------------------------------------------*/
+int 								/* length of the signature, 0 if no key 			*/
+cef_valid_sign_len_get (
+	const unsigned char* name,
+	int name_len
+) {
+	CefT_Keys* key_entry;
+
+	key_entry = (CefT_Keys*) cef_valid_key_entry_search (name, name_len);
+
+	if ((key_entry == NULL) || (key_entry->prv_key == NULL)) {
+		return (0);
+	}
+	return (RSA_size (key_entry->prv_key));
+}
+
+/*--------------------------------------------------------------------------------------
+	Sets the signature into the Validation Payload reserved by the deferred signing.
+	The signed range and the key are the same as cef_valid_dosign called from
+	cef_frame_object_create, so the message is same as the one signed inline.
+----------------------------------------------------------------------------------------*/
+int 								/* 1 if signed, otherwise 0 						*/
+cef_valid_msg_sign (
+	unsigned char* msg,
+	int msg_len
+) {
+	struct fixed_hdr* 	fixed_hp;
+	struct tlv_hdr* 	tlv_ptr;
+	CefT_Keys* 			key_entry;
+	unsigned char 		hash[SHA256_DIGEST_LENGTH];
+	unsigned char 		sign[256];
+	unsigned int 		sign_len;
+	uint16_t 	index;
+	uint16_t 	pkt_len;
+	uint16_t 	hdr_len;
+	uint16_t 	val_len;
+	uint16_t 	name_len;
+	uint16_t 	pld_offset;
+	int 		res;
+
+	/* Obtains header length and packet length 		*/
+	fixed_hp = (struct fixed_hdr*) msg;
+	pkt_len  = ntohs (fixed_hp->pkt_len);
+	if ((pkt_len != msg_len) || (msg_len < CefC_S_Fix_Header)) {
+		return (0);
+	}
+	hdr_len = fixed_hp->hdr_len;
+	if (hdr_len + CefC_S_TLF * 2 > pkt_len) {
+		return (0);
+	}
+
+	/* Obtains the Name 		*/
+	tlv_ptr = (struct tlv_hdr*) &msg[hdr_len + CefC_S_TLF];
+	if (ntohs (tlv_ptr->type) != CefC_T_NAME) {
+		return (0);
+	}
+	name_len = ntohs (tlv_ptr->length);
+
+	/* Skips the CCN message and Validation Algorithm TLVs 	*/
+	tlv_ptr = (struct tlv_hdr*) &msg[hdr_len];
+	index = hdr_len + CefC_S_TLF + ntohs (tlv_ptr->length);
+	if (index + CefC_S_TLF * 2 > pkt_len) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[index];
+	if (ntohs (tlv_ptr->type) != CefC_T_VALIDATION_ALG) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[index + CefC_S_TLF];
+	if (ntohs (tlv_ptr->type) != CefC_T_RSA_SHA256) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[index];
+	index += CefC_S_TLF + ntohs (tlv_ptr->length);
+
+	/* Checks the reserved Validation Payload 	*/
+	pld_offset = index;
+	if (pld_offset + CefC_S_TLF > pkt_len) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[pld_offset];
+	val_len = ntohs (tlv_ptr->length);
+	if ((ntohs (tlv_ptr->type) != CefC_T_VALIDATION_PAYLOAD) ||
+		(pld_offset + CefC_S_TLF + val_len > pkt_len)) {
+		return (0);
+	}
+
+	key_entry = (CefT_Keys*) cef_valid_key_entry_search (
+					&msg[hdr_len + CefC_S_TLF * 2], name_len);
+	if ((key_entry == NULL) || (key_entry->prv_key == NULL) ||
+		(RSA_size (key_entry->prv_key) != val_len)) {
+		return (0);
+	}
+
+	SHA256 (&msg[hdr_len], pld_offset - hdr_len, hash);
+	res = RSA_sign (
+		NID_sha256, hash, SHA256_DIGEST_LENGTH, sign, &sign_len, key_entry->prv_key);
+	if ((res != 1) || (sign_len != val_len)) {
+		return (0);
+	}
+	memcpy (&msg[pld_offset + CefC_S_TLF], sign, sign_len);
+
+	return (1);
+}
+
 int
 cef_valid_keyid_create_forccninfo (
 	unsigned char* pubkey,
@@ -864,7 +1112,6 @@ cef_valid_rsa_sha256_std_verify (
 	{
 		uint16_t 		pkey_offset;
 		uint16_t 		type;
-		unsigned char* 	ptr_for_free;
 
 		pkey_offset = alg_offset;
 		pkey_offset += CefC_S_TLF; 			/* Move offset by TL size of T_VALIDATION_ALG	*/
@@ -881,12 +1128,10 @@ cef_valid_rsa_sha256_std_verify (
 			return (1);
 		}
 		length = ntohs (tlv_ptr->length);
-		ptr_for_free = pub_key_bi = (unsigned char*)calloc(length, 1);
+		pub_key_bi = (unsigned char*) &msg[pkey_offset+CefC_S_TLF];
 		pub_key_bi_len = length;
-		memcpy (pub_key_bi, &msg[pkey_offset+CefC_S_TLF], pub_key_bi_len);
 
-		pub_key = d2i_RSA_PUBKEY(NULL, (const unsigned char**)&pub_key_bi, pub_key_bi_len);
-		free(ptr_for_free);
+		pub_key = cef_valid_pubkey_cache_get (pub_key_bi, pub_key_bi_len);
 		if (pub_key == NULL) {
 			return (1);
 		}
@@ -902,6 +1147,7 @@ cef_valid_rsa_sha256_std_verify (
 	res = RSA_verify (
 		NID_sha256, hash, SHA256_DIGEST_LENGTH, &msg[index], length, pub_key);
 	RSA_free (pub_key);
+	cef_valid_verify_count (res);
 
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Finest,
@@ -1076,7 +1322,6 @@ cef_valid_rsa_sha256_std_verify_forccninfo (
 	{
 		uint16_t 		pkey_offset;
 		uint16_t 		type;
-		unsigned char* 	ptr_for_free;
 
 		pkey_offset = alg_offset;
 		pkey_offset += CefC_S_TLF; 			/* Move offset by TL size of T_VALIDATION_ALG	*/
@@ -1093,17 +1338,15 @@ cef_valid_rsa_sha256_std_verify_forccninfo (
 			return (1);
 		}
 		length = ntohs (tlv_ptr->length);
-		ptr_for_free = pub_key_bi = (unsigned char*)calloc(length, 1);
+		pub_key_bi = (unsigned char*) &msg[pkey_offset+CefC_S_TLF];
 		pub_key_bi_len = length;
-		memcpy (pub_key_bi, &msg[pkey_offset+CefC_S_TLF], pub_key_bi_len);
 		if (rcvdpub_key_bi_len_p != NULL && rcvdpub_key_bi_pp != NULL) {
 			/* Set information used in authentication & authorization */
 			*rcvdpub_key_bi_len_p = pub_key_bi_len;
 			*rcvdpub_key_bi_pp = (unsigned char*)calloc(pub_key_bi_len, 1);
 			memcpy (*rcvdpub_key_bi_pp, pub_key_bi, pub_key_bi_len);
 		}
-		pub_key = d2i_RSA_PUBKEY(NULL, (const unsigned char**)&pub_key_bi, pub_key_bi_len);
-		free(ptr_for_free);
+		pub_key = cef_valid_pubkey_cache_get (pub_key_bi, pub_key_bi_len);
 		if (pub_key == NULL) {
 			return (1);
 		}
@@ -1119,6 +1362,7 @@ cef_valid_rsa_sha256_std_verify_forccninfo (
 	res = RSA_verify (
 		NID_sha256, hash, SHA256_DIGEST_LENGTH, &msg[index], length, pub_key);
 	RSA_free (pub_key);
+	cef_valid_verify_count (res);
 
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Finest,
@@ -1361,9 +1605,316 @@ cef_valid_sha256_keypass_ccninfoRT(
 	return (0);
 }
 
+/*--------------------------------------------------------------------------------------
+	Obtains the RSA key of the DER encoded public key from the cache. The key is
+	decoded and cached by replacing the least recently used entry if not found.
+	The caller releases the returned key with RSA_free.
+----------------------------------------------------------------------------------------*/
+static RSA*
+cef_valid_pubkey_cache_get (
+	const unsigned char* pub_key_bi,
+	int pub_key_bi_len
+) {
+	CefT_Valid_Key_Cache* entry;
+	CefT_Valid_Key_Cache* victim;
+	const unsigned char* p;
+	uint32_t hashv;
+	RSA* pub_key;
+	int i;
+
+	hashv = cef_hash_key_hashv_create (pub_key_bi, (uint32_t) pub_key_bi_len);
+
+	pthread_mutex_lock (&valid_mutex);
+	for (i = 0 ; i < CefC_Valid_Key_Cache_Num ; i++) {
+		entry = &key_cache[i];
+		if ((entry->pub_key) && (entry->hashv == hashv) &&
+			(entry->pub_key_bi_len == pub_key_bi_len) &&
+			(memcmp (entry->pub_key_bi, pub_key_bi, pub_key_bi_len) == 0)) {
+			entry->used = ++key_cache_clock;
+			RSA_up_ref (entry->pub_key);
+			valid_stat.key_cache_hit++;
+			pthread_mutex_unlock (&valid_mutex);
+			return (entry->pub_key);
+		}
+	}
+	valid_stat.key_cache_miss++;
+	pthread_mutex_unlock (&valid_mutex);
+
+	p = pub_key_bi;
+	pub_key = d2i_RSA_PUBKEY (NULL, &p, pub_key_bi_len);
+	if (pub_key == NULL) {
+		return (NULL);
+	}
+
+	pthread_mutex_lock (&valid_mutex);
+	victim = &key_cache[0];
+	for (i = 0 ; i < CefC_Valid_Key_Cache_Num ; i++) {
+		if (key_cache[i].pub_key == NULL) {
+			victim = &key_cache[i];
+			break;
+		}
+		if (key_cache[i].used < victim->used) {
+			victim = &key_cache[i];
+		}
+	}
+	if (victim->pub_key) {
+		/* the key is freed when the last verifier using it releases it 	*/
+		RSA_free (victim->pub_key);
+		free (victim->pub_key_bi);
+		victim->pub_key = NULL;
+	}
+	victim->pub_key_bi = (unsigned char*) malloc (pub_key_bi_len);
+	if (victim->pub_key_bi) {
+		memcpy (victim->pub_key_bi, pub_key_bi, pub_key_bi_len);
+		victim->pub_key_bi_len 	= pub_key_bi_len;
+		victim->hashv 			= hashv;
+		victim->used 			= ++key_cache_clock;
+		victim->pub_key 		= pub_key;
+		RSA_up_ref (pub_key);
+	}
+	pthread_mutex_unlock (&valid_mutex);
+
+	return (pub_key);
+}
+
+/*--------------------------------------------------------------------------------------
+	Counts the result of RSA_verify
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_verify_count (
+	int res
+) {
+	time_t now = time (NULL);
+
+	pthread_mutex_lock (&valid_mutex);
+	if (now != valid_rate_sec) {
+		valid_stat.verify_per_sec = (now == valid_rate_sec + 1) ? valid_rate_cnt : 0;
+		valid_rate_sec = now;
+		valid_rate_cnt = 0;
+	}
+	valid_rate_cnt++;
+	valid_stat.verify_num++;
+	if (res == 1) {
+		valid_stat.verify_ok++;
+	}
+	pthread_mutex_unlock (&valid_mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the signature verification
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_stat_get (
+	CefT_Valid_Stat* stat
+) {
+	time_t now = time (NULL);
+
+	pthread_mutex_lock (&valid_mutex);
+	memcpy (stat, &valid_stat, sizeof (CefT_Valid_Stat));
+	if (now == valid_rate_sec + 1) {
+		stat->verify_per_sec = valid_rate_cnt;
+	} else if (now != valid_rate_sec) {
+		stat->verify_per_sec = 0;
+	}
+	pthread_mutex_unlock (&valid_mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+	Starts the threads which sign or verify the messages of a batch
+----------------------------------------------------------------------------------------*/
+int 								/* number of the started threads, or -1 			*/
+cef_valid_pool_init (
+	int thread_num
+) {
+	int i;
+
+	pthread_mutex_lock (&valid_pool.batch_mutex);
+	if (valid_pool.thread_num > 0) {
+		pthread_mutex_unlock (&valid_pool.batch_mutex);
+		return (valid_pool.thread_num);
+	}
+	if (thread_num > CefC_Valid_Pool_Thread_Max) {
+		thread_num = CefC_Valid_Pool_Thread_Max;
+	}
+	valid_pool.stop_f = 0;
+	cef_valid_crc_init ();
+
+	for (i = 0 ; i < thread_num ; i++) {
+		if (pthread_create (&valid_pool.threads[i], NULL,
+				cef_valid_pool_worker, NULL) != 0) {
+			cef_log_write (CefC_Log_Warn,
+				"%s(%u) Failed to create the validation thread\n", __func__, __LINE__);
+			break;
+		}
+	}
+	valid_pool.thread_num = i;
+	pthread_mutex_unlock (&valid_pool.batch_mutex);
+
+	if ((i == 0) && (thread_num > 0)) {
+		return (-1);
+	}
+	return (i);
+}
+
+/*--------------------------------------------------------------------------------------
+	Stops the threads of the pool
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_pool_destroy (
+	void
+) {
+	int i;
+
+	pthread_mutex_lock (&valid_pool.batch_mutex);
+	pthread_mutex_lock (&valid_pool.mutex);
+	valid_pool.stop_f = 1;
+	pthread_cond_broadcast (&valid_pool.start_cond);
+	pthread_mutex_unlock (&valid_pool.mutex);
+
+	for (i = 0 ; i < valid_pool.thread_num ; i++) {
+		pthread_join (valid_pool.threads[i], NULL);
+	}
+	valid_pool.thread_num = 0;
+	pthread_mutex_unlock (&valid_pool.batch_mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+	Signs the messages of a batch with the thread pool
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_batch_sign (
+	CefT_Valid_Job jobs[],
+	int job_num
+) {
+	cef_valid_batch_run (jobs, job_num, CefC_Valid_Job_Sign);
+}
+
+/*--------------------------------------------------------------------------------------
+	Verifies the messages of a batch with the thread pool
+----------------------------------------------------------------------------------------*/
+void
+cef_valid_batch_verify (
+	CefT_Valid_Job jobs[],
+	int job_num
+) {
+	cef_valid_batch_run (jobs, job_num, CefC_Valid_Job_Verify);
+}
+
+/*--------------------------------------------------------------------------------------
+	Runs the jobs of a batch. The caller takes the jobs together with the threads,
+	and returns after all the threads left the batch.
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_batch_run (
+	CefT_Valid_Job jobs[],
+	int job_num,
+	int job_op
+) {
+	if (job_num < 1) {
+		return;
+	}
+	pthread_mutex_lock (&valid_pool.batch_mutex);
+	pthread_mutex_lock (&valid_pool.mutex);
+
+	/* Waits for the threads which woke up late for the previous batch 	*/
+	while (valid_pool.busy > 0) {
+		pthread_cond_wait (&valid_pool.done_cond, &valid_pool.mutex);
+	}
+	valid_pool.jobs 	= jobs;
+	valid_pool.job_num 	= job_num;
+	valid_pool.job_next = 0;
+	valid_pool.job_op 	= job_op;
+
+	if ((valid_pool.thread_num > 0) && (job_num > 1)) {
+		valid_pool.batch_gen++;
+		pthread_cond_broadcast (&valid_pool.start_cond);
+	}
+	pthread_mutex_unlock (&valid_pool.mutex);
+
+	cef_valid_pool_run ();
+
+	pthread_mutex_lock (&valid_pool.mutex);
+	while (valid_pool.busy > 0) {
+		pthread_cond_wait (&valid_pool.done_cond, &valid_pool.mutex);
+	}
+	valid_pool.jobs 	= NULL;
+	valid_pool.job_num 	= 0;
+	pthread_mutex_unlock (&valid_pool.mutex);
+	pthread_mutex_unlock (&valid_pool.batch_mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+	Takes the jobs of the current batch until no job is left
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_pool_run (
+	void
+) {
+	CefT_Valid_Job* job;
+	int n;
+
+	while ((n = __atomic_fetch_add (&valid_pool.job_next, 1, __ATOMIC_RELAXED))
+			< valid_pool.job_num) {
+		job = &valid_pool.jobs[n];
+
+		if (valid_pool.job_op == CefC_Valid_Job_Sign) {
+			job->res = cef_valid_msg_sign (job->msg, job->msg_len);
+		} else {
+			job->res = cef_valid_msg_verify (job->msg, job->msg_len);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Thread of the pool
+----------------------------------------------------------------------------------------*/
+static void*
+cef_valid_pool_worker (
+	void* arg
+) {
+	uint64_t gen;
+
+	pthread_mutex_lock (&valid_pool.mutex);
+	gen = valid_pool.batch_gen;
+
+	while (1) {
+		while ((valid_pool.stop_f == 0) && (valid_pool.batch_gen == gen)) {
+			pthread_cond_wait (&valid_pool.start_cond, &valid_pool.mutex);
+		}
+		if (valid_pool.stop_f) {
+			break;
+		}
+		gen = valid_pool.batch_gen;
+		valid_pool.busy++;
+		pthread_mutex_unlock (&valid_pool.mutex);
+
+		cef_valid_pool_run ();
+
+		pthread_mutex_lock (&valid_pool.mutex);
+		valid_pool.busy--;
+		if (valid_pool.busy == 0) {
+			pthread_cond_broadcast (&valid_pool.done_cond);
+		}
+	}
+	pthread_mutex_unlock (&valid_pool.mutex);
+
+	return (NULL);
+}
+
+/*--------------------------------------------------------------------------------------
+	Builds the tables and selects the CRC32 kernel only once, even if the worker
+	threads of the pool call cef_valid_crc32_calc first
+----------------------------------------------------------------------------------------*/
 static void
 cef_valid_crc_init (
 	void
+) {
+	pthread_once (&crc_once, cef_valid_crc_table_build);
+}
+
+static void
+cef_valid_crc_table_build (
+	void
 ) {
 	uint32_t i, c;
 	int j;
@@ -1373,9 +1924,175 @@ cef_valid_crc_init (
 		for (j = 0 ; j < 8 ; j++) {
 			c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
 		}
-		crc_table[i] = c;
+		crc_table[0][i] = c;
+	}
+	/* crc_table[n][i] is the CRC of i followed by n zero bytes 	*/
+	for (i = 0 ; i < 256 ; i++) {
+		c = crc_table[0][i];
+		for (j = 1 ; j < CefC_Valid_Crc_Slice_Num ; j++) {
+			c = crc_table[0][c & 0xFF] ^ (c >> 8);
+			crc_table[j][i] = c;
+		}
+	}
+
+	crc_kernel = cef_valid_crc32_sb8;
+#ifdef CefC_Valid_Crc_Pclmul
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("pclmul") && __builtin_cpu_supports ("sse4.1")) {
+		crc_kernel = cef_valid_crc32_pclmul;
 	}
+#endif // CefC_Valid_Crc_Pclmul
+}
+
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32 a byte at a time, as cef_valid_crc32_calc did before the other
+	kernels. It is kept as the reference of them.
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_valid_crc32_byte (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+) {
+	while (len > 0) {
+		c = crc_table[0][(c ^ *buf++) & 0xFF] ^ (c >> 8);
+		len--;
+	}
+
+	return (c);
+}
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32 with slicing-by-8, which handles 8 bytes per step
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_valid_crc32_sb8 (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	uint32_t lo, hi;
+
+	while ((len > 0) && (((uintptr_t) buf & 7) != 0)) {
+		c = crc_table[0][(c ^ *buf++) & 0xFF] ^ (c >> 8);
+		len--;
+	}
+	while (len >= 8) {
+		memcpy (&lo, buf, 4);
+		memcpy (&hi, buf + 4, 4);
+		lo ^= c;
+		c = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+			crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+			crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+			crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+		buf += 8;
+		len -= 8;
+	}
+#endif // __ORDER_LITTLE_ENDIAN__
+	while (len > 0) {
+		c = crc_table[0][(c ^ *buf++) & 0xFF] ^ (c >> 8);
+		len--;
+	}
+
+	return (c);
+}
+
+#ifdef CefC_Valid_Crc_Pclmul
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32 by folding 64 bytes per step with carry-less multiplication,
+	and by the Barrett reduction. The constants are of the bit-reflected
+	0xEDB88320 polynomial in "Fast CRC Computation for Generic Polynomials Using
+	PCLMULQDQ Instruction" (Intel). The rest of 16 bytes is handled by sb8.
+----------------------------------------------------------------------------------------*/
+__attribute__ ((target ("pclmul,sse4.1")))
+static uint32_t
+cef_valid_crc32_pclmul (
+	uint32_t c,
+	const unsigned char* buf,
+	size_t len
+) {
+	const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009e, 0x01751997d0);
+	const __m128i k5k0 = _mm_set_epi64x (0x0000000000, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x (0x01f7011641, 0x01db710641);
+	const __m128i mask = _mm_setr_epi32 (~0, 0, ~0, 0);
+	__m128i x1, x2, x3, x4, x5, x6, x7, x8;
+	size_t fold_len;
+
+	if (len < CefC_Valid_Crc_Fold_Min) {
+		return (cef_valid_crc32_sb8 (c, buf, len));
+	}
+	fold_len = len & ~((size_t) 15);
+
+	x1 = _mm_loadu_si128 ((const __m128i*)(buf + 0x00));
+	x2 = _mm_loadu_si128 ((const __m128i*)(buf + 0x10));
+	x3 = _mm_loadu_si128 ((const __m128i*)(buf + 0x20));
+	x4 = _mm_loadu_si128 ((const __m128i*)(buf + 0x30));
+	x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 ((int) c));
+	buf += 64;
+	fold_len -= 64;
+
+	/* Folds 4 x 128 bits in parallel 	*/
+	while (fold_len >= 64) {
+		x5 = _mm_clmulepi64_si128 (x1, k1k2, 0x00);
+		x6 = _mm_clmulepi64_si128 (x2, k1k2, 0x00);
+		x7 = _mm_clmulepi64_si128 (x3, k1k2, 0x00);
+		x8 = _mm_clmulepi64_si128 (x4, k1k2, 0x00);
+		x1 = _mm_clmulepi64_si128 (x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128 (x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128 (x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128 (x4, k1k2, 0x11);
+		x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5),
+				_mm_loadu_si128 ((const __m128i*)(buf + 0x00)));
+		x2 = _mm_xor_si128 (_mm_xor_si128 (x2, x6),
+				_mm_loadu_si128 ((const __m128i*)(buf + 0x10)));
+		x3 = _mm_xor_si128 (_mm_xor_si128 (x3, x7),
+				_mm_loadu_si128 ((const __m128i*)(buf + 0x20)));
+		x4 = _mm_xor_si128 (_mm_xor_si128 (x4, x8),
+				_mm_loadu_si128 ((const __m128i*)(buf + 0x30)));
+		buf += 64;
+		fold_len -= 64;
+	}
+
+	/* Folds into 128 bits 	*/
+	x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+	x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x3), x5);
+	x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x4), x5);
+
+	while (fold_len >= 16) {
+		x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+		x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5),
+				_mm_loadu_si128 ((const __m128i*) buf));
+		buf += 16;
+		fold_len -= 16;
+	}
+
+	/* Folds 128 bits into 64 bits 	*/
+	x2 = _mm_clmulepi64_si128 (x1, k3k4, 0x10);
+	x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), x2);
+	x2 = _mm_srli_si128 (x1, 4);
+	x1 = _mm_and_si128 (x1, mask);
+	x1 = _mm_clmulepi64_si128 (x1, k5k0, 0x00);
+	x1 = _mm_xor_si128 (x1, x2);
+
+	/* Barrett reduction to 32 bits 	*/
+	x2 = _mm_and_si128 (x1, mask);
+	x2 = _mm_clmulepi64_si128 (x2, poly, 0x10);
+	x2 = _mm_and_si128 (x2, mask);
+	x2 = _mm_clmulepi64_si128 (x2, poly, 0x00);
+	x1 = _mm_xor_si128 (x1, x2);
+	c = (uint32_t) _mm_extract_epi32 (x1, 1);
+
+	return (cef_valid_crc32_sb8 (c, buf, len & 15));
 }
+#endif // CefC_Valid_Crc_Pclmul
 
 static int
 cef_valid_conf_value_get (
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench.h
+ */
+
+#ifndef __CEF_BENCH_HEADER__
+#define __CEF_BENCH_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <arpa/inet.h>
+
+#include <cefore/cef_frame.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/* Result line of the benchmarks, which the scripts can grep 	*/
+#define CefC_Bench_Result_Fmt		"[%s] %-24s %12.3f %s\n"
+
+#define CefC_Bench_Key_Stride		128			/* room of a key in the key array 		*/
+#define CefC_Bench_Depth_Max		8			/* Name Segments fitting in the stride 	*/
+
+#define cef_bench_key_get(keys, i)	(&(keys)->buff[(size_t) (i) * CefC_Bench_Key_Stride])
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/* Names created by cef_bench_keys_create 	*/
+typedef struct {
+	unsigned char* 	buff;				/* num keys of CefC_Bench_Key_Stride bytes 	*/
+	uint16_t* 		lens;
+	uint32_t 		num;
+} CefT_Bench_Keys;
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Obtains the monotonic time (usec)
+----------------------------------------------------------------------------------------*/
+static inline uint64_t
+cef_bench_now_get (
+	void
+) {
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the next random value (xorshift64), which is reproducible by the seed
+----------------------------------------------------------------------------------------*/
+static inline uint64_t
+cef_bench_rand_get (
+	uint64_t* state
+) {
+	uint64_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return (x);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the CPU time which the process spent in the user and the system mode
+----------------------------------------------------------------------------------------*/
+static inline int64_t						/* CPU time (usec), -1 if unknown 			*/
+cef_bench_cpu_time_get (
+	pid_t pid
+) {
+	char path[64];
+	char buff[1024];
+	unsigned long utime;
+	unsigned long stime;
+	long ticks = sysconf (_SC_CLK_TCK);
+	FILE* fp;
+	char* wp;
+
+	sprintf (path, "/proc/%d/stat", (int) pid);
+	fp = fopen (path, "r");
+	if (fp == NULL) {
+		return (-1);
+	}
+	wp = fgets (buff, sizeof (buff), fp);
+	fclose (fp);
+	if (wp == NULL) {
+		return (-1);
+	}
+
+	/* utime and stime are the 14th and 15th fields. The 2nd field may have spaces. */
+	wp = strrchr (buff, ')');
+	if ((wp == NULL) || (ticks <= 0) ||
+		(sscanf (wp + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+			&utime, &stime) != 2)) {
+		return (-1);
+	}
+	return ((int64_t)(utime + stime) * 1000000 / ticks);
+}
+/*--------------------------------------------------------------------------------------
+	Prints the result of a benchmark
+----------------------------------------------------------------------------------------*/
+static inline void
+cef_bench_result_print (
+	const char* prog,
+	const char* item,
+	double value,
+	const char* unit
+) {
+	fprintf (stdout, CefC_Bench_Result_Fmt, prog, item, value, unit);
+}
+
+/*--------------------------------------------------------------------------------------
+	Creates a TLV Name of the Name Segments "b<id>", "s1", ... followed by the Chunk
+	Number. Returns the length.
+----------------------------------------------------------------------------------------*/
+static inline int
+cef_bench_name_create (
+	unsigned char* buff,					/* CefC_Bench_Key_Stride bytes at least 		*/
+	uint64_t id,							/* distinguishes the first segment 			*/
+	int depth,								/* number of the Name Segments 				*/
+	uint32_t chunk
+) {
+	uint16_t tv;
+	uint32_t cv;
+	int len;
+	int idx = 0;
+	int i;
+
+	for (i = 0 ; i < depth ; i++) {
+		if (i == 0) {
+			len = sprintf ((char*) &buff[idx + 4], "b%llu", (unsigned long long) id);
+		} else {
+			len = sprintf ((char*) &buff[idx + 4], "s%d", i);
+		}
+		tv = htons (CefC_T_NAMESEGMENT);
+		memcpy (&buff[idx], &tv, sizeof (uint16_t));
+		tv = htons ((uint16_t) len);
+		memcpy (&buff[idx + 2], &tv, sizeof (uint16_t));
+		idx += 4 + len;
+	}
+	tv = htons (CefC_T_CHUNK);
+	memcpy (&buff[idx], &tv, sizeof (uint16_t));
+	tv = htons (sizeof (uint32_t));
+	memcpy (&buff[idx + 2], &tv, sizeof (uint16_t));
+	cv = htonl (chunk);
+	memcpy (&buff[idx + 4], &cv, sizeof (uint32_t));
+
+	return (idx + 8);
+}
+
+/*--------------------------------------------------------------------------------------
+	Creates the Names of the ids from base to base + num - 1
+----------------------------------------------------------------------------------------*/
+static inline int
+cef_bench_keys_create (
+	CefT_Bench_Keys* keys,
+	uint64_t base,							/* id of the first key 						*/
+	uint32_t num,
+	int depth								/* 1 to CefC_Bench_Depth_Max 				*/
+) {
+	uint32_t i;
+
+	keys->buff = (unsigned char*) malloc ((size_t) num * CefC_Bench_Key_Stride);
+	keys->lens = (uint16_t*) malloc (sizeof (uint16_t) * num);
+	if ((keys->buff == NULL) || (keys->lens == NULL)) {
+		return (-1);
+	}
+	keys->num = num;
+
+	for (i = 0 ; i < num ; i++) {
+		keys->lens[i] = (uint16_t) cef_bench_name_create (
+			cef_bench_key_get (keys, i), base + i, depth, i);
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Creates an Interest of the specified Name. Returns the length or -1.
+----------------------------------------------------------------------------------------*/
+static inline int
+cef_bench_interest_create (
+	unsigned char* buff,					/* at least CefC_Max_Length bytes 			*/
+	CefT_CcnMsg_MsgBdy* tlvs,				/* work area cleared by the caller once 	*/
+	const unsigned char* name,
+	uint16_t name_len,
+	uint16_t lifetime						/* Interest Lifetime (msec) 				*/
+) {
+	CefT_CcnMsg_OptHdr opt;
+
+	memset (&opt, 0, sizeof (CefT_CcnMsg_OptHdr));
+	memcpy (tlvs->name, name, name_len);
+	tlvs->name_len 	= name_len;
+	tlvs->hoplimit 	= 32;
+	opt.lifetime_f 	= 1;
+	opt.lifetime 	= lifetime;
+
+	return (cef_frame_interest_create (buff, &opt, tlvs));
+}
+/*--------------------------------------------------------------------------------------
+	Parses the message at the top of the buffer as cefnetd does
+----------------------------------------------------------------------------------------*/
+static inline int							/* -1 if the message is invalid 			*/
+cef_bench_message_parse (
+	unsigned char* msg,
+	CefT_CcnMsg_OptHdr* poh,
+	CefT_CcnMsg_MsgBdy* pm,
+	int target_type							/* CefC_PT_XXX 								*/
+) {
+	struct fixed_hdr* fhdr = (struct fixed_hdr*) msg;
+	uint16_t pkt_len = ntohs (fhdr->pkt_len);
+
+	if (pkt_len < fhdr->hdr_len) {
+		return (-1);
+	}
+	return (cef_frame_message_parse (msg, pkt_len - fhdr->hdr_len, fhdr->hdr_len,
+				poh, pm, target_type));
+}
+
+#endif // __CEF_BENCH_HEADER__
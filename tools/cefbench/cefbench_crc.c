@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_crc.c
+ *
+ * Measures the throughput of the CRC32 kernels of cef_valid_crc32_calc: the
+ * byte-at-a-time reference, slicing-by-8 and PCLMUL folding. The payload sizes
+ * double from 64 bytes up to CefC_Max_Block. Before timing, every kernel checks
+ * the "123456789" check value and must agree with the reference on random
+ * buffers of every length up to 256 bytes, at every alignment up to 16, and of
+ * every measured size. The PCLMUL kernel is skipped on the hosts without it.
+ */
+
+#define __CEF_BENCH_CRC_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_valid.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_crc"
+#define CefC_Bench_Size_Min			64
+#define CefC_Bench_Check_Len		256			/* lengths checked one by one 			*/
+#define CefC_Bench_Align_Max		16
+#define CefC_Bench_Check_Value		0xCBF43926	/* CRC32 of "123456789" 				*/
+
+/****************************************************************************************
+ Static Variables
+ ****************************************************************************************/
+
+static const int kernels[] = {
+	CefC_Valid_Crc_Kernel_Byte,
+	CefC_Valid_Crc_Kernel_Sb8,
+	CefC_Valid_Crc_Kernel_Pclmul,
+};
+static const char* kernel_names[] = { "byte", "sb8", "pclmul" };
+#define CefC_Bench_Kernel_Num		(int)(sizeof (kernels) / sizeof (kernels[0]))
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int									/* number of the errors 					*/
+cef_bench_crc_check (
+	const unsigned char* buff,
+	int avail[]								/* set 1 if the kernel is available 		*/
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	unsigned char* buff;
+	int avail[CefC_Bench_Kernel_Num];
+	char item[64];
+	uint64_t seed 	= 1;
+	uint64_t total 	= 64 * 1024 * 1024;
+	uint64_t start_t;
+	uint64_t elapsed;
+	uint64_t loops;
+	uint64_t l;
+	uint32_t crc;
+	uint32_t sink = 0;
+	size_t size;
+	int err = 0;
+	int opt;
+	int k;
+	size_t i;
+
+	while ((opt = getopt (argc, argv, "m:h")) != -1) {
+		switch (opt) {
+			case 'm': {
+				total = (uint64_t) strtoul (optarg, NULL, 10) * 1024 * 1024;
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((total < 1024 * 1024) || (total > (uint64_t) 16 * 1024 * 1024 * 1024)) {
+		print_usage ();
+		return (1);
+	}
+
+	buff = (unsigned char*) malloc (CefC_Max_Block + CefC_Bench_Align_Max);
+	if (buff == NULL) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	for (i = 0 ; i < CefC_Max_Block + CefC_Bench_Align_Max ; i++) {
+		buff[i] = (unsigned char) cef_bench_rand_get (&seed);
+	}
+
+	err = cef_bench_crc_check (buff, avail);
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d mismatches)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+
+	/* Each kernel processes about the same bytes at every size 	*/
+	for (size = CefC_Bench_Size_Min ; size <= CefC_Max_Block ; size *= 2) {
+		loops = total / size;
+		for (k = 0 ; k < CefC_Bench_Kernel_Num ; k++) {
+			if (avail[k] == 0) {
+				continue;
+			}
+			start_t = cef_bench_now_get ();
+			for (l = 0 ; l < loops ; l++) {
+				cef_valid_crc32_calc_with_kernel (kernels[k], buff, size, &crc);
+				sink ^= crc;
+			}
+			elapsed = cef_bench_now_get () - start_t;
+			sprintf (item, "%s %zuB", kernel_names[k], size);
+			cef_bench_result_print (CefC_Bench_Prog, item,
+				(double)(loops * size) / 1000 / (elapsed ? elapsed : 1), "GB/s");
+		}
+		if ((size < CefC_Max_Block) && (size * 2 > CefC_Max_Block)) {
+			size = CefC_Max_Block / 2;
+		}
+	}
+	if (avail[CefC_Valid_Crc_Kernel_Pclmul] == 0) {
+		fprintf (stderr, "[%s] pclmul is not available on this host\n", CefC_Bench_Prog);
+	}
+
+	/* Keeps the results alive 	*/
+	if (sink == 0x5A5A5A5A) {
+		fprintf (stderr, "[%s] %08x\n", CefC_Bench_Prog, sink);
+	}
+	free (buff);
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_crc_check (
+	const unsigned char* buff,
+	int avail[]								/* set 1 if the kernel is available 		*/
+) {
+	uint32_t ref;
+	uint32_t crc;
+	size_t len;
+	size_t size;
+	int align;
+	int err = 0;
+	int k;
+
+	for (k = 0 ; k < CefC_Bench_Kernel_Num ; k++) {
+		avail[k] = (cef_valid_crc32_calc_with_kernel (
+			kernels[k], (const unsigned char*) "123456789", 9, &crc) == 0);
+		if ((avail[k]) && (crc != CefC_Bench_Check_Value)) {
+			fprintf (stderr, "[%s] %s: check value %08x\n",
+				CefC_Bench_Prog, kernel_names[k], crc);
+			err++;
+		}
+	}
+
+	for (align = 0 ; align < CefC_Bench_Align_Max ; align++) {
+		for (len = 0 ; len <= CefC_Bench_Check_Len ; len++) {
+			cef_valid_crc32_calc_with_kernel (
+				CefC_Valid_Crc_Kernel_Byte, &buff[align], len, &ref);
+			for (k = 1 ; k < CefC_Bench_Kernel_Num ; k++) {
+				if (avail[k] == 0) {
+					continue;
+				}
+				cef_valid_crc32_calc_with_kernel (kernels[k], &buff[align], len, &crc);
+				if (crc != ref) {
+					fprintf (stderr, "[%s] %s: length %zu at +%d\n",
+						CefC_Bench_Prog, kernel_names[k], len, align);
+					err++;
+				}
+			}
+		}
+	}
+	for (size = CefC_Bench_Size_Min ; size <= CefC_Max_Block ; size *= 2) {
+		cef_valid_crc32_calc_with_kernel (CefC_Valid_Crc_Kernel_Byte, buff, size, &ref);
+		for (k = 1 ; k < CefC_Bench_Kernel_Num ; k++) {
+			if (avail[k] == 0) {
+				continue;
+			}
+			cef_valid_crc32_calc_with_kernel (kernels[k], buff, size, &crc);
+			if (crc != ref) {
+				fprintf (stderr, "[%s] %s: length %zu\n",
+					CefC_Bench_Prog, kernel_names[k], size);
+				err++;
+			}
+		}
+		if ((size < CefC_Max_Block) && (size * 2 > CefC_Max_Block)) {
+			size = CefC_Max_Block / 2;
+		}
+	}
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-m megabytes]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  megabytes  Bytes each kernel processes at each size (default 64)\n\n");
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_fib.c
+ *
+ * Compares the longest prefix match of cef_fib_entry_search, which probes only the
+ * indexed depths, with cef_fib_entry_search_linear, which removes the Name
+ * Segments one by one. The routes have 1 to -p Name Segments and the Interests
+ * have -q Name Segments and the Chunk Number. Half of the Interests match no
+ * route. Both searches must return the same entry for every Interest.
+ */
+
+#define __CEF_BENCH_FIB_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_hash.h>
+#include <cefore/cef_fib.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_fib"
+
+/* Length of the Chunk Number TLV at the tail of the Names of cef_bench_name_create */
+#define CefC_Bench_Chunk_Tlv_Len	(CefC_S_TLF + CefC_S_ChunkNum)
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CefT_Hash_Handle fib,
+	const CefT_Bench_Keys* names,			/* Names of the Interests 					*/
+	int rounds
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Keys names;
+	CefT_Hash_Handle fib;
+	unsigned char route[CefC_Bench_Key_Stride];
+	uint32_t route_num 	= 10000;
+	int route_depth 	= 3;
+	int name_depth 		= 6;
+	int rounds 			= 5;
+	int route_len;
+	int err = 0;
+	int opt;
+	uint32_t i;
+
+	while ((opt = getopt (argc, argv, "n:p:q:r:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				route_num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'p': {
+				route_depth = atoi (optarg);
+				break;
+			}
+			case 'q': {
+				name_depth = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((route_num < 1) || (route_num > 65000) ||
+		(route_depth < 1) || (route_depth > CefC_Bench_Depth_Max) ||
+		(name_depth < route_depth) || (name_depth > CefC_Bench_Depth_Max) ||
+		(rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+
+	/* Sized for the routes like cefnetd sizes the FIB for FIB_SIZE 	*/
+	fib = cef_hash_tbl_create_resizable (route_num + 1, CefC_Hash_Coef_FIB);
+	if (fib == (CefT_Hash_Handle) NULL) {
+		fprintf (stderr, "[%s] cef_hash_tbl_create_resizable failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	for (i = 0 ; i < route_num ; i++) {
+		route_len = cef_bench_name_create (route, i, 1 + (int)(i % route_depth), 0);
+		if (cef_fib_entry_lookup (
+				fib, route, route_len - CefC_Bench_Chunk_Tlv_Len) == NULL) {
+			fprintf (stderr, "[%s] route %u could not be added\n", CefC_Bench_Prog, i);
+			return (1);
+		}
+	}
+
+	/* The Interests of the ids from route_num do not match any route 	*/
+	if (cef_bench_keys_create (&names, 0, route_num * 2, name_depth) < 0) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	err = cef_bench_run (fib, &names, rounds);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CefT_Hash_Handle fib,
+	const CefT_Bench_Keys* names,			/* Names of the Interests 					*/
+	int rounds
+) {
+	CefT_Fib_Entry** expects;
+	CefT_Fib_Entry* entry;
+	uint64_t start_t;
+	uint64_t lpm_t = 0;
+	uint64_t linear_t = 0;
+	uint64_t ops;
+	uint32_t matched = 0;
+	uint32_t i;
+	int err = 0;
+	int r;
+
+	expects = (CefT_Fib_Entry**) calloc (names->num, sizeof (CefT_Fib_Entry*));
+	if (expects == NULL) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	for (r = 0 ; r < rounds ; r++) {
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < names->num ; i++) {
+			expects[i] = cef_fib_entry_search_linear (
+				fib, cef_bench_key_get (names, i), names->lens[i]);
+		}
+		linear_t += cef_bench_now_get () - start_t;
+
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < names->num ; i++) {
+			entry = cef_fib_entry_search (
+				fib, cef_bench_key_get (names, i), names->lens[i]);
+			if (entry != expects[i]) {
+				if (err++ < 10) {
+					fprintf (stderr, "[%s] Interest %u matched a different entry\n",
+						CefC_Bench_Prog, i);
+				}
+			}
+		}
+		lpm_t += cef_bench_now_get () - start_t;
+	}
+	for (i = 0 ; i < names->num ; i++) {
+		if (expects[i]) {
+			matched++;
+		}
+	}
+	free (expects);
+
+	ops = (uint64_t) names->num * rounds;
+	cef_bench_result_print (CefC_Bench_Prog, "linear search",
+		(double) ops / (linear_t ? linear_t : 1), "Mlookups/s");
+	cef_bench_result_print (CefC_Bench_Prog, "indexed search",
+		(double) ops / (lpm_t ? lpm_t : 1), "Mlookups/s");
+	cef_bench_result_print (CefC_Bench_Prog, "matched",
+		(double) matched * 100 / names->num, "%");
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n routes] [-p route_depth] [-q name_depth] [-r rounds]\n\n",
+		CefC_Bench_Prog);
+	fprintf (stderr, "  routes       Number of the routes (1-65000)\n");
+	fprintf (stderr, "  route_depth  Max Name Segments of the routes (1-%d)\n",
+		CefC_Bench_Depth_Max);
+	fprintf (stderr, "  name_depth   Name Segments of the Interests "
+		"(route_depth-%d)\n", CefC_Bench_Depth_Max);
+	fprintf (stderr, "  rounds       Times to repeat the lookups\n\n");
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_flood.c
+ *
+ * Floods a running cefnetd with Interests over one TCP face and measures how fast
+ * cefnetd takes them in. The Interests are written in large blocks, or in blocks
+ * of random sizes with -f so that the messages are split at any byte. The program
+ * waits until the Rx Interest count of cefnetd grows by the number sent, and
+ * fails if it does not. With -P, the CPU time which cefnetd spent is reported.
+ * cefnetd counts only the Interests which got a PIT entry, so the number of the
+ * Interests must not exceed PIT_SIZE of cefnetd.conf.
+ */
+
+#define __CEF_BENCH_FLOOD_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_client.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_log.h>
+#include <cef_netd.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_flood"
+#define CefC_Bench_Write_Max		(1024 * 1024)
+#define CefC_Bench_Lifetime			1000		/* Interest Lifetime (msec) 			*/
+#define CefC_Bench_Status_Max		65536		/* status text to search 				*/
+#define CefC_Bench_Rx_Item			"Rx Interest      : "
+#define CefC_Bench_Idle_Max			3000000		/* gives up when the count stops (usec)	*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int64_t								/* Rx Interest of cefnetd, -1 if unknown 	*/
+cef_bench_rx_interest_get (
+	void
+);
+static int
+cef_bench_tcp_connect (
+	int port_num
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_CcnMsg_MsgBdy* tlvs;
+	unsigned char name[CefC_Bench_Key_Stride];
+	unsigned char* stream;
+	char conf_dir[PATH_MAX] = {0};
+	uint32_t num 	= 60000;
+	size_t write_size = 61440;
+	int frag_f 		= 0;
+	int port_num 	= CefC_Unset_Port;
+	pid_t pid 		= 0;
+	uint64_t seed 	= 1;
+	size_t stream_len = 0;
+	size_t off;
+	size_t len;
+	ssize_t res;
+	int64_t rx_start;
+	int64_t rx_now;
+	int64_t rx_last;
+	int64_t cpu_start = -1;
+	int64_t cpu_end = -1;
+	uint64_t start_t;
+	uint64_t sent_t;
+	uint64_t done_t;
+	uint64_t last_t;
+	int name_len;
+	int sock;
+	int opt;
+	uint32_t i;
+
+	while ((opt = getopt (argc, argv, "n:w:fP:p:d:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'w': {
+				write_size = (size_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'f': {
+				frag_f = 1;
+				break;
+			}
+			case 'P': {
+				pid = (pid_t) atoi (optarg);
+				break;
+			}
+			case 'p': {
+				port_num = atoi (optarg);
+				break;
+			}
+			case 'd': {
+				if (strlen (optarg) >= PATH_MAX) {
+					print_usage ();
+					return (1);
+				}
+				strcpy (conf_dir, optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 10000000) ||
+		(write_size < 1) || (write_size > CefC_Bench_Write_Max)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_log_init (CefC_Bench_Prog, 1);
+	cef_frame_init ();
+	if (cef_client_init (port_num, conf_dir) < 0) {
+		fprintf (stderr, "[%s] cef_client_init failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	port_num = cef_client_listen_port_get ();
+
+	/* Creates the Interests of the different Names in one stream 	*/
+	tlvs 	= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	stream 	= (unsigned char*) malloc ((size_t) num * CefC_Bench_Key_Stride * 2);
+	if ((tlvs == NULL) || (stream == NULL)) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	for (i = 0 ; i < num ; i++) {
+		name_len = cef_bench_name_create (name, i, 2, i);
+		res = cef_bench_interest_create (
+				&stream[stream_len], tlvs, name, (uint16_t) name_len, CefC_Bench_Lifetime);
+		if (res < 1) {
+			fprintf (stderr, "[%s] the Interest could not be created\n", CefC_Bench_Prog);
+			return (1);
+		}
+		stream_len += (size_t) res;
+	}
+	free (tlvs);
+
+	rx_start = cef_bench_rx_interest_get ();
+	if (rx_start < 0) {
+		fprintf (stderr, "[%s] the status of cefnetd could not be obtained\n",
+			CefC_Bench_Prog);
+		return (1);
+	}
+	sock = cef_bench_tcp_connect (port_num);
+	if (sock < 0) {
+		fprintf (stderr, "[%s] could not connect to port %d\n", CefC_Bench_Prog, port_num);
+		return (1);
+	}
+	if (pid > 0) {
+		cpu_start = cef_bench_cpu_time_get (pid);
+	}
+
+	start_t = cef_bench_now_get ();
+	for (off = 0 ; off < stream_len ; off += (size_t) res) {
+		len = write_size;
+		if (frag_f) {
+			len = 1 + (size_t)(cef_bench_rand_get (&seed) % write_size);
+		}
+		if (len > stream_len - off) {
+			len = stream_len - off;
+		}
+		res = write (sock, &stream[off], len);
+		if (res < 0) {
+			if (errno == EINTR) {
+				res = 0;
+				continue;
+			}
+			fprintf (stderr, "[%s] write failed (%s)\n", CefC_Bench_Prog, strerror (errno));
+			close (sock);
+			return (1);
+		}
+	}
+	sent_t = cef_bench_now_get ();
+
+	/* Waits until cefnetd counts all the Interests or the count stops 	*/
+	rx_last = rx_start;
+	last_t 	= sent_t;
+	done_t 	= sent_t;
+	while (1) {
+		rx_now = cef_bench_rx_interest_get ();
+		done_t = cef_bench_now_get ();
+		if ((rx_now < 0) || (rx_now - rx_start >= (int64_t) num)) {
+			break;
+		}
+		if (rx_now != rx_last) {
+			rx_last = rx_now;
+			last_t 	= done_t;
+		} else if (done_t - last_t > CefC_Bench_Idle_Max) {
+			break;
+		}
+		usleep (10000);
+	}
+	if (pid > 0) {
+		cpu_end = cef_bench_cpu_time_get (pid);
+	}
+	close (sock);
+
+	cef_bench_result_print (CefC_Bench_Prog, "write",
+		(double) stream_len / ((sent_t - start_t) ? (sent_t - start_t) : 1), "MB/s");
+	cef_bench_result_print (CefC_Bench_Prog, "counted",
+		(double)(rx_now - rx_start), "Interests");
+	cef_bench_result_print (CefC_Bench_Prog, "until counted",
+		(double)(rx_now - rx_start) * 1000000 /
+			((done_t - start_t) ? (done_t - start_t) : 1), "Interests/s");
+	if ((cpu_start >= 0) && (cpu_end >= 0)) {
+		cef_bench_result_print (CefC_Bench_Prog, "cefnetd cpu",
+			(double)(cpu_end - cpu_start) / 1000000, "sec");
+		cef_bench_result_print (CefC_Bench_Prog, "cefnetd cpu/Interest",
+			(double)(cpu_end - cpu_start) * 1000 / num, "ns");
+	}
+
+	if (rx_now - rx_start != (int64_t) num) {
+		fprintf (stderr, "[%s] NG (%u Interests sent, %lld counted)\n",
+			CefC_Bench_Prog, num, (long long)(rx_now - rx_start));
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int64_t								/* Rx Interest of cefnetd, -1 if unknown 	*/
+cef_bench_rx_interest_get (
+	void
+) {
+	CefT_Client_Handle fhdl;
+	unsigned char buff[CefC_Max_Length];
+	char* text;
+	char* wp;
+	char* user;
+	unsigned long long value;
+	int64_t rx = -1;
+	int text_len = 0;
+	int len;
+	int res;
+
+	text = (char*) malloc (CefC_Bench_Status_Max + 1);
+	if (text == NULL) {
+		return (-1);
+	}
+	fhdl = cef_client_connect ();
+	if (fhdl < 1) {
+		free (text);
+		return (-1);
+	}
+
+	/* Requests the status as cefctrl does 	*/
+	len = sprintf ((char*) buff, "%s%s", CefC_Ctrl, CefC_Ctrl_Status);
+	memset (&buff[len], 0, CefC_Ctrl_User_Len);
+	user = getenv ("USER");
+	if (user) {
+		strncpy ((char*) &buff[len], user, CefC_Ctrl_User_Len - 1);
+	}
+	cef_client_message_input (fhdl, buff, len + CefC_Ctrl_User_Len);
+
+	/* Reads the status until the line of Rx Interest arrives 	*/
+	while (text_len < CefC_Bench_Status_Max) {
+		res = cef_client_read (fhdl, (unsigned char*) &text[text_len],
+				CefC_Bench_Status_Max - text_len);
+		if (res <= 0) {
+			break;
+		}
+		text_len += res;
+		text[text_len] = 0x00;
+
+		wp = strstr (text, CefC_Bench_Rx_Item);
+		if ((wp != NULL) && (strchr (wp, '\n') != NULL) &&
+			(sscanf (wp + strlen (CefC_Bench_Rx_Item), "%llu", &value) == 1)) {
+			rx = (int64_t) value;
+			break;
+		}
+	}
+	cef_client_close (fhdl);
+	free (text);
+
+	return (rx);
+}
+
+static int
+cef_bench_tcp_connect (
+	int port_num
+) {
+	struct sockaddr_in addr;
+	int sock;
+
+	sock = socket (AF_INET, SOCK_STREAM, 0);
+	if (sock < 0) {
+		return (-1);
+	}
+	memset (&addr, 0, sizeof (addr));
+	addr.sin_family 		= AF_INET;
+	addr.sin_port 			= htons ((uint16_t) port_num);
+	addr.sin_addr.s_addr 	= htonl (INADDR_LOOPBACK);
+
+	if (connect (sock, (struct sockaddr*) &addr, sizeof (addr)) < 0) {
+		close (sock);
+		return (-1);
+	}
+	return (sock);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n interests] [-w write_size] [-f] [-P pid] [-p port] "
+		"[-d config_file_dir]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  interests   Number of the Interests to send (up to PIT_SIZE)\n");
+	fprintf (stderr, "  write_size  Bytes written at once (1-%d)\n", CefC_Bench_Write_Max);
+	fprintf (stderr, "  -f          Writes random sizes up to write_size\n");
+	fprintf (stderr, "  pid         Process ID of cefnetd to obtain its CPU time\n");
+	fprintf (stderr, "  port        Port number of cefnetd\n");
+	fprintf (stderr, "  config_file_dir  Directory of cefnetd.conf\n\n");
+}
@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_fwd.c
+ *
+ * Measures the forwarding rate of a running cefnetd with pairs of a consumer and a
+ * producer on UDP sockets. Each of the -t pairs runs on its own thread. The
+ * program adds the route of ccnx:/t<pair> to the producer socket of each pair as
+ * cefroute does, keeps up to -w Interests outstanding from each consumer socket,
+ * and answers each Interest at the producer socket with a Content Object of the
+ * same Name. The Names of each pair are spread over -k prefixes, so that
+ * FORWARDING_WORKERS of cefnetd.conf spreads them over the workers. With several
+ * pairs, the rate is not bound by a single thread of this program, so the scaling
+ * of cefnetd over the workers can be measured on a host with enough cores. The
+ * Interests of which no Content Object returns within a second are counted as
+ * lost. With -P, the CPU time which cefnetd spent is reported. CS_MODE must be 0.
+ */
+
+#define __CEF_BENCH_FWD_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_client.h>
+#include <cefore/cef_fib.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_log.h>
+#include <cef_netd.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_fwd"
+#define CefC_Bench_Lifetime			2000		/* Interest Lifetime (msec) 			*/
+#define CefC_Bench_Wait				1000		/* waits for the Content Objects (msec) */
+#define CefC_Bench_Window_Max		4096
+#define CefC_Bench_Prefix_Max		65536
+#define CefC_Bench_Pair_Max			16
+#define CefC_Bench_Producer_Port	9897
+#define CefC_Bench_Route_Wait		10000		/* after each route message (usec) 		*/
+#define CefC_Bench_Pair_Seg_Len		8			/* Name Segment of the pair 			*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/* Consumer and producer run by a thread 	*/
+typedef struct {
+	int 				cons_sock;
+	int 				prod_sock;
+	int 				idx;				/* index of the pair 						*/
+	uint32_t 			num;				/* Content Objects to forward 				*/
+	uint32_t 			sent;
+	uint32_t 			recv_num;
+	uint32_t 			lost;
+	uint32_t 			produced;
+	int 				err;
+	CefT_CcnMsg_MsgBdy* tlvs;				/* work area to create the Interests 		*/
+	CefT_CcnMsg_MsgBdy* obj;				/* work area to create the Content Objects 	*/
+	CefT_CcnMsg_MsgBdy* pm;					/* work area to parse the Interests 		*/
+	pthread_t 			th;
+} CefT_Bench_Pair;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static int bench_window 	= 64;
+static int bench_prefixes 	= 64;
+static int bench_size 		= 1024;
+static unsigned char* bench_payload = NULL;
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int
+cef_bench_route_add (
+	CefT_Client_Handle fhdl,
+	int idx,								/* index of the pair 						*/
+	int port_num							/* port of the producer socket 				*/
+);
+static int									/* length of the Name 						*/
+cef_bench_pair_name_create (
+	unsigned char* buff,
+	int idx,								/* index of the pair 						*/
+	uint32_t id,							/* Name prefix in the pair 					*/
+	uint32_t chunk
+);
+static int
+cef_bench_udp_open (
+	int local_port,							/* 0 to bind any port 						*/
+	int peer_port							/* port of cefnetd 							*/
+);
+static void*
+cef_bench_pair_thread (
+	void* arg
+);
+static int									/* Content Objects sent 					*/
+cef_bench_producer_process (
+	CefT_Bench_Pair* pr
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Pair pairs[CefC_Bench_Pair_Max];
+	CefT_Bench_Pair* pr;
+	CefT_Client_Handle fhdl;
+	char conf_dir[PATH_MAX] = {0};
+	uint32_t num 	= 100000;
+	int pair_num 	= 1;
+	int port_num 	= CefC_Unset_Port;
+	int prod_port 	= CefC_Bench_Producer_Port;
+	pid_t pid 		= 0;
+	uint32_t sent 	= 0;
+	uint32_t recv_num = 0;
+	uint32_t lost 	= 0;
+	uint32_t produced = 0;
+	int64_t cpu_start = -1;
+	int64_t cpu_end = -1;
+	uint64_t start_t;
+	uint64_t done_t;
+	int err = 0;
+	int opt;
+	int i;
+
+	while ((opt = getopt (argc, argv, "n:w:k:s:t:P:p:u:d:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'w': {
+				bench_window = atoi (optarg);
+				break;
+			}
+			case 'k': {
+				bench_prefixes = atoi (optarg);
+				break;
+			}
+			case 's': {
+				bench_size = atoi (optarg);
+				break;
+			}
+			case 't': {
+				pair_num = atoi (optarg);
+				break;
+			}
+			case 'P': {
+				pid = (pid_t) atoi (optarg);
+				break;
+			}
+			case 'p': {
+				port_num = atoi (optarg);
+				break;
+			}
+			case 'u': {
+				prod_port = atoi (optarg);
+				break;
+			}
+			case 'd': {
+				if (strlen (optarg) >= PATH_MAX) {
+					print_usage ();
+					return (1);
+				}
+				strcpy (conf_dir, optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 100000000) ||
+		(bench_window < 1) || (bench_window > CefC_Bench_Window_Max) ||
+		(bench_prefixes < 1) || (bench_prefixes > CefC_Bench_Prefix_Max) ||
+		(bench_size < 1) || (bench_size > CefC_Max_Length / 2) ||
+		(pair_num < 1) || (pair_num > CefC_Bench_Pair_Max) ||
+		(prod_port < 1) || (prod_port + pair_num - 1 > 65535)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_log_init (CefC_Bench_Prog, 1);
+	cef_frame_init ();
+	if (cef_client_init (port_num, conf_dir) < 0) {
+		fprintf (stderr, "[%s] cef_client_init failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	port_num = cef_client_listen_port_get ();
+
+	bench_payload = (unsigned char*) malloc ((size_t) bench_size);
+	if (bench_payload == NULL) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	memset (bench_payload, 0x55, (size_t) bench_size);
+
+	/* Each pair forwards its share of the Content Objects over its own prefixes 	*/
+	memset (pairs, 0, sizeof (pairs));
+	for (i = 0 ; i < pair_num ; i++) {
+		pr = &pairs[i];
+		pr->idx 		= i;
+		pr->num 		= num / (uint32_t) pair_num +
+							(((uint32_t) i < num % (uint32_t) pair_num) ? 1 : 0);
+		pr->tlvs 		= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+		pr->obj 		= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+		pr->pm 			= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+		if ((pr->tlvs == NULL) || (pr->obj == NULL) || (pr->pm == NULL)) {
+			fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+			return (1);
+		}
+		pr->prod_sock = cef_bench_udp_open (prod_port + i, port_num);
+		pr->cons_sock = cef_bench_udp_open (0, port_num);
+		if ((pr->prod_sock < 0) || (pr->cons_sock < 0)) {
+			fprintf (stderr, "[%s] the UDP sockets could not be opened\n", CefC_Bench_Prog);
+			return (1);
+		}
+	}
+
+	fhdl = cef_client_connect ();
+	if (fhdl < 1) {
+		fprintf (stderr, "[%s] cefnetd could not be connected\n", CefC_Bench_Prog);
+		return (1);
+	}
+	for (i = 0 ; i < pair_num ; i++) {
+		if (cef_bench_route_add (fhdl, i, prod_port + i) < 0) {
+			fprintf (stderr, "[%s] the route could not be added\n", CefC_Bench_Prog);
+			return (1);
+		}
+	}
+	usleep (100000);
+	cef_client_close (fhdl);
+
+	if (pid > 0) {
+		cpu_start = cef_bench_cpu_time_get (pid);
+	}
+	start_t = cef_bench_now_get ();
+	for (i = 0 ; i < pair_num ; i++) {
+		if (pthread_create (&pairs[i].th, NULL, cef_bench_pair_thread, &pairs[i]) != 0) {
+			fprintf (stderr, "[%s] pthread_create failed\n", CefC_Bench_Prog);
+			return (1);
+		}
+	}
+	for (i = 0 ; i < pair_num ; i++) {
+		pthread_join (pairs[i].th, NULL);
+	}
+	done_t = cef_bench_now_get ();
+	if (pid > 0) {
+		cpu_end = cef_bench_cpu_time_get (pid);
+	}
+
+	for (i = 0 ; i < pair_num ; i++) {
+		pr = &pairs[i];
+		sent 		+= pr->sent;
+		recv_num 	+= pr->recv_num;
+		lost 		+= pr->lost;
+		produced 	+= pr->produced;
+		err 		+= pr->err;
+		close (pr->cons_sock);
+		close (pr->prod_sock);
+		free (pr->tlvs);
+		free (pr->obj);
+		free (pr->pm);
+	}
+	free (bench_payload);
+
+	cef_bench_result_print (CefC_Bench_Prog, "pairs", (double) pair_num, "");
+	cef_bench_result_print (CefC_Bench_Prog, "Interests sent", (double) sent, "");
+	cef_bench_result_print (CefC_Bench_Prog, "Objects produced", (double) produced, "");
+	cef_bench_result_print (CefC_Bench_Prog, "Objects received", (double) recv_num, "");
+	cef_bench_result_print (CefC_Bench_Prog, "lost", (double) lost, "");
+	cef_bench_result_print (CefC_Bench_Prog, "forwarded",
+		(double) recv_num * 1000000 / ((done_t - start_t) ? (done_t - start_t) : 1),
+		"Objects/s");
+	if ((cpu_start >= 0) && (cpu_end >= 0)) {
+		cef_bench_result_print (CefC_Bench_Prog, "cefnetd cpu",
+			(double)(cpu_end - cpu_start) / 1000000, "sec");
+		cef_bench_result_print (CefC_Bench_Prog, "cefnetd cpu/Object",
+			(double)(cpu_end - cpu_start) * 1000 / (recv_num ? recv_num : 1), "ns");
+	}
+
+	if ((err > 0) || (recv_num < num)) {
+		fprintf (stderr, "[%s] NG (%u Interests sent, %u Objects received)\n",
+			CefC_Bench_Prog, num, recv_num);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int
+cef_bench_route_add (
+	CefT_Client_Handle fhdl,
+	int idx,								/* index of the pair 						*/
+	int port_num							/* port of the producer socket 				*/
+) {
+	unsigned char buff[CefC_Max_Length];
+	char uri[64];
+	char host[64];
+	char* user;
+	uint16_t uri_len;
+	uint8_t host_len;
+	uint8_t op 		= CefC_Fib_Route_Ope_Add;
+	uint8_t prot 	= CefC_Fib_Route_Pro_UDP;
+	int len;
+
+	/* Creates the message as cefroute does 	*/
+	len = sprintf ((char*) buff, "%s%s", CefC_Ctrl, CefC_Ctrl_Route);
+	memset (&buff[len], 0, CefC_Ctrl_User_Len);
+	user = getenv ("USER");
+	if (user) {
+		strncpy ((char*) &buff[len], user, CefC_Ctrl_User_Len - 1);
+	}
+	len += CefC_Ctrl_User_Len;
+	buff[len++] = op;
+	buff[len++] = prot;
+	uri_len = (uint16_t) sprintf (uri, "ccnx:/t%d", idx);
+	memcpy (&buff[len], &uri_len, sizeof (uint16_t));
+	len += sizeof (uint16_t);
+	memcpy (&buff[len], uri, uri_len);
+	len += uri_len;
+	host_len = (uint8_t) sprintf (host, "127.0.0.1:%d", port_num);
+	buff[len++] = host_len;
+	memcpy (&buff[len], host, host_len);
+	len += host_len;
+
+	if (cef_client_message_input (fhdl, buff, len) < 0) {
+		return (-1);
+	}
+	/* cefnetd reads a control message at a time 	*/
+	usleep (CefC_Bench_Route_Wait);
+
+	return (0);
+}
+
+static int									/* length of the Name 						*/
+cef_bench_pair_name_create (
+	unsigned char* buff,
+	int idx,								/* index of the pair 						*/
+	uint32_t id,							/* Name prefix in the pair 					*/
+	uint32_t chunk
+) {
+	uint16_t tv;
+	int len;
+
+	/* The Name of cef_bench_name_create under the Name Segment of the pair 	*/
+	len = sprintf ((char*) &buff[4], "t%d", idx);
+	tv = htons (CefC_T_NAMESEGMENT);
+	memcpy (&buff[0], &tv, sizeof (uint16_t));
+	tv = htons ((uint16_t) len);
+	memcpy (&buff[2], &tv, sizeof (uint16_t));
+	len += 4;
+
+	return (len + cef_bench_name_create (&buff[len], id, 2, chunk));
+}
+
+static int
+cef_bench_udp_open (
+	int local_port,							/* 0 to bind any port 						*/
+	int peer_port							/* port of cefnetd 							*/
+) {
+	struct sockaddr_in addr;
+	int buff_size = 4 * 1024 * 1024;
+	int sock;
+
+	sock = socket (AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0) {
+		return (-1);
+	}
+	setsockopt (sock, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof (buff_size));
+	setsockopt (sock, SOL_SOCKET, SO_SNDBUF, &buff_size, sizeof (buff_size));
+
+	memset (&addr, 0, sizeof (addr));
+	addr.sin_family 		= AF_INET;
+	addr.sin_port 			= htons ((uint16_t) local_port);
+	addr.sin_addr.s_addr 	= htonl (INADDR_LOOPBACK);
+	if (bind (sock, (struct sockaddr*) &addr, sizeof (addr)) < 0) {
+		close (sock);
+		return (-1);
+	}
+
+	/* cefnetd finds the Face from the source address and port 	*/
+	addr.sin_port = htons ((uint16_t) peer_port);
+	if (connect (sock, (struct sockaddr*) &addr, sizeof (addr)) < 0) {
+		close (sock);
+		return (-1);
+	}
+	return (sock);
+}
+
+static void*
+cef_bench_pair_thread (
+	void* arg
+) {
+	CefT_Bench_Pair* pr = (CefT_Bench_Pair*) arg;
+	unsigned char name[CefC_Bench_Key_Stride + CefC_Bench_Pair_Seg_Len];
+	unsigned char buff[CefC_Max_Length];
+	struct pollfd fds[2];
+	int outstanding = 0;
+	ssize_t res;
+	int name_len;
+
+	fds[0].fd 		= pr->cons_sock;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= pr->prod_sock;
+	fds[1].events 	= POLLIN;
+
+	while ((pr->sent < pr->num) || (outstanding > 0)) {
+		/* Fills the window with the Interests of the new Names 	*/
+		while ((outstanding < bench_window) && (pr->sent < pr->num)) {
+			name_len = cef_bench_pair_name_create (name, pr->idx,
+				pr->sent % (uint32_t) bench_prefixes, pr->sent);
+			res = cef_bench_interest_create (
+					buff, pr->tlvs, name, (uint16_t) name_len, CefC_Bench_Lifetime);
+			if (res < 1) {
+				fprintf (stderr, "[%s] the Interest could not be created\n",
+					CefC_Bench_Prog);
+				pr->err++;
+				return (NULL);
+			}
+			if (send (pr->cons_sock, buff, (size_t) res, 0) < 0) {
+				if ((errno == EAGAIN) || (errno == ENOBUFS)) {
+					break;
+				}
+				fprintf (stderr, "[%s] send failed (%s)\n",
+					CefC_Bench_Prog, strerror (errno));
+				pr->err++;
+				return (NULL);
+			}
+			pr->sent++;
+			outstanding++;
+		}
+
+		if (poll (fds, 2, CefC_Bench_Wait) == 0) {
+			/* The Interests or the Content Objects were dropped 	*/
+			pr->lost += (uint32_t) outstanding;
+			outstanding = 0;
+			continue;
+		}
+		if (fds[1].revents & POLLIN) {
+			pr->produced += (uint32_t) cef_bench_producer_process (pr);
+		}
+		if (fds[0].revents & POLLIN) {
+			while ((res = recv (pr->cons_sock, buff, sizeof (buff), MSG_DONTWAIT)) > 0) {
+				if ((res > CefC_S_Fix_Header) && (buff[1] == CefC_PT_OBJECT)) {
+					pr->recv_num++;
+					if (outstanding > 0) {
+						outstanding--;
+					}
+				}
+			}
+		}
+	}
+	return (NULL);
+}
+
+static int									/* Content Objects sent 					*/
+cef_bench_producer_process (
+	CefT_Bench_Pair* pr
+) {
+	CefT_CcnMsg_MsgBdy* pm 		= pr->pm;
+	CefT_CcnMsg_MsgBdy* tlvs 	= pr->obj;
+	CefT_CcnMsg_OptHdr poh;
+	CefT_CcnMsg_OptHdr opt;
+	unsigned char msg[CefC_Max_Length];
+	unsigned char buff[CefC_Max_Length];
+	ssize_t res;
+	int len;
+	int num = 0;
+
+	while ((res = recv (pr->prod_sock, msg, sizeof (msg), MSG_DONTWAIT)) > 0) {
+		if ((res <= CefC_S_Fix_Header) || (msg[1] != CefC_PT_INTEREST)) {
+			continue;
+		}
+		memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+		if (cef_bench_message_parse (msg, &poh, pm, CefC_PT_INTEREST) < 0) {
+			continue;
+		}
+
+		/* The Name in pm has the Chunk Number, so that it is copied as it is 	*/
+		memset (&opt, 0, sizeof (CefT_CcnMsg_OptHdr));
+		memcpy (tlvs->name, pm->name, pm->name_len);
+		tlvs->name_len 	= pm->name_len;
+		tlvs->chunk_num_f = 0;
+		tlvs->expiry 	= 3600000;
+		memcpy (tlvs->payload, bench_payload, bench_size);
+		tlvs->payload_len = (uint16_t) bench_size;
+
+		len = cef_frame_object_create (buff, &opt, tlvs);
+		if ((len > 0) && (send (pr->prod_sock, buff, (size_t) len, 0) > 0)) {
+			num++;
+		}
+	}
+	return (num);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n objects] [-w window] [-k prefixes] [-s size] [-t pairs] "
+		"[-P pid] [-p port] [-u producer_port] [-d config_file_dir]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  objects        Number of the Content Objects to forward\n");
+	fprintf (stderr, "  window         Interests outstanding at once in each pair (1-%d)\n",
+		CefC_Bench_Window_Max);
+	fprintf (stderr, "  prefixes       Number of the Name prefixes of each pair (1-%d)\n",
+		CefC_Bench_Prefix_Max);
+	fprintf (stderr, "  size           Payload bytes of a Content Object\n");
+	fprintf (stderr, "  pairs          Consumer and producer pairs run on threads (1-%d)\n",
+		CefC_Bench_Pair_Max);
+	fprintf (stderr, "  pid            Process ID of cefnetd to obtain its CPU time\n");
+	fprintf (stderr, "  port           Port number of cefnetd\n");
+	fprintf (stderr, "  producer_port  UDP port of the producer socket of the first pair;\n"
+		"                 the next pairs use the next ports (default %d)\n",
+		CefC_Bench_Producer_Port);
+	fprintf (stderr, "  config_file_dir  Directory of cefnetd.conf\n\n");
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_hash.c
+ *
+ * Compares the hash algorithms of CefT_Hash (MD5 and the seeded xxHash64) by the
+ * time to hash a Name and by the set, hit and miss rates of a table filled with
+ * Names. Every lookup is checked against the stored element.
+ */
+
+#define __CEF_BENCH_HASH_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_hash.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_hash"
+/* An element is the index of the key plus one, so that no element is NULL 	*/
+#define cef_bench_elem_make(idx)	((void*)(uintptr_t)((idx) + 1))
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	int alg,								/* CefC_Hash_Alg_XXX 						*/
+	const CefT_Bench_Keys* hits,			/* keys stored in the table 				*/
+	const CefT_Bench_Keys* misses,			/* keys not stored in the table 			*/
+	int rounds
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Keys hits;
+	CefT_Bench_Keys misses;
+	uint32_t num 	= 10000;
+	int depth 		= 3;
+	int rounds 		= 5;
+	int err = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "n:d:r:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'd': {
+				depth = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 10000000) ||
+		(depth < 1) || (depth > CefC_Bench_Depth_Max) || (rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+	if ((cef_bench_keys_create (&hits, 0, num, depth) < 0) ||
+		(cef_bench_keys_create (&misses, num, num, depth) < 0)) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	err += cef_bench_run (CefC_Hash_Alg_MD5, &hits, &misses, rounds);
+	err += cef_bench_run (CefC_Hash_Alg_XXH64, &hits, &misses, rounds);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	int alg,								/* CefC_Hash_Alg_XXX 						*/
+	const CefT_Bench_Keys* hits,			/* keys stored in the table 				*/
+	const CefT_Bench_Keys* misses,			/* keys not stored in the table 			*/
+	int rounds
+) {
+	CefT_Hash_Func func = cef_hash_func_get (alg);
+	CefT_Hash_Handle tbl;
+	const char* alg_str = (alg == CefC_Hash_Alg_MD5) ? "md5" : "xxh64";
+	char item_str[64];
+	uint64_t start_t;
+	uint64_t set_t;
+	uint64_t hash_t = 0;
+	uint64_t hit_t = 0;
+	uint64_t miss_t = 0;
+	uint32_t seed = cef_hash_seed_get ();
+	uint32_t sum = 0;
+	uint32_t i;
+	void* elem;
+	int err = 0;
+	int r;
+
+	/* Hash function only. The sum keeps the calls from being optimized out. 	*/
+	for (r = 0 ; r < rounds ; r++) {
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < hits->num ; i++) {
+			sum += func (seed, cef_bench_key_get (hits, i),
+				hits->lens[i]);
+		}
+		hash_t += cef_bench_now_get () - start_t;
+	}
+
+	tbl = cef_hash_tbl_create_with_alg (hits->num, CefC_Hash_Coef_PIT, alg);
+	if (tbl == (CefT_Hash_Handle) NULL) {
+		fprintf (stderr, "[%s] cef_hash_tbl_create_with_alg failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	start_t = cef_bench_now_get ();
+	for (i = 0 ; i < hits->num ; i++) {
+		if (cef_hash_tbl_item_set (tbl, cef_bench_key_get (hits, i),
+				hits->lens[i], cef_bench_elem_make (i)) < 0) {
+			err++;
+		}
+	}
+	set_t = cef_bench_now_get () - start_t;
+	if (err > 0) {
+		fprintf (stderr, "[%s] %s: %d keys could not be set\n",
+			CefC_Bench_Prog, alg_str, err);
+	}
+
+	for (r = 0 ; r < rounds ; r++) {
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < hits->num ; i++) {
+			elem = cef_hash_tbl_item_get (tbl,
+				cef_bench_key_get (hits, i), hits->lens[i]);
+			if (elem != cef_bench_elem_make (i)) {
+				err++;
+			}
+		}
+		hit_t += cef_bench_now_get () - start_t;
+
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < misses->num ; i++) {
+			elem = cef_hash_tbl_item_get (tbl,
+				cef_bench_key_get (misses, i), misses->lens[i]);
+			if (elem != NULL) {
+				err++;
+			}
+		}
+		miss_t += cef_bench_now_get () - start_t;
+	}
+	cef_hash_tbl_destroy (tbl);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] %s: %d lookups returned a wrong element\n",
+			CefC_Bench_Prog, alg_str, err);
+	}
+	sprintf (item_str, "%s hash", alg_str);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) hash_t * 1000 / ((double) hits->num * rounds), "ns/key");
+	sprintf (item_str, "%s set", alg_str);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) hits->num / (set_t ? set_t : 1), "Mops/s");
+	sprintf (item_str, "%s get hit", alg_str);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) hits->num * rounds / (hit_t ? hit_t : 1), "Mops/s");
+	sprintf (item_str, "%s get miss", alg_str);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) misses->num * rounds / (miss_t ? miss_t : 1), "Mops/s");
+	if (sum == 0) {
+		fprintf (stderr, "[%s] %s: all hash values are zero\n", CefC_Bench_Prog, alg_str);
+	}
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n keys] [-d depth] [-r rounds]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  keys    Number of the Names stored in the table\n");
+	fprintf (stderr, "  depth   Name Segments of each Name (1-%d)\n", CefC_Bench_Depth_Max);
+	fprintf (stderr, "  rounds  Times to repeat the hash and the lookups\n\n");
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_htbl.c
+ *
+ * Reports the memory footprint and the probe latency of CefT_Hash tables made by
+ * cef_hash_tbl_create. The table is created for -c entries as cefnetd creates it
+ * for FIB_SIZE and filled with -n Names. The memory is the growth of the mapped
+ * and of the resident size of the process in /proc/self/statm, since the large
+ * tables are mapped rather than taken from the heap. The lookups go in a random
+ * order, and the misses are Names which are not stored. Every lookup is checked.
+ */
+
+#define __CEF_BENCH_HTBL_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_hash.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_htbl"
+/* An element is the index of the key plus one, so that no element is NULL 	*/
+#define cef_bench_elem_make(idx)	((void*)(uintptr_t)((idx) + 1))
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int									/* -1 if the sizes are unknown 				*/
+cef_bench_mem_get (
+	int64_t* mapped,						/* mapped bytes 							*/
+	int64_t* resident						/* resident bytes 							*/
+);
+static void
+cef_bench_mem_print (
+	const char* item,
+	int64_t mapped,
+	int64_t resident
+);
+static uint32_t*
+cef_bench_order_create (
+	uint32_t num,
+	uint64_t seed
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Keys hits;
+	CefT_Bench_Keys misses;
+	CefT_Hash_Handle tbl;
+	uint32_t* order;
+	uint32_t num 	= 100000;
+	uint32_t size 	= 0;
+	int depth 		= 3;
+	int rounds 		= 5;
+	int64_t vm[3] = {0};
+	int64_t rss[3] = {0};
+	int mem_f;
+	uint64_t start_t;
+	uint64_t create_t;
+	uint64_t set_t;
+	uint64_t hit_t = 0;
+	uint64_t miss_t = 0;
+	uint64_t ops;
+	uint32_t i;
+	uint32_t k;
+	void* elem;
+	int err = 0;
+	int opt;
+	int r;
+
+	while ((opt = getopt (argc, argv, "n:c:d:r:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'c': {
+				size = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'd': {
+				depth = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if (size == 0) {
+		size = num;
+	}
+	if ((num < 1) || (num > 10000000) || (size < num) || (size > 16777216) ||
+		(depth < 1) || (depth > CefC_Bench_Depth_Max) || (rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+	if ((cef_bench_keys_create (&hits, 0, num, depth) < 0) ||
+		(cef_bench_keys_create (&misses, num, num, depth) < 0)) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	order = cef_bench_order_create (num, 1);
+	if (order == NULL) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	mem_f = cef_bench_mem_get (&vm[0], &rss[0]);
+	start_t = cef_bench_now_get ();
+	tbl = cef_hash_tbl_create (size);
+	create_t = cef_bench_now_get () - start_t;
+	if (tbl == (CefT_Hash_Handle) NULL) {
+		fprintf (stderr, "[%s] cef_hash_tbl_create failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	mem_f |= cef_bench_mem_get (&vm[1], &rss[1]);
+
+	start_t = cef_bench_now_get ();
+	for (i = 0 ; i < num ; i++) {
+		if (cef_hash_tbl_item_set (tbl, cef_bench_key_get (&hits, i),
+				hits.lens[i], cef_bench_elem_make (i)) < 0) {
+			err++;
+		}
+	}
+	set_t = cef_bench_now_get () - start_t;
+	mem_f |= cef_bench_mem_get (&vm[2], &rss[2]);
+	if (err > 0) {
+		fprintf (stderr, "[%s] %d keys could not be set\n", CefC_Bench_Prog, err);
+	}
+
+	for (r = 0 ; r < rounds ; r++) {
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < num ; i++) {
+			k = order[i];
+			elem = cef_hash_tbl_item_get (tbl, cef_bench_key_get (&hits, k), hits.lens[k]);
+			if (elem != cef_bench_elem_make (k)) {
+				err++;
+			}
+		}
+		hit_t += cef_bench_now_get () - start_t;
+
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < num ; i++) {
+			k = order[i];
+			elem = cef_hash_tbl_item_get (
+				tbl, cef_bench_key_get (&misses, k), misses.lens[k]);
+			if (elem != NULL) {
+				err++;
+			}
+		}
+		miss_t += cef_bench_now_get () - start_t;
+	}
+	cef_hash_tbl_destroy (tbl);
+
+	ops = (uint64_t) num * rounds;
+	cef_bench_result_print (CefC_Bench_Prog, "create",
+		(double) create_t / 1000, "ms");
+	if (mem_f == 0) {
+		cef_bench_mem_print ("empty", vm[1] - vm[0], rss[1] - rss[0]);
+		cef_bench_mem_print ("filled", vm[2] - vm[0], rss[2] - rss[0]);
+		cef_bench_result_print (CefC_Bench_Prog, "resident per entry",
+			(double)(rss[2] - rss[0]) / num, "bytes");
+	}
+	cef_bench_result_print (CefC_Bench_Prog, "set",
+		(double) set_t * 1000 / num, "ns/op");
+	cef_bench_result_print (CefC_Bench_Prog, "get hit",
+		(double) hit_t * 1000 / ops, "ns/op");
+	cef_bench_result_print (CefC_Bench_Prog, "get miss",
+		(double) miss_t * 1000 / ops, "ns/op");
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int									/* -1 if the sizes are unknown 				*/
+cef_bench_mem_get (
+	int64_t* mapped,						/* mapped bytes 							*/
+	int64_t* resident						/* resident bytes 							*/
+) {
+	long long pages[2];
+	long page_size = sysconf (_SC_PAGESIZE);
+	FILE* fp;
+	int res;
+
+	fp = fopen ("/proc/self/statm", "r");
+	if (fp == NULL) {
+		return (-1);
+	}
+	res = fscanf (fp, "%lld %lld", &pages[0], &pages[1]);
+	fclose (fp);
+	if ((res != 2) || (page_size <= 0)) {
+		return (-1);
+	}
+	*mapped 	= (int64_t) pages[0] * page_size;
+	*resident 	= (int64_t) pages[1] * page_size;
+
+	return (0);
+}
+
+static void
+cef_bench_mem_print (
+	const char* item,
+	int64_t mapped,
+	int64_t resident
+) {
+	char item_str[64];
+
+	sprintf (item_str, "%s mapped", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) mapped / (1024 * 1024), "MB");
+	sprintf (item_str, "%s resident", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) resident / (1024 * 1024), "MB");
+}
+
+static uint32_t*
+cef_bench_order_create (
+	uint32_t num,
+	uint64_t seed
+) {
+	uint32_t* order;
+	uint32_t tmp;
+	uint32_t i;
+	uint32_t j;
+
+	order = (uint32_t*) malloc (sizeof (uint32_t) * num);
+	if (order == NULL) {
+		return (NULL);
+	}
+	for (i = 0 ; i < num ; i++) {
+		order[i] = i;
+	}
+	/* Fisher-Yates shuffle 	*/
+	for (i = num - 1 ; i > 0 ; i--) {
+		j = (uint32_t)(cef_bench_rand_get (&seed) % (i + 1));
+		tmp 		= order[i];
+		order[i] 	= order[j];
+		order[j] 	= tmp;
+	}
+	return (order);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n keys] [-c size] [-d depth] [-r rounds]\n\n",
+		CefC_Bench_Prog);
+	fprintf (stderr, "  keys    Number of the Names stored in the table\n");
+	fprintf (stderr, "  size    Size given to cef_hash_tbl_create (keys-16777216)\n");
+	fprintf (stderr, "  depth   Name Segments of each Name (1-%d)\n", CefC_Bench_Depth_Max);
+	fprintf (stderr, "  rounds  Times to repeat the lookups\n\n");
+}
@@ -0,0 +1,662 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_memcache.c
+ *
+ * Drives the memory cache plugin of csmgrd with mixed gets and puts. The puts are
+ * the Upload Requests which cefnetd sends, passed to cache_item_puts as csmgrd
+ * does. The getter threads send the Cobs to their own sockets, which are read by
+ * the drain threads. With -S, the socket of the first getter is read slowly like
+ * a busy cefnetd. The puts are timed until all the Cobs can be looked up, alone
+ * and while the getters run. Every get of a stored Cob must hit.
+ *
+ * The plugin uses a named semaphore of the fixed name, so do not run this
+ * program while csmgrd with the memory cache is running.
+ */
+
+#define __CEF_BENCH_MEMCACHE_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_client.h>
+#include <cefore/cef_csmgr.h>
+#include <cefore/cef_csmgr_stat.h>
+#include <cefore/cef_frame.h>
+#include <csmgrd/csmgrd_plugin.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_memcache"
+#define CefC_Bench_Getter_Max		16
+#define CefC_Bench_Chunk_Num		64			/* Chunks of a content 					*/
+#define CefC_Bench_Puts_Len			65536		/* bytes passed to cache_item_puts 		*/
+#define CefC_Bench_Cache_Sec		3600		/* Cache Time and Expiry of the Cobs 	*/
+#define CefC_Bench_Slow_Read		4096		/* bytes the slow drain reads at once 	*/
+#define CefC_Bench_Slow_Wait		1000		/* usec between the reads of slow drain	*/
+#define CefC_Bench_Put_Wait_Max		30000000	/* gives up waiting for the puts (usec)	*/
+
+/* Library which csmgrd loads the plugins from 	*/
+#ifdef __APPLE__
+#define CefC_Bench_Plugin_Lib		"libcsmgrd_plugin.dylib"
+#else // __APPLE__
+#define CefC_Bench_Plugin_Lib		"libcsmgrd_plugin.so"
+#endif // __APPLE__
+
+/* Length of the Chunk Number TLV at the tail of the Names of cef_bench_name_create */
+#define CefC_Bench_Chunk_Tlv_Len	(CefC_S_TLF + CefC_S_ChunkNum)
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/* Cobs of one phase, as the Upload Requests and as the Names to get them 	*/
+typedef struct {
+	CefT_Bench_Keys 	names;				/* Names with the Chunk Number 				*/
+	uint32_t 			base;				/* Chunk Number of the first Cob 			*/
+	unsigned char* 		reqs;				/* Upload Requests 							*/
+	size_t 				reqs_len;
+} CefT_Bench_Cobs;
+
+typedef struct {
+	CsmgrdT_Plugin_Interface* 	cs;
+	const CefT_Bench_Cobs* 		cobs;		/* Cobs stored before the getters start 	*/
+	int 				sock;				/* socket which the Cobs are sent to 		*/
+	uint64_t 			seed;
+	uint64_t 			gets;
+	uint64_t 			misses;
+	uint64_t 			max_t;				/* the longest get (usec) 					*/
+	pthread_t 			th;
+} CefT_Bench_Getter;
+
+typedef struct {
+	int 				sock;
+	int 				slow_f;
+	uint64_t 			bytes;
+	pthread_t 			th;
+} CefT_Bench_Drain;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static volatile int bench_run_f = 0;		/* the getters run while it is 1 			*/
+static volatile int bench_drain_f = 0;		/* the drains run while it is 1 			*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int
+cef_bench_cobs_create (
+	CefT_Bench_Cobs* cobs,
+	uint32_t base,							/* index of the first Cob 					*/
+	uint32_t num,
+	int payload_len
+);
+static uint64_t								/* usec until all Cobs were stored, 0 if not*/
+cef_bench_cobs_put (
+	CsmgrdT_Plugin_Interface* cs,
+	const CefT_Bench_Cobs* cobs
+);
+static void*
+cef_bench_getter_thread (
+	void* arg
+);
+static void*
+cef_bench_drain_thread (
+	void* arg
+);
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CsmgrdT_Plugin_Interface* cs,
+	const char* item,
+	const CefT_Bench_Cobs* stored,			/* Cobs the getters get 					*/
+	const CefT_Bench_Cobs* put,				/* Cobs put while the getters run 			*/
+	int getter_num,
+	int slow_f
+);
+static int
+cef_bench_conf_write (
+	const char* dir,
+	uint32_t capacity
+);
+static int
+cef_bench_plugin_load (
+	CsmgrdT_Plugin_Interface* cs,
+	const char* dir
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CsmgrdT_Plugin_Interface cs;
+	CsmgrT_Stat_Handle stat_hdl;
+	CefT_Bench_Cobs cobs[4];
+	char dir[] = "/tmp/cefbench_memcache_XXXXXX";
+	char path[PATH_MAX];
+	uint32_t num 	= 20000;
+	int getter_num 	= 2;
+	int payload_len = 1024;
+	int slow_f 		= 0;
+	uint64_t put_t;
+	int err = 0;
+	int opt;
+	int i;
+
+	while ((opt = getopt (argc, argv, "n:g:s:Sh")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'g': {
+				getter_num = atoi (optarg);
+				break;
+			}
+			case 's': {
+				payload_len = atoi (optarg);
+				break;
+			}
+			case 'S': {
+				slow_f = 1;
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 1000000) ||
+		(getter_num < 1) || (getter_num > CefC_Bench_Getter_Max) ||
+		(payload_len < 1) || (payload_len > CefC_Max_Length / 2)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_frame_init ();
+	for (i = 0 ; i < 4 ; i++) {
+		if (cef_bench_cobs_create (&cobs[i], num * i, num, payload_len) < 0) {
+			fprintf (stderr, "[%s] the Cobs could not be created\n", CefC_Bench_Prog);
+			return (1);
+		}
+	}
+
+	/* The plugin reads csmgrd.conf from the directory 	*/
+	if (mkdtemp (dir) == NULL) {
+		fprintf (stderr, "[%s] mkdtemp failed (%s)\n", CefC_Bench_Prog, strerror (errno));
+		return (1);
+	}
+	if (cef_bench_conf_write (dir, num * 8) < 0) {
+		fprintf (stderr, "[%s] csmgrd.conf could not be written\n", CefC_Bench_Prog);
+		rmdir (dir);
+		return (1);
+	}
+	memset (&cs, 0, sizeof (CsmgrdT_Plugin_Interface));
+	stat_hdl = csmgrd_stat_handle_create ();
+	if ((cef_bench_plugin_load (&cs, dir) < 0) ||
+		(stat_hdl == CsmgrC_Invalid) || (cs.init (stat_hdl, 1) < 0)) {
+		fprintf (stderr, "[%s] the memory cache could not be initialized\n",
+			CefC_Bench_Prog);
+		return (1);
+	}
+
+	/* Puts alone 	*/
+	put_t = cef_bench_cobs_put (&cs, &cobs[0]);
+	if (put_t == 0) {
+		err++;
+	}
+	cef_bench_result_print (CefC_Bench_Prog, "put alone",
+		put_t ? (double) num * 1000000 / put_t : 0, "cobs/s");
+
+	/* Gets alone, then gets and puts at once 	*/
+	err += cef_bench_run (&cs, "get alone", &cobs[0], NULL, getter_num, 0);
+	err += cef_bench_run (&cs, "mixed", &cobs[0], &cobs[1], getter_num, 0);
+	if (slow_f) {
+		err += cef_bench_run (&cs, "slow alone", &cobs[0], NULL, getter_num, 1);
+		err += cef_bench_run (&cs, "slow mixed", &cobs[0], &cobs[2], getter_num, 1);
+	}
+
+	cs.destroy (1);
+	csmgrd_stat_handle_destroy (stat_hdl);
+	sprintf (path, "%s/csmgrd.conf", dir);
+	unlink (path);
+	rmdir (dir);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int
+cef_bench_cobs_create (
+	CefT_Bench_Cobs* cobs,
+	uint32_t base,							/* index of the first Cob 					*/
+	uint32_t num,
+	int payload_len
+) {
+	CefT_CcnMsg_OptHdr opt;
+	CefT_CcnMsg_MsgBdy* params;
+	unsigned char* cob;
+	unsigned char* buff;
+	struct timeval tv;
+	uint64_t nowt;
+	uint64_t value64;
+	uint32_t value32;
+	uint16_t value16;
+	uint16_t prefix_len;
+	size_t index;
+	int cob_len;
+	uint32_t i;
+
+	cobs->names.buff = (unsigned char*) malloc ((size_t) num * CefC_Bench_Key_Stride);
+	cobs->names.lens = (uint16_t*) malloc (sizeof (uint16_t) * num);
+	cobs->reqs = (unsigned char*) malloc (
+		(size_t) num * (payload_len + CefC_Bench_Key_Stride * 3 + 128));
+	params 	= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	cob 	= (unsigned char*) malloc (CefC_Max_Length);
+	if ((cobs->names.buff == NULL) || (cobs->names.lens == NULL) ||
+		(cobs->reqs == NULL) || (params == NULL) || (cob == NULL)) {
+		free (params);
+		free (cob);
+		return (-1);
+	}
+	cobs->names.num = num;
+	cobs->base 		= base;
+	cobs->reqs_len 	= 0;
+
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec + CefC_Bench_Cache_Sec * 1000000llu;
+
+	memset (&opt, 0, sizeof (CefT_CcnMsg_OptHdr));
+	memset (params->payload, 0x5a, payload_len);
+	params->payload_len = (uint16_t) payload_len;
+	params->chunk_num_f = 1;
+
+	for (i = 0 ; i < num ; i++) {
+		/* A content has CefC_Bench_Chunk_Num Chunks 	*/
+		cobs->names.lens[i] = (uint16_t) cef_bench_name_create (
+			cef_bench_key_get (&cobs->names, i),
+			(base + i) / CefC_Bench_Chunk_Num, 2, base + i);
+		prefix_len = cobs->names.lens[i] - CefC_Bench_Chunk_Tlv_Len;
+
+		memcpy (params->name, cef_bench_key_get (&cobs->names, i), prefix_len);
+		params->name_len 	= prefix_len;
+		params->chunk_num 	= base + i;
+		cob_len = cef_frame_object_create (cob, &opt, params);
+		if (cob_len < 1) {
+			free (params);
+			free (cob);
+			return (-1);
+		}
+
+		/* Upload Request as cef_csmgr_excache_item_put creates 	*/
+		buff 	= &cobs->reqs[cobs->reqs_len];
+		index 	= CefC_Csmgr_Msg_HeaderLen;
+		buff[CefC_O_Fix_Ver]  = CefC_Version;
+		buff[CefC_O_Fix_Type] = CefC_Csmgr_Msg_Type_UpReq;
+
+		value16 = htons ((uint16_t) payload_len);
+		memcpy (&buff[index], &value16, CefC_S_Length);
+		index += CefC_S_Length;
+		value16 = htons ((uint16_t) cob_len);
+		memcpy (&buff[index], &value16, CefC_S_Length);
+		index += CefC_S_Length;
+		memcpy (&buff[index], cob, cob_len);
+		index += cob_len;
+
+		value16 = htons (prefix_len);
+		memcpy (&buff[index], &value16, CefC_S_Length);
+		index += CefC_S_Length;
+		memcpy (&buff[index], params->name, prefix_len);
+		index += prefix_len;
+		value32 = htonl (base + i);
+		memcpy (&buff[index], &value32, CefC_S_ChunkNum);
+		index += CefC_S_ChunkNum;
+		value64 = cef_client_htonb (nowt);
+		memcpy (&buff[index], &value64, CefC_S_Cachetime);
+		index += CefC_S_Cachetime;
+		memcpy (&buff[index], &value64, CefC_S_Expiry);
+		index += CefC_S_Expiry;
+		memset (&buff[index], 0, sizeof (struct in_addr));
+		index += sizeof (struct in_addr);
+		buff[index]   	= 0x63;
+		buff[index + 1] = 0x6f;
+		buff[index + 2] = 0x62;
+		index += 3;
+
+		value16 = htons ((uint16_t) index);
+		memcpy (&buff[CefC_O_Length], &value16, CefC_S_Length);
+		cobs->reqs_len += index;
+	}
+	free (params);
+	free (cob);
+
+	return (0);
+}
+
+static uint64_t								/* usec until all Cobs were stored, 0 if not*/
+cef_bench_cobs_put (
+	CsmgrdT_Plugin_Interface* cs,
+	const CefT_Bench_Cobs* cobs
+) {
+	uint32_t cache_time;
+	uint32_t lifetime;
+	uint64_t start_t;
+	uint64_t now_t;
+	uint16_t value16;
+	size_t off = 0;
+	size_t end;
+	size_t index;
+	uint32_t i = 0;
+	int res;
+
+	start_t = cef_bench_now_get ();
+
+	/* Passes the whole requests in the blocks which csmgrd passes. The plugin	*/
+	/* takes only what fits in its buffers, so the rest is passed again.		*/
+	while (off < cobs->reqs_len) {
+		end = off;
+		while (end < cobs->reqs_len) {
+			memcpy (&value16, &cobs->reqs[end + CefC_O_Length], CefC_S_Length);
+			if ((end > off) && (end + ntohs (value16) - off > CefC_Bench_Puts_Len)) {
+				break;
+			}
+			end += ntohs (value16);
+		}
+		index = off;
+		while (index < end) {
+			res = cs->cache_item_puts (&cobs->reqs[index], (int)(end - index));
+			if (res < 0) {
+				fprintf (stderr, "[%s] cache_item_puts failed\n", CefC_Bench_Prog);
+				return (0);
+			}
+			index += res;
+			if (index < end) {
+				sched_yield ();
+			}
+		}
+		off = end;
+	}
+
+	/* Waits until the writer thread stores the last Cob 	*/
+	while (i < cobs->names.num) {
+		if (cs->content_lifetime_get (cef_bench_key_get (&cobs->names, i),
+				cobs->names.lens[i], &cache_time, &lifetime, 0) > 0) {
+			i++;
+			continue;
+		}
+		now_t = cef_bench_now_get ();
+		if (now_t - start_t > CefC_Bench_Put_Wait_Max) {
+			fprintf (stderr, "[%s] %u of %u Cobs were not stored\n",
+				CefC_Bench_Prog, cobs->names.num - i, cobs->names.num);
+			return (0);
+		}
+		sched_yield ();
+	}
+	now_t = cef_bench_now_get ();
+
+	return ((now_t > start_t) ? now_t - start_t : 1);
+}
+
+static void*
+cef_bench_getter_thread (
+	void* arg
+) {
+	CefT_Bench_Getter* gt = (CefT_Bench_Getter*) arg;
+	const CefT_Bench_Keys* names = &gt->cobs->names;
+	uint64_t start_t;
+	uint64_t elapsed;
+	uint32_t idx;
+	int res;
+
+	while (bench_run_f) {
+		idx = (uint32_t)(cef_bench_rand_get (&gt->seed) % names->num);
+
+		start_t = cef_bench_now_get ();
+		res = gt->cs->cache_item_get (cef_bench_key_get (names, idx),
+				names->lens[idx] - CefC_Bench_Chunk_Tlv_Len, gt->cobs->base + idx,
+				gt->sock, NULL, 0);
+		elapsed = cef_bench_now_get () - start_t;
+
+		if (res != CefC_Csmgr_Cob_Exist) {
+			gt->misses++;
+		}
+		if (elapsed > gt->max_t) {
+			gt->max_t = elapsed;
+		}
+		gt->gets++;
+	}
+	return (NULL);
+}
+
+static void*
+cef_bench_drain_thread (
+	void* arg
+) {
+	CefT_Bench_Drain* dr = (CefT_Bench_Drain*) arg;
+	unsigned char buff[65536];
+	struct pollfd fds[1];
+	ssize_t res;
+
+	fds[0].fd 		= dr->sock;
+	fds[0].events 	= POLLIN;
+
+	while (bench_drain_f) {
+		if (poll (fds, 1, 10) < 1) {
+			continue;
+		}
+		res = read (dr->sock, buff,
+				dr->slow_f ? CefC_Bench_Slow_Read : sizeof (buff));
+		if (res > 0) {
+			dr->bytes += (uint64_t) res;
+		}
+		if (dr->slow_f) {
+			usleep (CefC_Bench_Slow_Wait);
+		}
+	}
+	return (NULL);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CsmgrdT_Plugin_Interface* cs,
+	const char* item,
+	const CefT_Bench_Cobs* stored,			/* Cobs the getters get 					*/
+	const CefT_Bench_Cobs* put,				/* Cobs put while the getters run 			*/
+	int getter_num,
+	int slow_f
+) {
+	CefT_Bench_Getter getters[CefC_Bench_Getter_Max];
+	CefT_Bench_Drain drains[CefC_Bench_Getter_Max];
+	int socks[2];
+	char item_str[64];
+	uint64_t start_t;
+	uint64_t elapsed;
+	uint64_t put_t = 0;
+	uint64_t gets = 0;
+	uint64_t misses = 0;
+	uint64_t max_t = 0;
+	int err = 0;
+	int i;
+
+	memset (getters, 0, sizeof (getters));
+	memset (drains, 0, sizeof (drains));
+	bench_run_f 	= 1;
+	bench_drain_f 	= 1;
+
+	for (i = 0 ; i < getter_num ; i++) {
+		if (socketpair (AF_UNIX, SOCK_STREAM, 0, socks) < 0) {
+			fprintf (stderr, "[%s] socketpair failed\n", CefC_Bench_Prog);
+			bench_run_f 	= 0;
+			bench_drain_f 	= 0;
+			getter_num 		= i;
+			err++;
+			break;
+		}
+		drains[i].sock 		= socks[1];
+		drains[i].slow_f 	= (slow_f && (i == 0));
+		getters[i].cs 		= cs;
+		getters[i].cobs 	= stored;
+		getters[i].sock 	= socks[0];
+		getters[i].seed 	= 88172645463325252ull + i;
+		pthread_create (&drains[i].th, NULL, cef_bench_drain_thread, &drains[i]);
+		pthread_create (&getters[i].th, NULL, cef_bench_getter_thread, &getters[i]);
+	}
+
+	start_t = cef_bench_now_get ();
+	if (put) {
+		put_t = cef_bench_cobs_put (cs, put);
+		if (put_t == 0) {
+			err++;
+		}
+	} else {
+		usleep (1000000);
+	}
+	bench_run_f = 0;
+	elapsed = cef_bench_now_get () - start_t;
+
+	for (i = 0 ; i < getter_num ; i++) {
+		pthread_join (getters[i].th, NULL);
+		gets 	+= getters[i].gets;
+		misses 	+= getters[i].misses;
+		if (getters[i].max_t > max_t) {
+			max_t = getters[i].max_t;
+		}
+	}
+	bench_drain_f = 0;
+	for (i = 0 ; i < getter_num ; i++) {
+		pthread_join (drains[i].th, NULL);
+		close (getters[i].sock);
+		close (drains[i].sock);
+	}
+
+	if (misses > 0) {
+		fprintf (stderr, "[%s] %s: %llu gets of the stored Cobs missed\n",
+			CefC_Bench_Prog, item, (unsigned long long) misses);
+		err++;
+	}
+	if (put) {
+		sprintf (item_str, "%s put", item);
+		cef_bench_result_print (CefC_Bench_Prog, item_str,
+			put_t ? (double) put->names.num * 1000000 / put_t : 0, "cobs/s");
+	}
+	sprintf (item_str, "%s get", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) gets / (elapsed ? elapsed : 1), "Mops/s");
+	sprintf (item_str, "%s get max", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str, (double) max_t / 1000, "ms");
+
+	return (err);
+}
+
+static int
+cef_bench_conf_write (
+	const char* dir,
+	uint32_t capacity
+) {
+	char path[PATH_MAX];
+	FILE* fp;
+
+	sprintf (path, "%s/csmgrd.conf", dir);
+	fp = fopen (path, "w");
+	if (fp == NULL) {
+		return (-1);
+	}
+	fprintf (fp, "CACHE_TYPE=memory\n");
+	fprintf (fp, "CACHE_CAPACITY=%u\n", capacity);
+	fclose (fp);
+
+	return (0);
+}
+
+static int
+cef_bench_plugin_load (
+	CsmgrdT_Plugin_Interface* cs,
+	const char* dir
+) {
+	int (*func)(CsmgrdT_Plugin_Interface*, const char*);
+	void* lib;
+
+	/* Loads the plugin as csmgrd does 	*/
+	lib = dlopen (CefC_Bench_Plugin_Lib, RTLD_LAZY);
+	if (lib == NULL) {
+		fprintf (stderr, "[%s] %s\n", CefC_Bench_Prog, dlerror ());
+		return (-1);
+	}
+	func = dlsym (lib, "csmgrd_memory_plugin_load");
+	if ((func == NULL) || ((func) (cs, dir) != 0)) {
+		fprintf (stderr, "[%s] the memory cache plugin could not be loaded\n",
+			CefC_Bench_Prog);
+		return (-1);
+	}
+	return (0);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n cobs] [-g getters] [-s payload] [-S]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  cobs     Number of the Cobs put in a phase (1-1000000)\n");
+	fprintf (stderr, "  getters  Threads getting the stored Cobs (1-%d)\n",
+		CefC_Bench_Getter_Max);
+	fprintf (stderr, "  payload  Payload length of the Cobs\n");
+	fprintf (stderr, "  -S       Also runs with a getter whose socket is read slowly\n\n");
+}
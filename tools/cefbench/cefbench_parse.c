@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_parse.c
+ *
+ * Compares the parsing of the received messages. "copy" clears
+ * CefT_CcnMsg_MsgBdy as the message handlers of cefnetd did and parses with
+ * cef_frame_message_parse. "view" parses with cef_frame_message_view_parse and
+ * sets CefT_CcnMsg_MsgBdy with cef_frame_view_msgbdy_fill as cefnetd does now.
+ * Both are run on Interests and on Content Objects, and the Name, the Chunk
+ * Number and the Payload they obtain must be equal.
+ */
+
+#define __CEF_BENCH_PARSE_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_frame.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_parse"
+#define CefC_Bench_Lifetime			4000		/* Interest Lifetime (msec) 			*/
+
+#define CefC_Bench_Msg_Room			1024		/* room for the TLVs but the Payload 	*/
+
+#define cef_bench_msg_get(msgs, i)	(&(msgs)->buff[(size_t) (i) * (msgs)->stride])
+
+/* Length of the Chunk Number TLV at the tail of the Names of cef_bench_name_create */
+#define CefC_Bench_Chunk_Tlv_Len	(CefC_S_TLF + CefC_S_ChunkNum)
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/* Messages of stride bytes each 	*/
+typedef struct {
+	unsigned char* 	buff;
+	size_t 			stride;
+	uint32_t 		num;
+} CefT_Bench_Msgs;
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int
+cef_bench_msgs_create (
+	CefT_Bench_Msgs* msgs,
+	const CefT_Bench_Keys* keys,
+	int target_type,						/* CefC_PT_INTEREST or CefC_PT_OBJECT 		*/
+	int payload_len
+);
+static int									/* -1 if the message is invalid 			*/
+cef_bench_view_parse (
+	unsigned char* msg,
+	CefT_CcnMsg_OptHdr* poh,
+	CefT_CcnMsg_View* view,
+	CefT_CcnMsg_MsgBdy* pm,
+	int target_type
+);
+static int									/* number of the errors 					*/
+cef_bench_verify (
+	const CefT_Bench_Msgs* msgs,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_View* view,
+	int target_type
+);
+static int									/* number of the errors 					*/
+cef_bench_run (
+	const char* item,
+	const CefT_Bench_Msgs* msgs,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_View* view,
+	int target_type,
+	int rounds
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Keys keys;
+	CefT_Bench_Msgs interests;
+	CefT_Bench_Msgs objects;
+	CefT_CcnMsg_MsgBdy* pm;
+	CefT_CcnMsg_View* view;
+	uint32_t num 	= 10000;
+	int depth 		= 3;
+	int payload_len = 1024;
+	int rounds 		= 5;
+	int err = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "n:d:s:r:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'd': {
+				depth = atoi (optarg);
+				break;
+			}
+			case 's': {
+				payload_len = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 1000000) ||
+		(depth < 1) || (depth > CefC_Bench_Depth_Max) ||
+		(payload_len < 0) || (payload_len > CefC_Max_Length / 2) || (rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_frame_init ();
+	pm 	 = (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	view = (CefT_CcnMsg_View*) calloc (1, sizeof (CefT_CcnMsg_View));
+	if ((pm == NULL) || (view == NULL) ||
+		(cef_bench_keys_create (&keys, 0, num, depth) < 0)) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	if ((cef_bench_msgs_create (&interests, &keys, CefC_PT_INTEREST, 0) < 0) ||
+		(cef_bench_msgs_create (&objects, &keys, CefC_PT_OBJECT, payload_len) < 0)) {
+		fprintf (stderr, "[%s] the messages could not be created\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	err += cef_bench_run ("interest", &interests, pm, view, CefC_PT_INTEREST, rounds);
+	err += cef_bench_run ("object", &objects, pm, view, CefC_PT_OBJECT, rounds);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int
+cef_bench_msgs_create (
+	CefT_Bench_Msgs* msgs,
+	const CefT_Bench_Keys* keys,
+	int target_type,						/* CefC_PT_INTEREST or CefC_PT_OBJECT 		*/
+	int payload_len
+) {
+	CefT_CcnMsg_OptHdr opt;
+	CefT_CcnMsg_MsgBdy* params;
+	unsigned char* msg;
+	uint32_t i;
+	int res;
+
+	msgs->stride = payload_len + CefC_Bench_Msg_Room;
+	msgs->buff 	 = (unsigned char*) malloc ((size_t) keys->num * msgs->stride);
+	params 	= (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	msg 	= (unsigned char*) malloc (CefC_Max_Length);
+	if ((msgs->buff == NULL) || (params == NULL) || (msg == NULL)) {
+		free (params);
+		free (msg);
+		return (-1);
+	}
+	msgs->num = keys->num;
+
+	memset (&opt, 0, sizeof (CefT_CcnMsg_OptHdr));
+	memset (params->payload, 0x5a, payload_len);
+	params->payload_len = (uint16_t) payload_len;
+
+	for (i = 0 ; i < keys->num ; i++) {
+		if (target_type == CefC_PT_INTEREST) {
+			res = cef_bench_interest_create (msg, params,
+					cef_bench_key_get (keys, i), keys->lens[i], CefC_Bench_Lifetime);
+		} else {
+			/* The Chunk Number is set from chunk_num 	*/
+			params->chunk_num_f = 1;
+			params->name_len = keys->lens[i] - CefC_Bench_Chunk_Tlv_Len;
+			memcpy (params->name, cef_bench_key_get (keys, i), params->name_len);
+			params->chunk_num = i;
+			params->payload[0] = (unsigned char) i;
+			res = cef_frame_object_create (msg, &opt, params);
+		}
+		if ((res < 1) || ((size_t) res > msgs->stride)) {
+			free (params);
+			free (msg);
+			return (-1);
+		}
+		memcpy (cef_bench_msg_get (msgs, i), msg, res);
+	}
+	free (params);
+	free (msg);
+
+	return (0);
+}
+
+static int									/* -1 if the message is invalid 			*/
+cef_bench_view_parse (
+	unsigned char* msg,
+	CefT_CcnMsg_OptHdr* poh,
+	CefT_CcnMsg_View* view,
+	CefT_CcnMsg_MsgBdy* pm,
+	int target_type
+) {
+	struct fixed_hdr* fhdr = (struct fixed_hdr*) msg;
+	uint16_t pkt_len = ntohs (fhdr->pkt_len);
+
+	if (pkt_len < fhdr->hdr_len) {
+		return (-1);
+	}
+	if (cef_frame_message_view_parse (msg, pkt_len - fhdr->hdr_len, fhdr->hdr_len,
+			poh, view, target_type) < 0) {
+		return (-1);
+	}
+	return (cef_frame_view_msgbdy_fill (view, pm));
+}
+
+static int									/* number of the errors 					*/
+cef_bench_verify (
+	const CefT_Bench_Msgs* msgs,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_View* view,
+	int target_type
+) {
+	CefT_CcnMsg_OptHdr poh;
+	CefT_CcnMsg_MsgBdy* cpm;
+	unsigned char* msg;
+	unsigned char* payload;
+	uint16_t payload_len = 0;
+	uint32_t i;
+	int err = 0;
+
+	cpm = (CefT_CcnMsg_MsgBdy*) malloc (sizeof (CefT_CcnMsg_MsgBdy));
+	if (cpm == NULL) {
+		return (1);
+	}
+	for (i = 0 ; i < msgs->num ; i++) {
+		msg = cef_bench_msg_get (msgs, i);
+
+		memset (cpm, 0, sizeof (CefT_CcnMsg_MsgBdy));
+		memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+		if (cef_bench_message_parse (msg, &poh, cpm, target_type) < 0) {
+			err++;
+			continue;
+		}
+		memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+		if (cef_bench_view_parse (msg, &poh, view, pm, target_type) < 0) {
+			err++;
+			continue;
+		}
+		payload = cef_frame_view_payload_get (view, &payload_len);
+
+		if ((cpm->name_len != pm->name_len) ||
+			(memcmp (cpm->name, pm->name, pm->name_len) != 0) ||
+			(cpm->chunk_num_f != pm->chunk_num_f) || (cpm->chunk_num != pm->chunk_num) ||
+			(cpm->chunk_num != i) ||
+			(cpm->payload_len != pm->payload_len) ||
+			(cpm->payload_len != payload_len) ||
+			((payload_len > 0) &&
+			 ((payload == NULL) || (memcmp (cpm->payload, payload, payload_len) != 0)))) {
+			if (err++ < 10) {
+				fprintf (stderr, "[%s] message %u was parsed differently\n",
+					CefC_Bench_Prog, i);
+			}
+		}
+	}
+	free (cpm);
+
+	return (err);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	const char* item,
+	const CefT_Bench_Msgs* msgs,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_View* view,
+	int target_type,
+	int rounds
+) {
+	CefT_CcnMsg_OptHdr poh;
+	char item_str[64];
+	uint64_t start_t;
+	uint64_t copy_t = 0;
+	uint64_t view_t = 0;
+	uint64_t ops = (uint64_t) msgs->num * rounds;
+	uint32_t i;
+	int err;
+	int r;
+
+	err = cef_bench_verify (msgs, pm, view, target_type);
+
+	for (r = 0 ; r < rounds ; r++) {
+		/* As the handlers did with "CefT_CcnMsg_MsgBdy pm = { 0 }" 	*/
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < msgs->num ; i++) {
+			memset (pm, 0, sizeof (CefT_CcnMsg_MsgBdy));
+			memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+			if (cef_bench_message_parse (cef_bench_msg_get (msgs, i),
+					&poh, pm, target_type) < 0) {
+				err++;
+			}
+		}
+		copy_t += cef_bench_now_get () - start_t;
+
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < msgs->num ; i++) {
+			memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+			if (cef_bench_view_parse (cef_bench_msg_get (msgs, i),
+					&poh, view, pm, target_type) < 0) {
+				err++;
+			}
+		}
+		view_t += cef_bench_now_get () - start_t;
+	}
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] %s: %d messages failed\n", CefC_Bench_Prog, item, err);
+	}
+	sprintf (item_str, "%s copy", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) ops / (copy_t ? copy_t : 1), "Mmsgs/s");
+	sprintf (item_str, "%s view", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) ops / (view_t ? view_t : 1), "Mmsgs/s");
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n messages] [-d depth] [-s payload] [-r rounds]\n\n",
+		CefC_Bench_Prog);
+	fprintf (stderr, "  messages  Number of the Interests and of the Content Objects\n");
+	fprintf (stderr, "  depth     Name Segments of each Name (1-%d)\n", CefC_Bench_Depth_Max);
+	fprintf (stderr, "  payload   Payload length of the Content Objects\n");
+	fprintf (stderr, "  rounds    Times to parse the messages\n\n");
+}
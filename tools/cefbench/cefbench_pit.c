@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_pit.c
+ *
+ * Measures how many PIT entries are created, matched and freed per second. Each
+ * round creates an entry with the Down Faces for every Name, searches all of them
+ * as the Content Objects do, and frees them. The PIT must be empty after a round.
+ */
+
+#define __CEF_BENCH_PIT_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_hash.h>
+#include <cefore/cef_pit.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_pit"
+#define CefC_Bench_Face_Max			16
+#define CefC_Bench_Lifetime			4000		/* Interest Lifetime (msec) 			*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static void
+cef_bench_name_set (
+	CefT_CcnMsg_MsgBdy* pm,
+	const CefT_Bench_Keys* keys,
+	uint32_t idx
+);
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CefT_Hash_Handle pit,
+	CefT_CcnMsg_MsgBdy* pm,					/* parsed Interest used as the template 	*/
+	CefT_CcnMsg_OptHdr* poh,
+	unsigned char* msg,						/* the Interest 							*/
+	const CefT_Bench_Keys* keys,
+	int face_num,
+	int rounds
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Keys keys;
+	CefT_CcnMsg_MsgBdy* pm;
+	CefT_CcnMsg_OptHdr* poh;
+	CefT_Hash_Handle pit;
+	unsigned char msg[CefC_Max_Length];
+	uint32_t num 	= 100000;
+	int face_num 	= 2;
+	int depth 		= 3;
+	int rounds 		= 5;
+	int err = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "n:f:d:r:h")) != -1) {
+		switch (opt) {
+			case 'n': {
+				num = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			}
+			case 'f': {
+				face_num = atoi (optarg);
+				break;
+			}
+			case 'd': {
+				depth = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((num < 1) || (num > 10000000) ||
+		(face_num < 1) || (face_num > CefC_Bench_Face_Max) ||
+		(depth < 1) || (depth > CefC_Bench_Depth_Max) || (rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_frame_init ();
+	cef_pit_init (CefC_Default_CcninfoReplyTimeout,
+		CefC_Default_SYMBOLIC_LIFETIME, CefC_Default_REGULAR_LIFETIME);
+
+	pm  = (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	poh = (CefT_CcnMsg_OptHdr*) calloc (1, sizeof (CefT_CcnMsg_OptHdr));
+	if ((pm == NULL) || (poh == NULL) ||
+		(cef_bench_keys_create (&keys, 0, num, depth) < 0)) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	/* The Interest of the first Name is parsed once and its Name is replaced 	*/
+	if ((cef_bench_interest_create (msg, pm, cef_bench_key_get (&keys, 0), keys.lens[0],
+			CefC_Bench_Lifetime) < 0) ||
+		(cef_bench_message_parse (msg, poh, pm, CefC_PT_INTEREST) < 0)) {
+		fprintf (stderr, "[%s] the Interest could not be created\n", CefC_Bench_Prog);
+		return (1);
+	}
+
+	/* Sized for the Names like cefnetd sizes the PIT for PIT_SIZE 	*/
+	pit = cef_lhash_tbl_create_resizable (num, CefC_Hash_Coef_PIT);
+	if (pit == (CefT_Hash_Handle) NULL) {
+		fprintf (stderr, "[%s] cef_lhash_tbl_create_resizable failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	err = cef_bench_run (pit, pm, poh, msg, &keys, face_num, rounds);
+	cef_lhash_tbl_destroy (pit);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static void
+cef_bench_name_set (
+	CefT_CcnMsg_MsgBdy* pm,
+	const CefT_Bench_Keys* keys,
+	uint32_t idx
+) {
+	memcpy (pm->name, cef_bench_key_get (keys, idx), keys->lens[idx]);
+	pm->name_len 	= keys->lens[idx];
+	pm->chunk_num 	= idx;
+
+	/* The prefixes hashed at parsing belong to the previous Name 	*/
+	pm->name_hash_num = 0;
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	CefT_Hash_Handle pit,
+	CefT_CcnMsg_MsgBdy* pm,					/* parsed Interest used as the template 	*/
+	CefT_CcnMsg_OptHdr* poh,
+	unsigned char* msg,						/* the Interest 							*/
+	const CefT_Bench_Keys* keys,
+	int face_num,
+	int rounds
+) {
+	CefT_Pit_Entry** entries;
+	CefT_Pit_Entry* pe;
+	CefT_Pit_Slab_Stat stat;
+	uint64_t start_t;
+	uint64_t create_t = 0;
+	uint64_t search_t = 0;
+	uint64_t free_t = 0;
+	uint64_t ops;
+	uint32_t i;
+	int err = 0;
+	int r;
+	int f;
+
+	entries = (CefT_Pit_Entry**) calloc (keys->num, sizeof (CefT_Pit_Entry*));
+	if (entries == NULL) {
+		fprintf (stderr, "[%s] malloc failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	memset (&stat, 0, sizeof (CefT_Pit_Slab_Stat));
+
+	for (r = 0 ; r < rounds ; r++) {
+		/* Interests from face_num Down Faces create the entries 	*/
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < keys->num ; i++) {
+			cef_bench_name_set (pm, keys, i);
+			pe = cef_pit_entry_lookup (pit, pm, poh, NULL, 0);
+			if (pe == NULL) {
+				err++;
+				continue;
+			}
+			for (f = 0 ; f < face_num ; f++) {
+				cef_pit_entry_down_face_update (
+					pe, (uint16_t)(f + 1), pm, poh, msg, CefC_IntRetrans_Type_RFC);
+			}
+			entries[i] = pe;
+		}
+		create_t += cef_bench_now_get () - start_t;
+		if (r == 0) {
+			cef_pit_slab_stat_get (&stat);
+		}
+
+		/* Content Objects find the entries 	*/
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < keys->num ; i++) {
+			cef_bench_name_set (pm, keys, i);
+			pe = cef_pit_entry_search (pit, pm, poh, NULL, 0);
+			if ((pe == NULL) || (pe != entries[i]) || (pe->dnfacenum != face_num)) {
+				err++;
+			}
+		}
+		search_t += cef_bench_now_get () - start_t;
+
+		start_t = cef_bench_now_get ();
+		for (i = 0 ; i < keys->num ; i++) {
+			if (entries[i]) {
+				cef_pit_entry_free (pit, entries[i]);
+				entries[i] = NULL;
+			}
+		}
+		free_t += cef_bench_now_get () - start_t;
+
+		if (cef_lhash_tbl_item_num_get (pit) != 0) {
+			fprintf (stderr, "[%s] %d entries remain after round %d\n",
+				CefC_Bench_Prog, cef_lhash_tbl_item_num_get (pit), r);
+			err++;
+		}
+	}
+	free (entries);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] %d entries were not created or found\n",
+			CefC_Bench_Prog, err);
+	}
+	ops = (uint64_t) keys->num * rounds;
+	cef_bench_result_print (CefC_Bench_Prog, "create",
+		(double) ops / (create_t ? create_t : 1), "Mentries/s");
+	cef_bench_result_print (CefC_Bench_Prog, "search",
+		(double) ops / (search_t ? search_t : 1), "Mentries/s");
+	cef_bench_result_print (CefC_Bench_Prog, "free",
+		(double) ops / (free_t ? free_t : 1), "Mentries/s");
+	cef_bench_result_print (CefC_Bench_Prog, "entries pooled",
+		(double) stat.entry_pooled, "entries");
+	cef_bench_result_print (CefC_Bench_Prog, "down faces spilled",
+		(double) stat.dnface_spill_num, "faces");
+	cef_bench_result_print (CefC_Bench_Prog, "names spilled",
+		(double) stat.name_spill_num, "names");
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-n entries] [-f faces] [-d depth] [-r rounds]\n\n",
+		CefC_Bench_Prog);
+	fprintf (stderr, "  entries  Number of the PIT entries created in a round\n");
+	fprintf (stderr, "  faces    Down Faces of each entry (1-%d)\n", CefC_Bench_Face_Max);
+	fprintf (stderr, "  depth    Name Segments of each Name (1-%d)\n", CefC_Bench_Depth_Max);
+	fprintf (stderr, "  rounds   Times to create, search and free the entries\n\n");
+}
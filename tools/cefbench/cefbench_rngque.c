@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_rngque.c
+ *
+ * Stress test and throughput benchmark of CefT_Rngque. The producer threads push
+ * the sequence numbers of their own, and the consumer checks with pop_bulk that
+ * each producer's items arrive in order without loss or duplication.
+ */
+
+#define __CEF_BENCH_RNGQUE_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <cefore/cef_rngque.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_rngque"
+#define CefC_Bench_Producer_Max		64
+#define CefC_Bench_Bulk_Max			256
+
+/* An item carries the producer ID and its sequence number. One is added so that	*/
+/* no item is NULL, which pop regards as empty.										*/
+#define cef_bench_item_make(id, seq)	((void*)(uintptr_t)((((uint64_t)(id) << 40) | (seq)) + 1))
+#define cef_bench_item_id(item)			((int)(((uint64_t)(uintptr_t)(item) - 1) >> 40))
+#define cef_bench_item_seq(item)		(((uint64_t)(uintptr_t)(item) - 1) & 0xFFFFFFFFFFULL)
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+typedef struct {
+	CefT_Rngque* 	que;
+	int 			id;
+	uint64_t 		num;				/* items to push 							*/
+	uint64_t 		full;				/* pushes which found the queue full 		*/
+} CefT_Bench_Producer;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static volatile int bench_start_f = 0;
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static void*
+cef_bench_producer (
+	void* arg
+);
+static int									/* number of the errors 					*/
+cef_bench_run (
+	int mode,								/* CefC_Rngque_Mode_XXX 					*/
+	int prod_num,							/* number of the producers 					*/
+	uint64_t num,							/* items pushed by each producer 			*/
+	int capacity,							/* capacity of the queue 					*/
+	int bulk								/* items popped at once 					*/
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	int prod_num 	= 4;
+	uint64_t num 	= 2000000;
+	int capacity 	= 1024;
+	int bulk 		= 32;
+	int err = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "p:n:q:b:h")) != -1) {
+		switch (opt) {
+			case 'p': {
+				prod_num = atoi (optarg);
+				break;
+			}
+			case 'n': {
+				num = strtoull (optarg, NULL, 10);
+				break;
+			}
+			case 'q': {
+				capacity = atoi (optarg);
+				break;
+			}
+			case 'b': {
+				bulk = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((prod_num < 1) || (prod_num > CefC_Bench_Producer_Max) ||
+		(num < 1) || (num > 0xFFFFFFFFFFULL) ||
+		(capacity < 2) || (bulk < 1) || (bulk > CefC_Bench_Bulk_Max)) {
+		print_usage ();
+		return (1);
+	}
+
+	/* SPSC with one producer, then MPSC with the specified producers 	*/
+	err += cef_bench_run (CefC_Rngque_Mode_Spsc, 1, num, capacity, bulk);
+	err += cef_bench_run (CefC_Rngque_Mode_Mpsc, prod_num, num, capacity, bulk);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	int mode,								/* CefC_Rngque_Mode_XXX 					*/
+	int prod_num,							/* number of the producers 					*/
+	uint64_t num,							/* items pushed by each producer 			*/
+	int capacity,							/* capacity of the queue 					*/
+	int bulk								/* items popped at once 					*/
+) {
+	CefT_Bench_Producer prods[CefC_Bench_Producer_Max];
+	pthread_t threads[CefC_Bench_Producer_Max];
+	uint64_t expect[CefC_Bench_Producer_Max];
+	void* items[CefC_Bench_Bulk_Max];
+	uint64_t total = num * prod_num;
+	uint64_t popped = 0;
+	uint64_t pops = 0;
+	uint64_t full = 0;
+	uint64_t start_t;
+	uint64_t elapsed;
+	const char* mode_str = (mode == CefC_Rngque_Mode_Spsc) ? "spsc" : "mpsc";
+	char item_str[64];
+	int err = 0;
+	int n;
+	int i;
+	int id;
+
+	prods[0].que = cef_rngque_create_with_mode (capacity, mode);
+	if (prods[0].que == NULL) {
+		fprintf (stderr, "[%s] cef_rngque_create_with_mode failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	bench_start_f = 0;
+	for (i = 0 ; i < prod_num ; i++) {
+		prods[i].que 	= prods[0].que;
+		prods[i].id 	= i;
+		prods[i].num 	= num;
+		prods[i].full 	= 0;
+		expect[i] = 0;
+		if (pthread_create (&threads[i], NULL, cef_bench_producer, &prods[i]) != 0) {
+			fprintf (stderr, "[%s] pthread_create failed\n", CefC_Bench_Prog);
+			exit (1);
+		}
+	}
+	start_t = cef_bench_now_get ();
+	__atomic_store_n (&bench_start_f, 1, __ATOMIC_RELEASE);
+
+	while (popped < total) {
+		n = cef_rngque_pop_bulk (prods[0].que, items, bulk);
+		if (n == 0) {
+			/* lets the producers run when the cores are fewer than the threads */
+			sched_yield ();
+			continue;
+		}
+		pops++;
+		for (i = 0 ; i < n ; i++) {
+			id = cef_bench_item_id (items[i]);
+			if ((items[i] == NULL) || (id >= prod_num)) {
+				if (err++ < 10) {
+					fprintf (stderr, "[%s] %s: unknown item %p\n",
+						CefC_Bench_Prog, mode_str, items[i]);
+				}
+				continue;
+			}
+			if (cef_bench_item_seq (items[i]) != expect[id]) {
+				if (err++ < 10) {
+					fprintf (stderr, "[%s] %s: producer %d sent %llu but %llu arrived\n",
+						CefC_Bench_Prog, mode_str, id,
+						(unsigned long long) expect[id],
+						(unsigned long long) cef_bench_item_seq (items[i]));
+				}
+				expect[id] = cef_bench_item_seq (items[i]);
+			}
+			expect[id]++;
+		}
+		popped += n;
+	}
+	elapsed = cef_bench_now_get () - start_t;
+
+	for (i = 0 ; i < prod_num ; i++) {
+		pthread_join (threads[i], NULL);
+		full += prods[i].full;
+		if (expect[i] != num) {
+			fprintf (stderr, "[%s] %s: producer %d sent %llu but %llu arrived\n",
+				CefC_Bench_Prog, mode_str, i,
+				(unsigned long long) num, (unsigned long long) expect[i]);
+			err++;
+		}
+	}
+	/* Nothing may remain after all the items arrived 	*/
+	if (cef_rngque_pop_bulk (prods[0].que, items, bulk) != 0) {
+		fprintf (stderr, "[%s] %s: extra items remain\n", CefC_Bench_Prog, mode_str);
+		err++;
+	}
+	cef_rngque_destroy (prods[0].que);
+
+	if (elapsed == 0) {
+		elapsed = 1;
+	}
+	sprintf (item_str, "%s x%d throughput", mode_str, prod_num);
+	cef_bench_result_print (CefC_Bench_Prog, item_str, (double) total / elapsed, "Mitems/s");
+	sprintf (item_str, "%s x%d items/pop_bulk", mode_str, prod_num);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) popped / (pops ? pops : 1), "items");
+	sprintf (item_str, "%s x%d full pushes", mode_str, prod_num);
+	cef_bench_result_print (CefC_Bench_Prog, item_str, (double) full, "times");
+
+	return (err);
+}
+
+static void*
+cef_bench_producer (
+	void* arg
+) {
+	CefT_Bench_Producer* prod = (CefT_Bench_Producer*) arg;
+	uint64_t seq;
+
+	while (!__atomic_load_n (&bench_start_f, __ATOMIC_ACQUIRE)) {
+		sched_yield ();
+	}
+	for (seq = 0 ; seq < prod->num ; seq++) {
+		while (cef_rngque_push (prod->que, cef_bench_item_make (prod->id, seq)) == 0) {
+			prod->full++;
+			sched_yield ();
+		}
+	}
+	return (NULL);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-p producers] [-n items] [-q capacity] [-b bulk]\n\n",
+		CefC_Bench_Prog);
+	fprintf (stderr, "  producers  Number of the producer threads of MPSC (1-%d)\n",
+		CefC_Bench_Producer_Max);
+	fprintf (stderr, "  items      Items pushed by each producer\n");
+	fprintf (stderr, "  capacity   Capacity of the queue\n");
+	fprintf (stderr, "  bulk       Items popped by one pop_bulk (1-%d)\n\n",
+		CefC_Bench_Bulk_Max);
+}
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefbench_valid.c
+ *
+ * Measures the RSA-SHA256 verifications per second of cef_valid_msg_verify with
+ * and without the cache of the decoded public keys. The program creates -k key
+ * pairs and a cefnetd.key for them in a temporary directory, and signs Content
+ * Objects under ccnx:/k<n> with the key n.
+ *
+ *  - "one key": every Content Object is signed with the same key, so the key is
+ *    decoded once and then taken from the cache.
+ *  - "all keys": the Content Objects use the keys in turn. With more keys than
+ *    the cache holds, each key is evicted before it is used again, so every
+ *    verification decodes the key as it did before the cache.
+ */
+
+#define __CEF_BENCH_VALID_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include <openssl/bn.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_valid.h>
+
+#include "cefbench.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Bench_Prog				"cefbench_valid"
+#define CefC_Bench_Key_Max			1024
+#define CefC_Bench_Payload_Len		1024
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+typedef struct {
+	unsigned char* 	buff;				/* num messages of CefC_Max_Length bytes 	*/
+	uint16_t* 		lens;
+	int 			num;
+} CefT_Bench_Msgs;
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static int
+cef_bench_keys_write (
+	const char* dir,
+	int key_num,
+	int key_bits
+);
+static void
+cef_bench_keys_remove (
+	const char* dir,
+	int key_num
+);
+static int
+cef_bench_msgs_create (
+	CefT_Bench_Msgs* msgs,
+	int msg_num,
+	int key_num								/* keys used in turn 						*/
+);
+static int									/* number of the errors 					*/
+cef_bench_run (
+	const char* item,
+	const CefT_Bench_Msgs* msgs,
+	int rounds
+);
+static void
+print_usage (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+int main (
+	int argc,
+	char** argv
+) {
+	CefT_Bench_Msgs one_key;
+	CefT_Bench_Msgs all_keys;
+	char dir[] = "/tmp/cefbench_valid.XXXXXX";
+	int key_num 	= 128;
+	int key_bits 	= 1024;
+	int msg_num 	= 1024;
+	int rounds 		= 5;
+	int err = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "k:b:n:r:h")) != -1) {
+		switch (opt) {
+			case 'k': {
+				key_num = atoi (optarg);
+				break;
+			}
+			case 'b': {
+				key_bits = atoi (optarg);
+				break;
+			}
+			case 'n': {
+				msg_num = atoi (optarg);
+				break;
+			}
+			case 'r': {
+				rounds = atoi (optarg);
+				break;
+			}
+			default: {
+				print_usage ();
+				return (1);
+			}
+		}
+	}
+	if ((key_num < 1) || (key_num > CefC_Bench_Key_Max) ||
+		((key_bits != 1024) && (key_bits != 2048)) ||
+		(msg_num < key_num) || (rounds < 1)) {
+		print_usage ();
+		return (1);
+	}
+
+	cef_frame_init ();
+	if (mkdtemp (dir) == NULL) {
+		fprintf (stderr, "[%s] mkdtemp failed\n", CefC_Bench_Prog);
+		return (1);
+	}
+	fprintf (stderr, "[%s] Creating %d keys in %s\n", CefC_Bench_Prog, key_num, dir);
+	if ((cef_bench_keys_write (dir, key_num, key_bits) < 0) ||
+		(cef_valid_init (dir) < 0)) {
+		fprintf (stderr, "[%s] the keys could not be prepared\n", CefC_Bench_Prog);
+		cef_bench_keys_remove (dir, key_num);
+		return (1);
+	}
+	if ((cef_bench_msgs_create (&one_key, msg_num, 1) < 0) ||
+		(cef_bench_msgs_create (&all_keys, msg_num, key_num) < 0)) {
+		fprintf (stderr, "[%s] the Content Objects could not be signed\n",
+			CefC_Bench_Prog);
+		cef_bench_keys_remove (dir, key_num);
+		return (1);
+	}
+	cef_bench_keys_remove (dir, key_num);
+
+	err += cef_bench_run ("one key", &one_key, rounds);
+	err += cef_bench_run ("all keys", &all_keys, rounds);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] NG (%d errors)\n", CefC_Bench_Prog, err);
+		return (1);
+	}
+	fprintf (stderr, "[%s] OK\n", CefC_Bench_Prog);
+	return (0);
+}
+
+static int
+cef_bench_keys_write (
+	const char* dir,
+	int key_num,
+	int key_bits
+) {
+	char path[PATH_MAX];
+	char prv_path[PATH_MAX];
+	char pub_path[PATH_MAX];
+	FILE* conf_fp;
+	FILE* fp;
+	BIGNUM* exp;
+	RSA* rsa;
+	int res = 0;
+	int i;
+
+	sprintf (path, "%s/cefnetd.key", dir);
+	conf_fp = fopen (path, "w");
+	if (conf_fp == NULL) {
+		return (-1);
+	}
+	exp = BN_new ();
+	if ((exp == NULL) || (BN_set_word (exp, RSA_F4) != 1)) {
+		fclose (conf_fp);
+		BN_free (exp);
+		return (-1);
+	}
+
+	for (i = 0 ; (i < key_num) && (res == 0) ; i++) {
+		rsa = RSA_new ();
+		if ((rsa == NULL) || (RSA_generate_key_ex (rsa, key_bits, exp, NULL) != 1)) {
+			RSA_free (rsa);
+			res = -1;
+			break;
+		}
+		sprintf (prv_path, "%s/key%d-private-key", dir, i);
+		sprintf (pub_path, "%s/key%d-public-key", dir, i);
+
+		fp = fopen (prv_path, "w");
+		if ((fp == NULL) ||
+			(PEM_write_RSAPrivateKey (fp, rsa, NULL, NULL, 0, NULL, NULL) != 1)) {
+			res = -1;
+		}
+		if (fp) {
+			fclose (fp);
+		}
+		fp = fopen (pub_path, "w");
+		if ((fp == NULL) || (PEM_write_RSA_PUBKEY (fp, rsa) != 1)) {
+			res = -1;
+		}
+		if (fp) {
+			fclose (fp);
+		}
+		RSA_free (rsa);
+
+		fprintf (conf_fp, "ccnx:/k%d %s %s\n", i, prv_path, pub_path);
+	}
+	BN_free (exp);
+	fclose (conf_fp);
+
+	return (res);
+}
+
+static void
+cef_bench_keys_remove (
+	const char* dir,
+	int key_num
+) {
+	char path[PATH_MAX];
+	int i;
+
+	for (i = 0 ; i < key_num ; i++) {
+		sprintf (path, "%s/key%d-private-key", dir, i);
+		unlink (path);
+		sprintf (path, "%s/key%d-public-key", dir, i);
+		unlink (path);
+	}
+	sprintf (path, "%s/cefnetd.key", dir);
+	unlink (path);
+	rmdir (dir);
+}
+
+static int
+cef_bench_msgs_create (
+	CefT_Bench_Msgs* msgs,
+	int msg_num,
+	int key_num								/* keys used in turn 						*/
+) {
+	CefT_CcnMsg_OptHdr opt;
+	CefT_CcnMsg_MsgBdy* params;
+	char uri[64];
+	int len;
+	int i;
+
+	msgs->buff = (unsigned char*) malloc ((size_t) msg_num * CefC_Max_Length);
+	msgs->lens = (uint16_t*) malloc (sizeof (uint16_t) * msg_num);
+	params = (CefT_CcnMsg_MsgBdy*) calloc (1, sizeof (CefT_CcnMsg_MsgBdy));
+	if ((msgs->buff == NULL) || (msgs->lens == NULL) || (params == NULL)) {
+		free (params);
+		return (-1);
+	}
+	msgs->num = msg_num;
+
+	memset (&opt, 0, sizeof (CefT_CcnMsg_OptHdr));
+	memset (params->payload, 0x5a, CefC_Bench_Payload_Len);
+	params->payload_len 	= CefC_Bench_Payload_Len;
+	params->chunk_num_f 	= 1;
+	params->expiry 			= 0;
+	params->alg.valid_type 	= CefC_T_RSA_SHA256;
+
+	for (i = 0 ; i < msg_num ; i++) {
+		sprintf (uri, "ccnx:/k%d/c%d", i % key_num, i);
+		len = cef_frame_conversion_uri_to_name (uri, params->name);
+		if (len < 1) {
+			free (params);
+			return (-1);
+		}
+		params->name_len 	= (uint16_t) len;
+		params->chunk_num 	= (uint32_t) i;
+
+		len = cef_frame_object_create (
+				&msgs->buff[(size_t) i * CefC_Max_Length], &opt, params);
+		if (len < 1) {
+			free (params);
+			return (-1);
+		}
+		msgs->lens[i] = (uint16_t) len;
+	}
+	free (params);
+
+	return (0);
+}
+
+static int									/* number of the errors 					*/
+cef_bench_run (
+	const char* item,
+	const CefT_Bench_Msgs* msgs,
+	int rounds
+) {
+	CefT_Valid_Stat before;
+	CefT_Valid_Stat after;
+	char item_str[64];
+	uint64_t start_t;
+	uint64_t elapsed;
+	uint64_t ops = (uint64_t) msgs->num * rounds;
+	int err = 0;
+	int r;
+	int i;
+
+	cef_valid_stat_get (&before);
+	start_t = cef_bench_now_get ();
+	for (r = 0 ; r < rounds ; r++) {
+		for (i = 0 ; i < msgs->num ; i++) {
+			if (cef_valid_msg_verify (
+					&msgs->buff[(size_t) i * CefC_Max_Length], msgs->lens[i]) != 0) {
+				err++;
+			}
+		}
+	}
+	elapsed = cef_bench_now_get () - start_t;
+	cef_valid_stat_get (&after);
+
+	if (err > 0) {
+		fprintf (stderr, "[%s] %s: %d Content Objects were not verified\n",
+			CefC_Bench_Prog, item, err);
+	}
+	if (after.verify_num - before.verify_num != ops) {
+		fprintf (stderr, "[%s] %s: %llu verifications were counted for %llu\n",
+			CefC_Bench_Prog, item,
+			(unsigned long long)(after.verify_num - before.verify_num),
+			(unsigned long long) ops);
+		err++;
+	}
+	sprintf (item_str, "%s verify", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double) ops * 1000000 / (elapsed ? elapsed : 1), "msgs/s");
+	sprintf (item_str, "%s key cache hit", item);
+	cef_bench_result_print (CefC_Bench_Prog, item_str,
+		(double)(after.key_cache_hit - before.key_cache_hit) * 100 / ops, "%");
+
+	return (err);
+}
+
+static void
+print_usage (
+	void
+) {
+	fprintf (stderr, "\nUsage: %s\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  %s [-k keys] [-b bits] [-n msgs] [-r rounds]\n\n", CefC_Bench_Prog);
+	fprintf (stderr, "  keys    Number of the keys used in turn (1-%d)\n",
+		CefC_Bench_Key_Max);
+	fprintf (stderr, "  bits    Size of the keys (1024 or 2048)\n");
+	fprintf (stderr, "  msgs    Number of the signed Content Objects (keys or more)\n");
+	fprintf (stderr, "  rounds  Times to verify the Content Objects\n\n");
+}
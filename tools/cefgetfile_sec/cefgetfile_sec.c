@@ -307,8 +307,10 @@ int main (
 			}
 			work_arg = argv[i + 1];
 			mode_val = atoi (work_arg);
-			if ( (mode_val < 0) && (mode_val > 2) ) {
-				fprintf (stderr, "ERROR: [-m] parameter is 0 or 1 or 2.\n");
+			if ( (mode_val < 0) || (mode_val > 3) ) {
+				fprintf (stderr, "ERROR: [-m] parameter is 0 or 1 or 2 or 3.\n");
+				print_usage ();
+				return (-1);
 			}
 			mode_f++;
 			i++;
@@ -447,7 +449,7 @@ int main (
 	/*---------------------------------------------------------------------------
 		Get	Manifest
 	-----------------------------------------------------------------------------*/
-	if ( (mode_val == 1) || (mode_val == 2) ) {
+	if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 		srand((unsigned)time(NULL));
 		uint32_t rand_n = rand();
 		sprintf( man_fpath, "%s/manifest_%d", getenv("HOME"), rand_n );
@@ -471,6 +473,22 @@ printf ("Manifest URI=%s\n", man_uri);
 
 		man_params.name_len = res;
 
+		/* The Manifest is signed in mode 3, so the chunks validated with the	*/
+		/* CobHash of the Manifest are also bound to the key of the publisher. 	*/
+		if (mode_val == 3) {
+			unsigned char 	keyid[32];
+			unsigned char 	pubkey[CefC_Max_Length];
+
+			cef_valid_init (conf_path);
+			if (cef_valid_keyid_create (
+					man_params.name, man_params.name_len, pubkey, keyid) < 1) {
+				fprintf (stdout, "ERROR: KeyId of the Manifest can not be created.\n");
+				exit (1);
+			}
+			man_params.KeyIdRester_f = 1;
+			memcpy (man_params.KeyIdRester_val, keyid, 32);
+		}
+
 		man_params.hoplimit 			= 32;
 		man_opt.lifetime_f 		= 1;
 		Cef_Int_Regular(params);
@@ -733,7 +751,7 @@ printf( "man_rec_num:%d\n", man_rec_num );
 		params.KeyIdRester_f = 0;
 	}
 
-	if ( (mode_val == 1) || (mode_val == 2) ) {
+	if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 		/* Read Manifest */
 #ifdef __DEV_COBH__
 printf( "Manifest:%s\n", man_fpath );
@@ -784,13 +802,13 @@ printf( "man_rec.chunk:%d   man_buff_idx:%d   man_rec_ctr:%d\n", man_rec.chunk,
 			rxwnd_prev = rxwnd;
 			rxwnd_head = rxwnd;
 			rxwnd_tail = rxwnd;
-			if ( (mode_val == 1) || (mode_val == 2) ) {
+			if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 				if ( params.chunk_num == man_rec.chunk ) {
 #ifdef __DEV_COBH__
 printf( "CKP-000 params.chunk_num:%u   man_rec.chunk:%u\n", params.chunk_num, man_rec.chunk );
 #endif
 #ifdef	__DEB_GET__
-if ( (mode_val == 1) || ( mode_val == 2) ) {
+if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 	if ( params.chunk_num == man_rec.chunk ) {
 		int hidx;
 		char	hash_dbg[1024];
@@ -846,12 +864,12 @@ printf( "CKP-004 man_rec.chunk:%d   man_buff_idx:%d   man_rec_ctr:%d\n", man_rec
 			rxwnd_prev->next = rxwnd;
 			rxwnd_tail = rxwnd;
 			rxwnd_prev = rxwnd;
-			if ( (mode_val == 1) || (mode_val == 2) ) {
+			if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 #ifdef __DEV_COBH__
 printf( "CKP-005 params.chunk_num:%u   man_rec.chunk:%u\n", params.chunk_num, man_rec.chunk );
 #endif
 #ifdef	__DEV_GET__
-if ( (mode_val == 1) || ( mode_val == 2) ) {
+if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 	if ( params.chunk_num == man_rec.chunk ) {
 		int hidx;
 		char	hash_dbg[1024];
@@ -1065,12 +1083,12 @@ printf( "Content stat_recv_frames:%ld   end_chunk_num+1:%ld\n", stat_recv_frames
 						/* Sends an interest with the next chunk number 	*/
 						params.chunk_num = rxwnd_tail->seq;
 						if (params.chunk_num <= UINT32_MAX) {
-							if ( (mode_val == 1) || (mode_val == 2) ) {
+							if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 #ifdef __DEV_COBH__
 printf( "CKP-100 params.chunk_num:%u   man_rec.chunk:%u\n", params.chunk_num, man_rec.chunk );
 #endif
 #ifdef __DEB_GET__
-if ( (mode_val == 1) || ( mode_val == 2) ) {
+if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 	if ( params.chunk_num == man_rec.chunk ) {
 		int hidx;
 		char	hash_dbg[1024];
@@ -1162,7 +1180,7 @@ printf( "CKP-105 man_rec.chunk:%u   man_buff_idx:%d   man_rec_ctr:%d\n", man_rec
 printf( "CKP-200 params.chunk_num:%u\n", params.chunk_num );
 #endif
 #ifdef	__DEV_GET__
-if ( (mode_val == 1) || ( mode_val == 2) ) {
+if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 	if (rxwnd_head->CobHash_f == 1) {
 		int hidx;
 		char	hash_dbg[1024];
@@ -1176,7 +1194,7 @@ if ( (mode_val == 1) || ( mode_val == 2) ) {
 	}
 }
 #endif
-					if ( (mode_val == 1) || (mode_val == 2) ) {
+					if ( (mode_val == 1) || (mode_val == 2) || (mode_val == 3) ) {
 						if (rxwnd_head->CobHash_f == 1) {
 							params.ObjHash_f= 1;
 							memcpy( params.ObjHash_val, rxwnd->cob_hash, 32 );
@@ -1219,7 +1237,8 @@ print_usage (
 	fprintf (stdout, "  file             Specify the file name of output. \n");
 	fprintf (stdout, "  mode             0: Send Interest with KeyIdRestriction TLV set.\n"
 	                 "                   1: Send Interest requesting Manifest, and send Interest with a CobHash value set.\n"
-	                 "                   2: Send Interest requesting Manifest, and send Interest with KeyIdRestriction TLV and CobHash value set.\n");
+	                 "                   2: Send Interest requesting Manifest, and send Interest with KeyIdRestriction TLV and CobHash value set.\n"
+	                 "                   3: Send Interest with KeyIdRestriction TLV requesting the signed Manifest, and send Interest with a CobHash value set.\n");
 	fprintf (stdout, "  pipeline         Number of pipeline\n");
 	fprintf (stderr, "  config_file_dir  Configure file directory\n");
 	fprintf (stderr, "  port_num         Port Number\n\n");
@@ -159,6 +159,7 @@ int main (
 	int dir_path_f 	= 0;
 	int port_num_f 	= 0;
 	int mode_f		= 0;
+	int thread_f	= 0;
 	
 	/***** parameters 	*****/
 	uint16_t cache_time 	= 300;
@@ -166,6 +167,8 @@ int main (
 	double rate 			= 5.0;
 	int block_size 			= 1024;
 	int mode_val			= 0;
+	int thread_num			= 1;
+	int sign_defer_f		= 0;
 	
 	/*------------------------------------------
 		Checks specified options
@@ -339,11 +342,34 @@ int main (
 			}
 			work_arg = argv[i + 1];
 			mode_val = atoi (work_arg);
-			if ( (mode_val < 0) && (mode_val > 2) ) {
-				fprintf (stderr, "ERROR: [-m] parameter is 0 or 1 or 2.\n");
+			if ( (mode_val < 0) || (mode_val > 3) ) {
+				fprintf (stderr, "ERROR: [-m] parameter is 0 or 1 or 2 or 3.\n");
+				print_usage ();
+				return (-1);
 			}
 			mode_f++;
 			i++;
+		} else if (strcmp (work_arg, "-j") == 0) {
+			if (thread_f) {
+				fprintf (stderr, "ERROR: [-j] is duplicated.\n");
+				print_usage ();
+				return (-1);
+			}
+			if (i + 1 == argc) {
+				fprintf (stderr, "ERROR: [-j] has no parameter.\n");
+				print_usage ();
+				return (-1);
+			}
+			work_arg = argv[i + 1];
+			thread_num = atoi (work_arg);
+			if (thread_num < 1) {
+				thread_num = 1;
+			}
+			if (thread_num > CefC_Valid_Pool_Thread_Max + 1) {
+				thread_num = CefC_Valid_Pool_Thread_Max + 1;
+			}
+			thread_f++;
+			i++;
 		} else {
 			
 			work_arg = argv[i];
@@ -488,12 +514,20 @@ int main (
 			fprintf (stdout, "ERROR: KeyIdRestriction not get KeyId.\n");
 			exit (1);
 		}
+		/* Signs in batches with the threads. The Manifest (mode 2) needs	*/
+		/* the hash of the signed Content Object, so it is signed inline. 	*/
+		if ((mode_val == 0) && (thread_num > 1)) {
+			if (cef_valid_pool_init (thread_num - 1) > 0) {
+				cef_frame_set_sign_defer_f (1);
+				sign_defer_f = 1;
+			}
+		}
 	}
 
 	/*--------------------------------------------
 		For ConHash
 	--------------------------------------------*/
-	if ( (mode_val == 1) || ( mode_val == 2) ) {
+	if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 		memset (&man_opt, 0, sizeof (CefT_CcnMsg_OptHdr));	
 		memset (&man_params, 0, sizeof (CefT_CcnMsg_MsgBdy));
 		strcat( man_uri, CefC_MANIFEST_NAME );
@@ -517,6 +551,18 @@ int main (
 		} else {
 			man_params.expiry = now_ms + 3600000;
 		}
+
+		/* Signs only the Manifest. The chunks are validated by the CobHash 	*/
+		/* in the signed Manifest, so one signature covers CefC_MANIFEST_REC_MAX	*/
+		/* chunks.																*/
+		if (mode_val == 3) {
+			cef_valid_init (conf_path);
+			man_params.alg.valid_type = (uint16_t) cef_valid_type_get ("sha256");
+			if (man_params.alg.valid_type == CefC_T_ALG_INVALID) {
+				fprintf (stdout, "ERROR: Manifest can not be signed.\n");
+				exit (1);
+			}
+		}
 	}
 	
 
@@ -540,6 +586,9 @@ int main (
 	fprintf (stdout, "[cefputfile_sec] Block Size  = %d Bytes\n", block_size);
 	fprintf (stdout, "[cefputfile_sec] Cache Time  = %d sec\n", cache_time);
 	fprintf (stdout, "[cefputfile_sec] Expiration  = "FMTU64" sec\n", expiry);
+	if (sign_defer_f) {
+		fprintf (stdout, "[cefputfile_sec] Sign Thread = %d\n", thread_num);
+	}
 	
 	/*------------------------------------------
 		Calculates the interval
@@ -586,7 +635,7 @@ printf ( "CKP-010 params.end_chunk_num_f:%d  params.end_chunk_num:%d\n", params.
 #endif
 				}
 				//0.8.3
-				if ( (mode_val == 1) || ( mode_val == 2) ) {
+				if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 					params.ObjHash_f= 1;
 					memset( params.ObjHash_val, 0x00, 32 );
 					man_params.end_chunk_num_f = params.end_chunk_num_f;
@@ -605,13 +654,13 @@ printf ( "CKP-020 cob_len:%d\n", cob_len );
 					exit (1);
 				}
 				//0.8.3 ObjHash
-				if ( (mode_val == 1) || ( mode_val == 2) ) {
+				if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 					if ( man_buff_idx == 0 ) {
 						man_buff_idx = 4;
 					}
 #ifdef	__DEB_PUT__
 printf ( "CKP-030 man_buff_idx:%d\n", man_buff_idx );
-if ( (mode_val == 1) || ( mode_val == 2) ) {
+if ( (mode_val == 1) || ( mode_val == 2) || (mode_val == 3) ) {
 	int hidx;
 	char	hash_dbg[1024];
 	sprintf (hash_dbg, "CobHash [");
@@ -707,6 +756,12 @@ printf ( "CKP-040 work_buff_idx:%d\n", work_buff_idx );
 printf ( "CKP-050 work_buff_idx:%d\n", work_buff_idx );
 #endif				
 		if (work_buff_idx > 0) {
+			if (sign_defer_f) {
+				if (cef_client_objects_sign (work_buff, work_buff_idx) < 0) {
+					fprintf (stdout, "ERROR: Content Objects can not be signed.\n");
+					exit (1);
+				}
+			}
 			cef_client_message_input (fhdl, work_buff, work_buff_idx);
 			work_buff_idx = 0;
 #ifdef	__DEB_PUT__
@@ -737,6 +792,9 @@ printf ( "CKP-061 work_buff_idx:%d\n", work_buff_idx );
 	if (work_buff) {
 		free (work_buff);
 	}
+	if (sign_defer_f) {
+		cef_valid_pool_destroy ();
+	}
 
 	post_process ();
 	exit (0);
@@ -749,7 +807,7 @@ print_usage (
 	
 	fprintf (stdout, "\nUsage: cefputfile_sec\n");
 	fprintf (stdout, "  cefputfile_sec uri -f path [-r rate] [-b block_size] [-e expiry] "
-					 "[-t cache_time] [-m mode] [-d config_file_dir] [-p port_num] \n\n");
+					 "[-t cache_time] [-m mode] [-j threads] [-d config_file_dir] [-p port_num] \n\n");
 	fprintf (stderr, "  uri              Specify the URI.\n");
 	fprintf (stdout, "  path             Specify the file path of output. \n");
 	fprintf (stdout, "  rate             Transfer rate to cefnetd (Mbps)\n");
@@ -758,7 +816,9 @@ print_usage (
 	fprintf (stdout, "  cache_time       Specifies the period (seconds) after which Content Objects are cached before they are deleted.\n");
 	fprintf (stdout, "  m                0: Create Cob with added security information corresponding to KeyIdRestriction.\n"
 	                 "                   1: Create a Manifest paired with the content and register it as content.\n"
-	                 "                   2: Create a Cob with added security information corresponding to KeyIdRestriction, create a Manifest paired with the content, and register it as content.\n");
+	                 "                   2: Create a Cob with added security information corresponding to KeyIdRestriction, create a Manifest paired with the content, and register it as content.\n"
+	                 "                   3: Create a Manifest paired with the content and register it as content. Only the Manifest is signed.\n");
+	fprintf (stdout, "  threads          Specifies the number of threads which sign the Content Objects in mode 0.\n");
 	fprintf (stderr, "  config_file_dir  Configure file directory\n");
 	fprintf (stderr, "  port_num         Port Number\n\n");
 }
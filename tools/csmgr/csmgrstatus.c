@@ -462,12 +462,23 @@ output_result (
 	memcpy (&stat_hdr, &frame[0], sizeof (struct CefT_Csmgr_Status_Hdr));
 	stat_hdr.node_num 	= ntohs (stat_hdr.node_num);
 	stat_hdr.con_num 	= ntohl (stat_hdr.con_num);
+	stat_hdr.ingest_num 	= cef_client_ntohb (stat_hdr.ingest_num);
+	stat_hdr.ingest_drop 	= cef_client_ntohb (stat_hdr.ingest_drop);
+	stat_hdr.ingest_block 	= cef_client_ntohb (stat_hdr.ingest_block);
 	
 	fprintf (stderr, "*****   Connection Status Report   *****\n");
 	fprintf (stderr, "All Connection Num             : %d\n\n", stat_hdr.node_num);
 	
 	fprintf (stderr, "*****   Cache Status Report        *****\n");
 	fprintf (stderr, "Number of Cached Contents      : %d\n\n", stat_hdr.con_num);
+
+	fprintf (stderr, "*****   Upload Status Report       *****\n");
+	fprintf (stderr, "Received Cobs                  : %llu\n",
+		(unsigned long long) stat_hdr.ingest_num);
+	fprintf (stderr, "Dropped Cobs                   : %llu\n",
+		(unsigned long long) stat_hdr.ingest_drop);
+	fprintf (stderr, "Waits for Free Buffer          : %llu\n\n",
+		(unsigned long long) stat_hdr.ingest_block);
 	index += sizeof (struct CefT_Csmgr_Status_Hdr);
 	
 	while (index < frame_size) {